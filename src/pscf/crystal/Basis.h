@@ -13,11 +13,16 @@
 #include <pscf/crystal/SpaceGroup.h>
 #include <util/containers/DArray.h>
 #include <util/containers/GArray.h>
+#include <string>
+#include <vector>
+#include <iosfwd>
 
 namespace Pscf { 
 
    using namespace Util;
 
+   template <int D> struct TWave;
+
    /**
    * Symmetry-adapted basis for pseudo-spectral scft.
    *
@@ -165,6 +170,39 @@ namespace Pscf {
       */
       void update();
 
+      /**
+      * Read a basis previously saved by writeCache, if compatible.
+      *
+      * A cached basis is accepted only if it was created for the same
+      * space group name, mesh dimensions and lattice system, and (for 
+      * lattice systems with more than one parameter, for which the 
+      * order of stars depends on the cell shape) the same unit cell 
+      * parameters. If so, the basis is initialized from the file and 
+      * wave and star norms are recomputed for the current unit cell.
+      * If the file cannot be read or does not contain a valid basis,
+      * this basis is left empty and false is returned, so that 
+      * makeBasis may be called instead.
+      *
+      * \param fileName  name of cache file
+      * \param mesh  spatial discretization mesh
+      * \param unitCell  crystallographic unit cell
+      * \param groupName  name of space group 
+      * \return true if the basis was read, false otherwise
+      */
+      bool readCache(std::string const & fileName, 
+                     const Mesh<D>& mesh, const UnitCell<D>& unitCell, 
+                     std::string const & groupName);
+
+      /**
+      * Write this basis to a binary cache file for use by readCache.
+      *
+      * \param fileName  name of cache file
+      * \param groupName  name of space group used to make the basis
+      * \return true if the file was written, false otherwise
+      */
+      bool writeCache(std::string const & fileName, 
+                      std::string const & groupName) const;
+
       /**
       * Print a list of all waves to an output stream.
       *
@@ -262,6 +300,35 @@ namespace Pscf {
       */
       void makeStars(const SpaceGroup<D>& group);
 
+      /**
+      * Identify all stars in one list of waves of equal magnitude.
+      *
+      * \param listBegin  index of first wave in list
+      * \param listEnd  index one past the last wave in list
+      * \param group  space group
+      * \param twaves  waves of all lists, each sorted by indicesDft
+      * \param rootIds  index of root of star containing each wave
+      * \param stars  container to which stars are appended
+      */
+      void makeListStars(int listBegin, int listEnd, 
+                         const SpaceGroup<D>& group,
+                         std::vector< TWave<D> >& twaves,
+                         std::vector<int>& rootIds,
+                         std::vector<Star>& stars);
+
+      /**
+      * Read and validate the contents of a cache file (see readCache).
+      *
+      * \param file  input file stream, open for binary input
+      * \param mesh  spatial discretization mesh
+      * \param unitCell  crystallographic unit cell
+      * \param groupName  name of space group 
+      * \return true if a valid, compatible basis was read
+      */
+      bool readCacheFile(std::ifstream& file,
+                         const Mesh<D>& mesh, const UnitCell<D>& unitCell,
+                         std::string const & groupName);
+
       /**
       * Access associated Mesh<D> as const reference.
       */
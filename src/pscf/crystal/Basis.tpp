@@ -13,9 +13,11 @@
 #include "groupFile.h"
 #include <pscf/crystal/shiftToMinimum.h>
 #include <pscf/mesh/MeshIterator.h>
+#include <util/archives/BinaryFileOArchive.h>
+#include <util/archives/BinaryFileIArchive.h>
 #include <algorithm>
 #include <vector>
-#include <set>
+#include <exception>
 #include <fstream>
 
 namespace Pscf {
@@ -123,30 +125,64 @@ namespace Pscf {
    void Basis<D>::makeWaves()
    {
       IntVec<D> meshDimensions = mesh().dimensions();
-      std::vector< TWave<D> > twaves;
-      twaves.reserve(nWave_);
+      std::vector< TWave<D> > twaves(nWave_);
+
+      // Compute minimum image and norm for every wave of the dft mesh.
+      // Waves are independent, so this loop may be run in parallel.
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for schedule(static)
+      #endif
+      for (int rank = 0; rank < nWave_; ++rank) {
+         TWave<D>& w = twaves[rank];
+         w.indicesDft = mesh().position(rank);
+         w.indicesBz = shiftToMinimum(w.indicesDft, meshDimensions, 
+                                      *unitCellPtr_);
+         w.sqNorm = unitCell().ksq(w.indicesBz);
+         w.phase = 0.0;
+      }
 
-      // Loop over dft mesh to generate all waves, add to twaves
-      TWave<D> w;
-      IntVec<D> v;
-      MeshIterator<D> itr(mesh().dimensions());
-      for (itr.begin(); !itr.atEnd(); ++itr) {
-         w.indicesDft = itr.position();
-         v = shiftToMinimum(w.indicesDft, meshDimensions, *unitCellPtr_);
-         w.indicesBz = v;
-         w.sqNorm = unitCell().ksq(v);
-         twaves.push_back(w);
+      // Distribute waves among buckets that span equal intervals of 
+      // sqNorm, in order of increasing sqNorm, by a counting sort.
+      double maxNorm = 0.0;
+      int i, b;
+      for (i = 0; i < nWave_; ++i) {
+         if (twaves[i].sqNorm > maxNorm) maxNorm = twaves[i].sqNorm;
+      }
+      const int nBucket = nWave_/16 + 1;
+      const double scale = (maxNorm > 0.0) ? nBucket/maxNorm : 0.0;
+      std::vector<int> bucketIds(nWave_);
+      std::vector<int> bucketBegins(nBucket + 1, 0);
+      for (i = 0; i < nWave_; ++i) {
+         b = (int)(twaves[i].sqNorm*scale);
+         if (b >= nBucket) b = nBucket - 1;
+         bucketIds[i] = b;
+         ++bucketBegins[b + 1];
+      }
+      for (b = 0; b < nBucket; ++b) {
+         bucketBegins[b + 1] += bucketBegins[b];
+      }
+      std::vector< TWave<D> > sorted(nWave_);
+      std::vector<int> next(bucketBegins.begin(), bucketBegins.end() - 1);
+      for (i = 0; i < nWave_; ++i) {
+         sorted[next[bucketIds[i]]++] = twaves[i];
       }
 
-      // Sort temporary array twaves
+      // Sort waves within each bucket. Buckets are ordered by sqNorm,
+      // so this yields an array of all waves sorted by sqNorm.
       TWaveNormComp<D> comp;
-      std::sort(twaves.begin(), twaves.end(), comp);
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for schedule(dynamic, 64)
+      #endif
+      for (b = 0; b < nBucket; ++b) {
+         std::sort(sorted.begin() + bucketBegins[b], 
+                   sorted.begin() + bucketBegins[b + 1], comp);
+      }
 
-      // Copy temporary array twaves into member variable waves_
-      for (int i = 0; i < nWave_; ++i) {
-         waves_[i].sqNorm = twaves[i].sqNorm;
-         waves_[i].indicesDft = twaves[i].indicesDft;
-         waves_[i].indicesBz = twaves[i].indicesBz;
+      // Copy sorted array into member variable waves_
+      for (i = 0; i < nWave_; ++i) {
+         waves_[i].sqNorm = sorted[i].sqNorm;
+         waves_[i].indicesDft = sorted[i].indicesDft;
+         waves_[i].indicesBz = sorted[i].indicesBz;
       }
 
    }
@@ -154,122 +190,32 @@ namespace Pscf {
    template <int D>
    void Basis<D>::makeStars(const SpaceGroup<D>& group)
    {
-      /* 
-      * Local containers that hold TWave<D> objects:
-      * list - set of waves of equal norm, compared by indicesDft
-      * star - set of symmetry-related waves, compared by indicesDft
-      * tempStar - temporary star, sorted by descending indicesBz
-      * tempList - temporary list, ordered by star
-      */
-      std::set< TWave<D>, TWaveDftComp<D> > list;  
-      std::set< TWave<D>, TWaveDftComp<D> > star;  
-      std::vector< TWave<D> > tempStar;  
-      GArray< TWave<D> > tempList;            
-
-      typename std::set< TWave<D>, TWaveDftComp<D> >::iterator rootItr;
-      typename std::set< TWave<D>, TWaveDftComp<D> >::iterator setItr;
-      TWave<D> wave;
-      Basis<D>::Star newStar;
-
-      std::complex<double> coeff;
-      double Gsq;
-      double Gsq_max;
-      double phase_diff;
-      const double twoPi = 2.0*Constants::Pi;
-      const double epsilon = 1.0E-8;
-      IntVec<D> meshDimensions = mesh().dimensions();
-      IntVec<D> rootVecBz;   // BZ indices for root of this star
-      IntVec<D> vec;         // Indices of temporary wavevector
-      IntVec<D> nVec;        // Indices of negation of a wavevector
-      int listId = 0;        // id for this list
-      int listBegin = 0;     // id of first wave in this list
-      int listEnd = 0;       // (id of last wave in this list) + 1
-      int listSize;          // listEnd - listBegin
-      int starId = 0;        // id for this star
-      int starBegin = 0;     // id of first wave in this star
-      int i, j, k;
-      bool cancel;
-
       /*
       * Overview of algorithm:
       *
-      * Loop over index i of array waves_ {
-      *
-      *   Search for end of a "list", contiguous block of waves of equal
-      *   magnitude, with indices [listBegin,listEnd-1]. Set newList true.
-      *
-      *   // Each list can contain one or more stars.
-      *   // Process the newly identified list to identify stars
-      *
-      *   If (newList) {
-      *   
-      *     Copy all waves in range into container std::set<TWave<D>> list
+      * Identify "lists", contiguous blocks of waves_ of equal magnitude,
+      * with indices [listBegin,listEnd-1]. Each list can contain one or
+      * more stars.
       *
-      *     Set rootItr to first wave in list
+      * Copy waves_ into std::vector<TWave> twaves, and sort the block 
+      * of twaves associated with each list by indicesDft. Temporarily
+      * use waveIds_ as a look up table, in which waveIds_[rank] is the
+      * index in twaves of the wave with dft indices of mesh rank rank.
       *
-      *     // Loop over stars within list
-      *     while (list.size() > 0) {
-      *
-      *       // To generate a star from a root wave rootItr, 
-      *       // loop over symmetry operations of space group.
-      *       For each group symmetry operation group[j] {
-      *         Compute vec = (rootItr->indicesBz)*group[j]
-      *         Set phase = rootItr->indicesBz .dot. group[j].t 
-      *         Check for cancellation of the star, set cancel flag
-      *         Add wave to std::set<TWave> star if not added before
-      *         // Here, use of a std::set simplifies test of uniqueness
-      *       }
-      *
-      *       Copy all waves from star to std::vector<TWave> tempStar
-      *       Sort tempStar by indicesBz in descending order
-      *       // Here, use of ordered container std::vector allows sorting
-      *       For each wave in tempStar {
-      *         Append wave to std::vector<TWave> tempList
-      *         Erase wave from std::set<TWave> list
-      *         // Here, use of a std::set for list simplifies erasure
-      *       }
-      *
-      *       Initialize a Star object newStar and assign values
-      *       to members beginId, endId, size, eigen, cancel
-      *
-      *       // Assign values of newStar.invertFlag, rootItr, nextInvert
-      *       if (nextInvert == -1) { 
-      *          // This is the second star in pair
-      *          newStar.invertFlag = -1;
-      *          nextInvert = 1;
-      *          Set rootItr to the first wave in remaining list
-      *       } else {
-      *          Search for negation of rootItr in this star
-      *          if negation is in this star {
-      *             newStar.invertFlag = 0
-      *             nextInvert = 1;
-      *             Set rootItr to the first wave in remaining list
-      *          } else 
-      *          Search for negation of rootItr in this remaining list
-      *          if the negation is in the remaining list {
-      *             newStar.invertFlag = 1
-      *             nextInvert = -1;
-      *             set rootItr to negation of current root
-      *          }
-      *       }
-      *
-      *       Append newStar object to DArray<Basis::Star> stars_ 
-      *
-      *     } // end loop over stars in a single list
-      *
-      *     For each TWave in tempList {
-      *       Copy TWave in tempList to a Basis:Wave in  waves_
-      *       Assign a complex coefficient of unit norm to the Wave
-      *     }
-      *     // This overwrites a block of the waves_ array 
-      *
-      *     // At this point, coefficients of waves have correct
-      *     // correct relative phases within a star, but not final 
-      *     // absolute phases and have unit absolute magnitude.
+      * For each list {
+      *   Call makeListStars to identify the stars within the list,
+      *   append them to a separate std::vector<Star> for this list,
+      *   and overwrite the block of waves_ used to create the list 
+      *   with the same waves, ordered by star. 
+      * }
+      * // Lists are independent, and are processed in parallel when 
+      * // PSCF_OPENMP is defined.
       *
-      *   } // end processing of one list (waves of equal norm)
+      * Concatenate the stars of all lists, in order, into stars_.
       *
-      * } // End initial processing of all waves and stars
+      * // At this point, coefficients of waves have correct
+      * // correct relative phases within a star, but not final 
+      * // absolute phases and have unit absolute magnitude.
       *
       * // Set absolute wave coefficients
       * For each star in array stars_ {
@@ -311,295 +257,89 @@ namespace Pscf {
       * }
       */
 
-      // Loop over all waves
-      nBasis_ = 0;
-      nBasisWave_ = 0;
-      Gsq_max = waves_[0].sqNorm;
-      for (i = 1; i <= nWave_; ++i) {
-
-         // Determine if this wave begins a new list
-         bool newList = false;
-         if (i == nWave_) {
-            listEnd = i;
-            listSize = listEnd - listBegin;
-            newList = true;
-         } else {
-            Gsq = waves_[i].sqNorm;
-            if (Gsq > Gsq_max + epsilon) {
-               Gsq_max = Gsq;
-               listEnd = i;
-               listSize = listEnd - listBegin;
-               newList = true;
-            }
+      const double epsilon = 1.0E-8;
+      IntVec<D> meshDimensions = mesh().dimensions();
+      IntVec<D> vec;         // Indices of temporary wavevector
+      IntVec<D> nVec;        // Indices of negation of a wavevector
+      int i, j;
+
+      // Identify lists of waves of equal norm. Element listBegins[i] 
+      // is the index of the first wave in list i, and the last element
+      // is nWave_.
+      std::vector<int> listBegins;
+      double Gsq_max = waves_[0].sqNorm;
+      listBegins.push_back(0);
+      for (i = 1; i < nWave_; ++i) {
+         if (waves_[i].sqNorm > Gsq_max + epsilon) {
+            Gsq_max = waves_[i].sqNorm;
+            listBegins.push_back(i);
          }
+      }
+      listBegins.push_back(nWave_);
+      const int nList = listBegins.size() - 1;
 
-         // Process completed list of wavectors of equal norm
-         if (newList && listEnd > 0) {
-
-            // Copy waves of equal norm into std::set "list"
-            list.clear();
-            tempList.clear();
-            for (j = listBegin; j < listEnd; ++j) {
-               wave.indicesDft = waves_[j].indicesDft;
-               wave.indicesBz = waves_[j].indicesBz;
-               wave.sqNorm = waves_[j].sqNorm;
-               if (j > listBegin) {
-                  UTIL_CHECK( abs(wave.sqNorm-waves_[j].sqNorm) 
-                                 < 2.0*epsilon ); 
-               }
-               list.insert(wave);
-            }
-
-            // On entry to each iteration of the loop over stars,
-            // rootItr and nextInvert are known. The iterator rootItr 
-            // points to the wave in the remaining list that will be 
-            // used as the root of the next star. The flag nextInvert 
-            // is equal to -1 iff the previous star was the first of
-            // a pair that are open under inversion, and is equal 
-            // to + 1 otherwise.
-
-            // Initial values for first star in this list
-            rootItr = list.begin();
-            int nextInvert = 1;
-
-            // Loop over stars with a list of waves of equal norm,
-            // removing each star from the list as it is identified.
-            // The root of the next star must have been chosen on
-            // entry to each iteration of this loop.
-
-            while (list.size() > 0) {
-
-               rootVecBz = rootItr->indicesBz;
-               Gsq = rootItr->sqNorm;
-               cancel = false;
-               star.clear();
-
-               // Construct a star from root vector, by applying every
-               // symmetry operation in the group to the root wavevector.
-               for (j = 0; j < group.size(); ++j) {
-
-                  // Apply symmetry (i.e., multiply by rotation matrix)
-                  // vec = rotated wavevector.
-                  vec = rootVecBz*group[j];
-
-                  // Check that rotated vector has same norm as root.
-                  UTIL_CHECK(abs(Gsq - unitCell().ksq(vec)) < epsilon);
-
-                  // Initialize TWave object associated with rotated wave
-                  wave.sqNorm = Gsq;
-                  wave.indicesBz = shiftToMinimum(vec, meshDimensions, 
-                                                  *unitCellPtr_);
-                  wave.indicesDft = vec;
-                  mesh().shift(wave.indicesDft);
-
-                  // Compute phase for coeff. of wave in basis function.
-                  // Convention -pi < phase <= pi.
-                  wave.phase = 0.0;
-                  for (k = 0; k < D; ++k) {
-                     wave.phase += rootVecBz[k]*(group[j].t(k));
-                  }
-                  while (wave.phase > 0.5) {
-                     wave.phase -= 1.0;
-                  }
-                  while (wave.phase <= -0.5) {
-                     wave.phase += 1.0;
-                  }
-                  wave.phase *= twoPi;
-
-                  // Check for cancellation of star: The star is
-                  // cancelled if application of any symmetry operation
-                  // in the group to the root vector yields a rotated 
-                  // vector equivalent to the root vector but with a 
-                  // nonzero phase, creating a contradiction.
-
-                  if (wave.indicesDft == rootItr->indicesDft) {
-                     if (abs(wave.phase) > 1.0E-6) {
-                        cancel = true;
-                     }
-                  }
-
-                  // Search for an equivalent wave already in the star.
-                  // Note: Equivalent waves have equal DFT indices.
-                  setItr = star.find(wave);
-
-                  if (setItr == star.end()) {
-
-                     // If no equivalent wave is found in the star,
-                     // then add this wave to the star
-                     star.insert(wave);
-
-                  } else {
-
-                     // If an equivalent wave is found, check if the
-                     // phases are equivalent. If not, the star is
-                     // cancelled.
-
-                     phase_diff = setItr->phase - wave.phase;
-                     while (phase_diff > 0.5) {
-                        phase_diff -= 1.0;
-                     }
-                     while (phase_diff <= -0.5) {
-                        phase_diff += 1.0;
-                     }
-                     if (abs(phase_diff) > 1.0E-6) {
-                        cancel = true;
-                     }
-
-                  }
-
-               }
-
-               // Copy all waves from set star to std::vector tempStar
-               tempStar.clear();
-               setItr = star.begin(); 
-               for ( ; setItr != star.end(); ++setItr) {
-                  tempStar.push_back(*setItr);
-               }
-
-               // Sort tempStar, in descending order by indicesBz.
-               TWaveBzComp<D> waveBzComp;
-               std::sort(tempStar.begin(), tempStar.end(), waveBzComp);
-               
-               // Append contents of tempStar to tempList, erase from list
-               int tempStarSize = tempStar.size();
-               for (j = 0; j < tempStarSize; ++j) {
-                  list.erase(tempStar[j]);
-                  tempList.append(tempStar[j]);
-               }
-               UTIL_CHECK((int)(tempList.size()+list.size()) == listSize);
-
-               // If this star is not cancelled, increment the number of 
-               // basis functions (nBasis_) and waves in basis (nBasisWave_)
-               if (!cancel) {
-                  ++nBasis_;
-                  nBasisWave_ += star.size();
-               }
-
-               // Initialize a Star object 
-               newStar.eigen = Gsq;
-               newStar.beginId = starBegin;
-               newStar.endId = newStar.beginId + star.size();
-               newStar.size = star.size();
-               newStar.cancel = cancel;
-               // Note: newStar.starInvert is not yet known
-
-               // Determine invertFlag, rootItr and nextInvert
-               if (nextInvert == -1) {
-
-                  // If this star is 2nd of a pair related by inversion,
-                  // set root of next star to 1st wave of remaining list.
-
-                  newStar.invertFlag = -1;
-                  rootItr = list.begin();
-                  nextInvert = 1;
-
-               } else {
-
-                  // If this star is not the 2nd of a pair of partners,
-                  // then determine if it is closed under inversion.
-
-                  // Compute negation nVec of root vector in FBZ
-                  nVec.negate(rootVecBz);
-
-                  // Shift negation nVec to a DFT mesh
-                  (*meshPtr_).shift(nVec);
-       
-                  // Search for negation of root vector within this star
-                  bool negationFound = false;
-                  setItr = star.begin(); 
-                  for ( ; setItr != star.end(); ++setItr) {
-                     if (nVec == setItr->indicesDft) {
-                        negationFound = true;
-                        break;
-                     }
-                  }
-
-                  if (negationFound) {
-
-                     // If this star is closed under inversion, the root
-                     // of next star is the 1st vector of remaining list.
-
-                     newStar.invertFlag = 0;
-                     rootItr = list.begin();
-                     nextInvert = 1;
-
-                  } else {
-
-                     newStar.invertFlag = 1;
-                     nextInvert = -1;
-
-                     // If star is not closed, find negation of root in
-                     // the remaining list, and use this negation as the
-                     // root of the next star.
-
-                     setItr = list.begin();
-                     for ( ; setItr != list.end(); ++setItr) {
-                        if (nVec == setItr->indicesDft) {
-                           negationFound = true;
-                           rootItr = setItr;
-                           break;
-                        }
-                     }
-                     // If negationFound, then rootItr->indicesDft = nVec
-
-                     // Failure to find the negation here is an error:
-                     // It must be either in this star or remaining list
-
-                     if (!negationFound) {
-                        std::cout << "Negation not found for: " << "\n";
-                        std::cout << " vec (ft):" 
-                                  << rootItr->indicesDft <<"\n"; 
-                        std::cout << " vec (bz):" 
-                                  << rootItr->indicesBz <<"\n"; 
-                        std::cout << "-vec (dft):" << nVec << "\n";
-                        UTIL_CHECK(negationFound);
-                     }
-
-                  }
+      // Copy waves into twaves, and sort each list by indicesDft
+      std::vector< TWave<D> > twaves(nWave_);
+      for (i = 0; i < nWave_; ++i) {
+         twaves[i].indicesDft = waves_[i].indicesDft;
+         twaves[i].indicesBz = waves_[i].indicesBz;
+         twaves[i].sqNorm = waves_[i].sqNorm;
+         twaves[i].phase = 0.0;
+      }
+      TWaveDftComp<D> dftComp;
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for schedule(dynamic)
+      #endif
+      for (int listId = 0; listId < nList; ++listId) {
+         std::sort(twaves.begin() + listBegins[listId], 
+                   twaves.begin() + listBegins[listId+1], dftComp);
+      }
 
-               }
+      // Map mesh rank of dft indices to index in twaves
+      for (i = 0; i < nWave_; ++i) {
+         waveIds_[mesh().rank(twaves[i].indicesDft)] = i;
+      }
 
-               stars_.append(newStar);
-               ++starId;
-               starBegin = newStar.endId;
-
-            } 
-            // End loop over stars within a list.
-
-            UTIL_CHECK(list.size() == 0);
-            UTIL_CHECK(tempList.size() == listEnd - listBegin);
-
-            // Copy tempList into corresponding section of waves_,
-            // overwriting the section of waves_ used to create the list.
-            // Compute a complex coefficient of unit norm for each wave.
-            for (j = 0; j < tempList.size(); ++j) {
-               k = j + listBegin;
-               waves_[k].indicesDft = tempList[j].indicesDft;
-               waves_[k].indicesBz = tempList[j].indicesBz;
-               waves_[k].sqNorm = tempList[j].sqNorm;
-               coeff = std::complex<double>(0.0, tempList[j].phase);
-               coeff = exp(coeff);
-               if (abs(imag(coeff)) < 1.0E-6) {
-                  coeff = std::complex<double>(real(coeff), 0.0);
-               }
-               if (abs(real(coeff)) < 1.0E-6) {
-                  coeff = std::complex<double>(0.0, imag(coeff));
-               }
-               waves_[k].coeff = coeff;
+      // Identify stars within each list. An exception thrown while
+      // processing any list is rethrown after the loop over lists.
+      std::vector<int> rootIds(nWave_, -1);
+      std::vector< std::vector<Star> > listStars(nList);
+      std::exception_ptr error;
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for schedule(dynamic)
+      #endif
+      for (int listId = 0; listId < nList; ++listId) {
+         try {
+            makeListStars(listBegins[listId], listBegins[listId+1], 
+                          group, twaves, rootIds, listStars[listId]);
+         } catch (...) {
+            #ifdef PSCF_OPENMP
+            #pragma omp critical
+            #endif
+            {
+               if (!error) error = std::current_exception();
             }
+         }
+      }
+      if (error) {
+         std::rethrow_exception(error);
+      }
 
-            // Processing of list is now complete.
-            // Here, waves_[k].coeff has unit absolute magnitude, and
-            // correct relative phases for waves within a star, but
-            // the coeff may not be unity for the first or last wave in
-            // the star.
-
-            ++listId;
-            listBegin = listEnd;
-         } 
-         // Finished processing a list of waves of equal norm
-
-      } // End loop over all waves
+      // Concatenate stars of all lists, and count basis functions 
+      // (uncancelled stars) and waves in basis functions
+      stars_.clear();
+      nBasis_ = 0;
+      nBasisWave_ = 0;
+      for (int listId = 0; listId < nList; ++listId) {
+         std::vector<Star> const & stars = listStars[listId];
+         for (j = 0; j < (int)stars.size(); ++j) {
+            stars_.append(stars[j]);
+            if (!stars[j].cancel) {
+               ++nBasis_;
+               nBasisWave_ += stars[j].size;
+            }
+         }
+      }
       nStar_ = stars_.size();
       // Complete initial processing of all lists and stars
 
@@ -777,6 +517,297 @@ namespace Pscf {
    }
 
  
+   /*
+   * Identify stars within one list of waves of equal norm.
+   *
+   * On entry, block [listBegin, listEnd-1] of twaves contains the
+   * waves of this list sorted by indicesDft, waveIds_[rank] is the
+   * index in twaves of the wave with dft indices of mesh rank rank, 
+   * and rootIds[i] = -1 for all waves in the list. 
+   *
+   * On exit, the stars of this list have been appended to stars,
+   * and block [listBegin, listEnd-1] of waves_ contains the waves of
+   * the list ordered by star. Within each star, waves are listed in
+   * descending order of indicesBz, and each has a coefficient of 
+   * unit norm with correct phase relative to other waves in the star.
+   * 
+   * Algorithm:
+   *
+   *   Set root to first wave in list
+   *
+   *   // Loop over stars within list
+   *   while (some waves of the list are not yet in a star) {
+   *
+   *     // To generate a star from a root wave, 
+   *     // loop over symmetry operations of space group.
+   *     For each group symmetry operation group[j] {
+   *       Compute vec = (root.indicesBz)*group[j]
+   *       Set phase = root.indicesBz .dot. group[j].t 
+   *       Check for cancellation of the star, set cancel flag
+   *       Find index id of vec in twaves from its mesh rank
+   *       If wave id is not yet in this star (rootIds[id] != root) {
+   *         Add it: Set rootIds[id] = root and store its phase
+   *       } else {
+   *         Compare phases, set cancel flag if they differ
+   *       }
+   *     }
+   *
+   *     Sort waves of star by indicesBz in descending order
+   *     Copy them to the next block of waves_, with coefficients
+   *
+   *     Initialize a Star object newStar and assign values
+   *     to members beginId, endId, size, eigen, cancel
+   *
+   *     // Assign values of newStar.invertFlag, root, nextInvert
+   *     if (nextInvert == -1) { 
+   *        // This is the second star in pair
+   *        newStar.invertFlag = -1;
+   *        nextInvert = 1;
+   *        Set root to the first wave in remaining list
+   *     } else {
+   *        Find index of negation of root from its mesh rank
+   *        if negation is in this star {
+   *           newStar.invertFlag = 0
+   *           nextInvert = 1;
+   *           Set root to the first wave in remaining list
+   *        } else 
+   *        if the negation is in the remaining list {
+   *           newStar.invertFlag = 1
+   *           nextInvert = -1;
+   *           Set root to negation of current root
+   *        }
+   *     }
+   *
+   *     Append newStar to stars
+   *   }
+   *
+   * A wave remains in the list iff rootIds[id] == -1. Look up by mesh 
+   * rank replaces the search and erasure of ordered std::set containers,
+   * and the indicesBz of each rotated wave are copied from the minimum 
+   * image found by makeWaves, rather than recomputed.
+   */
+   template <int D>
+   void Basis<D>::makeListStars(int listBegin, int listEnd, 
+                                const SpaceGroup<D>& group,
+                                std::vector< TWave<D> >& twaves,
+                                std::vector<int>& rootIds,
+                                std::vector<Star>& stars)
+   {
+      std::vector<int> star;  // indices in twaves of waves in a star
+      Basis<D>::Star newStar;
+      std::complex<double> coeff;
+      double Gsq;
+      double phase;
+      double phase_diff;
+      const double twoPi = 2.0*Constants::Pi;
+      const double epsilon = 1.0E-8;
+      IntVec<D> rootVecBz;   // BZ indices for root of this star
+      IntVec<D> vec;         // Indices of temporary wavevector
+      IntVec<D> nVec;        // Indices of negation of a wavevector
+      const int listSize = listEnd - listBegin;
+      int nRemoved = 0;        // number of waves assigned to stars
+      int firstId = listBegin; // lower bound on first remaining wave
+      int rootId = listBegin;  // index of root of next star
+      int starBegin = listBegin; // id of first wave in this star
+      int nextInvert = 1;
+      int id, j, k;
+      bool cancel;
+
+      // Comparator for indices of waves, by descending indicesBz
+      struct BzComp {
+         std::vector< TWave<D> > const * twavesPtr;
+         bool operator() (int a, int b) const
+         {  return ((*twavesPtr)[a].indicesBz > (*twavesPtr)[b].indicesBz); }
+      } bzComp;
+      bzComp.twavesPtr = &twaves;
+
+      // Star::waveBz is set after all stars are identified
+      for (j = 0; j < D; ++j) {
+         newStar.waveBz[j] = 0;
+      }
+
+      // Loop over stars with a list of waves of equal norm. The root 
+      // of the next star must have been chosen on entry to each 
+      // iteration, and nextInvert is -1 iff the previous star was 
+      // the first of a pair that are open under inversion.
+      while (nRemoved < listSize) {
+
+         rootVecBz = twaves[rootId].indicesBz;
+         Gsq = twaves[rootId].sqNorm;
+         cancel = false;
+         star.clear();
+
+         // Construct a star from root vector, by applying every
+         // symmetry operation in the group to the root wavevector.
+         for (j = 0; j < group.size(); ++j) {
+
+            // Apply symmetry (i.e., multiply by rotation matrix)
+            // vec = rotated wavevector.
+            vec = rootVecBz*group[j];
+
+            // Check that rotated vector has same norm as root.
+            UTIL_CHECK(abs(Gsq - unitCell().ksq(vec)) < epsilon);
+
+            // Compute phase for coeff. of wave in basis function.
+            // Convention -pi < phase <= pi.
+            phase = 0.0;
+            for (k = 0; k < D; ++k) {
+               phase += rootVecBz[k]*(group[j].t(k));
+            }
+            while (phase > 0.5) {
+               phase -= 1.0;
+            }
+            while (phase <= -0.5) {
+               phase += 1.0;
+            }
+            phase *= twoPi;
+
+            // Find index of rotated wave, which must be in this list
+            mesh().shift(vec);
+            id = waveIds_[mesh().rank(vec)];
+            UTIL_CHECK(id >= listBegin && id < listEnd);
+
+            // Check for cancellation of star: The star is
+            // cancelled if application of any symmetry operation
+            // in the group to the root vector yields a rotated 
+            // vector equivalent to the root vector but with a 
+            // nonzero phase, creating a contradiction.
+            if (id == rootId) {
+               if (abs(phase) > 1.0E-6) {
+                  cancel = true;
+               }
+            }
+
+            if (rootIds[id] != rootId) {
+
+               // If this wave is not yet in the star, add it
+               UTIL_CHECK(rootIds[id] == -1);
+               rootIds[id] = rootId;
+               twaves[id].phase = phase;
+               star.push_back(id);
+
+            } else {
+
+               // If an equivalent wave is found, check if the
+               // phases are equivalent. If not, the star is
+               // cancelled.
+
+               phase_diff = twaves[id].phase - phase;
+               while (phase_diff > 0.5) {
+                  phase_diff -= 1.0;
+               }
+               while (phase_diff <= -0.5) {
+                  phase_diff += 1.0;
+               }
+               if (abs(phase_diff) > 1.0E-6) {
+                  cancel = true;
+               }
+
+            }
+
+         }
+         const int starSize = star.size();
+         nRemoved += starSize;
+
+         // Sort star, in descending order by indicesBz.
+         std::sort(star.begin(), star.end(), bzComp);
+
+         // Copy star into next block of waves_. Compute a complex 
+         // coefficient of unit norm for each wave.
+         for (j = 0; j < starSize; ++j) {
+            TWave<D> const & wave = twaves[star[j]];
+            k = starBegin + j;
+            waves_[k].indicesDft = wave.indicesDft;
+            waves_[k].indicesBz = wave.indicesBz;
+            waves_[k].sqNorm = Gsq;
+            coeff = std::complex<double>(0.0, wave.phase);
+            coeff = exp(coeff);
+            if (abs(imag(coeff)) < 1.0E-6) {
+               coeff = std::complex<double>(real(coeff), 0.0);
+            }
+            if (abs(real(coeff)) < 1.0E-6) {
+               coeff = std::complex<double>(0.0, imag(coeff));
+            }
+            waves_[k].coeff = coeff;
+         }
+
+         // Initialize a Star object 
+         newStar.eigen = Gsq;
+         newStar.beginId = starBegin;
+         newStar.endId = newStar.beginId + starSize;
+         newStar.size = starSize;
+         newStar.cancel = cancel;
+         // Note: newStar.starInvert is not yet known
+
+         // Determine invertFlag, rootId and nextInvert
+         if (nextInvert == -1) {
+
+            // If this star is 2nd of a pair related by inversion,
+            // set root of next star to 1st wave of remaining list.
+
+            newStar.invertFlag = -1;
+            nextInvert = 1;
+            while (firstId < listEnd && rootIds[firstId] != -1) {
+               ++firstId;
+            }
+            rootId = firstId;
+
+         } else {
+
+            // If this star is not the 2nd of a pair of partners,
+            // then determine if it is closed under inversion.
+
+            // Compute negation nVec of root vector, shifted to DFT mesh
+            nVec.negate(rootVecBz);
+            mesh().shift(nVec);
+            id = waveIds_[mesh().rank(nVec)];
+            bool inList = (id >= listBegin && id < listEnd);
+
+            if (inList && rootIds[id] == rootId) {
+
+               // If this star is closed under inversion, the root
+               // of next star is the 1st vector of remaining list.
+
+               newStar.invertFlag = 0;
+               nextInvert = 1;
+               while (firstId < listEnd && rootIds[firstId] != -1) {
+                  ++firstId;
+               }
+               rootId = firstId;
+
+            } else {
+
+               // If star is not closed, the negation of the root must
+               // be in the remaining list, and is used as the root of 
+               // the next star.
+
+               newStar.invertFlag = 1;
+               nextInvert = -1;
+
+               bool negationFound = (inList && rootIds[id] == -1);
+               if (!negationFound) {
+                  std::cout << "Negation not found for: " << "\n";
+                  std::cout << " vec (ft):" 
+                            << twaves[rootId].indicesDft <<"\n"; 
+                  std::cout << " vec (bz):" 
+                            << twaves[rootId].indicesBz <<"\n"; 
+                  std::cout << "-vec (dft):" << nVec << "\n";
+                  UTIL_CHECK(negationFound);
+               }
+               rootId = id;
+
+            }
+
+         }
+
+         stars.push_back(newStar);
+         starBegin = newStar.endId;
+
+      } 
+      UTIL_CHECK(starBegin == listEnd);
+
+   }
+
    /*
    *  Update wave norms after change in unit cell dimensions.
    */
@@ -799,6 +830,244 @@ namespace Pscf {
 
    }
 
+   /*
+   * Read basis from a cache file, if it exists and is compatible.
+   */
+   template <int D>
+   bool Basis<D>::readCache(std::string const & fileName, 
+                            const Mesh<D>& mesh, 
+                            const UnitCell<D>& unitCell,
+                            std::string const & groupName)
+   {
+      std::ifstream file;
+      file.open(fileName.c_str(), std::ios::in | std::ios::binary);
+      if (!file.is_open()) {
+         return false;
+      }
+
+      // Read file. A corrupt or truncated file may cause an exception
+      // (e.g., from an invalid string length), which is treated in the
+      // same way as any other failure to read a valid basis.
+      bool isRead;
+      try {
+         isRead = readCacheFile(file, mesh, unitCell, groupName);
+      } catch (...) {
+         isRead = false;
+      }
+      file.close();
+
+      // On failure, reset to the empty state so that makeBasis may be
+      // called to construct the basis instead.
+      if (!isRead) {
+         if (waves_.isAllocated()) {
+            waves_.deallocate();
+            waveIds_.deallocate();
+         }
+         stars_.clear();
+         nWave_ = 0;
+         nBasisWave_ = 0;
+         nStar_ = 0;
+         nBasis_ = 0;
+         meshPtr_ = 0;
+         unitCellPtr_ = 0;
+      }
+      return isRead;
+   }
+
+   /*
+   * Read and validate the contents of an open cache file.
+   */
+   template <int D>
+   bool Basis<D>::readCacheFile(std::ifstream& file,
+                                const Mesh<D>& mesh, 
+                                const UnitCell<D>& unitCell,
+                                std::string const & groupName)
+   {
+      BinaryFileIArchive ar(file);
+
+      // Read header, return false if this basis is not compatible
+      std::string label;
+      int version, dim, lattice, nParameter, i, k;
+      ar & label;
+      if (!file || label != "PSCF_BASIS") return false;
+      ar & version;
+      if (!file || version != 1) return false;
+      ar & dim;
+      if (!file || dim != D) return false;
+      ar & label;
+      if (!file || label != groupName) return false;
+      IntVec<D> dimensions;
+      for (k = 0; k < D; ++k) {
+         ar & dimensions[k];
+      }
+      if (!file || dimensions != mesh.dimensions()) return false;
+      ar & lattice;
+      if (!file || lattice != (int)unitCell.lattice()) return false;
+      ar & nParameter;
+      if (!file || nParameter != unitCell.nParameter()) return false;
+      FSArray<double, 6> parameters = unitCell.parameters();
+      bool isChanged = false;
+      double parameter;
+      for (i = 0; i < nParameter; ++i) {
+         ar & parameter;
+         if (parameter != parameters[i]) {
+            isChanged = true;
+         }
+      }
+      if (!file) return false;
+      if (isChanged && nParameter > 1) return false;
+
+      // Save pointers to mesh and unit cell
+      meshPtr_ = &mesh;
+      unitCellPtr_ = &unitCell;
+
+      // Read counters, allocate arrays
+      ar & nWave_;
+      ar & nBasisWave_;
+      ar & nStar_;
+      ar & nBasis_;
+      if (!file) return false;
+      if (nWave_ != mesh.size()) return false;
+      if (nStar_ < 1 || nStar_ > nWave_) return false;
+      if (!waves_.isAllocated()) {
+         waves_.allocate(nWave_);
+         waveIds_.allocate(nWave_);
+      }
+      UTIL_CHECK(waves_.capacity() == nWave_);
+
+      // Read waves, and construct look up table
+      for (i = 0; i < nWave_; ++i) {
+         waveIds_[i] = -1;
+      }
+      double re, im;
+      int rank;
+      for (i = 0; i < nWave_; ++i) {
+         Wave& wave = waves_[i];
+         ar & re;
+         ar & im;
+         wave.coeff = std::complex<double>(re, im);
+         ar & wave.sqNorm;
+         for (k = 0; k < D; ++k) {
+            ar & wave.indicesDft[k];
+         }
+         for (k = 0; k < D; ++k) {
+            ar & wave.indicesBz[k];
+         }
+         ar & wave.starId;
+         ar & wave.implicit;
+         if (!file) return false;
+         for (k = 0; k < D; ++k) {
+            if (wave.indicesDft[k] < 0) return false;
+            if (wave.indicesDft[k] >= mesh.dimension(k)) return false;
+         }
+         if (wave.starId < 0 || wave.starId >= nStar_) return false;
+         rank = mesh.rank(wave.indicesDft);
+         if (waveIds_[rank] != -1) return false;
+         waveIds_[rank] = i;
+      }
+
+      // Read stars
+      Star star;
+      stars_.clear();
+      for (i = 0; i < nStar_; ++i) {
+         ar & star.eigen;
+         ar & star.size;
+         ar & star.beginId;
+         ar & star.endId;
+         ar & star.invertFlag;
+         for (k = 0; k < D; ++k) {
+            ar & star.waveBz[k];
+         }
+         ar & star.cancel;
+         if (!file) return false;
+         if (star.beginId < 0 || star.beginId >= star.endId) return false;
+         if (star.endId > nWave_) return false;
+         stars_.append(star);
+      }
+
+      // Recompute norms if cell size differs from that of cached basis
+      if (isChanged) {
+         update();
+      }
+
+      return isValid();
+   }
+
+   /*
+   * Write basis to a cache file.
+   */
+   template <int D>
+   bool Basis<D>::writeCache(std::string const & fileName, 
+                             std::string const & groupName) const
+   {
+      std::ofstream file;
+      file.open(fileName.c_str(), std::ios::out | std::ios::binary);
+      if (!file.is_open()) {
+         return false;
+      }
+      BinaryFileOArchive ar(file);
+
+      // Write header
+      std::string label = "PSCF_BASIS";
+      int version = 1;
+      int dim = D;
+      int lattice = (int)unitCell().lattice();
+      int nParameter = unitCell().nParameter();
+      FSArray<double, 6> parameters = unitCell().parameters();
+      int i, k;
+      ar << label;
+      ar << version;
+      ar << dim;
+      ar << groupName;
+      for (k = 0; k < D; ++k) {
+         ar << mesh().dimension(k);
+      }
+      ar << lattice;
+      ar << nParameter;
+      for (i = 0; i < nParameter; ++i) {
+         ar << parameters[i];
+      }
+
+      // Write counters
+      ar << nWave_;
+      ar << nBasisWave_;
+      ar << nStar_;
+      ar << nBasis_;
+
+      // Write waves
+      for (i = 0; i < nWave_; ++i) {
+         Wave const & wave = waves_[i];
+         ar << wave.coeff.real();
+         ar << wave.coeff.imag();
+         ar << wave.sqNorm;
+         for (k = 0; k < D; ++k) {
+            ar << wave.indicesDft[k];
+         }
+         for (k = 0; k < D; ++k) {
+            ar << wave.indicesBz[k];
+         }
+         ar << wave.starId;
+         ar << wave.implicit;
+      }
+
+      // Write stars
+      for (i = 0; i < nStar_; ++i) {
+         Star const & star = stars_[i];
+         ar << star.eigen;
+         ar << star.size;
+         ar << star.beginId;
+         ar << star.endId;
+         ar << star.invertFlag;
+         for (k = 0; k < D; ++k) {
+            ar << star.waveBz[k];
+         }
+         ar << star.cancel;
+      }
+      file.close();
+
+      return true;
+   }
+
    // Return value of nBasis
    template <int D>
    int Basis<D>::nBasis() const
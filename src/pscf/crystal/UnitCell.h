@@ -116,6 +116,12 @@ namespace Pscf
       */
       UnitCell();
 
+      /**
+      * Return lattice system enumeration value.
+      */
+      LatticeSystem lattice() const
+      {  return lattice_; }
+
    private:
 
       // Lattice type
@@ -192,6 +198,12 @@ namespace Pscf
       */
       UnitCell();
 
+      /**
+      * Return lattice system enumeration value.
+      */
+      LatticeSystem lattice() const
+      {  return lattice_; }
+
    private:
 
       /**
@@ -272,6 +284,12 @@ namespace Pscf
       */
       UnitCell();
 
+      /**
+      * Return lattice system enumeration value.
+      */
+      LatticeSystem lattice() const
+      {  return lattice_; }
+
    private:
 
       LatticeSystem lattice_;
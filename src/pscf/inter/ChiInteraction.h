@@ -42,6 +42,18 @@ namespace Pscf {
       */
       virtual void readParameters(std::istream& in);
 
+      /**
+      * Change one element of the chi matrix.
+      *
+      * Sets chi(i, j) and chi(j, i) to the same value, and recomputes
+      * the inverse chi matrix and idempotent matrix.
+      *
+      * \param i row index
+      * \param j column index
+      * \param chi new value of chi(i, j) = chi(j, i)
+      */
+      void setChi(int i, int j, double chi);
+
       /**
       * Compute excess Helmholtz free energy per monomer.
       *
@@ -132,6 +144,11 @@ namespace Pscf {
 
       double sum_inv_;
 
+      /**
+      * Compute chiInverse_, idemp_ and sum_inv_ from chi_.
+      */
+      void updateMembers();
+
    };
 
    // Inline function
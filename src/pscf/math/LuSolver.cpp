@@ -13,8 +13,10 @@ namespace Pscf
   
    LuSolver::LuSolver()
     : luPtr_(0),
+      gMatInverse_(0),
       permPtr_(0),
-      n_(0)
+      n_(0),
+      m_(0)
    {
       // Initialize gs_vector b_ 
       b_.size = 0;
@@ -29,6 +31,16 @@ namespace Pscf
       x_.data = 0;
       x_.block = 0;
       x_.owner = 0;
+
+      // Initialize views lu_ and perm_
+      lu_.size1 = 0;
+      lu_.size2 = 0;
+      lu_.tda = 0;
+      lu_.data = 0;
+      lu_.block = 0;
+      lu_.owner = 0;
+      perm_.size = 0;
+      perm_.data = 0;
    }
 
    LuSolver::~LuSolver()
@@ -61,20 +73,39 @@ namespace Pscf
    * Compute the LU decomposition for later use.
    */
    void LuSolver::computeLU(const Matrix<double>& A)
+   {  computeLU(A, n_); }
+
+   /*
+   * Compute the LU decomposition of the leading m x m block of A.
+   */
+   void LuSolver::computeLU(const Matrix<double>& A, int m)
    {
       UTIL_CHECK(n_ > 0);
       UTIL_CHECK(A.capacity1() == n_);
       UTIL_CHECK(A.capacity2() == n_);
+      UTIL_CHECK(m > 0);
+      UTIL_CHECK(m <= n_);
 
+      // Pack the leading block contiguously, with row stride m
       int i, j;
       int k = 0;
-      for (i = 0; i < n_;  ++i) {
-         for (j = 0; j < n_; ++j) {
+      for (i = 0; i < m;  ++i) {
+         for (j = 0; j < m; ++j) {
             luPtr_->data[k] = A(i,j);
             ++k;
          }
       }
-      gsl_linalg_LU_decomp(luPtr_, permPtr_, &signum_);
+
+      // Associate views with the leading block and permutation
+      lu_.size1 = m;
+      lu_.size2 = m;
+      lu_.tda = m;
+      lu_.data = luPtr_->data;
+      perm_.size = m;
+      perm_.data = permPtr_->data;
+      m_ = m;
+
+      gsl_linalg_LU_decomp(&lu_, &perm_, &signum_);
    }
 
    /*
@@ -82,16 +113,18 @@ namespace Pscf
    */
    void LuSolver::solve(Array<double>& b, Array<double>& x)
    {
-      UTIL_CHECK(n_ > 0);
-      UTIL_CHECK(b.capacity() == n_);
-      UTIL_CHECK(x.capacity() == n_);
+      UTIL_CHECK(m_ > 0);
+      UTIL_CHECK(b.capacity() >= m_);
+      UTIL_CHECK(x.capacity() >= m_);
 
       // Associate gsl_vectors b_ and x_ with Arrays b and x
+      b_.size = m_;
+      x_.size = m_;
       b_.data = b.cArray();
       x_.data = x.cArray();
 
       // Solve system of equations
-      gsl_linalg_LU_solve(luPtr_, permPtr_, &b_, &x_);
+      gsl_linalg_LU_solve(&lu_, &perm_, &b_, &x_);
 
       // Destroy temporary associations
       b_.data = 0;
@@ -104,9 +137,10 @@ namespace Pscf
    void LuSolver::inverse(Matrix<double>& inv)
    {   
       UTIL_CHECK(n_ > 0); 
+      UTIL_CHECK(m_ == n_); 
 
       gMatInverse_->data = inv.cArray();
-      gsl_linalg_LU_invert(luPtr_, permPtr_, gMatInverse_);
+      gsl_linalg_LU_invert(&lu_, &perm_, gMatInverse_);
 
    } 
 
@@ -25,6 +25,10 @@ namespace Pscf
    * This class is a simple wrapper for the functions provided by
    * the Gnu Scientific Library (GSL).
    *
+   * Memory is allocated once for a maximum dimension n. The functions
+   * computeLU(A, m) and solve(b, x) may then be applied to the leading
+   * m x m block of A, for any 0 < m <= n, without reallocation.
+   *
    * \ingroup Pscf_Math_Module
    */  
    class LuSolver
@@ -55,9 +59,22 @@ namespace Pscf
       */
       void computeLU(const Matrix<double>& A);
 
+      /**
+      * Compute the LU decomposition of a leading block of A.
+      *
+      * Later calls to solve use the leading m elements of b and x.
+      *
+      * \param A square matrix with capacity n x n
+      * \param m dimension of the leading block, 0 < m <= n
+      */
+      void computeLU(const Matrix<double>& A, int m);
+
       /**
       * Solve Ax = b for known b to compute x.
       *
+      * Only the leading m elements of b and x are used, where m is
+      * the dimension passed to the last call of computeLU.
+      *
       * \param b the RHS vector
       * \param x the solution vector
       */
@@ -81,6 +98,12 @@ namespace Pscf
       /// Pointer to LU decomposition matrix.
       gsl_matrix* luPtr_;
 
+      /// View of the leading m x m block of *luPtr_.
+      gsl_matrix lu_;
+
+      /// View of the leading m elements of *permPtr_.
+      gsl_permutation perm_;
+
       /// Pointer to inverse matrix.
       gsl_matrix* gMatInverse_;
 
@@ -93,6 +116,9 @@ namespace Pscf
       /// Number of rows and columns in matrix.
       int n_;
 
+      /// Dimension of the last LU decomposition.
+      int m_;
+
    };
 
 }
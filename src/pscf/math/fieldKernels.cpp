@@ -0,0 +1,165 @@
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "fieldKernels.h"
+
+#include <cmath>
+#ifdef PSCF_OPENMP
+#include <omp.h>
+#endif
+
+namespace Pscf
+{
+
+   const int FieldKernelThreshold = 32768;
+
+   namespace {
+
+      /*
+      * Should a loop over n elements be multi-threaded?
+      */
+      inline bool isThreaded(int n)
+      {
+         #ifdef PSCF_OPENMP
+         return (n >= FieldKernelThreshold && !omp_in_parallel());
+         #else
+         return false;
+         #endif
+      }
+
+   }
+
+   void setField(double s, double* a, int n)
+   {
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for simd schedule(static) if (isThreaded(n))
+      #endif
+      for (int i = 0; i < n; ++i) {
+         a[i] = s;
+      }
+   }
+
+   void copyField(double const * b, double* a, int n)
+   {
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for simd schedule(static) if (isThreaded(n))
+      #endif
+      for (int i = 0; i < n; ++i) {
+         a[i] = b[i];
+      }
+   }
+
+   void scaleField(double s, double* a, int n)
+   {
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for simd schedule(static) if (isThreaded(n))
+      #endif
+      for (int i = 0; i < n; ++i) {
+         a[i] *= s;
+      }
+   }
+
+   void expField(double const * b, double s, double* a, int n)
+   {
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for simd schedule(static) if (isThreaded(n))
+      #endif
+      for (int i = 0; i < n; ++i) {
+         a[i] = exp(s*b[i]);
+      }
+   }
+
+   void addField(double const * b, double* a, int n)
+   {
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for simd schedule(static) if (isThreaded(n))
+      #endif
+      for (int i = 0; i < n; ++i) {
+         a[i] += b[i];
+      }
+   }
+
+   void mulField(double const * b, double* a, int n)
+   {
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for simd schedule(static) if (isThreaded(n))
+      #endif
+      for (int i = 0; i < n; ++i) {
+         a[i] *= b[i];
+      }
+   }
+
+   void mulField(double const * b, double const * c, double* a, int n)
+   {
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for simd schedule(static) if (isThreaded(n))
+      #endif
+      for (int i = 0; i < n; ++i) {
+         a[i] = b[i]*c[i];
+      }
+   }
+
+   void axpyField(double s, double const * b, double* a, int n)
+   {
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for simd schedule(static) if (isThreaded(n))
+      #endif
+      for (int i = 0; i < n; ++i) {
+         a[i] += s*b[i];
+      }
+   }
+
+   void mulAddField(double s, double const * b, double const * c,
+                    double* a, int n)
+   {
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for simd schedule(static) if (isThreaded(n))
+      #endif
+      for (int i = 0; i < n; ++i) {
+         a[i] += s*b[i]*c[i];
+      }
+   }
+
+   void axpyDiffField(double s, double const * b, double const * c,
+                      double* a, int n)
+   {
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for simd schedule(static) if (isThreaded(n))
+      #endif
+      for (int i = 0; i < n; ++i) {
+         a[i] += s*(b[i] - c[i]);
+      }
+   }
+
+   double dotField(double const * a, double const * b, int n)
+   {
+      double sum = 0.0;
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for simd schedule(static) reduction(+:sum) \
+                                    if (isThreaded(n))
+      #endif
+      for (int i = 0; i < n; ++i) {
+         sum += a[i]*b[i];
+      }
+      return sum;
+   }
+
+   double maxAbsField(double const * a, int n)
+   {
+      double max = 0.0;
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for simd schedule(static) reduction(max:max) \
+                                    if (isThreaded(n))
+      #endif
+      for (int i = 0; i < n; ++i) {
+         double value = std::fabs(a[i]);
+         max = (value > max) ? value : max;
+      }
+      return max;
+   }
+
+}
@@ -0,0 +1,188 @@
+#ifndef PSCF_FIELD_KERNELS_H
+#define PSCF_FIELD_KERNELS_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+namespace Pscf
+{
+
+   /**
+   * \defgroup Pscf_Math_FieldKernels_Module Field Kernels
+   *
+   * Pointwise operations and reductions on arrays of field values.
+   *
+   * Each function operates on n elements of arrays of doubles that are
+   * accessed through bare pointers, and is implemented in the file
+   * fieldKernels.cpp, separately from its callers, as a single loop with
+   * no branches or function calls other than exp, so that it can be
+   * vectorized by the compiler.
+   * With fast math options (e.g., -O3 -ffast-math with gcc and glibc),
+   * this includes the exponential and the reductions. If the library
+   * is compiled with PSCF_OPENMP defined (see the pscf config file),
+   * loops are also marked for vectorization by an omp simd directive,
+   * and are multi-threaded if n is at least FieldKernelThreshold and
+   * the function is not called from within an active parallel region.
+   * Functions that modify an array allow it to be identical to an
+   * input array, but not to overlap it in any other way.
+   *
+   * Without OpenMP or fast math options, results are bitwise identical
+   * to those of the equivalent sequential loop. Otherwise, reductions
+   * may differ from a sequential sum by round-off.
+   *
+   * \ingroup Pscf_Math_Module
+   */
+
+   /**
+   * Minimum number of elements for multi-threaded execution.
+   *
+   * \ingroup Pscf_Math_FieldKernels_Module
+   */
+   extern const int FieldKernelThreshold;
+
+   /**
+   * Set all elements of an array to a constant: a[i] = s.
+   *
+   * \param s  constant value
+   * \param a  output array
+   * \param n  number of elements
+   *
+   * \ingroup Pscf_Math_FieldKernels_Module
+   */
+   void setField(double s, double* a, int n);
+
+   /**
+   * Copy an array: a[i] = b[i].
+   *
+   * \param b  input array
+   * \param a  output array
+   * \param n  number of elements
+   *
+   * \ingroup Pscf_Math_FieldKernels_Module
+   */
+   void copyField(double const * b, double* a, int n);
+
+   /**
+   * Multiply all elements of an array by a constant: a[i] *= s.
+   *
+   * \param s  scale factor
+   * \param a  array to be scaled
+   * \param n  number of elements
+   *
+   * \ingroup Pscf_Math_FieldKernels_Module
+   */
+   void scaleField(double s, double* a, int n);
+
+   /**
+   * Exponential of a scaled array: a[i] = exp(s*b[i]).
+   *
+   * \param b  input array
+   * \param s  scale factor applied to b before exponentiation
+   * \param a  output array
+   * \param n  number of elements
+   *
+   * \ingroup Pscf_Math_FieldKernels_Module
+   */
+   void expField(double const * b, double s, double* a, int n);
+
+   /**
+   * Add an array in place: a[i] += b[i].
+   *
+   * \param b  input array
+   * \param a  array to be incremented
+   * \param n  number of elements
+   *
+   * \ingroup Pscf_Math_FieldKernels_Module
+   */
+   void addField(double const * b, double* a, int n);
+
+   /**
+   * Multiply by an array in place: a[i] *= b[i].
+   *
+   * \param b  input array
+   * \param a  array to be multiplied
+   * \param n  number of elements
+   *
+   * \ingroup Pscf_Math_FieldKernels_Module
+   */
+   void mulField(double const * b, double* a, int n);
+
+   /**
+   * Pointwise product of two arrays: a[i] = b[i]*c[i].
+   *
+   * \param b  first input array
+   * \param c  second input array
+   * \param a  output array
+   * \param n  number of elements
+   *
+   * \ingroup Pscf_Math_FieldKernels_Module
+   */
+   void mulField(double const * b, double const * c, double* a, int n);
+
+   /**
+   * Add a scaled array in place: a[i] += s*b[i].
+   *
+   * \param s  scale factor
+   * \param b  input array
+   * \param a  array to be incremented
+   * \param n  number of elements
+   *
+   * \ingroup Pscf_Math_FieldKernels_Module
+   */
+   void axpyField(double s, double const * b, double* a, int n);
+
+   /**
+   * Add a scaled pointwise product in place: a[i] += s*b[i]*c[i].
+   *
+   * \param s  scale factor
+   * \param b  first input array
+   * \param c  second input array
+   * \param a  array to be incremented
+   * \param n  number of elements
+   *
+   * \ingroup Pscf_Math_FieldKernels_Module
+   */
+   void mulAddField(double s, double const * b, double const * c,
+                    double* a, int n);
+
+   /**
+   * Add a scaled difference in place: a[i] += s*(b[i] - c[i]).
+   *
+   * \param s  scale factor
+   * \param b  first input array
+   * \param c  array subtracted from b
+   * \param a  array to be incremented
+   * \param n  number of elements
+   *
+   * \ingroup Pscf_Math_FieldKernels_Module
+   */
+   void axpyDiffField(double s, double const * b, double const * c,
+                      double* a, int n);
+
+   /**
+   * Return the inner product sum_i a[i]*b[i].
+   *
+   * \param a  first input array
+   * \param b  second input array
+   * \param n  number of elements
+   *
+   * \ingroup Pscf_Math_FieldKernels_Module
+   */
+   double dotField(double const * a, double const * b, int n);
+
+   /**
+   * Return the maximum absolute value max_i |a[i]|, or 0.0 if n == 0.
+   *
+   * \param a  input array
+   * \param n  number of elements
+   *
+   * \ingroup Pscf_Math_FieldKernels_Module
+   */
+   double maxAbsField(double const * a, int n);
+
+}
+#endif
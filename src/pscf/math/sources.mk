@@ -2,7 +2,8 @@ pscf_math_= \
   pscf/math/LuSolver.cpp \
   pscf/math/TridiagonalSolver.cpp \
   pscf/math/IntVec.cpp \
-  pscf/math/Field.cpp
+  pscf/math/Field.cpp \
+  pscf/math/fieldKernels.cpp
 
 
 pscf_math_SRCS=\
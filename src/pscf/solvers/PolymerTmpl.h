@@ -166,6 +166,17 @@ namespace Pscf
 
       virtual void makePlan();
 
+      /**
+      * Solve the modified diffusion equation for all propagators.
+      *
+      * Called by solve(). The default implementation solves all 
+      * propagators sequentially, in the order given by the plan created
+      * by makePlan(). Subclasses may override this to solve independent
+      * propagators concurrently. Upon entry, all propagators are marked
+      * as unsolved. Upon return, all must be solved.
+      */
+      virtual void solvePropagators();
+
    private:
 
       /// Array of Block objects in this polymer.
@@ -424,6 +435,18 @@ namespace Pscf
 
    }
 
+   /*
+   * Solve the MDE for all propagators, in order of computation.
+   */ 
+   template <class Block>
+   void PolymerTmpl<Block>::solvePropagators()
+   {
+      for (int j = 0; j < nPropagator(); ++j) {
+         UTIL_CHECK(propagator(j).isReady());
+         propagator(j).solve();
+      }
+   }
+
    /*
    * Compute solution to MDE and concentrations.
    */ 
@@ -437,10 +460,7 @@ namespace Pscf
       }
 
       // Solve modified diffusion equation for all propagators
-      for (int j = 0; j < nPropagator(); ++j) {
-         UTIL_CHECK(propagator(j).isReady());
-         propagator(j).solve();
-      }
+      solvePropagators();
 
       // Compute molecular partition function
       double q = block(0).propagator(0).computeQ();
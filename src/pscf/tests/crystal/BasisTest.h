@@ -21,6 +21,8 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <cstdio>
 
 using namespace Util;
 using namespace Pscf;
@@ -351,6 +353,100 @@ public:
 
    }
 
+   void testBasisCache()
+   {
+      printMethod(TEST_FUNC);
+      // printEndl();
+
+      // Make unitcell
+      UnitCell<3> unitCell;
+      std::ifstream in;
+      openInputFile("in/Cubic", in);
+      in >> unitCell;
+      in.close();
+
+      // Make mesh object
+      IntVec<3> d;
+      d[0] = 8;
+      d[1] = 8;
+      d[2] = 8;
+      Mesh<3> mesh(d);
+
+      // Read group
+      SpaceGroup<3> group;
+      openInputFile("in/I_m_-3_m", in);
+      in >> group;
+      in.close();
+
+      // Construct basis object, write cache file
+      Basis<3> basis;
+      basis.makeBasis(mesh, unitCell, group);
+      std::string fileName = filePrefix() + "tempBasisCache";
+      TEST_ASSERT(basis.writeCache(fileName, "I_m_-3_m"));
+
+      // Cache is rejected for a different group or mesh
+      Basis<3> other;
+      TEST_ASSERT(!other.readCache(fileName, mesh, unitCell, "I_a_-3_d"));
+      d[0] = 16;
+      d[1] = 16;
+      d[2] = 16;
+      Mesh<3> otherMesh(d);
+      TEST_ASSERT(!other.readCache(fileName, otherMesh, unitCell, 
+                                   "I_m_-3_m"));
+
+      // Basis read from cache is identical to original
+      Basis<3> cached;
+      TEST_ASSERT(cached.readCache(fileName, mesh, unitCell, "I_m_-3_m"));
+      TEST_ASSERT(cached.isValid());
+      TEST_ASSERT(eq(cached.nWave(), basis.nWave()));
+      TEST_ASSERT(eq(cached.nStar(), basis.nStar()));
+      TEST_ASSERT(eq(cached.nBasis(), basis.nBasis()));
+      std::stringstream out1, out2;
+      basis.outputWaves(out1, true);
+      basis.outputStars(out1, true);
+      cached.outputWaves(out2, true);
+      cached.outputStars(out2, true);
+      TEST_ASSERT(out1.str() == out2.str());
+
+      // A truncated or corrupt cache file is rejected, leaving a basis 
+      // that can still be constructed by makeBasis
+      std::string contents;
+      {
+         std::ifstream file(fileName.c_str(), std::ios::binary);
+         std::stringstream buffer;
+         buffer << file.rdbuf();
+         contents = buffer.str();
+      }
+      std::string badName = filePrefix() + "tempBasisCacheBad";
+      for (int k = 0; k < 3; ++k) {
+         std::string bad;
+         if (k == 0) {
+            bad = contents.substr(0, contents.size()/2);
+         } else if (k == 1) {
+            bad = contents.substr(0, contents.size() - 1);
+         } else {
+            // Overwrite the body, after the header, with garbage bytes
+            bad = contents;
+            for (size_t i = bad.size()/4; i < bad.size(); ++i) {
+               bad[i] = (char)(37*i + 11);
+            }
+         }
+         {
+            std::ofstream file(badName.c_str(), std::ios::binary);
+            file.write(bad.c_str(), bad.size());
+         }
+         Basis<3> corrupt;
+         TEST_ASSERT(!corrupt.readCache(badName, mesh, unitCell, 
+                                        "I_m_-3_m"));
+         TEST_ASSERT(corrupt.nWave() == 0);
+         TEST_ASSERT(corrupt.nStar() == 0);
+         corrupt.makeBasis(mesh, unitCell, group);
+         TEST_ASSERT(corrupt.isValid());
+         TEST_ASSERT(eq(corrupt.nStar(), basis.nStar()));
+      }
+      std::remove(badName.c_str());
+   }
+
 };
 
 TEST_BEGIN(BasisTest)
@@ -363,6 +459,7 @@ TEST_ADD(BasisTest, testMake2DBasis_hex)
 TEST_ADD(BasisTest, testMake3DBasis_I)
 TEST_ADD(BasisTest, testMake3DBasis_I_m_3b_m)
 TEST_ADD(BasisTest, testMake3DBasis_I_a_3b_d) 
+TEST_ADD(BasisTest, testBasisCache)
 TEST_END(BasisTest)
 
 #endif
@@ -0,0 +1,259 @@
+/*
+* This program benchmarks the field kernels of pscf/math/fieldKernels.h.
+*
+* Usage: Benchmark [n [nRep]]
+*
+* Each kernel is compared to the scalar loop over DArray<double>
+* elements that it replaced in pspc (e.g., in Block::setupSolver,
+* Propagator::computeHead and computeQ, Mixture::compute and
+* AmIterator::buildOmega), using arrays of n elements (default
+* n = 262144 = 64^3) and nRep repetitions per timing (default 200).
+* For each, the program reports ns per element for the reference loop
+* and the kernel, and the ratio of these times. The reference loops
+* are compiled in this file with the same compiler options as the
+* library ('make benchmark'), and each repetition is timed separately
+* so that the compiler cannot merge repetitions of a reference loop.
+*/
+
+#include <pscf/math/fieldKernels.h>
+#include <util/containers/DArray.h>
+#include <util/misc/Timer.h>
+#include <util/format/Dbl.h>
+#include <util/global.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+
+using namespace Util;
+using namespace Pscf;
+
+// Reference scalar loops
+
+void refExp(DArray<double> const & w, double ds,
+            DArray<double>& e, DArray<double>& e2, int n)
+{
+   for (int i = 0; i < n; ++i) {
+      e[i] = exp(-0.5*w[i]*ds);
+      e2[i] = exp(-0.5*0.5*w[i]*ds);
+   }
+}
+
+void refMul(DArray<double> const & b, DArray<double>& a, int n)
+{
+   for (int i = 0; i < n; ++i) {
+      a[i] *= b[i];
+   }
+}
+
+void refMulAdd(double s, DArray<double> const & b,
+               DArray<double> const & c, DArray<double>& a, int n)
+{
+   for (int i = 0; i < n; ++i) {
+      a[i] += s*b[i]*c[i];
+   }
+}
+
+void refAdd(DArray<double> const & b, DArray<double>& a, int n)
+{
+   for (int i = 0; i < n; ++i) {
+      a[i] += b[i];
+   }
+}
+
+void refAxpyDiff(double s, DArray<double> const & b,
+                 DArray<double> const & c, DArray<double>& a, int n)
+{
+   for (int i = 0; i < n; ++i) {
+      a[i] += s*(b[i] - c[i]);
+   }
+}
+
+double refDot(DArray<double> const & a, DArray<double> const & b, int n)
+{
+   double sum = 0;
+   for (int i = 0; i < n; ++i) {
+      sum += a[i]*b[i];
+   }
+   return sum;
+}
+
+double refMaxAbs(DArray<double> const & a, int n)
+{
+   double max = 0.0;
+   for (int i = 0; i < n; ++i) {
+      if (max < fabs(a[i])) {
+         max = fabs(a[i]);
+      }
+   }
+   return max;
+}
+
+void report(std::string name, double refTime, double time,
+            int nRep, int n)
+{
+   double factor = 1.0E9/(double(nRep)*double(n));
+   std::cout << std::setw(10) << std::left << name << std::right
+             << Dbl(refTime*factor, 15, 6)
+             << Dbl(time*factor, 15, 6)
+             << Dbl(refTime/time, 15, 6) << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+   int n = 262144;
+   int nRep = 200;
+   if (argc > 1) {
+      n = atoi(argv[1]);
+   }
+   if (argc > 2) {
+      nRep = atoi(argv[2]);
+   }
+   UTIL_CHECK(n > 0);
+   UTIL_CHECK(nRep > 0);
+
+   DArray<double> a, b, c, d;
+   a.allocate(n);
+   b.allocate(n);
+   c.allocate(n);
+   d.allocate(n);
+   int i;
+   for (i = 0; i < n; ++i) {
+      b[i] = sin(0.01*double(i));
+      c[i] = 1.0 + 0.5*cos(0.03*double(i));
+      d[i] = 1.0;
+   }
+   double ds = 0.01;
+
+   std::cout << "n = " << n << ",  nRep = " << nRep << std::endl;
+   std::cout << std::setw(10) << std::left << "kernel" << std::right
+             << std::setw(15) << "ref (ns/elem)"
+             << std::setw(15) << "new (ns/elem)"
+             << std::setw(15) << "speedup" << std::endl;
+
+   Timer timer;
+   double refTime;
+   int k;
+
+   // exp(-w*ds/2) and exp(-w*ds/4), as in Block::setupSolver
+   for (k = 0; k < nRep; ++k) {
+      timer.start();
+      refExp(b, ds, a, d, n);
+      timer.stop();
+   }
+   refTime = timer.time();
+   timer.clear();
+   for (k = 0; k < nRep; ++k) {
+      timer.start();
+      expField(b.cArray(), -0.5*ds, a.cArray(), n);
+      expField(b.cArray(), -0.25*ds, d.cArray(), n);
+      timer.stop();
+   }
+   report("exp", refTime, timer.time(), nRep, n);
+
+   // In-place product, as in Propagator::computeHead
+   setField(1.0, a.cArray(), n);
+   timer.clear();
+   for (k = 0; k < nRep; ++k) {
+      timer.start();
+      refMul(c, a, n);
+      refMul(d, a, n);
+      timer.stop();
+   }
+   refTime = timer.time();
+   setField(1.0, a.cArray(), n);
+   timer.clear();
+   for (k = 0; k < nRep; ++k) {
+      timer.start();
+      mulField(c.cArray(), a.cArray(), n);
+      mulField(d.cArray(), a.cArray(), n);
+      timer.stop();
+   }
+   report("mul", refTime, timer.time(), nRep, 2*n);
+
+   // Scaled product accumulation, as in Block::computeConcentration
+   timer.clear();
+   for (k = 0; k < nRep; ++k) {
+      timer.start();
+      refMulAdd(4.0, b, c, a, n);
+      timer.stop();
+   }
+   refTime = timer.time();
+   timer.clear();
+   for (k = 0; k < nRep; ++k) {
+      timer.start();
+      mulAddField(4.0, b.cArray(), c.cArray(), a.cArray(), n);
+      timer.stop();
+   }
+   report("mulAdd", refTime, timer.time(), nRep, n);
+
+   // Accumulation, as in Mixture::compute
+   timer.clear();
+   for (k = 0; k < nRep; ++k) {
+      timer.start();
+      refAdd(b, a, n);
+      timer.stop();
+   }
+   refTime = timer.time();
+   timer.clear();
+   for (k = 0; k < nRep; ++k) {
+      timer.start();
+      addField(b.cArray(), a.cArray(), n);
+      timer.stop();
+   }
+   report("add", refTime, timer.time(), nRep, n);
+
+   // Scaled difference, as in AmIterator::buildOmega
+   timer.clear();
+   for (k = 0; k < nRep; ++k) {
+      timer.start();
+      refAxpyDiff(0.1, b, c, a, n);
+      timer.stop();
+   }
+   refTime = timer.time();
+   timer.clear();
+   for (k = 0; k < nRep; ++k) {
+      timer.start();
+      axpyDiffField(0.1, b.cArray(), c.cArray(), a.cArray(), n);
+      timer.stop();
+   }
+   report("axpyDiff", refTime, timer.time(), nRep, n);
+
+   // Inner product, as in Propagator::computeQ
+   double refValue = 0.0;
+   double value = 0.0;
+   timer.clear();
+   for (k = 0; k < nRep; ++k) {
+      timer.start();
+      refValue = refDot(b, c, n);
+      timer.stop();
+   }
+   refTime = timer.time();
+   timer.clear();
+   for (k = 0; k < nRep; ++k) {
+      timer.start();
+      value = dotField(b.cArray(), c.cArray(), n);
+      timer.stop();
+   }
+   report("dot", refTime, timer.time(), nRep, n);
+   UTIL_CHECK(std::abs(value - refValue) < 1.0E-10*double(n));
+
+   // Maximum absolute value, as in the AmIterator residual
+   timer.clear();
+   for (k = 0; k < nRep; ++k) {
+      timer.start();
+      refValue = refMaxAbs(b, n);
+      timer.stop();
+   }
+   refTime = timer.time();
+   timer.clear();
+   for (k = 0; k < nRep; ++k) {
+      timer.start();
+      value = maxAbsField(b.cArray(), n);
+      timer.stop();
+   }
+   report("maxAbs", refTime, timer.time(), nRep, n);
+   UTIL_CHECK(value == refValue);
+
+   return 0;
+}
@@ -0,0 +1,137 @@
+#ifndef PSCF_FIELD_KERNELS_TEST_H
+#define PSCF_FIELD_KERNELS_TEST_H
+
+#include <test/UnitTest.h>
+#include <test/UnitTestRunner.h>
+
+#include <pscf/math/fieldKernels.h>
+#include <util/containers/DArray.h>
+
+#include <cmath>
+
+using namespace Util;
+using namespace Pscf;
+
+class FieldKernelsTest : public UnitTest
+{
+
+public:
+
+   void setUp()
+   {
+      // Exceed FieldKernelThreshold, to test threaded loops if enabled
+      n_ = FieldKernelThreshold + 37;
+      if (!a_.isAllocated()) {
+         a_.allocate(n_);
+         b_.allocate(n_);
+         c_.allocate(n_);
+      }
+      for (int i = 0; i < n_; ++i) {
+         b_[i] = sin(0.1*double(i));
+         c_[i] = 1.0 + 0.5*cos(0.3*double(i));
+         a_[i] = 0.25*double(i % 7);
+      }
+   }
+
+   void tearDown()
+   {}
+
+   void testPointwise()
+   {
+      printMethod(TEST_FUNC);
+      DArray<double> a;
+      a.allocate(n_);
+      int i;
+
+      setField(2.5, a.cArray(), n_);
+      for (i = 0; i < n_; ++i) {
+         TEST_ASSERT(a[i] == 2.5);
+      }
+
+      copyField(b_.cArray(), a.cArray(), n_);
+      scaleField(3.0, a.cArray(), n_);
+      for (i = 0; i < n_; ++i) {
+         TEST_ASSERT(eq(a[i], 3.0*b_[i]));
+      }
+
+      expField(b_.cArray(), -0.5, a.cArray(), n_);
+      for (i = 0; i < n_; ++i) {
+         TEST_ASSERT(std::abs(a[i] - exp(-0.5*b_[i])) < 1.0E-14);
+      }
+
+      copyField(a_.cArray(), a.cArray(), n_);
+      addField(b_.cArray(), a.cArray(), n_);
+      mulField(c_.cArray(), a.cArray(), n_);
+      for (i = 0; i < n_; ++i) {
+         TEST_ASSERT(eq(a[i], (a_[i] + b_[i])*c_[i]));
+      }
+
+      mulField(b_.cArray(), c_.cArray(), a.cArray(), n_);
+      for (i = 0; i < n_; ++i) {
+         TEST_ASSERT(eq(a[i], b_[i]*c_[i]));
+      }
+   }
+
+   void testFusedUpdate()
+   {
+      printMethod(TEST_FUNC);
+      DArray<double> a;
+      a.allocate(n_);
+      int i;
+
+      copyField(a_.cArray(), a.cArray(), n_);
+      axpyField(0.7, b_.cArray(), a.cArray(), n_);
+      for (i = 0; i < n_; ++i) {
+         TEST_ASSERT(eq(a[i], a_[i] + 0.7*b_[i]));
+      }
+
+      copyField(a_.cArray(), a.cArray(), n_);
+      mulAddField(4.0, b_.cArray(), c_.cArray(), a.cArray(), n_);
+      for (i = 0; i < n_; ++i) {
+         TEST_ASSERT(eq(a[i], a_[i] + 4.0*b_[i]*c_[i]));
+      }
+
+      copyField(a_.cArray(), a.cArray(), n_);
+      axpyDiffField(-0.3, b_.cArray(), c_.cArray(), a.cArray(), n_);
+      for (i = 0; i < n_; ++i) {
+         TEST_ASSERT(eq(a[i], a_[i] - 0.3*(b_[i] - c_[i])));
+      }
+   }
+
+   void testReduction()
+   {
+      printMethod(TEST_FUNC);
+
+      double sum = 0.0;
+      double max = 0.0;
+      for (int i = 0; i < n_; ++i) {
+         sum += b_[i]*c_[i];
+         if (max < std::abs(b_[i])) {
+            max = std::abs(b_[i]);
+         }
+      }
+      TEST_ASSERT(std::abs(dotField(b_.cArray(), c_.cArray(), n_) - sum)
+                  < 1.0E-10);
+      TEST_ASSERT(maxAbsField(b_.cArray(), n_) == max);
+
+      // Reductions of empty arrays
+      TEST_ASSERT(dotField(b_.cArray(), c_.cArray(), 0) == 0.0);
+      TEST_ASSERT(maxAbsField(b_.cArray(), 0) == 0.0);
+   }
+
+private:
+
+   DArray<double> a_;
+   DArray<double> b_;
+   DArray<double> c_;
+   int n_;
+
+};
+
+TEST_BEGIN(FieldKernelsTest)
+TEST_ADD(FieldKernelsTest, testPointwise)
+TEST_ADD(FieldKernelsTest, testFusedUpdate)
+TEST_ADD(FieldKernelsTest, testReduction)
+TEST_END(FieldKernelsTest)
+
+#endif
@@ -95,12 +95,68 @@ public:
       TEST_ASSERT(eq(b[1], y[1]));
       TEST_ASSERT(eq(b[2], y[2]));
    }
+
+   void testSolveBlock()
+   {
+      printMethod(TEST_FUNC);
+
+      // Only the leading 2 x 2 block of a is used
+      DMatrix<double> a;
+      a.allocate(3,3);
+      a(0,0) = 1.0;
+      a(0,1) = 2.0;
+      a(1,0) = 2.0;
+      a(1,1) = 3.0;
+      a(0,2) = 7.0;
+      a(1,2) = 8.0;
+      a(2,0) = 9.0;
+      a(2,1) = 6.0;
+      a(2,2) = 0.0;
+
+      DArray<double> b, x;
+      b.allocate(3);
+      x.allocate(3);
+      b[0] = 1.0;
+      b[1] = 2.0;
+      b[2] = 5.0;
+      x[2] = -1.0;
+
+      LuSolver solver;
+      solver.allocate(3);
+      solver.computeLU(a, 2);
+      solver.solve(b, x);
+
+      int i, j;
+      double y;
+      for (i = 0; i < 2; ++i) {
+         y = 0.0;
+         for (j = 0; j < 2; ++j) {
+            y += a(i,j)*x[j];
+         }
+         TEST_ASSERT(eq(b[i], y));
+      }
+      TEST_ASSERT(eq(x[2], -1.0));
+
+      // Reuse the same solver for the full matrix
+      a(2,2) = 4.0;
+      solver.computeLU(a);
+      solver.solve(b, x);
+      for (i = 0; i < 3; ++i) {
+         y = 0.0;
+         for (j = 0; j < 3; ++j) {
+            y += a(i,j)*x[j];
+         }
+         TEST_ASSERT(eq(b[i], y));
+      }
+   }
+
 };
 
 TEST_BEGIN(LuSolverTest)
 TEST_ADD(LuSolverTest, testConstructor)
 TEST_ADD(LuSolverTest, testDecompose)
 TEST_ADD(LuSolverTest, testSolve)
+TEST_ADD(LuSolverTest, testSolveBlock)
 TEST_END(LuSolverTest)
 
 #endif
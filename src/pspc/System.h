@@ -11,10 +11,14 @@
 #include <util/param/ParamComposite.h>     // base class
 
 #include <pspc/solvers/Mixture.h>          // member
+#include <pspc/solvers/WaveList.h>         // member
 #include <pspc/field/FFT.h>                // member
+#include <pspc/field/FFTPlanner.h>         // function implementation
 #include <pspc/field/FieldIo.h>            // member
 #include <pscf/mesh/Mesh.h>                // member
 #include <pspc/field/RField.h>             // typedef
+#include <pspc/field/RFieldBlock.h>        // member
+#include <pspc/field/FieldArena.h>         // member
 
 #include <pscf/crystal/Basis.h>            // member
 #include <pscf/crystal/UnitCell.h>         // member
@@ -23,15 +27,17 @@
 #include <util/misc/FileMaster.h>          // member
 #include <util/containers/DArray.h>        // member template
 #include <util/containers/Array.h>         // function parameter
+#include <util/containers/FSArray.h>       // function parameter
 
 namespace Pscf { class ChiInteraction; }
 
 namespace Pscf {
 namespace Pspc
 {
-   template <int D> class AmIterator;
-   class Sweep;
-   class SweepFactory;
+   template <int D> class Iterator;
+   template <int D> class IteratorFactory;
+   template <int D> class Sweep;
+   template <int D> class SweepFactory;
 
    using namespace Util;
 
@@ -118,6 +124,18 @@ namespace Pspc
       */
       void readCommands();
 
+      /**
+      * Set unit cell parameters and update all dependent quantities.
+      *
+      * Updates the unit cell, the squared wavevector magnitudes and
+      * their derivatives in the WaveList, the unit cell dependent
+      * data of all blocks in the Mixture, and the symmetry-adapted
+      * Basis.
+      *
+      * \param parameters  array of new unit cell parameters
+      */
+      void setUnitCell(FSArray<double, 6> const & parameters);
+
       //@}
       /// \name Thermodynamic Properties
       //@{
@@ -180,9 +198,15 @@ namespace Pspc
       * Get array of all chemical potential fields on an r-space grid.
       *
       * The array capacity is equal to the number of monomer types.
+      * Elements are views of fields in wFieldsRGridBlock().
       */
       DArray<WField>& wFieldsRGrid();
 
+      /**
+      * Get contiguous block of chemical potential fields on r-space grid.
+      */
+      RFieldBlock<D>& wFieldsRGridBlock();
+
       /**
       * Get chemical potential field for one monomer type on r-space grid.
       *
@@ -226,9 +250,15 @@ namespace Pspc
       * Get array of all concentration fields on r-space grid.
       *
       * The array capacity is equal to the number of monomer types.
+      * Elements are views of fields in cFieldsRGridBlock().
       */
       DArray<CField>& cFieldsRGrid();
 
+      /**
+      * Get contiguous block of concentration fields on r-space grid.
+      */
+      RFieldBlock<D>& cFieldsRGridBlock();
+
       /**
       * Get concentration field for one monomer type on r-space grid.
       *
@@ -264,6 +294,11 @@ namespace Pspc
       */
       Mesh<D>& mesh();
 
+      /**
+      * Get wavevector data for the mesh and unit cell by reference.
+      */
+      WaveList<D>& wavelist();
+
       /**
       * Get UnitCell (i.e., lattice type and parameters) by reference.
       */
@@ -277,8 +312,12 @@ namespace Pspc
       /**
       * Get the Iterator by reference.
       */
-      //temporarily changed to allow testing on member functions
-      AmIterator<D>& iterator();
+      Iterator<D>& iterator();
+
+      /**
+      * Get the Sweep by reference (if any).
+      */
+      Sweep<D>& sweep();
 
       /**
       * Get associated Basis object by reference.
@@ -334,6 +373,11 @@ namespace Pspc
       */  
       bool hasCFields() const;
 
+      /** 
+      * Does this system have an associated Sweep object?
+      */
+      bool hasSweep() const;
+
       //@}
       /// \name Commands (one-to-one correspondence with command file commands)
       //@{
@@ -366,6 +410,18 @@ namespace Pspc
       */
       void readWRGrid(const std::string & filename);
    
+      /**
+      * Read chemical potential fields from a binary r-grid file.
+      *
+      * This function reads fields in the binary r-grid format described 
+      * in FieldIo::readFieldsRGridBinary into the wFieldsRGrid array, 
+      * and converts them to symmetrized basis format. On exit hasWFields 
+      * is true and hasCFields is false. 
+      *
+      * \param filename name of input w-field file in binary r-grid format
+      */
+      void readWRGridBinary(const std::string & filename);
+   
       /**
       * Iteratively solve a SCFT problem.
       * 
@@ -378,6 +434,11 @@ namespace Pspc
       * energy and pressure are computed if and only if convergence is
       * obtained. 
       *
+      * If the mixture uses adaptive contour steps, the contour grids
+      * stay fixed during each iterative solution. After convergence, 
+      * the grids are adapted to the converged solution, and iteration 
+      * is repeated if any grid changed, at most 4 times.
+      *
       * \pre The hasWFields flag must be true on entry.
       * \return returns 0 for successful convergence, 1 for failure.
       */
@@ -416,6 +477,13 @@ namespace Pspc
       */
       void writeWRGrid(const std::string & filename);
    
+      /**
+      * Write chemical potential fields in binary r-grid format.
+      *
+      * \param filename name of output file
+      */
+      void writeWRGridBinary(const std::string & filename);
+   
       /**
       * Write concentrations in symmetry-adapted basis format.
       *
@@ -429,6 +497,41 @@ namespace Pspc
       * \param filename name of output file
       */
       void writeCRGrid(const std::string & filename);
+
+      /**
+      * Write concentration fields in binary r-grid format.
+      *
+      * \param filename name of output file
+      */
+      void writeCRGridBinary(const std::string & filename);
+   
+      /**
+      * Write a binary checkpoint file, from which iteration can resume.
+      *
+      * The file contains the unit cell parameters, the chemical 
+      * potential fields in both basis and r-grid formats, and the 
+      * internal state of the iterator (e.g., the Anderson mixing 
+      * histories), as saved by Iterator::saveState. An Exception is
+      * thrown if the iterator cannot save its state, as indicated by
+      * Iterator::canSaveState.
+      *
+      * \param filename name of output file
+      */
+      void writeCheckpoint(const std::string & filename);
+
+      /**
+      * Read a binary checkpoint file written by writeCheckpoint.
+      *
+      * This function restores the unit cell, chemical potential fields
+      * and iterator state, so that the next call to iterate() resumes
+      * the checkpointed iteration exactly. The file must have been 
+      * written by a System with the same dimension, mesh, basis and 
+      * iterator class, which must be able to save its state. On exit
+      * hasWFields is true and hasCFields is false.
+      *
+      * \param filename name of input file
+      */
+      void readCheckpoint(const std::string & filename);
    
       /**
       * Convert a field from symmetry-adapted basis to r-grid format.
@@ -456,6 +559,32 @@ namespace Pspc
       void rGridToBasis(const std::string & inFileName, 
                         const std::string & outFileName);
    
+      /**
+      * Convert a field file from text to binary r-grid format.
+      *
+      * This function uses the c-field r-grid arrays for temporary 
+      * storage, and thus corrupts any previously stored values. As a 
+      * result, flag hasCFields is false on return.
+      *
+      * \param inFileName name of input file, in text r-grid format
+      * \param outFileName name of output file, in binary r-grid format
+      */
+      void rGridToBinary(const std::string & inFileName, 
+                         const std::string & outFileName);
+   
+      /**
+      * Convert a field file from binary to text r-grid format.
+      *
+      * This function uses the c-field r-grid arrays for temporary 
+      * storage, and thus corrupts any previously stored values. As a 
+      * result, flag hasCFields is false on return.
+      *
+      * \param inFileName name of input file, in binary r-grid format
+      * \param outFileName name of output file, in text r-grid format
+      */
+      void binaryToRGrid(const std::string & inFileName, 
+                         const std::string & outFileName);
+   
       /**
       * Convert fields from Fourier (k-grid) to real-space (r-grid) format.
       *
@@ -510,6 +639,16 @@ namespace Pspc
       */
       void outputWaves(const std::string & outFileName);
 
+      /**
+      * Write a summary of memory used by fields, for each subsystem.
+      *
+      * Reports memory allocated from the FieldArena objects used for
+      * system fields, propagator slices and block work fields.
+      *
+      * \param out output stream
+      */
+      void writeMemoryReport(std::ostream& out);
+
       //@}
 
    private:
@@ -531,6 +670,11 @@ namespace Pspc
       */
       Mesh<D> mesh_;
 
+      /**
+      * Minimum images and |G|^2 of wavevectors, shared by all blocks.
+      */
+      WaveList<D> wavelist_;
+
       /**
       * FFT object to be used by iterator
       */
@@ -541,6 +685,11 @@ namespace Pspc
       */
       std::string groupName_;
 
+      /**
+      * Name of FFTW wisdom file (empty if wisdom is not saved).
+      */
+      std::string wisdomFileName_;
+
       /**
       * Pointer to a Basis object
       */
@@ -569,19 +718,27 @@ namespace Pspc
       /**
       * Pointer to an iterator.
       */
-      AmIterator<D>* iteratorPtr_;
+      Iterator<D>* iteratorPtr_;
+
+      /**
+      * Pointer to iterator factory.
+      */
+      IteratorFactory<D>* iteratorFactoryPtr_;
 
-      #if 0
       /**
       * Pointer to an Sweep object
       */
-      Sweep* sweepPtr_;
+      Sweep<D>* sweepPtr_;
 
       /**
       * Pointer to SweepFactory object
       */
-      SweepFactory* sweepFactoryPtr_;
-      #endif
+      SweepFactory<D>* sweepFactoryPtr_;
+
+      /**
+      * Memory for r-grid and k-grid fields of the system.
+      */
+      FieldArena fieldArena_;
 
       /**
       * Array of chemical potential fields for monomer types.
@@ -591,11 +748,11 @@ namespace Pspc
       DArray<DArray <double> > wFields_;
 
       /**
-      * Array of chemical potential fields for monomer types.
+      * Chemical potential fields for monomer types on r-space grid.
       *
-      * Indexed by monomer typeId, size = nMonomer.
+      * Contiguous block of nMonomer fields, indexed by monomer typeId.
       */
-      DArray<WField> wFieldsRGrid_;
+      RFieldBlock<D> wFieldsRGrid_;
 
       /**
       * Work space for chemical potential fields
@@ -610,11 +767,11 @@ namespace Pspc
       DArray<DArray <double> > cFields_;
 
       /**
-      * Array of concentration fields on real space grid.
+      * Concentration fields for monomer types on real space grid.
       *
-      * Indexed by monomer typeId, size = nMonomer.
+      * Contiguous block of nMonomer fields, indexed by monomer typeId.
       */
-      DArray<CField> cFieldsRGrid_;
+      RFieldBlock<D> cFieldsRGrid_;
 
       /**
       * Array of concentration fields on Fourier grid (k-grid).
@@ -677,12 +834,10 @@ namespace Pspc
       */
       bool hasCFields_;
 
-      #if 0
       /**
       * Does this system have a Sweep object?
       */
       bool hasSweep_;
-      #endif
 
       // Private member functions
 
@@ -739,6 +894,11 @@ namespace Pspc
    inline Mesh<D>& System<D>::mesh()
    { return mesh_; }
 
+   // Get the WaveList<D> object.
+   template <int D>
+   inline WaveList<D>& System<D>::wavelist()
+   { return wavelist_; }
+
    // Get the FFT<D> object.
    template <int D>
    inline FFT<D>& System<D>::fft()
@@ -779,12 +939,20 @@ namespace Pspc
 
    // Get the Iterator.
    template <int D>
-   inline AmIterator<D>& System<D>::iterator()
+   inline Iterator<D>& System<D>::iterator()
    {
       UTIL_ASSERT(iteratorPtr_);
       return *iteratorPtr_;
    }
 
+   // Get the Sweep.
+   template <int D>
+   inline Sweep<D>& System<D>::sweep()
+   {
+      UTIL_ASSERT(sweepPtr_);
+      return *sweepPtr_;
+   }
+
    template <int D>
    inline
    DArray<DArray <double> >& System<D>::wFields()
@@ -799,6 +967,12 @@ namespace Pspc
    template <int D>
    inline 
    DArray< typename System<D>::WField >& System<D>::wFieldsRGrid()
+   {  return wFieldsRGrid_.fields(); }
+
+   // Get the contiguous block of chemical potential fields on r-grids.
+   template <int D>
+   inline 
+   RFieldBlock<D>& System<D>::wFieldsRGridBlock()
    {  return wFieldsRGrid_; }
 
    // Get a single monomer chemical potential field on an r-space grid.
@@ -841,6 +1015,12 @@ namespace Pspc
    template <int D>
    inline
    DArray< typename System<D>::CField >& System<D>::cFieldsRGrid()
+   {  return cFieldsRGrid_.fields(); }
+
+   // Get the contiguous block of concentration fields on r-grids.
+   template <int D>
+   inline 
+   RFieldBlock<D>& System<D>::cFieldsRGridBlock()
    {  return cFieldsRGrid_; }
 
    // Get a single monomer concentration field on an r-space grid.
@@ -858,6 +1038,11 @@ namespace Pspc
    inline bool System<D>::hasCFields() const
    {  return hasCFields_; }
 
+   // Does this system have a Sweep?
+   template <int D>
+   inline bool System<D>::hasSweep() const
+   {  return hasSweep_; }
+
    // Get the precomputed Helmoltz free energy per monomer / kT.
    template <int D>
    inline double System<D>::fHelmholtz() const
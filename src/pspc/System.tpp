@@ -10,12 +10,11 @@
 
 #include "System.h"
 
-#if 0
 #include <pspc/sweep/Sweep.h>
 #include <pspc/sweep/SweepFactory.h>
-#endif
 
-#include <pspc/iterator/AmIterator.h>
+#include <pspc/iterator/Iterator.h>
+#include <pspc/iterator/IteratorFactory.h>
 
 #include <pscf/mesh/MeshIterator.h>
 #include <pscf/crystal/shiftToMinimum.h>
@@ -23,11 +22,15 @@
 #include <pscf/inter/ChiInteraction.h>
 #include <pscf/homogeneous/Clump.h>
 
+#include <util/archives/BinaryFileOArchive.h>
+#include <util/archives/BinaryFileIArchive.h>
 #include <util/format/Str.h>
 #include <util/format/Int.h>
 #include <util/format/Dbl.h>
 
+#include <algorithm>
 #include <ctime>
+#include <fstream>
 #include <iomanip>
 #include <sstream>
 #include <string>
@@ -47,16 +50,20 @@ namespace Pspc
     : mixture_(),
       unitCell_(),
       mesh_(),
+      wavelist_(),
       fft_(),
       groupName_(),
+      wisdomFileName_(),
       basis_(),
       fileMaster_(),
       fieldIo_(),
       homogeneous_(),
       interactionPtr_(0),
       iteratorPtr_(0),
-      // sweepPtr_(0),
-      // sweepFactoryPtr_(0),
+      iteratorFactoryPtr_(0),
+      sweepPtr_(0),
+      sweepFactoryPtr_(0),
+      fieldArena_("system fields"),
       wFields_(),
       cFields_(),
       f_(),
@@ -67,8 +74,8 @@ namespace Pspc
       hasUnitCell_(false),
       isAllocated_(false),
       hasWFields_(false),
-      hasCFields_(false)
-      //hasSweep_(false)
+      hasCFields_(false),
+      hasSweep_(false)
    {  
       setClassName("System"); 
 
@@ -76,9 +83,9 @@ namespace Pspc
                          basis_, fileMaster_);
 
       interactionPtr_ = new ChiInteraction(); 
-      iteratorPtr_ = new AmIterator<D>(this); 
+      iteratorFactoryPtr_ = new IteratorFactory<D>(*this); 
 
-      // sweepFactoryPtr_ = new SweepFactory(*this);
+      sweepFactoryPtr_ = new SweepFactory<D>(*this);
    }
 
    /*
@@ -87,12 +94,26 @@ namespace Pspc
    template <int D>
    System<D>::~System()
    {
+      // Save FFTW wisdom accumulated during this run, if requested
+      if (!wisdomFileName_.empty()) {
+         FFTPlanner::exportWisdom(fileMaster().outputPrefix() 
+                                  + wisdomFileName_);
+      }
       if (interactionPtr_) {
          delete interactionPtr_;
       }
       if (iteratorPtr_) {
          delete iteratorPtr_;
       }
+      if (iteratorFactoryPtr_) {
+         delete iteratorFactoryPtr_;
+      }
+      if (sweepPtr_) {
+         delete sweepPtr_;
+      }
+      if (sweepFactoryPtr_) {
+         delete sweepFactoryPtr_;
+      }
    }
 
    /*
@@ -198,31 +219,117 @@ namespace Pspc
 
       read(in, "groupName", groupName_);
 
+      // Optionally set FFTW planning rigor (default estimate). 
+      // This must precede mixture().setMesh(), which creates plans.
+      FFTPlanner::Rigor fftPlanning = FFTPlanner::Estimate;
+      readOptional<FFTPlanner::Rigor>(in, "fftPlanning", fftPlanning);
+      FFTPlanner::setRigor(fftPlanning);
+      if (fftPlanning != FFTPlanner::Estimate) {
+
+         // Wisdom file name is keyed by mesh dimensions
+         std::stringstream buffer;
+         buffer << "fftw_wisdom";
+         for (int i = 0; i < D; ++i) {
+            buffer << (i == 0 ? "_" : "x") << mesh().dimension(i);
+         }
+         wisdomFileName_ = buffer.str();
+
+         // Load wisdom saved by a previous run on the same mesh, if 
+         // any. An unreadable file is ignored, and replaced on exit.
+         std::string filename = fileMaster().inputPrefix() 
+                              + wisdomFileName_;
+         if (FFTPlanner::importWisdom(filename)) {
+            Log::file() << "Read FFTW wisdom file " 
+                        << filename << std::endl;
+         } else {
+            std::ifstream file(filename.c_str());
+            if (file.is_open()) {
+               Log::file() << "Warning: Ignoring invalid FFTW wisdom file "
+                           << filename << std::endl;
+            }
+         }
+      }
+
+      // Optionally request transparent huge pages for field memory
+      // (default false). This must precede mixture().setMesh().
+      bool hugePages = false;
+      readOptional<bool>(in, "hugePages", hugePages);
+      fieldArena_.setHugePages(hugePages);
+      mixture().propagatorArena().setHugePages(hugePages);
+      mixture().blockArena().setHugePages(hugePages);
+
+      // Optionally read the symmetry-adapted basis from a cache file
+      // written by a previous run, or write one (default false).
+      bool basisCache = false;
+      readOptional<bool>(in, "basisCache", basisCache);
+
       mixture().setMesh(mesh());
-      mixture().setupUnitCell(unitCell());
-      basis().makeBasis(mesh(), unitCell(), groupName_);
+
+      // Compute minimum images and |G|^2 once for all blocks
+      wavelist().allocate(mesh(), unitCell());
+      wavelist().computeMinimumImages(mesh(), unitCell());
+      wavelist().computeKSq(unitCell());
+      wavelist().computedKSq(unitCell());
+      mixture().setupUnitCell(unitCell(), wavelist());
+      if (basisCache) {
+
+         // Cache file name is keyed by group, mesh and lattice system
+         std::stringstream buffer;
+         buffer << "basis_" << groupName_;
+         for (int i = 0; i < D; ++i) {
+            buffer << (i == 0 ? "_" : "x") << mesh().dimension(i);
+         }
+         buffer << "_" << unitCell().lattice();
+         std::string fileName = buffer.str();
+         std::replace(fileName.begin(), fileName.end(), '/', '_');
+
+         // Read with the input prefix, write with the output prefix
+         std::string inFileName = fileMaster().inputPrefix() + fileName;
+         std::string outFileName = fileMaster().outputPrefix() + fileName;
+         if (basis().readCache(inFileName, mesh(), unitCell(), 
+                               groupName_)) {
+            Log::file() << "Read basis cache file " 
+                        << inFileName << std::endl;
+         } else {
+            basis().makeBasis(mesh(), unitCell(), groupName_);
+            if (basis().writeCache(outFileName, groupName_)) {
+               Log::file() << "Wrote basis cache file " 
+                           << outFileName << std::endl;
+            }
+         }
+
+      } else {
+         basis().makeBasis(mesh(), unitCell(), groupName_);
+      }
 
       allocate();
       isAllocated_ = true;
-
-      // Initialize iterator
-      readParamComposite(in, iterator());
+      writeMemoryReport(Log::file());
+
+      // Instantiate and initialize an Iterator (e.g., AmIterator)
+      std::string className;
+      bool isEnd;
+      iteratorPtr_ = 
+         iteratorFactoryPtr_->readObject(in, *this, className, isEnd);
+      if (!iteratorPtr_) {
+         std::string msg = "Unrecognized Iterator subclass name: ";
+         msg += className;
+         UTIL_THROW(msg.c_str());
+      }
       iterator().allocate();
 
-      #if 0
       // Optionally instantiate a Sweep object
+      hasSweep_ = false;
       readOptional<bool>(in, "hasSweep", hasSweep_);
       if (hasSweep_) {
-         std::string className;
-         bool isEnd;
          sweepPtr_ = 
             sweepFactoryPtr_->readObject(in, *this, className, isEnd);
          if (!sweepPtr_) {
-            UTIL_THROW("Unrecognized Sweep subclass name");
+            std::string msg = "Unrecognized Sweep subclass name: ";
+            msg += className;
+            UTIL_THROW(msg.c_str());
          }
-         sweepPtr_->setSystem(*this);
       }
-      #endif
    }
 
    /*
@@ -256,21 +363,19 @@ namespace Pspc
       // Allocate wFields and cFields
       int nMonomer = mixture().nMonomer();
       wFields_.allocate(nMonomer);
-      wFieldsRGrid_.allocate(nMonomer);
+      wFieldsRGrid_.allocate(nMonomer, mesh().dimensions(), &fieldArena_);
       wFieldsKGrid_.allocate(nMonomer);
 
       cFields_.allocate(nMonomer);
-      cFieldsRGrid_.allocate(nMonomer);
+      cFieldsRGrid_.allocate(nMonomer, mesh().dimensions(), &fieldArena_);
       cFieldsKGrid_.allocate(nMonomer);
       
       for (int i = 0; i < nMonomer; ++i) {
          wField(i).allocate(basis().nStar());
-         wFieldRGrid(i).allocate(mesh().dimensions());
-         wFieldKGrid(i).allocate(mesh().dimensions());
+         wFieldKGrid(i).allocate(mesh().dimensions(), &fieldArena_);
 
          cField(i).allocate(basis().nStar());
-         cFieldRGrid(i).allocate(mesh().dimensions());
-         cFieldKGrid(i).allocate(mesh().dimensions());
+         cFieldKGrid(i).allocate(mesh().dimensions(), &fieldArena_);
       }
       isAllocated_ = true;
    }
@@ -313,6 +418,10 @@ namespace Pspc
             readEcho(in, filename);
             readWRGrid(filename);
          } else
+         if (command == "READ_W_RGRID_BINARY") {
+            readEcho(in, filename);
+            readWRGridBinary(filename);
+         } else
          if (command == "ITERATE") {
             // Read w (chemical potential) fields if not done previously 
             if (!hasWFields_) {
@@ -325,6 +434,25 @@ namespace Pspc
                readNext = false;
             }
          } else
+         if (command == "SWEEP") {
+            // Read w (chemical potential) fields if not done previously 
+            if (!hasWFields_) {
+               readEcho(in, filename);
+               readWBasis(filename);
+            }
+            // Solve a sequence of problems along a line in parameter space
+            UTIL_CHECK(hasSweep_);
+            UTIL_CHECK(sweepPtr_);
+            sweepPtr_->solve();
+         } else
+         if (command == "CHECKPOINT") {
+            readEcho(in, filename);
+            writeCheckpoint(filename);
+         } else
+         if (command == "RESTART") {
+            readEcho(in, filename);
+            readCheckpoint(filename);
+         } else
          if (command == "SOLVE_MDE") {
             // Read w (chemical potential fields) if not done previously 
             if (!hasWFields_) {
@@ -342,6 +470,10 @@ namespace Pspc
             readEcho(in, filename);
             writeWRGrid(filename);
          } else 
+         if (command == "WRITE_W_RGRID_BINARY") {
+            readEcho(in, filename);
+            writeWRGridBinary(filename);
+         } else 
          if (command == "WRITE_C_BASIS") {
             readEcho(in, filename);
             writeCBasis(filename);
@@ -350,6 +482,10 @@ namespace Pspc
             readEcho(in, filename);
             writeCRGrid(filename);
          } else
+         if (command == "WRITE_C_RGRID_BINARY") {
+            readEcho(in, filename);
+            writeCRGridBinary(filename);
+         } else
          if (command == "BASIS_TO_RGRID") {
             readEcho(in, inFileName);
             readEcho(in, outFileName);
@@ -360,6 +496,16 @@ namespace Pspc
             readEcho(in, outFileName);
             rGridToBasis(inFileName, outFileName);
          } else
+         if (command == "RGRID_TO_BINARY") {
+            readEcho(in, inFileName);
+            readEcho(in, outFileName);
+            rGridToBinary(inFileName, outFileName);
+         } else
+         if (command == "BINARY_TO_RGRID") {
+            readEcho(in, inFileName);
+            readEcho(in, outFileName);
+            binaryToRGrid(inFileName, outFileName);
+         } else
          if (command == "KGRID_TO_RGRID") {
             readEcho(in, inFileName);
             readEcho(in, outFileName);
@@ -382,6 +528,9 @@ namespace Pspc
          if (command == "OUTPUT_WAVES") {
             readEcho(in, outFileName);
             outputWaves(outFileName);
+         } else
+         if (command == "WRITE_MEMORY_REPORT") {
+            writeMemoryReport(Log::file());
          } else {
             Log::file() << "Error: Unknown command  " 
                         << command << std::endl;
@@ -402,7 +551,19 @@ namespace Pspc
       readCommands(fileMaster().commandFile()); 
    }
 
-  
+   /*
+   * Set unit cell parameters and update dependent quantities.
+   */
+   template <int D>
+   void System<D>::setUnitCell(FSArray<double, 6> const & parameters)
+   {
+      unitCell().setParameters(parameters);
+      wavelist().computeKSq(unitCell());
+      wavelist().computedKSq(unitCell());
+      mixture().setupUnitCell(unitCell(), wavelist());
+      basis().update();
+   }
+
    /*
    * Compute Helmoltz free energy and pressure
    */
@@ -557,7 +718,7 @@ namespace Pspc
    void System<D>::readWBasis(const std::string & filename)
    {
       fieldIo().readFieldsBasis(filename, wFields());
-      fieldIo().convertBasisToRGrid(wFields(), wFieldsRGrid());
+      fieldIo().convertBasisToRGrid(wFields(), wFieldsRGridBlock());
       hasWFields_ = true;
       hasCFields_ = false;
    }
@@ -569,7 +730,19 @@ namespace Pspc
    void System<D>::readWRGrid(const std::string & filename)
    {
       fieldIo().readFieldsRGrid(filename, wFieldsRGrid());
-      fieldIo().convertRGridToBasis(wFieldsRGrid(), wFields());
+      fieldIo().convertRGridToBasis(wFieldsRGridBlock(), wFields());
+      hasWFields_ = true;
+      hasCFields_ = false;
+   }
+
+   /*
+   * Read w-fields in binary real-space grid (r-grid) format.
+   */
+   template <int D>
+   void System<D>::readWRGridBinary(const std::string & filename)
+   {
+      fieldIo().readFieldsRGridBinary(filename, wFieldsRGrid());
+      fieldIo().convertRGridToBasis(wFieldsRGridBlock(), wFields());
       hasWFields_ = true;
       hasCFields_ = false;
    }
@@ -588,6 +761,18 @@ namespace Pspc
 
       // Call iterator
       int error = iterator().solve();
+
+      // Adaptive contour steps: Adapt the grids only between converged
+      // solutions, and iterate again on each new grid until it is stable
+      if (mixture().isAdaptive()) {
+         const int maxAdapt = 4;
+         int nAdapt = 0;
+         while (!error && nAdapt < maxAdapt && mixture().adaptContour()) {
+            ++nAdapt;
+            Log::file() << "Contour grid adapted, iterating again\n";
+            error = iterator().solve();
+         }
+      }
       hasCFields_ = true;
 
       if (error) {
@@ -611,7 +796,7 @@ namespace Pspc
       mixture().compute(wFieldsRGrid(), cFieldsRGrid());
 
       // Convert c fields from r-grid to basis
-      fieldIo().convertRGridToBasis(cFieldsRGrid(), cFields());
+      fieldIo().convertRGridToBasis(cFieldsRGridBlock(), cFields());
       hasCFields_ = true;
    }
 
@@ -635,6 +820,16 @@ namespace Pspc
       fieldIo().writeFieldsRGrid(filename, wFieldsRGrid());
    }
 
+   /*
+   * Write w-fields to real space grid, in binary format.
+   */
+   template <int D>
+   void System<D>::writeWRGridBinary(const std::string & filename)
+   {
+      UTIL_CHECK(hasWFields_);
+      fieldIo().writeFieldsRGridBinary(filename, wFieldsRGrid());
+   }
+
    /*
    * Write concentrations in symmetry-adapted basis format.
    */
@@ -655,6 +850,154 @@ namespace Pspc
       fieldIo().writeFieldsRGrid(filename, cFieldsRGrid());
    }
 
+   /*
+   * Write concentration fields to real space grid, in binary format.
+   */
+   template <int D>
+   void System<D>::writeCRGridBinary(const std::string & filename)
+   {
+      UTIL_CHECK(hasCFields_);
+      fieldIo().writeFieldsRGridBinary(filename, cFieldsRGrid());
+   }
+
+   /*
+   * Write fields, unit cell and iterator state to a binary file.
+   */
+   template <int D>
+   void System<D>::writeCheckpoint(const std::string & filename)
+   {
+      UTIL_CHECK(hasWFields_);
+      if (!iterator().canSaveState()) {
+         std::string msg = "Iterator does not support checkpoints: ";
+         msg += iterator().className();
+         UTIL_THROW(msg.c_str());
+      }
+      std::ofstream file;
+      fileMaster().openOutputFile(filename, file, 
+                                  std::ios::out | std::ios::binary);
+      BinaryFileOArchive ar(file);
+
+      // Header, used to check consistency when reading
+      std::string label = "PSPC_CHECKPOINT";
+      int version = 1;
+      int dimension = D;
+      int nMonomer = mixture().nMonomer();
+      int nStar = basis().nStar();
+      IntVec<D> meshDimensions = mesh().dimensions();
+      ar & label;
+      ar & version;
+      ar & dimension;
+      ar & nMonomer;
+      ar & nStar;
+      ar & meshDimensions;
+
+      // Unit cell parameters
+      int nParameter = unitCell().nParameter();
+      FSArray<double, 6> parameters = unitCell().parameters();
+      ar & nParameter;
+      int i;
+      for (i = 0; i < nParameter; ++i) {
+         ar & parameters[i];
+      }
+
+      // Chemical potential fields, in basis and r-grid formats
+      for (i = 0; i < nMonomer; ++i) {
+         ar & wFields_[i];
+      }
+      for (i = 0; i < nMonomer; ++i) {
+         ar & wFieldsRGrid_[i];
+      }
+
+      // Iterator state
+      std::string iteratorName = iterator().className();
+      ar & iteratorName;
+      iterator().saveState(ar);
+
+      file.close();
+   }
+
+   /*
+   * Read a binary file written by writeCheckpoint.
+   */
+   template <int D>
+   void System<D>::readCheckpoint(const std::string & filename)
+   {
+      if (!iterator().canSaveState()) {
+         std::string msg = "Iterator does not support checkpoints: ";
+         msg += iterator().className();
+         UTIL_THROW(msg.c_str());
+      }
+      std::ifstream file;
+      fileMaster().openInputFile(filename, file, 
+                                 std::ios::in | std::ios::binary);
+      BinaryFileIArchive ar(file);
+
+      // Read and check header
+      std::string label;
+      int version, dimension, nMonomer, nStar;
+      IntVec<D> meshDimensions;
+      ar & label;
+      if (label != "PSPC_CHECKPOINT") {
+         UTIL_THROW("Invalid checkpoint file label");
+      }
+      ar & version;
+      if (version != 1) {
+         UTIL_THROW("Unsupported checkpoint file version");
+      }
+      ar & dimension;
+      ar & nMonomer;
+      ar & nStar;
+      ar & meshDimensions;
+      if (dimension != D || nMonomer != mixture().nMonomer()
+          || nStar != basis().nStar() 
+          || meshDimensions != mesh().dimensions()) {
+         UTIL_THROW("Checkpoint file is inconsistent with System");
+      }
+
+      // Read unit cell parameters, and update cell if they differ
+      int nParameter;
+      ar & nParameter;
+      if (nParameter != unitCell().nParameter()) {
+         UTIL_THROW("Inconsistent number of unit cell parameters");
+      }
+      FSArray<double, 6> parameters = unitCell().parameters();
+      bool isChanged = false;
+      double value;
+      int i;
+      for (i = 0; i < nParameter; ++i) {
+         ar & value;
+         if (value != parameters[i]) {
+            parameters[i] = value;
+            isChanged = true;
+         }
+      }
+      if (isChanged) {
+         setUnitCell(parameters);
+      }
+
+      // Chemical potential fields, in basis and r-grid formats
+      for (i = 0; i < nMonomer; ++i) {
+         ar & wFields_[i];
+      }
+      for (i = 0; i < nMonomer; ++i) {
+         ar & wFieldsRGrid_[i];
+      }
+      hasWFields_ = true;
+      hasCFields_ = false;
+
+      // Iterator state
+      std::string iteratorName;
+      ar & iteratorName;
+      if (iteratorName != iterator().className()) {
+         std::string msg = "Checkpoint written by different iterator: ";
+         msg += iteratorName;
+         UTIL_THROW(msg.c_str());
+      }
+      iterator().loadState(ar);
+
+      file.close();
+   }
+
    /*
    * Convert fields from symmetry-adpated basis to real-space grid format.
    */
@@ -667,7 +1010,7 @@ namespace Pspc
       hasCFields_ = false;
 
       fieldIo().readFieldsBasis(inFileName, cFields());
-      fieldIo().convertBasisToRGrid(cFields(), cFieldsRGrid());
+      fieldIo().convertBasisToRGrid(cFields(), cFieldsRGridBlock());
       fieldIo().writeFieldsRGrid(outFileName, cFieldsRGrid());
    }
 
@@ -682,10 +1025,34 @@ namespace Pspc
       hasCFields_ = false;
 
       fieldIo().readFieldsRGrid(inFileName, cFieldsRGrid());
-      fieldIo().convertRGridToBasis(cFieldsRGrid(), cFields());
+      fieldIo().convertRGridToBasis(cFieldsRGridBlock(), cFields());
       fieldIo().writeFieldsBasis(outFileName, cFields());
    }
 
+   /*
+   * Convert fields from text to binary real-space grid format.
+   */
+   template <int D>
+   void System<D>::rGridToBinary(const std::string & inFileName,
+                                 const std::string & outFileName)
+   {
+      hasCFields_ = false;
+      fieldIo().readFieldsRGrid(inFileName, cFieldsRGrid());
+      fieldIo().writeFieldsRGridBinary(outFileName, cFieldsRGrid());
+   }
+
+   /*
+   * Convert fields from binary to text real-space grid format.
+   */
+   template <int D>
+   void System<D>::binaryToRGrid(const std::string & inFileName,
+                                 const std::string & outFileName)
+   {
+      hasCFields_ = false;
+      fieldIo().readFieldsRGridBinary(inFileName, cFieldsRGrid());
+      fieldIo().writeFieldsRGrid(outFileName, cFieldsRGrid());
+   }
+
    /*
    * Convert fields from Fourier (k-grid) to real-space (r-grid) format.
    */
@@ -762,7 +1129,7 @@ namespace Pspc
       }
 
       // Convert to r-grid format
-      fieldIo().convertBasisToRGrid(wFields(), wFieldsRGrid());
+      fieldIo().convertBasisToRGrid(wFields(), wFieldsRGridBlock());
       hasWFields_ = true;
       hasCFields_ = false;
 
@@ -794,6 +1161,36 @@ namespace Pspc
       basis().outputWaves(outFile);
    }
 
+   /*
+   * Write memory used by fields in each FieldArena.
+   */
+   template <int D>
+   void System<D>::writeMemoryReport(std::ostream& out)
+   {
+      FieldArena* arenas[3];
+      arenas[0] = &fieldArena_;
+      arenas[1] = &mixture().propagatorArena();
+      arenas[2] = &mixture().blockArena();
+
+      out << std::endl;
+      out << "Field memory (MB):" << std::endl;
+      out << "  " << Str("subsystem", 16) << std::setw(8) << "arrays"
+          << std::setw(12) << "used" << std::setw(12) << "reserved"
+          << std::setw(8) << "regions" << std::endl;
+      size_t size = 0;
+      size_t capacity = 0;
+      for (int i = 0; i < 3; ++i) {
+         arenas[i]->writeReport(out);
+         size += arenas[i]->size();
+         capacity += arenas[i]->capacity();
+      }
+      double mb = 1.0/(1024.0*1024.0);
+      out << "  " << Str("total", 24)
+          << Dbl(double(size)*mb, 12, 3)
+          << Dbl(double(capacity)*mb, 12, 3) << std::endl;
+      out << std::endl;
+   }
+
 } // namespace Pspc
 } // namespace Pscf
 #endif
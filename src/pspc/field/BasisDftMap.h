@@ -0,0 +1,220 @@
+#ifndef PSPC_BASIS_DFT_MAP_H
+#define PSPC_BASIS_DFT_MAP_H
+
+/*
+* PSCF++ Package
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <pscf/crystal/Basis.h>
+#include <pscf/mesh/Mesh.h>
+#include <util/containers/DArray.h>
+#include <util/global.h>
+
+#include <complex>
+#include <fftw3.h>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+   using namespace Pscf;
+
+   /**
+   * Precomputed map between a symmetry-adapted basis and a k-grid.
+   *
+   * A BasisDftMap<D> is constructed once from a Basis<D>, and is then
+   * used to convert fields between a symmetry-adapted basis and the
+   * discrete Fourier transform (DFT) of a real field, without further
+   * access to the Basis.
+   *
+   * Waves that are represented explicitly in the DFT of a real field
+   * are in one-to-one correspondence with elements of the DFT array.
+   * For each element of this array, the map stores the index of the
+   * star that contains the corresponding wave and the coefficient of
+   * the wave in the associated basis function, in flat arrays indexed
+   * by DFT rank. The map also stores the DFT rank and coefficient of
+   * the characteristic wave used to compute each component in the
+   * conversion from k-grid to basis.
+   *
+   * Conversion from basis to DFT thus requires one pass over the stars
+   * to compute a complex prefactor for each, followed by a sequential
+   * pass over the DFT array that gathers prefactors by star index.
+   * Conversion from DFT to basis requires one pass over the stars.
+   * Loops are multi-threaded if PSPC_OPENMP is defined. Versions that
+   * convert an array of fields stored in a contiguous k-grid array
+   * process all fields within each loop iteration.
+   *
+   * \ingroup Pspc_Field_Module
+   */
+   template <int D>
+   class BasisDftMap
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      */
+      BasisDftMap();
+
+      /**
+      * Destructor.
+      */
+      ~BasisDftMap();
+
+      /**
+      * Allocate and construct the map.
+      *
+      * \param basis  symmetry-adapted basis
+      * \param mesh  spatial discretization mesh
+      */
+      void setup(Basis<D> const & basis, Mesh<D> const & mesh);
+
+      /**
+      * Convert a field from symmetry-adapted basis to a DFT array.
+      *
+      * \param in  array of nStar basis function coefficients
+      * \param out  DFT of a real field, with dftSize elements
+      */
+      void basisToDft(double const * in, fftw_complex* out) const;
+
+      /**
+      * Convert a field from a DFT array to symmetry-adapted basis.
+      *
+      * \param in  DFT of a real field, with dftSize elements
+      * \param out  array of nStar basis function coefficients
+      */
+      void dftToBasis(fftw_complex const * in, double* out) const;
+
+      /**
+      * Convert an array of fields from basis to a contiguous DFT array.
+      *
+      * Element j of the DFT of field i is element i*kSize + j of out.
+      *
+      * \param in  basis function coefficients of fields
+      * \param out  DFT of all fields
+      * \param kSize  stride between fields in out (>= dftSize)
+      */
+      void basisToDft(DArray< DArray<double> > const & in,
+                      fftw_complex* out, int kSize) const;
+
+      /**
+      * Convert an array of fields from a contiguous DFT array to basis.
+      *
+      * Element j of the DFT of field i is element i*kSize + j of in.
+      *
+      * \param in  DFT of all fields
+      * \param kSize  stride between fields in in (>= dftSize)
+      * \param out  basis function coefficients of fields
+      */
+      void dftToBasis(fftw_complex const * in, int kSize,
+                      DArray< DArray<double> > & out) const;
+
+      /**
+      * Has this map been constructed?
+      */
+      bool isSetup() const;
+
+      /**
+      * Number of stars.
+      */
+      int nStar() const;
+
+      /**
+      * Number of elements of the DFT of a real field.
+      */
+      int dftSize() const;
+
+   private:
+
+      /// Index of star containing the wave of each DFT element.
+      DArray<int> starIds_;
+
+      /// Real part of coefficient of the wave of each DFT element.
+      DArray<double> coeffRe_;
+
+      /// Imaginary part of coefficient of the wave of each DFT element.
+      DArray<double> coeffIm_;
+
+      /// Type of each star (value of StarType).
+      DArray<int> starTypes_;
+
+      /// DFT mesh rank of characteristic wave of each star.
+      DArray<int> charRanks_;
+
+      /// Coefficient of characteristic wave of each star.
+      DArray< std::complex<double> > charCoeffs_;
+
+      /// Work array for real parts of star prefactors.
+      mutable DArray<double> compRe_;
+
+      /// Work array for imaginary parts of star prefactors.
+      mutable DArray<double> compIm_;
+
+      /// Number of stars.
+      int nStar_;
+
+      /// Number of elements of DFT (number of explicit waves).
+      int dftSize_;
+
+      /**
+      * Type of star, equal to Basis::Star::invertFlag if not cancelled.
+      */
+      enum StarType {Second = -1, Closed = 0, First = 1, Cancelled = 2};
+
+      /**
+      * Compute complex prefactor of waves of one star of a field.
+      *
+      * \param in  basis function coefficients of field
+      * \param is  star index
+      * \param re  real part of prefactor (output)
+      * \param im  imaginary part of prefactor (output)
+      */
+      void starComponent(double const * in, int is,
+                         double& re, double& im) const;
+
+      /**
+      * Compute basis function coefficients of one star of a field.
+      *
+      * Sets out[is] for a closed star, and out[is] and out[is+1] for
+      * the first star of a pair related by inversion. Does nothing for
+      * the second star of such a pair.
+      *
+      * \param in  DFT of field
+      * \param is  star index
+      * \param out  basis function coefficients of field (output)
+      * \return false if the result for a closed star is not real
+      */
+      bool starCoefficients(fftw_complex const * in, int is,
+                            double* out) const;
+
+   };
+
+   // Inline member functions
+
+   template <int D>
+   inline bool BasisDftMap<D>::isSetup() const
+   {  return (nStar_ > 0); }
+
+   template <int D>
+   inline int BasisDftMap<D>::nStar() const
+   {  return nStar_; }
+
+   template <int D>
+   inline int BasisDftMap<D>::dftSize() const
+   {  return dftSize_; }
+
+   #ifndef PSPC_BASIS_DFT_MAP_TPP
+   // Suppress implicit instantiation
+   extern template class BasisDftMap<1>;
+   extern template class BasisDftMap<2>;
+   extern template class BasisDftMap<3>;
+   #endif
+
+} // namespace Pspc
+} // namespace Pscf
+#endif
@@ -0,0 +1,386 @@
+#ifndef PSPC_BASIS_DFT_MAP_TPP
+#define PSPC_BASIS_DFT_MAP_TPP
+
+/*
+* PSCF++ Package
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "BasisDftMap.h"
+#include <pscf/math/IntVec.h>
+
+#include <cmath>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /*
+   * Constructor.
+   */
+   template <int D>
+   BasisDftMap<D>::BasisDftMap()
+    : starIds_(),
+      coeffRe_(),
+      coeffIm_(),
+      starTypes_(),
+      charRanks_(),
+      charCoeffs_(),
+      compRe_(),
+      compIm_(),
+      nStar_(0),
+      dftSize_(0)
+   {}
+
+   /*
+   * Destructor.
+   */
+   template <int D>
+   BasisDftMap<D>::~BasisDftMap()
+   {}
+
+   /*
+   * Construct map from a Basis.
+   */
+   template <int D>
+   void BasisDftMap<D>::setup(Basis<D> const & basis,
+                              Mesh<D> const & mesh)
+   {
+      UTIL_CHECK(basis.nStar() > 0);
+
+      // Create Mesh<D> with dimensions of DFT Fourier grid.
+      IntVec<D> dftDimensions = mesh.dimensions();
+      dftDimensions[D-1] = mesh.dimension(D-1)/2 + 1;
+      Mesh<D> dftMesh(dftDimensions);
+
+      // Deallocate any previous map
+      if (starIds_.isAllocated()) {
+         starIds_.deallocate();
+         coeffRe_.deallocate();
+         coeffIm_.deallocate();
+         starTypes_.deallocate();
+         charRanks_.deallocate();
+         charCoeffs_.deallocate();
+         compRe_.deallocate();
+         compIm_.deallocate();
+      }
+
+      // Allocate arrays. Waves that are represented explicitly are in
+      // one-to-one correspondence with elements of the DFT array.
+      nStar_ = basis.nStar();
+      dftSize_ = dftMesh.size();
+      starIds_.allocate(dftSize_);
+      coeffRe_.allocate(dftSize_);
+      coeffIm_.allocate(dftSize_);
+      starTypes_.allocate(nStar_);
+      charRanks_.allocate(nStar_);
+      charCoeffs_.allocate(nStar_);
+
+      typename Basis<D>::Star const* starPtr; // pointer to current star
+      typename Basis<D>::Wave const* wavePtr; // pointer to current wave
+      bool isImplicit;
+      int is, iw, j, rank;
+
+      // Mark all elements of the DFT array as not yet assigned
+      for (j = 0; j < dftSize_; ++j) {
+         starIds_[j] = -1;
+      }
+
+      j = 0;
+      for (is = 0; is < nStar_; ++is) {
+         starPtr = &(basis.star(is));
+         UTIL_CHECK(starPtr->invertFlag >= -1 && starPtr->invertFlag <= 1);
+         if (starPtr->invertFlag == 1) {
+            UTIL_CHECK(is + 1 < nStar_);
+            UTIL_CHECK(basis.star(is+1).invertFlag == -1);
+            UTIL_CHECK(basis.star(is+1).cancel == starPtr->cancel);
+         }
+
+         // Add all explicit waves of this star
+         for (iw = starPtr->beginId; iw < starPtr->endId; ++iw) {
+            wavePtr = &basis.wave(iw);
+            if (!wavePtr->implicit) {
+               rank = dftMesh.rank(wavePtr->indicesDft);
+               UTIL_CHECK(starIds_[rank] == -1);
+               starIds_[rank] = is;
+               if (starPtr->cancel) {
+                  coeffRe_[rank] = 0.0;
+                  coeffIm_[rank] = 0.0;
+               } else {
+                  coeffRe_[rank] = wavePtr->coeff.real();
+                  coeffIm_[rank] = wavePtr->coeff.imag();
+               }
+               ++j;
+            }
+         }
+
+         // Set star type and characteristic wave
+         charRanks_[is] = -1;
+         charCoeffs_[is] = std::complex<double>(1.0, 0.0);
+         if (starPtr->cancel) {
+            starTypes_[is] = Cancelled;
+         } else
+         if (starPtr->invertFlag == 0) {
+            starTypes_[is] = Closed;
+
+            // Choose a characteristic wave that is not implicit.
+            // Start with the first, alternately searching from
+            // the beginning and end of star.
+            isImplicit = true;
+            iw = 0;
+            while (isImplicit) {
+                UTIL_CHECK(iw <= (starPtr->size)/2);
+                wavePtr = &basis.wave(starPtr->beginId + iw);
+                if (wavePtr->implicit) {
+                   wavePtr = &basis.wave(starPtr->endId - 1 - iw);
+                }
+                isImplicit = wavePtr->implicit;
+                ++iw;
+            }
+            UTIL_CHECK(wavePtr->starId == is);
+            charRanks_[is] = dftMesh.rank(wavePtr->indicesDft);
+            charCoeffs_[is] = wavePtr->coeff;
+
+         } else
+         if (starPtr->invertFlag == 1) {
+            starTypes_[is] = First;
+
+            // Identify a characteristic wave that is not implicit:
+            // Either first wave of 1st star or last wave of 2nd star.
+            wavePtr = &basis.wave(starPtr->beginId);
+            if (wavePtr->implicit) {
+               wavePtr = &basis.wave(basis.star(is+1).endId - 1);
+               UTIL_CHECK(!(wavePtr->implicit));
+            }
+            UTIL_CHECK(abs(wavePtr->coeff) > 1.0E-8);
+            charRanks_[is] = dftMesh.rank(wavePtr->indicesDft);
+            charCoeffs_[is] = wavePtr->coeff;
+
+         } else {
+            starTypes_[is] = Second;
+         }
+
+      }
+
+      // Every element of the DFT array is set by exactly one wave
+      UTIL_CHECK(j == dftSize_);
+   }
+
+   /*
+   * Compute complex prefactor of waves in star is.
+   */
+   template <int D>
+   inline
+   void BasisDftMap<D>::starComponent(double const * in, int is,
+                                      double& re, double& im) const
+   {
+      switch (starTypes_[is]) {
+         case Closed:
+            re = in[is];
+            im = 0.0;
+            break;
+         case First:
+            re = in[is]/sqrt(2.0);
+            im = -in[is+1]/sqrt(2.0);
+            break;
+         case Second:
+            // Complex conjugate of component of first star of pair
+            re = in[is-1]/sqrt(2.0);
+            im = in[is]/sqrt(2.0);
+            break;
+         default:
+            re = 0.0;
+            im = 0.0;
+      }
+   }
+
+   /*
+   * Compute basis function coefficients associated with star is.
+   */
+   template <int D>
+   inline
+   bool BasisDftMap<D>::starCoefficients(fftw_complex const * in, int is,
+                                         double* out) const
+   {
+      std::complex<double> component;
+      int rank;
+      switch (starTypes_[is]) {
+         case Closed:
+            rank = charRanks_[is];
+            component = std::complex<double>(in[rank][0], in[rank][1]);
+            component /= charCoeffs_[is];
+            out[is] = component.real();
+            return (std::abs(component.imag()) < 1.0E-8);
+         case First:
+            rank = charRanks_[is];
+            component = std::complex<double>(in[rank][0], in[rank][1]);
+            component /= charCoeffs_[is];
+            component *= sqrt(2.0);
+            out[is] = component.real();
+            out[is+1] = -component.imag();
+            return true;
+         case Second:
+            // Set with first star of pair
+            return true;
+         default:
+            out[is] = 0.0;
+            return true;
+      }
+   }
+
+   /*
+   * Convert a field from basis to DFT.
+   */
+   template <int D>
+   void BasisDftMap<D>::basisToDft(double const * in,
+                                   fftw_complex* out) const
+   {
+      UTIL_CHECK(isSetup());
+      if (!compRe_.isAllocated()) {
+         compRe_.allocate(nStar_);
+         compIm_.allocate(nStar_);
+      }
+      double* compRe = compRe_.cArray();
+      double* compIm = compIm_.cArray();
+      int const * starIds = starIds_.cArray();
+      double const * coeffRe = coeffRe_.cArray();
+      double const * coeffIm = coeffIm_.cArray();
+
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel
+      #endif
+      {
+         // Compute complex prefactor for each star
+         #ifdef PSPC_OPENMP
+         #pragma omp for schedule(static)
+         #endif
+         for (int is = 0; is < nStar_; ++is) {
+            starComponent(in, is, compRe[is], compIm[is]);
+         }
+
+         // Multiply prefactor of each star by coefficient of each wave
+         #ifdef PSPC_OPENMP
+         #pragma omp for schedule(static)
+         #endif
+         for (int j = 0; j < dftSize_; ++j) {
+            const int is = starIds[j];
+            out[j][0] = compRe[is]*coeffRe[j] - compIm[is]*coeffIm[j];
+            out[j][1] = compRe[is]*coeffIm[j] + compIm[is]*coeffRe[j];
+         }
+      }
+   }
+
+   /*
+   * Convert a field from DFT to basis.
+   */
+   template <int D>
+   void BasisDftMap<D>::dftToBasis(fftw_complex const * in,
+                                   double* out) const
+   {
+      UTIL_CHECK(isSetup());
+      bool isReal = true;
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel for schedule(static) reduction(&&:isReal)
+      #endif
+      for (int is = 0; is < nStar_; ++is) {
+         isReal = starCoefficients(in, is, out) && isReal;
+      }
+      UTIL_CHECK(isReal);
+   }
+
+   /*
+   * Convert an array of fields from basis to a contiguous DFT array.
+   */
+   template <int D>
+   void BasisDftMap<D>::basisToDft(DArray< DArray<double> > const & in,
+                                   fftw_complex* out, int kSize) const
+   {
+      UTIL_CHECK(isSetup());
+      UTIL_CHECK(kSize >= dftSize_);
+      const int nField = in.capacity();
+      for (int k = 0; k < nField; ++k) {
+         UTIL_CHECK(in[k].capacity() >= nStar_);
+      }
+      if (compRe_.isAllocated() && compRe_.capacity() < nField*nStar_) {
+         compRe_.deallocate();
+         compIm_.deallocate();
+      }
+      if (!compRe_.isAllocated()) {
+         compRe_.allocate(nField*nStar_);
+         compIm_.allocate(nField*nStar_);
+      }
+      double* compRe = compRe_.cArray();
+      double* compIm = compIm_.cArray();
+      int const * starIds = starIds_.cArray();
+      double const * coeffRe = coeffRe_.cArray();
+      double const * coeffIm = coeffIm_.cArray();
+
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel
+      #endif
+      {
+         // Compute complex prefactor for each star and field.
+         // Element k + is*nField is the prefactor for field k.
+         #ifdef PSPC_OPENMP
+         #pragma omp for schedule(static)
+         #endif
+         for (int is = 0; is < nStar_; ++is) {
+            for (int k = 0; k < nField; ++k) {
+               starComponent(in[k].cArray(), is,
+                             compRe[k + is*nField], compIm[k + is*nField]);
+            }
+         }
+
+         // Multiply prefactors by coefficient of each wave
+         #ifdef PSPC_OPENMP
+         #pragma omp for schedule(static)
+         #endif
+         for (int j = 0; j < dftSize_; ++j) {
+            const int offset = starIds[j]*nField;
+            const double cRe = coeffRe[j];
+            const double cIm = coeffIm[j];
+            double re, im;
+            for (int k = 0; k < nField; ++k) {
+               re = compRe[offset + k];
+               im = compIm[offset + k];
+               out[j + k*kSize][0] = re*cRe - im*cIm;
+               out[j + k*kSize][1] = re*cIm + im*cRe;
+            }
+         }
+      }
+   }
+
+   /*
+   * Convert an array of fields from a contiguous DFT array to basis.
+   */
+   template <int D>
+   void BasisDftMap<D>::dftToBasis(fftw_complex const * in, int kSize,
+                                   DArray< DArray<double> > & out) const
+   {
+      UTIL_CHECK(isSetup());
+      UTIL_CHECK(kSize >= dftSize_);
+      const int nField = out.capacity();
+      for (int k = 0; k < nField; ++k) {
+         UTIL_CHECK(out[k].capacity() >= nStar_);
+      }
+
+      bool isReal = true;
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel for schedule(static) reduction(&&:isReal)
+      #endif
+      for (int is = 0; is < nStar_; ++is) {
+         for (int k = 0; k < nField; ++k) {
+            isReal = starCoefficients(in + k*kSize, is, out[k].cArray())
+                     && isReal;
+         }
+      }
+      UTIL_CHECK(isReal);
+   }
+
+}
+}
+#endif
@@ -6,6 +6,7 @@
 */
 
 #include "FFT.tpp"
+#include "FFTPlanner.h"
 
 namespace Pscf {
 namespace Pspc {
@@ -24,7 +25,7 @@ namespace Pspc {
    template<>
    void FFT<1>::makePlans(RField<1>& rField, RFieldDft<1>& kField)
    {
-      unsigned int flags = FFTW_ESTIMATE;
+      unsigned int flags = FFTPlanner::flags();
       fPlan_ = fftw_plan_dft_r2c_1d(rSize_, &rField[0], &kField[0], flags);
       iPlan_ = fftw_plan_dft_c2r_1d(rSize_, &kField[0], &rField[0], flags);
    }
@@ -32,7 +33,7 @@ namespace Pspc {
    template <>
    void FFT<2>::makePlans(RField<2>& rField, RFieldDft<2>& kField)
    {
-      unsigned int flags = FFTW_ESTIMATE;
+      unsigned int flags = FFTPlanner::flags();
       fPlan_ = fftw_plan_dft_r2c_2d(meshDimensions_[0], meshDimensions_[1],
       	                           &rField[0], &kField[0], flags);
       iPlan_ = fftw_plan_dft_c2r_2d(meshDimensions_[0], meshDimensions_[1],
@@ -42,7 +43,7 @@ namespace Pspc {
    template <>
    void FFT<3>::makePlans(RField<3>& rField, RFieldDft<3>& kField)
    {
-      unsigned int flags = FFTW_ESTIMATE;
+      unsigned int flags = FFTPlanner::flags();
       fPlan_ = fftw_plan_dft_r2c_3d(meshDimensions_[0], meshDimensions_[1],
       	                           meshDimensions_[2], &rField[0], &kField[0],
       	                           flags);
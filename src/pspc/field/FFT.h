@@ -45,6 +45,10 @@ namespace Pspc {
       /**
       * Setup grid dimensions, plans and work space.
       *
+      * Plans are created with the planning rigor given by 
+      * FFTPlanner::rigor(). The contents of rField and kField are used
+      * only to obtain dimensions, and are not modified.
+      *
       * \param rField real data on r-space grid
       * \param kField complex data on k-space grid
       */
@@ -58,6 +62,40 @@ namespace Pspc {
       */
       void forwardTransform(RField<D>& in, RFieldDft<D>& out);
 
+      /**
+      * Compute unnormalized forward Fourier transform, without a copy.
+      *
+      * Unlike forwardTransform(in, out), the output is not multiplied 
+      * by 1/rSize, and FFTW reads the input array directly rather than
+      * a rescaled copy. The caller is responsible for normalization, 
+      * e.g., by folding a factor 1/rSize into a k-space multiplier. 
+      * The input is not modified, because out-of-place real-to-complex
+      * FFTW plans preserve their input. Requires that setup() has 
+      * already been called.
+      *
+      * \param in  array of real values on r-space grid
+      * \param out  array of complex values on k-space grid
+      */
+      void forwardTransformUnscaled(RField<D> const & in, 
+                                    RFieldDft<D>& out);
+
+      /**
+      * Compute unnormalized forward transform of a pointwise product.
+      *
+      * Computes the transform of the product in[i]*factor[i] of two 
+      * real fields, without normalization. The multiplication is done
+      * in the copy into the internal work array, so the product is 
+      * never stored in a separate array. Neither input field is 
+      * modified. Requires that setup() has already been called.
+      *
+      * \param in  array of real values on r-space grid
+      * \param factor  array of real multipliers on r-space grid
+      * \param out  array of complex values on k-space grid
+      */
+      void forwardTransformUnscaled(RField<D> const & in, 
+                                    RField<D> const & factor,
+                                    RFieldDft<D>& out);
+
       /**
       * Compute inverse (complex-to-real) Fourier transform.
       *
@@ -71,6 +109,11 @@ namespace Pspc {
       */
       const IntVec<D>& meshDimensions() const;
 
+      /**
+      * Has this FFT object been setup?
+      */
+      bool isSetup() const;
+
    private:
 
       // Work array for real data.
@@ -119,6 +162,13 @@ namespace Pspc {
    inline const IntVec<D>& FFT<D>::meshDimensions() const
    {  return meshDimensions_; }
 
+   /*
+   * Has this object been setup?
+   */
+   template <int D>
+   inline bool FFT<D>::isSetup() const
+   {  return isSetup_; }
+
    #ifndef PSPC_FFT_TPP
    // Suppress implicit instantiation
    extern template class FFT<1>;
@@ -82,8 +82,13 @@ namespace Pspc
       }
       UTIL_CHECK(work_.capacity() == rSize_);
 
-      // Make FFTW plans (explicit specializations)
-      makePlans(rField, kField);
+      // Make FFTW plans (explicit specializations). Plans are made with 
+      // the work array and a temporary k-space array, rather than with
+      // rField and kField, because planning with any rigor other than
+      // FFTW_ESTIMATE overwrites the arrays used to create the plans.
+      RFieldDft<D> kWork;
+      kWork.allocate(rDimensions);
+      makePlans(work_, kWork);
 
       isSetup_ = true;
    }
@@ -113,6 +118,47 @@ namespace Pspc
       fftw_execute_dft_r2c(fPlan_, &work_[0], &kField[0]);
    }
 
+   /*
+   * Execute unnormalized forward transform directly from input array.
+   */
+   template <int D>
+   void FFT<D>::forwardTransformUnscaled(RField<D> const & in, 
+                                         RFieldDft<D>& out)
+   {
+      UTIL_CHECK(isSetup_);
+      UTIL_CHECK(in.capacity() == rSize_);
+      UTIL_CHECK(out.capacity() == kSize_);
+
+      // Out-of-place r2c plans preserve input, so const_cast is safe
+      double* inPtr = const_cast<double*>(in.cField());
+      fftw_execute_dft_r2c(fPlan_, inPtr, out.cField());
+   }
+
+   /*
+   * Execute unnormalized forward transform of a product of real fields.
+   */
+   template <int D>
+   void FFT<D>::forwardTransformUnscaled(RField<D> const & in, 
+                                         RField<D> const & factor,
+                                         RFieldDft<D>& out)
+   {
+      UTIL_CHECK(isSetup_);
+      UTIL_CHECK(work_.capacity() == rSize_);
+      UTIL_CHECK(in.capacity() == rSize_);
+      UTIL_CHECK(factor.capacity() == rSize_);
+      UTIL_CHECK(out.capacity() == kSize_);
+
+      // Copy product into work array (single pass)
+      double* workPtr = work_.cField();
+      double const * inPtr = in.cField();
+      double const * factorPtr = factor.cField();
+      for (int i = 0; i < rSize_; ++i) {
+         workPtr[i] = inPtr[i]*factorPtr[i];
+      }
+
+      fftw_execute_dft_r2c(fPlan_, workPtr, out.cField());
+   }
+
    /*
    * Execute inverse (complex-to-real) transform.
    */
@@ -121,10 +167,8 @@ namespace Pspc
    {
       if (!isSetup_) {
          setup(rField, kField);
-         fftw_execute(iPlan_);
-      } else {
-         fftw_execute_dft_c2r(iPlan_, &kField[0], &rField[0]);
       }
+      fftw_execute_dft_c2r(iPlan_, &kField[0], &rField[0]);
    }
 
 }
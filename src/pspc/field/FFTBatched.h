@@ -0,0 +1,224 @@
+#ifndef PSPC_FFT_BATCHED_H
+#define PSPC_FFT_BATCHED_H
+
+/*
+* PSCF++ Package
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <pspc/field/Field.h>
+#include <pspc/field/RField.h>
+#include <pscf/math/IntVec.h>
+#include <util/containers/DArray.h>
+#include <util/global.h>
+
+#include <fftw3.h>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+   using namespace Pscf;
+
+   /**
+   * Batched Fourier transform wrapper for real data.
+   *
+   * An FFTBatched<D> object computes a batch of batchSize() real-to-
+   * complex or complex-to-real transforms of fields with equal mesh
+   * dimensions in a single call to the FFTW library, using plans
+   * created by fftw_plan_many_dft_r2c and fftw_plan_many_dft_c2r.
+   *
+   * Data for a batch is stored contiguously: Element j of field i of
+   * a batch of real fields is element i*rSize() + j of a Field<double>
+   * with capacity batchSize()*rSize(), and similarly for complex fields,
+   * with kSize() in place of rSize(). Normalization conventions are the
+   * same as those of FFT<D>: The forward transform is multiplied by
+   * 1/rSize(), and the inverse transform is unnormalized.
+   *
+   * \ingroup Pspc_Field_Module
+   */
+   template <int D>
+   class FFTBatched
+   {
+
+   public:
+
+      /**
+      * Default constructor.
+      */
+      FFTBatched();
+
+      /**
+      * Destructor.
+      */
+      virtual ~FFTBatched();
+
+      /**
+      * Setup grid dimensions, batch size, plans and work space.
+      *
+      * This function may be called more than once, to change the mesh
+      * dimensions or batch size. Any previous plans are destroyed.
+      *
+      * \param meshDimensions  dimensions of r-space grid
+      * \param batchSize  number of fields in each batch
+      */
+      void setup(IntVec<D> const & meshDimensions, int batchSize);
+
+      /**
+      * Compute a batch of forward (real-to-complex) transforms.
+      *
+      * The input is copied into an internal work array, and is not
+      * modified.
+      *
+      * \param in  contiguous batch of real fields (batchSize*rSize)
+      * \param out  contiguous batch of complex fields (batchSize*kSize)
+      */
+      void forwardTransform(Field<double> const & in,
+                            Field<fftw_complex>& out);
+
+      /**
+      * Compute an unnormalized batch of forward transforms, without a copy.
+      *
+      * Unlike forwardTransform(in, out), the output is not multiplied 
+      * by 1/rSize(), and FFTW reads the input array directly. The input
+      * is not modified, because out-of-place real-to-complex plans 
+      * preserve their input.
+      *
+      * \param in  contiguous batch of real fields (batchSize*rSize)
+      * \param out  contiguous batch of complex fields (batchSize*kSize)
+      */
+      void forwardTransformUnscaled(Field<double> const & in,
+                                    Field<fftw_complex>& out);
+
+      /**
+      * Compute forward transforms of an array of separate real fields.
+      *
+      * The fields in[i] are gathered into the internal work array in
+      * the same pass used to rescale the data, and are not modified.
+      *
+      * \param in  array of batchSize() real fields on r-space grid
+      * \param out  contiguous batch of complex fields (batchSize*kSize)
+      */
+      void forwardTransform(DArray< RField<D> > const & in,
+                            Field<fftw_complex>& out);
+
+      /**
+      * Compute a batch of inverse (complex-to-real) transforms.
+      *
+      * The input array is overwritten (destroyed) by FFTW.
+      *
+      * \param in  contiguous batch of complex fields (batchSize*kSize)
+      * \param out  contiguous batch of real fields (batchSize*rSize)
+      */
+      void inverseTransform(Field<fftw_complex>& in, Field<double>& out);
+
+      /**
+      * Compute inverse transforms into an array of separate real fields.
+      *
+      * The transforms are computed in the internal work array, and then
+      * scattered into out[i]. The input array is overwritten by FFTW.
+      *
+      * \param in  contiguous batch of complex fields (batchSize*kSize)
+      * \param out  array of batchSize() real fields on r-space grid
+      */
+      void inverseTransform(Field<fftw_complex>& in,
+                            DArray< RField<D> >& out);
+
+      /**
+      * Return the dimensions of the grid for which this was allocated.
+      */
+      const IntVec<D>& meshDimensions() const;
+
+      /**
+      * Number of fields per batch.
+      */
+      int batchSize() const;
+
+      /**
+      * Number of points in each r-space grid.
+      */
+      int rSize() const;
+
+      /**
+      * Number of points in each k-space (DFT) grid.
+      */
+      int kSize() const;
+
+      /**
+      * Has this object been setup?
+      */
+      bool isSetup() const;
+
+   private:
+
+      // Work array for a batch of real fields.
+      Field<double> work_;
+
+      // Vector containing number of grid points in each direction.
+      IntVec<D> meshDimensions_;
+
+      // Number of points in each r-space grid
+      int rSize_;
+
+      // Number of points in each k-space grid
+      int kSize_;
+
+      // Number of fields per batch
+      int batchSize_;
+
+      // Pointer to a plan for a batch of forward transforms.
+      fftw_plan fPlan_;
+
+      // Pointer to a plan for a batch of inverse transforms.
+      fftw_plan iPlan_;
+
+      // Have array dimension and plans been initialized?
+      bool isSetup_;
+
+      /**
+      * Make FFTW plans for transform and inverse transform.
+      */
+      void makePlans();
+
+      /**
+      * Destroy any existing FFTW plans.
+      */
+      void destroyPlans();
+
+   };
+
+   // Inline member functions
+
+   template <int D>
+   inline const IntVec<D>& FFTBatched<D>::meshDimensions() const
+   {  return meshDimensions_; }
+
+   template <int D>
+   inline int FFTBatched<D>::batchSize() const
+   {  return batchSize_; }
+
+   template <int D>
+   inline int FFTBatched<D>::rSize() const
+   {  return rSize_; }
+
+   template <int D>
+   inline int FFTBatched<D>::kSize() const
+   {  return kSize_; }
+
+   template <int D>
+   inline bool FFTBatched<D>::isSetup() const
+   {  return isSetup_; }
+
+   #ifndef PSPC_FFT_BATCHED_TPP
+   // Suppress implicit instantiation
+   extern template class FFTBatched<1>;
+   extern template class FFTBatched<2>;
+   extern template class FFTBatched<3>;
+   #endif
+
+} // namespace Pscf::Pspc
+} // namespace Pscf
+#endif
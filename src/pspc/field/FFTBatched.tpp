@@ -0,0 +1,239 @@
+#ifndef PSPC_FFT_BATCHED_TPP
+#define PSPC_FFT_BATCHED_TPP
+
+/*
+* PSCF++ Package
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "FFTBatched.h"
+#include "FFTPlanner.h"
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /*
+   * Default constructor.
+   */
+   template <int D>
+   FFTBatched<D>::FFTBatched()
+    : work_(),
+      meshDimensions_(0),
+      rSize_(0),
+      kSize_(0),
+      batchSize_(0),
+      fPlan_(0),
+      iPlan_(0),
+      isSetup_(false)
+   {}
+
+   /*
+   * Destructor.
+   */
+   template <int D>
+   FFTBatched<D>::~FFTBatched()
+   {  destroyPlans(); }
+
+   /*
+   * Setup mesh dimensions, batch size, work array and plans.
+   */
+   template <int D>
+   void FFTBatched<D>::setup(IntVec<D> const & meshDimensions,
+                             int batchSize)
+   {
+      UTIL_CHECK(batchSize > 0);
+
+      // Set and check mesh dimensions
+      rSize_ = 1;
+      kSize_ = 1;
+      for (int i = 0; i < D; ++i) {
+         UTIL_CHECK(meshDimensions[i] > 0);
+         meshDimensions_[i] = meshDimensions[i];
+         rSize_ *= meshDimensions[i];
+         if (i < D - 1) {
+            kSize_ *= meshDimensions[i];
+         } else {
+            kSize_ *= (meshDimensions[i]/2 + 1);
+         }
+      }
+      batchSize_ = batchSize;
+
+      // Allocate or reallocate work array
+      if (work_.isAllocated()) {
+         if (work_.capacity() != batchSize_*rSize_) {
+            work_.deallocate();
+         }
+      }
+      if (!work_.isAllocated()) {
+         work_.allocate(batchSize_*rSize_);
+      }
+
+      destroyPlans();
+      makePlans();
+
+      isSetup_ = true;
+   }
+
+   /*
+   * Execute a batch of forward transforms of contiguous data.
+   */
+   template <int D>
+   void FFTBatched<D>::forwardTransform(Field<double> const & in,
+                                        Field<fftw_complex>& out)
+   {
+      UTIL_CHECK(isSetup_);
+      int rCapacity = batchSize_*rSize_;
+      UTIL_CHECK(in.capacity() == rCapacity);
+      UTIL_CHECK(out.capacity() == batchSize_*kSize_);
+
+      // Copy rescaled input data into work array
+      double scale = 1.0/double(rSize_);
+      double* workPtr = work_.cField();
+      double const * inPtr = in.cField();
+      for (int i = 0; i < rCapacity; ++i) {
+         workPtr[i] = inPtr[i]*scale;
+      }
+
+      fftw_execute_dft_r2c(fPlan_, workPtr, out.cField());
+   }
+
+   /*
+   * Execute unnormalized batch of forward transforms, without a copy.
+   */
+   template <int D>
+   void FFTBatched<D>::forwardTransformUnscaled(Field<double> const & in,
+                                                Field<fftw_complex>& out)
+   {
+      UTIL_CHECK(isSetup_);
+      UTIL_CHECK(in.capacity() == batchSize_*rSize_);
+      UTIL_CHECK(out.capacity() == batchSize_*kSize_);
+
+      // Out-of-place r2c plans preserve input, so const_cast is safe
+      double* inPtr = const_cast<double*>(in.cField());
+      fftw_execute_dft_r2c(fPlan_, inPtr, out.cField());
+   }
+
+   /*
+   * Execute forward transforms of an array of separate fields.
+   */
+   template <int D>
+   void FFTBatched<D>::forwardTransform(DArray< RField<D> > const & in,
+                                        Field<fftw_complex>& out)
+   {
+      UTIL_CHECK(isSetup_);
+      UTIL_CHECK(in.capacity() == batchSize_);
+      UTIL_CHECK(out.capacity() == batchSize_*kSize_);
+
+      // Gather rescaled input data into work array
+      double scale = 1.0/double(rSize_);
+      double* workPtr;
+      double const * inPtr;
+      int i, j;
+      for (i = 0; i < batchSize_; ++i) {
+         UTIL_CHECK(in[i].capacity() == rSize_);
+         workPtr = work_.cField() + i*rSize_;
+         inPtr = in[i].cField();
+         for (j = 0; j < rSize_; ++j) {
+            workPtr[j] = inPtr[j]*scale;
+         }
+      }
+
+      fftw_execute_dft_r2c(fPlan_, work_.cField(), out.cField());
+   }
+
+   /*
+   * Execute a batch of inverse transforms of contiguous data.
+   */
+   template <int D>
+   void FFTBatched<D>::inverseTransform(Field<fftw_complex>& in,
+                                        Field<double>& out)
+   {
+      UTIL_CHECK(isSetup_);
+      UTIL_CHECK(in.capacity() == batchSize_*kSize_);
+      UTIL_CHECK(out.capacity() == batchSize_*rSize_);
+
+      fftw_execute_dft_c2r(iPlan_, in.cField(), out.cField());
+   }
+
+   /*
+   * Execute inverse transforms into an array of separate fields.
+   */
+   template <int D>
+   void FFTBatched<D>::inverseTransform(Field<fftw_complex>& in,
+                                        DArray< RField<D> >& out)
+   {
+      UTIL_CHECK(isSetup_);
+      UTIL_CHECK(in.capacity() == batchSize_*kSize_);
+      UTIL_CHECK(out.capacity() == batchSize_);
+
+      fftw_execute_dft_c2r(iPlan_, in.cField(), work_.cField());
+
+      // Scatter results into output fields
+      double* outPtr;
+      double const * workPtr;
+      int i, j;
+      for (i = 0; i < batchSize_; ++i) {
+         UTIL_CHECK(out[i].capacity() == rSize_);
+         outPtr = out[i].cField();
+         workPtr = work_.cField() + i*rSize_;
+         for (j = 0; j < rSize_; ++j) {
+            outPtr[j] = workPtr[j];
+         }
+      }
+   }
+
+   /*
+   * Make FFTW plans for a batch of transforms.
+   */
+   template <int D>
+   void FFTBatched<D>::makePlans()
+   {
+      int n[D];
+      for (int i = 0; i < D; ++i) {
+         n[i] = meshDimensions_[i];
+      }
+
+      // Temporary complex array, used only to create plans. Planning may
+      // overwrite work_ and kWork, and fftw_malloc guarantees alignment
+      // equal to that of arrays passed to the new-array execute functions.
+      Field<fftw_complex> kWork;
+      kWork.allocate(batchSize_*kSize_);
+
+      unsigned int flags = FFTPlanner::flags();
+      fPlan_ = fftw_plan_many_dft_r2c(D, n, batchSize_,
+                                      work_.cField(), NULL, 1, rSize_,
+                                      kWork.cField(), NULL, 1, kSize_,
+                                      flags);
+      iPlan_ = fftw_plan_many_dft_c2r(D, n, batchSize_,
+                                      kWork.cField(), NULL, 1, kSize_,
+                                      work_.cField(), NULL, 1, rSize_,
+                                      flags);
+      UTIL_CHECK(fPlan_);
+      UTIL_CHECK(iPlan_);
+   }
+
+   /*
+   * Destroy existing FFTW plans, if any.
+   */
+   template <int D>
+   void FFTBatched<D>::destroyPlans()
+   {
+      if (fPlan_) {
+         fftw_destroy_plan(fPlan_);
+         fPlan_ = 0;
+      }
+      if (iPlan_) {
+         fftw_destroy_plan(iPlan_);
+         iPlan_ = 0;
+      }
+      isSetup_ = false;
+   }
+
+}
+}
+#endif
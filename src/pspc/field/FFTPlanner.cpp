@@ -0,0 +1,98 @@
+/*
+* PSCF++ Package 
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "FFTPlanner.h"
+
+#include <fftw3.h>
+
+namespace Pscf {
+namespace Pspc {
+
+   using namespace Util;
+
+   // Static member variable definition
+   FFTPlanner::Rigor FFTPlanner::rigor_ = FFTPlanner::Estimate;
+
+   /*
+   * Get FFTW planner flags for the current rigor.
+   */
+   unsigned int FFTPlanner::flags()
+   {
+      switch (rigor_) {
+         case Estimate:
+            return FFTW_ESTIMATE;
+         case Measure:
+            return FFTW_MEASURE;
+         case Patient:
+            return FFTW_PATIENT;
+         case Exhaustive:
+            return FFTW_EXHAUSTIVE;
+      }
+      UTIL_THROW("Invalid FFTPlanner::Rigor value");
+      return FFTW_ESTIMATE;
+   }
+
+   /*
+   * Load FFTW wisdom from a file, if it exists.
+   */
+   bool FFTPlanner::importWisdom(std::string const & filename)
+   {  return (fftw_import_wisdom_from_filename(filename.c_str()) != 0); }
+
+   /*
+   * Save all FFTW wisdom to a file.
+   */
+   bool FFTPlanner::exportWisdom(std::string const & filename)
+   {  return (fftw_export_wisdom_to_filename(filename.c_str()) != 0); }
+
+   /* 
+   * Extract a FFTPlanner::Rigor from an istream as a string.
+   */
+   std::istream& operator >> (std::istream& in, FFTPlanner::Rigor& rigor)
+   {
+      std::string buffer;
+      in >> buffer;
+      if (buffer == "Estimate" || buffer == "estimate") {
+         rigor = FFTPlanner::Estimate;
+      } else 
+      if (buffer == "Measure" || buffer == "measure") {
+         rigor = FFTPlanner::Measure;
+      } else 
+      if (buffer == "Patient" || buffer == "patient") {
+         rigor = FFTPlanner::Patient;
+      } else 
+      if (buffer == "Exhaustive" || buffer == "exhaustive") {
+         rigor = FFTPlanner::Exhaustive;
+      } else {
+         UTIL_THROW("Invalid FFTPlanner::Rigor string in operator >>");
+      } 
+      return in;
+   }
+   
+   /* 
+   * Insert a FFTPlanner::Rigor to an ostream as a string.
+   */
+   std::ostream& operator << (std::ostream& out, FFTPlanner::Rigor rigor) 
+   {
+      if (rigor == FFTPlanner::Estimate) {
+         out << "estimate";
+      } else 
+      if (rigor == FFTPlanner::Measure) {
+         out << "measure";
+      } else 
+      if (rigor == FFTPlanner::Patient) {
+         out << "patient";
+      } else 
+      if (rigor == FFTPlanner::Exhaustive) {
+         out << "exhaustive";
+      } else {
+         UTIL_THROW("Unrecognized value for FFTPlanner::Rigor");
+      } 
+      return out; 
+   }
+
+}
+}
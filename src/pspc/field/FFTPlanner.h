@@ -0,0 +1,126 @@
+#ifndef PSPC_FFT_PLANNER_H
+#define PSPC_FFT_PLANNER_H
+
+/*
+* PSCF++ Package 
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <util/global.h>
+
+#include <iostream>
+#include <string>
+
+namespace Pscf {
+namespace Pspc {
+
+   using namespace Util;
+
+   /**
+   * Global FFTW planning rigor and wisdom file access.
+   *
+   * This class has only static members. The planning rigor applies to 
+   * all FFTW plans subsequently created by FFT<D> and FFTBatched<D> 
+   * objects. Plans created with any rigor other than Estimate are found
+   * by timing trial transforms, which is slower but usually yields 
+   * faster plans. The results of this search ("wisdom") can be saved 
+   * to a file and reloaded by a later run, to avoid repeating it.
+   *
+   * \ingroup Pspc_Field_Module
+   */
+   class FFTPlanner
+   {
+
+   public:
+
+      /**
+      * FFTW planning rigor (FFTW_ESTIMATE, ..., FFTW_EXHAUSTIVE).
+      */
+      enum Rigor {Estimate, Measure, Patient, Exhaustive};
+
+      /**
+      * Set planning rigor for all subsequently created plans.
+      *
+      * \param rigor  planning rigor
+      */
+      static void setRigor(Rigor rigor);
+
+      /**
+      * Get current planning rigor.
+      */
+      static Rigor rigor();
+
+      /**
+      * Get FFTW planner flags for the current planning rigor.
+      */
+      static unsigned int flags();
+
+      /**
+      * Load accumulated FFTW wisdom from a file, if it exists.
+      *
+      * \param filename  name of wisdom file
+      * \return true if the file was found and read, false otherwise
+      */
+      static bool importWisdom(std::string const & filename);
+
+      /**
+      * Save all accumulated FFTW wisdom to a file.
+      *
+      * \param filename  name of wisdom file
+      * \return true if the file was successfully written
+      */
+      static bool exportWisdom(std::string const & filename);
+
+   private:
+
+      // Planning rigor for all plans (default Estimate).
+      static Rigor rigor_;
+
+   };
+
+   /**
+   * istream extractor for a FFTPlanner::Rigor.
+   *
+   * Accepted strings are estimate, measure, patient and exhaustive, 
+   * either in lower case or capitalized.
+   *
+   * \param  in  input stream
+   * \param  rigor  FFTPlanner::Rigor to be read
+   * \return modified input stream
+   */
+   std::istream& operator >> (std::istream& in, FFTPlanner::Rigor& rigor);
+
+   /**
+   * ostream inserter for a FFTPlanner::Rigor.
+   *
+   * \param  out  output stream
+   * \param  rigor  FFTPlanner::Rigor to be written
+   * \return modified output stream
+   */
+   std::ostream& operator << (std::ostream& out, FFTPlanner::Rigor rigor);
+
+   /**
+   * Serialize a FFTPlanner::Rigor.
+   *
+   * \param ar  archive object
+   * \param rigor  object to be serialized
+   * \param version  archive version id
+   */
+   template <class Archive>
+   void serialize(Archive& ar, FFTPlanner::Rigor& rigor, 
+                  const unsigned int version)
+   {  serializeEnum(ar, rigor, version); }
+
+   // Inline static member functions
+
+   inline void FFTPlanner::setRigor(FFTPlanner::Rigor rigor)
+   {  rigor_ = rigor; }
+
+   inline FFTPlanner::Rigor FFTPlanner::rigor()
+   {  return rigor_; }
+
+}
+}
+#endif
@@ -8,6 +8,7 @@
 * Distributed under the terms of the GNU General Public License.
 */
 
+#include "FieldArena.h"
 #include <util/global.h>
 
 namespace Pscf {
@@ -19,6 +20,12 @@ namespace Pspc
    /**
    * Dynamic array with aligned data, for use with FFTW library.
    *
+   * A Field normally owns its data, which is allocated by allocate()
+   * and freed by deallocate() or the destructor. Alternatively, a Field
+   * may be associated with a C array that it does not own, by calling
+   * associate(). Such a Field (a view) provides the same interface for
+   * element access, but never frees the associated memory.
+   *
    * \ingroup Pspc_Field_Module
    */
    template <typename Data>
@@ -35,7 +42,7 @@ namespace Pspc
       /**
       * Destructor.
       *
-      * Deletes underlying C array, if allocated previously.
+      * Deletes underlying C array, if allocated previously and owned.
       */
       virtual ~Field();
 
@@ -48,9 +55,39 @@ namespace Pspc
       */
       void allocate(int capacity);
 
+      /**
+      * Allocate the underlying C array from a FieldArena.
+      *
+      * If arena is null, this is equivalent to allocate(capacity).
+      * Otherwise, the memory is owned by the arena, and is initialized
+      * to zero.
+      *
+      * \throw Exception if the Field is already allocated.
+      *
+      * \param capacity number of elements to allocate.
+      * \param arena  arena from which to allocate (may be null)
+      */
+      void allocate(int capacity, FieldArena* arena);
+
+      /**
+      * Associate this Field with a C array that it does not own.
+      *
+      * The caller must guarantee that the array contains at least
+      * capacity elements and outlives its use through this Field.
+      *
+      * \throw Exception if the Field is already allocated.
+      *
+      * \param ptr  pointer to first element of the C array
+      * \param capacity  number of elements in the view
+      */
+      void associate(Data* ptr, int capacity);
+
       /**
       * Dellocate the underlying C array.
       *
+      * If the Field is a view created by associate(), this method only
+      * dissociates it, without freeing memory.
+      *
       * \throw Exception if the Field is not allocated.
       */
       void deallocate();
@@ -60,6 +97,11 @@ namespace Pspc
       */
       bool isAllocated() const;
 
+      /**
+      * Return true if the Field owns its data, false if it is a view.
+      */
+      bool isOwner() const;
+
       /**
       * Return allocated size.
       *
@@ -114,6 +156,9 @@ namespace Pspc
       /// Allocated size of the data_ array.
       int capacity_;
 
+      /// Does this Field own data_ (false for a view)?
+      bool isOwner_;
+
    private:
 
       /**
@@ -181,6 +226,13 @@ namespace Pspc
    inline bool Field<Data>::isAllocated() const
    {  return (bool)data_; }
 
+   /*
+   * Return true if the Field owns its data.
+   */
+   template <typename Data>
+   inline bool Field<Data>::isOwner() const
+   {  return isOwner_; }
+
    /*
    * Serialize a Field to/from an Archive.
    */
@@ -25,7 +25,8 @@ namespace Pspc
    template <typename Data>
    Field<Data>::Field()
     : data_(0),
-      capacity_(0)
+      capacity_(0),
+      isOwner_(true)
    {}
 
    /*
@@ -34,7 +35,7 @@ namespace Pspc
    template <typename Data>
    Field<Data>::~Field()
    {
-      if (isAllocated()) {
+      if (isAllocated() && isOwner_) {
          fftw_free(data_);
          capacity_ = 0;
       }
@@ -117,6 +118,46 @@ namespace Pspc
       }
       data_ = (Data*) fftw_malloc(sizeof(Data)*capacity);
       capacity_ = capacity;
+      isOwner_ = true;
+   }
+
+   /*
+   * Allocate the underlying C array from an arena, if any.
+   */
+   template <typename Data>
+   void Field<Data>::allocate(int capacity, FieldArena* arena)
+   {
+      if (!arena) {
+         allocate(capacity);
+         return;
+      }
+      if (isAllocated()) {
+         UTIL_THROW("Attempt to re-allocate a Field");
+      }
+      if (capacity <= 0) {
+         UTIL_THROW("Attempt to allocate with capacity <= 0");
+      }
+      data_ = arena->allocate<Data>(capacity);
+      capacity_ = capacity;
+      isOwner_ = false;
+   }
+
+   /*
+   * Associate with a C array owned by another object.
+   *
+   * Throw an Exception if the Field has already allocated.
+   */
+   template <typename Data>
+   void Field<Data>::associate(Data* ptr, int capacity)
+   {
+      if (isAllocated()) {
+         UTIL_THROW("Attempt to associate an allocated Field");
+      }
+      UTIL_CHECK(ptr);
+      UTIL_CHECK(capacity > 0);
+      data_ = ptr;
+      capacity_ = capacity;
+      isOwner_ = false;
    }
 
    /*
@@ -130,8 +171,12 @@ namespace Pspc
       if (!isAllocated()) {
          UTIL_THROW("Array is not allocated");
       }
-      fftw_free(data_);
+      if (isOwner_) {
+         fftw_free(data_);
+      }
+      data_ = 0;
       capacity_ = 0;
+      isOwner_ = true;
    }
 
 }
@@ -0,0 +1,146 @@
+/*
+* PSCF++ Package
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "FieldArena.h"
+#include <pscf/math/fieldKernels.h>
+#include <util/format/Dbl.h>
+#include <util/format/Int.h>
+#include <util/format/Str.h>
+
+#include <cstdlib>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   const size_t FieldArena::Alignment;
+   const size_t FieldArena::HugePageSize;
+   const size_t FieldArena::DefaultRegionSize;
+
+   /*
+   * Constructor.
+   */
+   FieldArena::FieldArena(std::string name)
+    : regions_(),
+      name_(name),
+      regionSize_(DefaultRegionSize),
+      size_(0),
+      capacity_(0),
+      nArray_(0),
+      hugePages_(false)
+   {}
+
+   /*
+   * Destructor.
+   */
+   FieldArena::~FieldArena()
+   {  clear(); }
+
+   /*
+   * Set name used in memory reports.
+   */
+   void FieldArena::setName(std::string name)
+   {  name_ = name; }
+
+   /*
+   * Enable or disable huge pages for subsequent regions.
+   */
+   void FieldArena::setHugePages(bool hugePages)
+   {  hugePages_ = hugePages; }
+
+   /*
+   * Set minimum size of subsequent regions.
+   */
+   void FieldArena::setRegionSize(size_t regionSize)
+   {
+      UTIL_CHECK(regionSize > 0);
+      regionSize_ = regionSize;
+   }
+
+   /*
+   * Allocate an aligned, zero-initialized block from the last region,
+   * or from a new region if the last one has insufficient space.
+   */
+   void* FieldArena::allocateBytes(size_t bytes)
+   {
+      UTIL_CHECK(bytes > 0);
+      bytes = ((bytes + Alignment - 1)/Alignment)*Alignment;
+
+      int n = regions_.size();
+      if (n == 0 || regions_[n-1].capacity - regions_[n-1].size < bytes) {
+
+         // Allocate a new region
+         size_t align = hugePages_ ? HugePageSize : Alignment;
+         size_t capacity = (bytes > regionSize_) ? bytes : regionSize_;
+         capacity = ((capacity + align - 1)/align)*align;
+         void* ptr = 0;
+         if (posix_memalign(&ptr, align, capacity) != 0 || !ptr) {
+            UTIL_THROW("Failed to allocate FieldArena region");
+         }
+         #if defined(__linux__) && defined(MADV_HUGEPAGE)
+         if (hugePages_) {
+            madvise(ptr, capacity, MADV_HUGEPAGE);
+         }
+         #endif
+
+         Region region;
+         region.begin = (char*) ptr;
+         region.capacity = capacity;
+         region.size = 0;
+         regions_.append(region);
+         capacity_ += capacity;
+         ++n;
+      }
+
+      Region& region = regions_[n-1];
+      char* ptr = region.begin + region.size;
+      region.size += bytes;
+      size_ += bytes;
+      ++nArray_;
+
+      // First touch, with the thread layout of the field kernels
+      setField(0.0, (double*) ptr, int(bytes/sizeof(double)));
+
+      return (void*) ptr;
+   }
+
+   /*
+   * Free all regions.
+   */
+   void FieldArena::clear()
+   {
+      for (int i = 0; i < regions_.size(); ++i) {
+         free(regions_[i].begin);
+      }
+      regions_.clear();
+      size_ = 0;
+      capacity_ = 0;
+      nArray_ = 0;
+   }
+
+   /*
+   * Write a one line summary of memory usage (sizes in MB).
+   */
+   void FieldArena::writeReport(std::ostream& out) const
+   {
+      double mb = 1.0/(1024.0*1024.0);
+      out << "  " << Str(name_, 16)
+          << Int(nArray_, 8)
+          << Dbl(double(size_)*mb, 12, 3)
+          << Dbl(double(capacity_)*mb, 12, 3)
+          << Int(regions_.size(), 8)
+          << (hugePages_ ? "  huge pages" : "")
+          << std::endl;
+   }
+
+}
+}
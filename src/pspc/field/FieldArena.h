@@ -0,0 +1,243 @@
+#ifndef PSPC_FIELD_ARENA_H
+#define PSPC_FIELD_ARENA_H
+
+/*
+* PSCF++ Package
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <util/containers/GArray.h>      // member template
+#include <util/global.h>
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /**
+   * Region allocator for fields.
+   *
+   * A FieldArena hands out memory for fields from a small number of
+   * large regions, rather than making one heap allocation per field.
+   * Each request is rounded up to a multiple of Alignment bytes, and
+   * every array begins on an Alignment boundary, which is at least as
+   * strict as the alignment of arrays allocated by fftw_malloc.
+   * Memory is never returned to the arena for reuse. All regions are
+   * freed together by clear() or by the destructor, after which any
+   * field that was allocated from the arena must no longer be used.
+   *
+   * If huge pages are enabled by setHugePages(true) before the first
+   * allocation, each region is aligned to and sized in multiples of
+   * HugePageSize and, on Linux, marked as eligible for transparent
+   * huge pages with madvise.
+   *
+   * Each new array is initialized to zero by setField (see
+   * pscf/math/fieldKernels.h), which is multi-threaded with the same
+   * static partition of elements among threads as the field kernels.
+   * On a NUMA system this first touch places each page of an array
+   * on the memory node of the thread that later operates on it.
+   *
+   * Fields allocate memory from an arena by passing a pointer to it
+   * to Field<Data>::allocate, or to the allocate functions of RField
+   * and RFieldDft. Fields allocated in this way do not own their data.
+   *
+   * \ingroup Pspc_Field_Module
+   */
+   class FieldArena
+   {
+
+   public:
+
+      /**
+      * Alignment of each array, in bytes (one cache line).
+      */
+      static const size_t Alignment = 64;
+
+      /**
+      * Size and alignment of regions with huge pages, in bytes.
+      */
+      static const size_t HugePageSize = 2097152;
+
+      /**
+      * Default minimum size of a region, in bytes.
+      */
+      static const size_t DefaultRegionSize = 33554432;
+
+      /**
+      * Constructor.
+      *
+      * \param name  name used in memory reports (e.g., "propagators")
+      */
+      FieldArena(std::string name = "fields");
+
+      /**
+      * Destructor.
+      *
+      * Frees all regions.
+      */
+      ~FieldArena();
+
+      /**
+      * Set the name used in memory reports.
+      *
+      * \param name  name of arena
+      */
+      void setName(std::string name);
+
+      /**
+      * Enable or disable huge pages for regions allocated later.
+      *
+      * \param hugePages  true to request transparent huge pages
+      */
+      void setHugePages(bool hugePages);
+
+      /**
+      * Set the minimum size of regions allocated later.
+      *
+      * \param regionSize  minimum region size, in bytes
+      */
+      void setRegionSize(size_t regionSize);
+
+      /**
+      * Allocate a zero-initialized array of n elements of type Data.
+      *
+      * \param n  number of elements (n > 0)
+      * \return pointer to the first element
+      */
+      template <typename Data>
+      Data* allocate(int n);
+
+      /**
+      * Free all regions.
+      */
+      void clear();
+
+      /**
+      * Write a one line summary of memory usage.
+      *
+      * Columns are the name, number of arrays, megabytes in use and
+      * reserved, and number of regions.
+      *
+      * \param out  output stream
+      */
+      void writeReport(std::ostream& out) const;
+
+      /**
+      * Get name used in memory reports.
+      */
+      std::string const & name() const;
+
+      /**
+      * Number of arrays allocated since construction or clear().
+      */
+      int nArray() const;
+
+      /**
+      * Number of regions.
+      */
+      int nRegion() const;
+
+      /**
+      * Number of bytes handed out to arrays (including rounding).
+      */
+      size_t size() const;
+
+      /**
+      * Number of bytes reserved in all regions.
+      */
+      size_t capacity() const;
+
+      /**
+      * Are huge pages enabled?
+      */
+      bool hugePages() const;
+
+   private:
+
+      /**
+      * A contiguous region, from which arrays are allocated in order.
+      */
+      struct Region
+      {
+         char* begin;
+         size_t capacity;
+         size_t size;
+      };
+
+      /// Regions, in order of allocation.
+      GArray<Region> regions_;
+
+      /// Name used in memory reports.
+      std::string name_;
+
+      /// Minimum region size, in bytes.
+      size_t regionSize_;
+
+      /// Total bytes handed out to arrays.
+      size_t size_;
+
+      /// Total bytes reserved in all regions.
+      size_t capacity_;
+
+      /// Number of arrays allocated.
+      int nArray_;
+
+      /// Request transparent huge pages?
+      bool hugePages_;
+
+      /**
+      * Return pointer to a zero-initialized aligned block of memory.
+      *
+      * \param bytes  size of block, in bytes
+      */
+      void* allocateBytes(size_t bytes);
+
+      /**
+      * Copy constructor (private and not implemented to prohibit).
+      */
+      FieldArena(FieldArena const & other);
+
+      /**
+      * Assignment operator (private and not implemented to prohibit).
+      */
+      FieldArena& operator = (FieldArena const & other);
+
+   };
+
+   // Inline member functions
+
+   template <typename Data>
+   inline Data* FieldArena::allocate(int n)
+   {
+      UTIL_CHECK(n > 0);
+      return (Data*) allocateBytes(sizeof(Data)*size_t(n));
+   }
+
+   inline std::string const & FieldArena::name() const
+   {  return name_; }
+
+   inline int FieldArena::nArray() const
+   {  return nArray_; }
+
+   inline int FieldArena::nRegion() const
+   {  return regions_.size(); }
+
+   inline size_t FieldArena::size() const
+   {  return size_; }
+
+   inline size_t FieldArena::capacity() const
+   {  return capacity_; }
+
+   inline bool FieldArena::hugePages() const
+   {  return hugePages_; }
+
+}
+}
+#endif
@@ -9,8 +9,11 @@
 */
 
 #include <pspc/field/FFT.h>                // member
+#include <pspc/field/FFTBatched.h>         // member
+#include <pspc/field/BasisDftMap.h>        // member
 #include <pspc/field/RField.h>             // function parameter
 #include <pspc/field/RFieldDft.h>          // function parameter
+#include <pspc/field/RFieldBlock.h>        // function parameter
 
 #include <pscf/crystal/Basis.h>            // member
 #include <pscf/crystal/UnitCell.h>         // member
@@ -168,6 +171,47 @@ namespace Pspc
       void writeFieldsRGrid(std::string filename,
                             DArray< RField<D> > const& fields);
 
+      /**
+      * Read r-grid fields from a binary file, by memory mapping.
+      *
+      * The binary r-grid format begins with the 8 character label
+      * PSPC_RGB, an int format version number and the int length of
+      * a text header. The text header is identical to the header of 
+      * a text r-grid file, including the unit cell, group name,
+      * N_monomer and ngrid. After padding to a multiple of 8 bytes,
+      * the fields follow as nMonomer contiguous arrays of doubles, in 
+      * the native byte order and in the internal storage order of an 
+      * RField<D> (last index fastest). As for readFieldsRGrid, the 
+      * unit cell is set from the header.
+      *
+      * The file is mapped into memory, and each field is copied from
+      * the mapping directly into its RField storage, without parsing 
+      * or reordering.
+      *
+      * \param filename  name of input file (with input prefix)
+      * \param fields  array of RField fields (r-space grid)
+      */
+      void readFieldsRGridBinary(std::string filename, 
+                                 DArray< RField<D> >& fields);
+
+      /**
+      * Write r-grid fields in binary format.
+      *
+      * \param out  output stream, opened in binary mode
+      * \param fields  array of RField fields (r-space grid)
+      */
+      void writeFieldsRGridBinary(std::ostream& out, 
+                                  DArray< RField<D> > const& fields);
+
+      /**
+      * Write r-grid fields to a file in binary format.
+      *
+      * \param filename  name of output file
+      * \param fields  array of RField fields (r-space grid)
+      */
+      void writeFieldsRGridBinary(std::string filename,
+                                  DArray< RField<D> > const& fields);
+
       /**
       * Read array of RFieldDft objects (k-space fields) from file.
       *
@@ -295,6 +339,27 @@ namespace Pspc
       void convertRGridToBasis(DArray< RField<D> > & in,
                                DArray< DArray <double> > & out);
 
+      /**
+      * Convert fields from symmetrized basis to a contiguous rgrid block.
+      * 
+      * If the block is contiguous, the batched inverse FFT writes its 
+      * output directly into the block, with no intermediate copy.
+      *
+      * \param in  fields in symmetry adapted basis form
+      * \param out block of fields defined on real-space grid
+      */
+      void convertBasisToRGrid(DArray< DArray <double> > & in,
+                               RFieldBlock<D>& out);
+
+      /**
+      * Convert fields from a contiguous rgrid block to symmetrized basis.
+      * 
+      * \param in  block of fields defined on real-space grid
+      * \param out  fields in symmetry adapted basis form
+      */
+      void convertRGridToBasis(RFieldBlock<D> & in,
+                               DArray< DArray <double> > & out);
+
       //@}
 
    private:
@@ -302,6 +367,15 @@ namespace Pspc
       // DFT work array for two-step conversion basis <-> kgrid <-> rgrid.
       RFieldDft<D> workDft_;
 
+      // Contiguous DFT work array for batched conversion of field arrays.
+      Field<fftw_complex> workDftBatch_;
+
+      // Batched FFT for conversion of arrays of fields.
+      FFTBatched<D> fftBatched_;
+
+      // Precomputed map between basis and DFT arrays.
+      BasisDftMap<D> basisDftMap_;
+
       // Pointers to associated objects.
 
       /// Pointer to crystallographic unit cell.
@@ -411,6 +485,34 @@ namespace Pspc
       */
       void checkWorkDft();
 
+      /**
+      * Check and (if necessary) setup batched FFT and work array.
+      *
+      * \param batchSize  number of fields to be converted together
+      */
+      void checkWorkBatch(int batchSize);
+
+      /**
+      * Check and (if necessary) setup map between basis and DFT arrays.
+      */
+      void checkBasisDftMap();
+
+      /**
+      * Convert field from symmetrized basis to DFT (k-grid) array.
+      *
+      * \param in  coefficients of symmetry-adapted basis functions
+      * \param out  pointer to first element of DFT of a real field
+      */
+      void convertBasisToKGrid(DArray<double> const& in, fftw_complex* out);
+
+      /**
+      * Convert field from DFT (k-grid) array to symmetrized basis.
+      *
+      * \param in  pointer to first element of DFT of a real field
+      * \param out  coefficients of symmetry-adapted basis functions
+      */
+      void convertKGridToBasis(fftw_complex const * in, DArray<double>& out);
+
    };
 
    #ifndef PSPC_FIELD_IO_TPP
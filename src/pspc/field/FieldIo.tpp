@@ -9,6 +9,8 @@
 */
 
 #include "FieldIo.h"
+#include "MappedFile.h"
+#include "textValues.h"
 
 #include <pscf/crystal/shiftToMinimum.h>
 #include <pscf/mesh/MeshIterator.h>
@@ -18,7 +20,10 @@
 #include <util/format/Int.h>
 #include <util/format/Dbl.h>
 
+#include <cmath>
+#include <cstring>
 #include <iomanip>
+#include <sstream>
 #include <string>
 
 namespace Pscf {
@@ -98,20 +103,30 @@ namespace Pspc
       DArray<double> temp;
       temp.allocate(nMonomer);
 
+      // Convert all remaining numbers: For each star, these are the 
+      // components for all monomers, the characteristic wave and the
+      // number of wavevectors in the star.
+      int nValue = nMonomer + D + 1;
+      DArray<double> values;
+      values.allocate(nStarIn*nValue);
+      readTextValues(in, values.cArray(), nStarIn*nValue);
+
       // Loop over stars to read field components
       IntVec<D> waveIn, waveBz, waveDft;
-      int waveId, starId, nWaveVectors;
+      int waveId, starId, k;
       bool waveExists;
       for (i = 0; i < nStarIn; ++i) {
+         k = i*nValue;
 
-         // Read components for different monomers
+         // Components for different monomers
          for (j = 0; j < nMonomer; ++j) {
-            in >> temp [j];
+            temp[j] = values[k + j];
          }
 
-         // Read characteristic wave and number of wavectors in star.
-         in >> waveIn;
-         in >> nWaveVectors;
+         // Characteristic wave
+         for (j = 0; j < D; ++j) {
+            waveIn[j] = (int) std::floor(values[k + nMonomer + j] + 0.5);
+         }
 
          // Check if waveIn is in first Brillouin zone (FBZ) for the mesh.
          waveBz = shiftToMinimum(waveIn, mesh().dimensions(), unitCell());
@@ -209,11 +224,15 @@ namespace Pspc
          temp[i].allocate(mesh().dimensions());
       }
 
-      // Read Fields;
-      MeshIterator<D> itr(mesh().dimensions());
-      for (itr.begin(); !itr.atEnd(); ++itr) {
+      // Read fields: For each grid point, in order of increasing rank, 
+      // the file lists values for all monomer types.
+      int meshSize = mesh().size();
+      DArray<double> values;
+      values.allocate(meshSize*nMonomer);
+      readTextValues(in, values.cArray(), meshSize*nMonomer);
+      for (int rank = 0; rank < meshSize; ++rank) {
          for (int i = 0; i < nMonomer; ++i) {
-            in  >> std::setprecision(15) >> temp[i][itr.rank()];
+            temp[i][rank] = values[rank*nMonomer + i];
          }
       }
 
@@ -369,15 +388,15 @@ namespace Pspc
          std::cout << "Invalid Dimensions";
       }
 
-      // Write fields
-      MeshIterator<D> itr(mesh().dimensions());
-      for (itr.begin(); !itr.atEnd(); ++itr) {
-         // out << Int(itr.rank(), 5);
-         for (int j = 0; j < nMonomer; ++j) {
-            out << "  " << Dbl(temp[j][itr.rank()], 18, 15);
-         }
-         out << std::endl;
+      // Write fields, one line per grid point in order of increasing
+      // rank. Format "%18.15e" is equivalent to Dbl(value, 18, 15).
+      DArray<double const *> columns;
+      columns.allocate(nMonomer);
+      for (int j = 0; j < nMonomer; ++j) {
+         columns[j] = temp[j].cField();
       }
+      writeTextColumns(out, columns.cArray(), nMonomer, mesh().size(),
+                       "  ", "%18.15e");
 
    }
 
@@ -391,6 +410,105 @@ namespace Pspc
       file.close();
    }
 
+   /*
+   * Read r-grid fields from a memory-mapped binary file.
+   */
+   template <int D>
+   void FieldIo<D>::readFieldsRGridBinary(std::string filename, 
+                                          DArray< RField<D> >& fields)
+   {
+      int nMonomer = fields.capacity();
+      UTIL_CHECK(nMonomer > 0);
+      int meshSize = mesh().size();
+
+      MappedFile file;
+      file.open(fileMaster().inputPrefix() + filename);
+      char const * data = file.data();
+      size_t size = file.size();
+
+      // Read label, version and length of text header
+      int version, length;
+      if (size < 16 || std::memcmp(data, "PSPC_RGB", 8) != 0) {
+         UTIL_THROW("Invalid binary r-grid field file label");
+      }
+      std::memcpy(&version, data + 8, sizeof(int));
+      std::memcpy(&length, data + 12, sizeof(int));
+      UTIL_CHECK(version == 1);
+      UTIL_CHECK(length > 0 && size >= 16 + (size_t)length);
+
+      // Parse text header
+      std::istringstream header(std::string(data + 16, length));
+      readFieldHeader(header, nMonomer);
+      std::string label;
+      header >> label;
+      UTIL_CHECK(label == "ngrid");
+      IntVec<D> nGrid;
+      header >> nGrid;
+      UTIL_CHECK(nGrid == mesh().dimensions());
+
+      // Copy field data, which begins at an 8 byte boundary
+      size_t offset = 8*((16 + length + 7)/8);
+      size_t nByte = meshSize*sizeof(double);
+      if (size != offset + nMonomer*nByte) {
+         UTIL_THROW("Inconsistent size of binary r-grid field file");
+      }
+      for (int i = 0; i < nMonomer; ++i) {
+         UTIL_CHECK(fields[i].capacity() == meshSize);
+         std::memcpy(fields[i].cField(), data + offset + i*nByte, nByte);
+      }
+      file.close();
+   }
+
+   /*
+   * Write r-grid fields in binary format.
+   */
+   template <int D>
+   void FieldIo<D>::writeFieldsRGridBinary(std::ostream &out,
+                                           DArray<RField<D> > const& fields)
+   {
+      int nMonomer = fields.capacity();
+      UTIL_CHECK(nMonomer > 0);
+      int meshSize = mesh().size();
+
+      // Write text header to a string
+      std::ostringstream header;
+      writeFieldHeader(header, nMonomer);
+      header << "ngrid" <<  std::endl
+             << "           " << mesh().dimensions() << std::endl;
+      std::string text = header.str();
+
+      // Write label, version and text header, padded to 8 bytes
+      int version = 1;
+      int length = text.size();
+      out.write("PSPC_RGB", 8);
+      out.write((char const *) &version, sizeof(int));
+      out.write((char const *) &length, sizeof(int));
+      out.write(text.c_str(), length);
+      size_t offset = 16 + length;
+      while (offset % 8 != 0) {
+         out.put('\0');
+         ++offset;
+      }
+
+      // Write each field as one block
+      for (int i = 0; i < nMonomer; ++i) {
+         UTIL_CHECK(fields[i].capacity() == meshSize);
+         out.write((char const *) fields[i].cField(), 
+                   meshSize*sizeof(double));
+      }
+   }
+
+   template <int D>
+   void FieldIo<D>::writeFieldsRGridBinary(std::string filename, 
+                                           DArray< RField<D> > const & fields)
+   {
+      std::ofstream file;
+      fileMaster().openOutputFile(filename, file, 
+                                  std::ios::out | std::ios::binary);
+      writeFieldsRGridBinary(file, fields);
+      file.close();
+   }
+
    template <int D>
    void FieldIo<D>::readFieldsKGrid(std::istream &in,
                                     DArray<RFieldDft<D> >& fields)
@@ -517,187 +635,34 @@ namespace Pspc
    void FieldIo<D>::convertBasisToKGrid(DArray<double> const& in, 
                                         RFieldDft<D>& out)
    {
-      // Create Mesh<D> with dimensions of DFT Fourier grid.
-      Mesh<D> dftMesh(out.dftDimensions());
-
-      typename Basis<D>::Star const* starPtr; // pointer to current star
-      typename Basis<D>::Wave const* wavePtr; // pointer to current wave
-      std::complex<double> component;         // coefficient for star
-      std::complex<double> coeff;             // coefficient for wave
-      IntVec<D> indices;                      // dft grid indices of wave
-      int rank;                               // dft grid rank of wave
-      int is;                                 // star index
-      int iw;                                 // wave index
-
-      // Initialize all dft coponents to zero
-      for (rank = 0; rank < dftMesh.size(); ++rank) {
-         out[rank][0] = 0.0;
-         out[rank][1] = 0.0;
-      }
-
-      // Loop over stars, skipping cancelled stars
-      is = 0;
-      while (is < basis().nStar()) {
-         starPtr = &(basis().star(is));
-
-         if (starPtr->cancel) {
-            ++is;
-            continue;
-         }
-
-         if (starPtr->invertFlag == 0) {
-
-            // Make complex coefficient for star basis function
-            component = std::complex<double>(in[is], 0.0);
-
-            // Loop over waves in closed star
-            for (iw = starPtr->beginId; iw < starPtr->endId; ++iw) {
-               wavePtr = &basis().wave(iw);
-               if (!wavePtr->implicit) {
-                  coeff = component*(wavePtr->coeff);
-                  indices = wavePtr->indicesDft;    
-                  rank = dftMesh.rank(indices);
-                  out[rank][0] = coeff.real();
-                  out[rank][1] = coeff.imag();
-               }
-            }
-            ++is;
-
-         } else
-         if (starPtr->invertFlag == 1) {
-
-            // Make complex component for first star
-            component = std::complex<double>(in[is], -in[is+1]);
-            component /= sqrt(2.0);
-
-            // Loop over waves in first star
-            starPtr = &(basis().star(is));
-            for (iw = starPtr->beginId; iw < starPtr->endId; ++iw) {
-               wavePtr = &basis().wave(iw);
-               if (!(wavePtr->implicit)) {
-                  coeff = component*(wavePtr->coeff);
-                  indices = wavePtr->indicesDft;    
-                  rank = dftMesh.rank(indices);
-                  out[rank][0] = coeff.real();
-                  out[rank][1] = coeff.imag();
-               }
-            }
-
-            // Loop over waves in second star
-            starPtr = &(basis().star(is+1));
-            UTIL_CHECK(starPtr->invertFlag == -1);
-            component = conj(component);
-            for (iw = starPtr->beginId; iw < starPtr->endId; ++iw) {
-               wavePtr = &basis().wave(iw);
-               if (!(wavePtr->implicit)) {
-                  coeff = component*(wavePtr->coeff);
-                  indices = wavePtr->indicesDft;
-                  rank = dftMesh.rank(indices);
-                  out[rank][0] = coeff.real();
-                  out[rank][1] = coeff.imag();
-               }
-            }
-
-            // Increment is by 2 (two stars were processed)
-            is += 2;
-
-         } else {
- 
-            UTIL_THROW("Invalid invertFlag value");
-  
-         }
-
-      }
+      UTIL_CHECK(out.meshDimensions() == mesh().dimensions());
+      convertBasisToKGrid(in, out.cField());
+   }
 
+   template <int D>
+   void FieldIo<D>::convertBasisToKGrid(DArray<double> const& in, 
+                                        fftw_complex* out)
+   {
+      checkBasisDftMap();
+      UTIL_CHECK(in.capacity() >= basis().nStar());
+      basisDftMap_.basisToDft(in.cArray(), out);
    }
 
    template <int D>
    void FieldIo<D>::convertKGridToBasis(RFieldDft<D> const& in, 
                                         DArray<double>& out)
    {
-      // Create Mesh<D> with dimensions of DFT Fourier grid.
-      Mesh<D> dftMesh(in.dftDimensions());
-
-      typename Basis<D>::Star const* starPtr;  // pointer to current star
-      typename Basis<D>::Wave const* wavePtr;  // pointer to current wave
-      std::complex<double> component;          // coefficient for star
-      IntVec<D> indices;                       // dft grid indices of wave
-      int rank;                                // dft grid rank of wave
-      int is;                                  // star index
-      int iw;                                  // wave id, within star 
-      bool isImplicit;
-
-      // Initialize all components to zero
-      for (is = 0; is < basis().nStar(); ++is) {
-         out[is] = 0.0;
-      }
-
-      // Loop over stars
-      is = 0;
-      while (is < basis().nStar()) {
-         starPtr = &(basis().star(is));
-
-         if (starPtr->cancel) {
-            ++is;
-            continue;
-         }
-
-         if (starPtr->invertFlag == 0) {
-
-            // Choose a characteristic wave that is not implicit.
-            // Start with the first, alternately searching from
-            // the beginning and end of star.
-            isImplicit = true;
-            iw = 0;
-            while (isImplicit) {
-                UTIL_CHECK(iw <= (starPtr->size)/2);
-                wavePtr = &basis().wave(starPtr->beginId + iw);
-                if (wavePtr->implicit) {
-                   wavePtr = &basis().wave(starPtr->endId - 1 - iw);
-                }
-                isImplicit = wavePtr->implicit;
-                ++iw;
-            }
-            UTIL_CHECK(wavePtr->starId == is);
-            indices = wavePtr->indicesDft;
-            rank = dftMesh.rank(indices);
-
-            // Compute component value
-            component = std::complex<double>(in[rank][0], in[rank][1]);
-            component /= wavePtr->coeff;
-            UTIL_CHECK(abs(component.imag()) < 1.0E-8);
-            out[is] = component.real();
-            ++is;
-
-         } else
-         if (starPtr->invertFlag == 1) {
-
-            // Identify a characteristic wave that is not implicit:
-            // Either first wave of 1st star or last wave of 2nd star.
-            wavePtr = &basis().wave(starPtr->beginId);
-            if (wavePtr->implicit) {
-               starPtr = &(basis().star(is+1));
-               UTIL_CHECK(starPtr->invertFlag == -1);
-               wavePtr = &basis().wave(starPtr->endId-1);
-               UTIL_CHECK(!(wavePtr->implicit));
-            } 
-            indices = wavePtr->indicesDft;
-            rank = dftMesh.rank(indices);
-
-            // Compute component value
-            component = std::complex<double>(in[rank][0], in[rank][1]);
-            UTIL_CHECK(abs(wavePtr->coeff) > 1.0E-8);
-            component /= wavePtr->coeff;
-            component *= sqrt(2.0);
-            out[is] = component.real();
-            out[is+1] = -component.imag();
-
-            is += 2;
-         } else {
-            UTIL_THROW("Invalid invertFlag value");
-         }
+      UTIL_CHECK(in.meshDimensions() == mesh().dimensions());
+      convertKGridToBasis(in.cField(), out);
+   }
 
-      } //  loop over star index is
+   template <int D>
+   void FieldIo<D>::convertKGridToBasis(fftw_complex const * in, 
+                                        DArray<double>& out)
+   {
+      checkBasisDftMap();
+      UTIL_CHECK(out.capacity() >= basis().nStar());
+      basisDftMap_.dftToBasis(in, out.cArray());
    }
 
    template <int D>
@@ -728,13 +693,14 @@ namespace Pspc
                                    DArray< RField<D> >& out)
    {
       UTIL_ASSERT(in.capacity() == out.capacity());
-      checkWorkDft();
-
       int n = in.capacity();
-      for (int i = 0; i < n; ++i) {
-         convertBasisToKGrid(in[i], workDft_);
-         fft().inverseTransform(workDft_, out[i]);
-      }
+      checkWorkBatch(n);
+
+      // Convert all fields to k-grid, then apply one batched transform
+      checkBasisDftMap();
+      basisDftMap_.basisToDft(in, workDftBatch_.cField(),
+                              fftBatched_.kSize());
+      fftBatched_.inverseTransform(workDftBatch_, out);
    }
 
    template <int D>
@@ -743,13 +709,51 @@ namespace Pspc
                                    DArray< DArray <double> > & out)
    {
       UTIL_ASSERT(in.capacity() == out.capacity());
-      checkWorkDft();
-
       int n = in.capacity();
-      for (int i = 0; i < n; ++i) {
-         fft().forwardTransform(in[i], workDft_);
-         convertKGridToBasis(workDft_, out[i]);
+      checkWorkBatch(n);
+
+      // Apply one batched transform, then convert each field to basis
+      fftBatched_.forwardTransform(in, workDftBatch_);
+      checkBasisDftMap();
+      basisDftMap_.dftToBasis(workDftBatch_.cField(), fftBatched_.kSize(),
+                              out);
+   }
+
+   template <int D>
+   void 
+   FieldIo<D>::convertBasisToRGrid(DArray< DArray <double> >& in,
+                                   RFieldBlock<D>& out)
+   {
+      if (!out.isContiguous()) {
+         convertBasisToRGrid(in, out.fields());
+         return;
+      }
+      UTIL_ASSERT(in.capacity() == out.nField());
+      checkWorkBatch(out.nField());
+
+      // Transform directly into the block, without a scatter copy
+      checkBasisDftMap();
+      basisDftMap_.basisToDft(in, workDftBatch_.cField(),
+                              fftBatched_.kSize());
+      fftBatched_.inverseTransform(workDftBatch_, out.data());
+   }
+
+   template <int D>
+   void 
+   FieldIo<D>::convertRGridToBasis(RFieldBlock<D>& in,
+                                   DArray< DArray <double> > & out)
+   {
+      if (!in.isContiguous()) {
+         convertRGridToBasis(in.fields(), out);
+         return;
       }
+      UTIL_ASSERT(in.nField() == out.capacity());
+      checkWorkBatch(in.nField());
+
+      fftBatched_.forwardTransform(in.data(), workDftBatch_);
+      checkBasisDftMap();
+      basisDftMap_.dftToBasis(workDftBatch_.cField(), fftBatched_.kSize(),
+                              out);
    }
 
    template <int D>
@@ -762,6 +766,38 @@ namespace Pspc
       }
    }
 
+   template <int D>
+   void FieldIo<D>::checkWorkBatch(int batchSize)
+   {
+      UTIL_CHECK(batchSize > 0);
+      if (!fftBatched_.isSetup() 
+          || fftBatched_.batchSize() != batchSize
+          || !(fftBatched_.meshDimensions() == mesh().dimensions())) {
+         fftBatched_.setup(mesh().dimensions(), batchSize);
+      }
+      int capacity = batchSize*fftBatched_.kSize();
+      if (workDftBatch_.isAllocated()) {
+         if (workDftBatch_.capacity() != capacity) {
+            workDftBatch_.deallocate();
+         }
+      }
+      if (!workDftBatch_.isAllocated()) {
+         workDftBatch_.allocate(capacity);
+      }
+   }
+
+   template <int D>
+   void FieldIo<D>::checkBasisDftMap()
+   {
+      int dftSize = mesh().size()/mesh().dimension(D-1);
+      dftSize *= mesh().dimension(D-1)/2 + 1;
+      if (!basisDftMap_.isSetup()
+          || basisDftMap_.nStar() != basis().nStar()
+          || basisDftMap_.dftSize() != dftSize) {
+         basisDftMap_.setup(basis(), mesh());
+      }
+   }
+
 } // namespace Pspc
 } // namespace Pscf
 #endif
@@ -0,0 +1,84 @@
+/*
+* PSCF++ Package 
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "MappedFile.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Pscf {
+namespace Pspc {
+
+   using namespace Util;
+
+   /*
+   * Constructor.
+   */
+   MappedFile::MappedFile()
+    : data_(0),
+      size_(0)
+   {}
+
+   /*
+   * Destructor.
+   */
+   MappedFile::~MappedFile()
+   {  close(); }
+
+   /*
+   * Map an entire file, read-only.
+   */
+   void MappedFile::open(std::string const & path)
+   {
+      UTIL_CHECK(!isOpen());
+
+      int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0) {
+         std::string msg = "Error opening file ";
+         msg += path;
+         UTIL_THROW(msg.c_str());
+      }
+      struct stat status;
+      if (fstat(fd, &status) != 0 || status.st_size == 0) {
+         ::close(fd);
+         std::string msg = "Error reading size of file ";
+         msg += path;
+         UTIL_THROW(msg.c_str());
+      }
+      size_t size = (size_t) status.st_size;
+
+      void* ptr = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      ::close(fd); // The mapping remains valid after closing fd
+      if (ptr == MAP_FAILED) {
+         std::string msg = "Error mapping file ";
+         msg += path;
+         UTIL_THROW(msg.c_str());
+      }
+
+      // Fields are read once, from beginning to end
+      madvise(ptr, size, MADV_SEQUENTIAL);
+
+      data_ = static_cast<char*>(ptr);
+      size_ = size;
+   }
+
+   /*
+   * Unmap the file, if mapped.
+   */
+   void MappedFile::close()
+   {
+      if (data_) {
+         munmap(data_, size_);
+         data_ = 0;
+         size_ = 0;
+      }
+   }
+
+}
+}
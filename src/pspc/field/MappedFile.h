@@ -0,0 +1,105 @@
+#ifndef PSPC_MAPPED_FILE_H
+#define PSPC_MAPPED_FILE_H
+
+/*
+* PSCF++ Package 
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <util/global.h>
+
+#include <cstddef>
+#include <string>
+
+namespace Pscf {
+namespace Pspc {
+
+   using namespace Util;
+
+   /**
+   * Read-only memory mapping of an entire file.
+   *
+   * The file is mapped by the POSIX mmap function when open() is 
+   * called, and unmapped by close() or by the destructor. Contents 
+   * are then accessed through the data() pointer, and are paged in
+   * from the file (or the page cache) on demand, with no intermediate
+   * buffering or parsing.
+   *
+   * \ingroup Pspc_Field_Module
+   */
+   class MappedFile
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      */
+      MappedFile();
+
+      /**
+      * Destructor (unmaps the file, if open).
+      */
+      ~MappedFile();
+
+      /**
+      * Map a file for reading.
+      *
+      * Throws an Exception if the file cannot be opened or mapped.
+      *
+      * \param path  full path of file
+      */
+      void open(std::string const & path);
+
+      /**
+      * Unmap the file.
+      */
+      void close();
+
+      /**
+      * Get pointer to the first byte of the mapped file.
+      */
+      char const * data() const;
+
+      /**
+      * Get the size of the file, in bytes.
+      */
+      size_t size() const;
+
+      /**
+      * Is a file currently mapped?
+      */
+      bool isOpen() const;
+
+   private:
+
+      // Address of mapped memory, or null if not open.
+      char* data_;
+
+      // Size of file in bytes.
+      size_t size_;
+
+      /// Copy constructor - private and not implemented.
+      MappedFile(MappedFile const &);
+
+      /// Assignment - private and not implemented.
+      MappedFile& operator = (MappedFile const &);
+
+   };
+
+   // Inline member functions
+
+   inline char const * MappedFile::data() const
+   {  return data_; }
+
+   inline size_t MappedFile::size() const
+   {  return size_; }
+
+   inline bool MappedFile::isOpen() const
+   {  return (bool)data_; }
+
+}
+}
+#endif
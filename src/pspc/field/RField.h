@@ -74,6 +74,30 @@ namespace Pspc
       */
       void allocate(const IntVec<D>& meshDimensions);
 
+      /**
+      * Allocate the underlying C array for an FFT grid from an arena.
+      *
+      * If arena is null, this is equivalent to allocate(meshDimensions).
+      *
+      * \throw Exception if the RField is already allocated.
+      *
+      * \param meshDimensions vector of grid points in each direction
+      * \param arena  arena from which to allocate (may be null)
+      */
+      void allocate(const IntVec<D>& meshDimensions, FieldArena* arena);
+
+      using Field<double>::associate;
+
+      /**
+      * Associate with a C array for an FFT grid, without ownership.
+      *
+      * \throw Exception if the RField is already allocated.
+      *
+      * \param ptr  pointer to the first element of the C array
+      * \param meshDimensions vector containing number of grid points in each direction
+      */
+      void associate(double* ptr, const IntVec<D>& meshDimensions);
+
       /**
       * Return mesh dimensions by constant reference.
       */
@@ -105,6 +105,37 @@ namespace Pspc
       Field<double>::allocate(size);
    }
 
+   /*
+   * Allocate the underlying C array for an FFT grid from an arena.
+   */
+   template <int D>
+   void RField<D>::allocate(const IntVec<D>& meshDimensions, 
+                            FieldArena* arena)
+   {
+      int size = 1;
+      for (int i = 0; i < D; ++i) {
+         UTIL_CHECK(meshDimensions[i] > 0);
+         meshDimensions_[i] = meshDimensions[i];
+         size *= meshDimensions[i];
+      }
+      Field<double>::allocate(size, arena);
+   }
+
+   /*
+   * Associate with a C array for an FFT grid, without ownership.
+   */
+   template <int D>
+   void RField<D>::associate(double* ptr, const IntVec<D>& meshDimensions)
+   {
+      int size = 1;
+      for (int i = 0; i < D; ++i) {
+         UTIL_CHECK(meshDimensions[i] > 0);
+         meshDimensions_[i] = meshDimensions[i];
+         size *= meshDimensions[i];
+      }
+      Field<double>::associate(ptr, size);
+   }
+
 }
 }
 #endif
@@ -0,0 +1,19 @@
+/*
+* PSCF++ Package 
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "RFieldBlock.tpp"
+
+namespace Pscf {
+namespace Pspc
+{
+
+   template class RFieldBlock<1>;
+   template class RFieldBlock<2>;
+   template class RFieldBlock<3>;
+
+}
+}
@@ -0,0 +1,238 @@
+#ifndef PSPC_R_FIELD_BLOCK_H
+#define PSPC_R_FIELD_BLOCK_H
+
+/*
+* PSCF++ Package
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "Field.h"                       // member
+#include "FieldArena.h"                  // function parameter
+#include "RField.h"                      // member template argument
+#include <pscf/math/IntVec.h>            // member
+#include <util/containers/DArray.h>      // member template
+#include <util/global.h>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+   using namespace Pscf;
+
+   /**
+   * Set of real fields on an FFT mesh, stored in one contiguous block.
+   *
+   * An RFieldBlock allocates nField() fields, each with fieldSize()
+   * elements, in a single aligned block of memory, and provides an
+   * array of RField<D> views of the individual fields. Field i begins
+   * at element i*stride() of the block, where stride() is fieldSize()
+   * rounded up to a multiple of Alignment. Every field thus has the
+   * same alignment as the block, which allows FFTW plans made for any
+   * one of them to be executed on all the others. Padding elements,
+   * if any, are set to zero on allocation.
+   *
+   * If isContiguous() is true (i.e., if fieldSize() is a multiple of
+   * Alignment, as for any 3D mesh with even dimensions, or any mesh
+   * with a dimension divisible by 8), there is no padding and data()
+   * can be used directly as a batch of fields, e.g., by FFTBatched, or
+   * as a single array of nField()*fieldSize() values for pointwise
+   * operations.
+   *
+   * The views returned by fields() and operator [] must not be
+   * deallocated or re-allocated by users.
+   *
+   * \ingroup Pspc_Field_Module
+   */
+   template <int D>
+   class RFieldBlock
+   {
+
+   public:
+
+      /**
+      * Number of elements (doubles) to which stride() is rounded up.
+      *
+      * Eight doubles are one 64 byte cache line.
+      */
+      static const int Alignment = 8;
+
+      /**
+      * Default constructor.
+      */
+      RFieldBlock();
+
+      /**
+      * Destructor.
+      */
+      ~RFieldBlock();
+
+      /**
+      * Allocate memory and create views of all fields.
+      *
+      * \throw Exception if the RFieldBlock is already allocated.
+      *
+      * \param nField  number of fields (e.g., number of monomer types)
+      * \param meshDimensions  number of grid points in each direction
+      * \param arena  arena from which to allocate (null for heap)
+      */
+      void allocate(int nField, IntVec<D> const & meshDimensions,
+                    FieldArena* arena = 0);
+
+      /**
+      * Get array of views of all fields.
+      */
+      DArray< RField<D> >& fields();
+
+      /**
+      * Get array of views of all fields, by const reference.
+      */
+      DArray< RField<D> > const & fields() const;
+
+      /**
+      * Get a view of one field.
+      *
+      * \param i  field index, 0 <= i < nField()
+      */
+      RField<D>& operator [] (int i);
+
+      /**
+      * Get a view of one field, by const reference.
+      *
+      * \param i  field index, 0 <= i < nField()
+      */
+      RField<D> const & operator [] (int i) const;
+
+      /**
+      * Get the underlying block, of capacity nField()*stride().
+      */
+      Field<double>& data();
+
+      /**
+      * Get the underlying block, by const reference.
+      */
+      Field<double> const & data() const;
+
+      /**
+      * Return mesh dimensions by constant reference.
+      */
+      IntVec<D> const & meshDimensions() const;
+
+      /**
+      * Number of fields.
+      */
+      int nField() const;
+
+      /**
+      * Number of elements per field (number of mesh points).
+      */
+      int fieldSize() const;
+
+      /**
+      * Offset between first elements of consecutive fields.
+      */
+      int stride() const;
+
+      /**
+      * Are consecutive fields adjacent in memory (no padding)?
+      */
+      bool isContiguous() const;
+
+      /**
+      * Has this RFieldBlock been allocated?
+      */
+      bool isAllocated() const;
+
+   private:
+
+      /// Memory block for all fields.
+      Field<double> data_;
+
+      /// Views of individual fields.
+      DArray< RField<D> > fields_;
+
+      /// Number of grid points in each direction.
+      IntVec<D> meshDimensions_;
+
+      /// Number of fields.
+      int nField_;
+
+      /// Number of elements per field.
+      int fieldSize_;
+
+      /// Offset between consecutive fields.
+      int stride_;
+
+      /**
+      * Copy constructor (private and not implemented to prohibit).
+      */
+      RFieldBlock(RFieldBlock const & other);
+
+      /**
+      * Assignment operator (private and not implemented to prohibit).
+      */
+      RFieldBlock& operator = (RFieldBlock const & other);
+
+   };
+
+   // Inline member functions
+
+   template <int D>
+   inline DArray< RField<D> >& RFieldBlock<D>::fields()
+   {  return fields_; }
+
+   template <int D>
+   inline DArray< RField<D> > const & RFieldBlock<D>::fields() const
+   {  return fields_; }
+
+   template <int D>
+   inline RField<D>& RFieldBlock<D>::operator [] (int i)
+   {  return fields_[i]; }
+
+   template <int D>
+   inline RField<D> const & RFieldBlock<D>::operator [] (int i) const
+   {  return fields_[i]; }
+
+   template <int D>
+   inline Field<double>& RFieldBlock<D>::data()
+   {  return data_; }
+
+   template <int D>
+   inline Field<double> const & RFieldBlock<D>::data() const
+   {  return data_; }
+
+   template <int D>
+   inline IntVec<D> const & RFieldBlock<D>::meshDimensions() const
+   {  return meshDimensions_; }
+
+   template <int D>
+   inline int RFieldBlock<D>::nField() const
+   {  return nField_; }
+
+   template <int D>
+   inline int RFieldBlock<D>::fieldSize() const
+   {  return fieldSize_; }
+
+   template <int D>
+   inline int RFieldBlock<D>::stride() const
+   {  return stride_; }
+
+   template <int D>
+   inline bool RFieldBlock<D>::isContiguous() const
+   {  return (stride_ == fieldSize_); }
+
+   template <int D>
+   inline bool RFieldBlock<D>::isAllocated() const
+   {  return data_.isAllocated(); }
+
+   #ifndef PSPC_R_FIELD_BLOCK_TPP
+   extern template class RFieldBlock<1>;
+   extern template class RFieldBlock<2>;
+   extern template class RFieldBlock<3>;
+   #endif
+
+}
+}
+#endif
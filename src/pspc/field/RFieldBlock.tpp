@@ -0,0 +1,74 @@
+#ifndef PSPC_R_FIELD_BLOCK_TPP
+#define PSPC_R_FIELD_BLOCK_TPP
+
+/*
+* PSCF++ Package
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "RFieldBlock.h"
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /*
+   * Default constructor.
+   */
+   template <int D>
+   RFieldBlock<D>::RFieldBlock()
+    : data_(),
+      fields_(),
+      meshDimensions_(),
+      nField_(0),
+      fieldSize_(0),
+      stride_(0)
+   {}
+
+   /*
+   * Destructor.
+   */
+   template <int D>
+   RFieldBlock<D>::~RFieldBlock()
+   {}
+
+   /*
+   * Allocate the block and associate a view with each field.
+   */
+   template <int D>
+   void RFieldBlock<D>::allocate(int nField,
+                                 IntVec<D> const & meshDimensions,
+                                 FieldArena* arena)
+   {
+      UTIL_CHECK(!isAllocated());
+      UTIL_CHECK(nField > 0);
+      int size = 1;
+      for (int i = 0; i < D; ++i) {
+         UTIL_CHECK(meshDimensions[i] > 0);
+         size *= meshDimensions[i];
+      }
+      meshDimensions_ = meshDimensions;
+      nField_ = nField;
+      fieldSize_ = size;
+      stride_ = ((size + Alignment - 1)/Alignment)*Alignment;
+
+      data_.allocate(nField_*stride_, arena);
+      fields_.allocate(nField_);
+      double* ptr = data_.cField();
+      int i, j;
+      for (i = 0; i < nField_; ++i) {
+         fields_[i].associate(ptr, meshDimensions_);
+         for (j = fieldSize_; j < stride_; ++j) {
+            ptr[j] = 0.0;
+         }
+         ptr += stride_;
+      }
+   }
+
+}
+}
+#endif
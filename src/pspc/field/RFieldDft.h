@@ -76,6 +76,18 @@ namespace Pspc
       */
       void allocate(const IntVec<D>& meshDimensions);
 
+      /**
+      * Allocate the underlying C array for an FFT grid from an arena.
+      *
+      * If arena is null, this is equivalent to allocate(meshDimensions).
+      *
+      * \throw Exception if the RFieldDft is already allocated.
+      *
+      * \param meshDimensions vector of grid points in each direction
+      * \param arena  arena from which to allocate (may be null)
+      */
+      void allocate(const IntVec<D>& meshDimensions, FieldArena* arena);
+
       /**
       * Return vector of spatial mesh dimensions by constant reference.
       */
@@ -114,6 +126,14 @@ namespace Pspc
    */
    template <int D>
    void RFieldDft<D>::allocate(const IntVec<D>& meshDimensions)
+   {  allocate(meshDimensions, 0); }
+
+   /*
+   * Allocate the underlying C array for an FFT grid from an arena.
+   */
+   template <int D>
+   void RFieldDft<D>::allocate(const IntVec<D>& meshDimensions,
+                               FieldArena* arena)
    {
       int size = 1;
       for (int i = 0; i < D; ++i) {
@@ -127,7 +147,7 @@ namespace Pspc
             size *= dftDimensions_[i];
          }
       }
-      Field<fftw_complex>::allocate(size);
+      Field<fftw_complex>::allocate(size, arena);
    }
 
    /*
@@ -2,7 +2,13 @@ pspc_field_= \
   pspc/field/FFT.cpp \
   pspc/field/RField.cpp \
   pspc/field/RFieldDft.cpp \
-  pspc/field/FFT.cpp \
+  pspc/field/RFieldBlock.cpp \
+  pspc/field/FieldArena.cpp \
+  pspc/field/FFTBatched.cpp \
+  pspc/field/FFTPlanner.cpp \
+  pspc/field/MappedFile.cpp \
+  pspc/field/textValues.cpp \
+  pspc/field/BasisDftMap.cpp \
   pspc/field/FieldIo.cpp 
 
 pspc_field_SRCS=\
@@ -0,0 +1,183 @@
+/*
+* PSCF++ Package 
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "textValues.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifdef PSPC_OPENMP
+#include <omp.h>
+#endif
+
+namespace Pscf {
+namespace Pspc {
+
+   using namespace Util;
+
+   namespace {
+
+      /*
+      * Is c a whitespace character, in the C locale?
+      */
+      inline bool isSpace(char c)
+      {  return (c == ' ' || (c >= '\t' && c <= '\r')); }
+
+      /*
+      * Number of chunks into which work is divided.
+      */
+      int nChunk(int nItem)
+      {
+         int n = 1;
+         #ifdef PSPC_OPENMP
+         n = 4*omp_get_max_threads();
+         #endif
+         if (n > nItem) n = nItem;
+         if (n < 1) n = 1;
+         return n;
+      }
+
+   }
+
+   /*
+   * Read and convert the next n values in a stream.
+   */
+   void readTextValues(std::istream& in, double* values, int n)
+   {
+      UTIL_CHECK(n >= 0);
+
+      // Copy text up to the end of the n-th token into a buffer. As
+      // for operator >>, the character after the last token is left 
+      // in the stream, so that any trailing content can still be read.
+      std::string buffer;
+      std::streambuf* sb = in.rdbuf();
+      typedef std::char_traits<char> Traits;
+      Traits::int_type ic = sb->sgetc();
+      int m = 0;
+      bool inToken = false;
+      while (!Traits::eq_int_type(ic, Traits::eof())) {
+         char ch = Traits::to_char_type(ic);
+         if (isSpace(ch)) {
+            if (inToken && m == n) break;
+            inToken = false;
+         } else if (!inToken) {
+            if (m == n) break;
+            inToken = true;
+            ++m;
+         }
+         buffer.push_back(ch);
+         ic = sb->snextc();
+      }
+      if (Traits::eq_int_type(ic, Traits::eof())) {
+         in.setstate(std::ios::eofbit);
+      }
+      if (m != n) {
+         UTIL_THROW("Unexpected number of values in field file");
+      }
+      char const * text = buffer.c_str();
+      long size = buffer.size();
+
+      // Divide text into chunks, each beginning with whitespace
+      int nc = nChunk(size/4096 + 1);
+      std::vector<long> begin(nc + 1);
+      begin[0] = 0;
+      begin[nc] = size;
+      int c;
+      for (c = 1; c < nc; ++c) {
+         long k = (size*c)/nc;
+         if (k < begin[c-1]) k = begin[c-1];
+         while (k < size && !isSpace(text[k])) ++k;
+         begin[c] = k;
+      }
+
+      // Count values in each chunk
+      std::vector<int> count(nc + 1, 0);
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel for schedule(static)
+      #endif
+      for (c = 0; c < nc; ++c) {
+         int m = 0;
+         bool inToken = false;
+         for (long k = begin[c]; k < begin[c+1]; ++k) {
+            if (isSpace(text[k])) {
+               inToken = false;
+            } else if (!inToken) {
+               inToken = true;
+               ++m;
+            }
+         }
+         count[c+1] = m;
+      }
+      for (c = 0; c < nc; ++c) {
+         count[c+1] += count[c];
+      }
+      UTIL_CHECK(count[nc] == n);
+
+      // Convert values, each chunk starting at its offset
+      bool error = false;
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel for schedule(static) reduction(||:error)
+      #endif
+      for (c = 0; c < nc; ++c) {
+         char const * ptr = text + begin[c];
+         char* end;
+         for (int i = count[c]; i < count[c+1]; ++i) {
+            values[i] = std::strtod(ptr, &end);
+            if (end == ptr) {
+               error = true;
+               break;
+            }
+            ptr = end;
+         }
+      }
+      if (error) {
+         UTIL_THROW("Invalid number in field file");
+      }
+   }
+
+   /*
+   * Format rows in parallel, then write them in order.
+   */
+   void writeTextColumns(std::ostream& out, 
+                         double const * const * columns, 
+                         int nColumn, int nRow,
+                         char const * separator, char const * format)
+   {
+      int nc = nChunk(nRow/1024 + 1);
+      std::vector<std::string> chunks(nc);
+
+      int c;
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel for schedule(static)
+      #endif
+      for (c = 0; c < nc; ++c) {
+         int first = (int)(((long)nRow*c)/nc);
+         int last = (int)(((long)nRow*(c+1))/nc);
+         std::string& chunk = chunks[c];
+         chunk.reserve((last - first)*(nColumn*24 + 1));
+         char number[64];
+         int i, j, length;
+         for (i = first; i < last; ++i) {
+            for (j = 0; j < nColumn; ++j) {
+               chunk += separator;
+               length = std::snprintf(number, sizeof(number), format, 
+                                      columns[j][i]);
+               chunk.append(number, length);
+            }
+            chunk += '\n';
+         }
+      }
+
+      for (c = 0; c < nc; ++c) {
+         out.write(chunks[c].c_str(), chunks[c].size());
+      }
+   }
+
+}
+}
@@ -0,0 +1,68 @@
+#ifndef PSPC_TEXT_VALUES_H
+#define PSPC_TEXT_VALUES_H
+
+/*
+* PSCF++ Package 
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <util/global.h>
+
+#include <iostream>
+
+namespace Pscf {
+namespace Pspc {
+
+   using namespace Util;
+
+   /**
+   * Read the next n whitespace separated numbers from a stream.
+   *
+   * This function copies the text of the next n whitespace separated 
+   * tokens into memory, and then converts it to n floating point 
+   * values, which are stored in values[0], ..., values[n-1]. The text
+   * is divided into chunks at whitespace boundaries, and chunks are 
+   * counted and then converted by strtod in parallel if PSPC_OPENMP 
+   * is defined. The values are identical to those obtained by reading 
+   * one value at a time with operator >>, and, as for operator >>, the 
+   * stream is left positioned just after the last value, so that any 
+   * trailing content may still be read. An Exception is thrown if the
+   * stream ends before n values have been read.
+   *
+   * \param in  input stream, positioned after any header
+   * \param values  array of n elements to be set
+   * \param n  number of expected values
+   *
+   * \ingroup Pspc_Field_Module
+   */
+   void readTextValues(std::istream& in, double* values, int n);
+
+   /**
+   * Write a table of values in columns, one row per line.
+   *
+   * Each line contains the string separator followed by the value of
+   * columns[j][i], formatted by printf format string format, for each
+   * column j. Rows are formatted into separate buffers in parallel if
+   * PSPC_OPENMP is defined, and the buffers are then written in order.
+   * The format "%18.15e" gives output byte-identical to that of 
+   * operator << with Dbl(value, 18, 15).
+   *
+   * \param out  output stream
+   * \param columns  array of nColumn pointers to columns of values
+   * \param nColumn  number of columns
+   * \param nRow  number of rows (i.e., lines)
+   * \param separator  string written before each value
+   * \param format  printf format for one double value
+   *
+   * \ingroup Pspc_Field_Module
+   */
+   void writeTextColumns(std::ostream& out, 
+                         double const * const * columns, 
+                         int nColumn, int nRow,
+                         char const * separator, char const * format);
+
+}
+}
+#endif
@@ -8,15 +8,9 @@
 * Distributed under the terms of the GNU General Public License.
 */
 
-#include <pspc/iterator/Iterator.h> // base class
-#include <pspc/solvers/Mixture.h>
-#include <pscf/math/LuSolver.h>
+#include <pspc/iterator/AmIteratorBase.h>     // base class
+#include <pspc/iterator/RpaPreconditioner.h>  // member
 #include <util/containers/DArray.h>
-#include <util/containers/FArray.h>
-#include <util/containers/FSArray.h>
-#include <util/containers/DMatrix.h>
-#include <util/containers/RingBuffer.h>
-//#include <pspc/iterator/RingBuffer.h>
 #include <pspc/field/RField.h>
 
 
@@ -32,7 +26,7 @@ namespace Pspc
    * \ingroup Pspc_Iterator_Module
    */
    template <int D>
-   class AmIterator : public Iterator<D>
+   class AmIterator : public AmIteratorBase<D>
    {
    public:
       
@@ -63,92 +57,52 @@ namespace Pspc
       */
       void allocate();
 
-      /**
-      * Iterate to a solution
-      */
-      int solve();
+   protected:
 
       /**
-      * Get epsilon (error threshhold).
+      * Copy the symmetry-adapted basis components of the w fields.
+      *
+      * \param om array of nMonomer pointers to the fields of the slot
       */
-      double epsilon();
+      void storeOmega(double* const * om);
 
       /**
-      * Get the maximum number of field histories retained.
+      * Compute the residual for all basis functions but the first.
+      *
+      * The residual is preconditioned if isPreconditioned is true.
+      *
+      * \param dev array of nMonomer pointers to the fields of the slot
+      * \return maximum magnitude of the residual before preconditioning
       */
-      int maxHist();
+      double computeResidual(double* const * dev);
 
       /**
-      * Get the maximum number of iteration before convergence.
+      * Set new basis components of the w fields by mixing histories.
       */
-      int maxItr();
+      void mixOmega();
 
       /**
-      * Compute the deviation of wFields from a mean field solution
+      * Setup the preconditioner, if isPreconditioned is true.
       */
-      void computeDeviation();
+      void setup();
 
       /**
-      * Check if solution is converge within specified tolerance.
-      *
-      * \return true for error < epsilon and false for error >= epsilon
+      * Convert the new w fields from the basis to the r-grid.
       */
-      bool isConverged();
+      void convertWFields();
 
       /**
-      * Determine the coefficients that would minimize invertMatrix_ Umn
+      * Convert the computed c fields from the r-grid to the basis.
       */
-      void minimizeCoeff(int itr);
-
-      /**
-      * Rebuild wFields for the next iteration from minimized coefficients
-      */
-      void buildOmega(int itr);
+      void convertCFields();
 
    private:
 
-      /// Error tolerance
-      double epsilon_;
-
-      /// Flexible cell computation (1) or rigid (0), default value = 0
-      bool isFlexible_;
-
-      /// Free parameter for minimization
-      double lambda_;
-
-      /// Number of previous steps to use to compute next state. [0,maxHist_]
-      int nHist_;
-
-      // Number of histories to retain.
-      int maxHist_;
-
-      /// Maximum number of iterations to attempt.
-      int maxItr_;
-
-      // Work Array for iterating on parameters 
-      FSArray<double, 6> parameters;
+      /// Apply RPA preconditioner to deviations (1) or not (0), default 0
+      bool isPreconditioned_;
 
-      /// holds histories of deviation for each monomer
-      /// 1st index = history, 2nd index = monomer, 3rd index = ngrid
-      // The ringbuffer used is now slightly modified to return by reference
-      RingBuffer< DArray < DArray<double> > > devHists_;
-
-      RingBuffer< DArray < DArray<double> > > omHists_;
-
-      /// History of deviation for each cell parameter
-      /// 1st index = history, 2nd index = cell parameter
-      // The ringbuffer used is now slightly modified to return by reference
-      RingBuffer< FArray <double, 6> > devCpHists_;
-
-      RingBuffer< FSArray<double, 6> > CpHists_;
-
-      /// Umn, matrix to be minimized
-      DMatrix<double> invertMatrix_;
-
-      /// Cn, coefficient to convolute previous histories with
-      DArray<double> coeffs_;
-
-      DArray<double> vM_;
+      /// RPA preconditioner for deviations (used if isPreconditioned_)
+      RpaPreconditioner<D> preconditioner_;
 
       /// bigW, blended omega fields
       DArray<DArray <double> > wArrays_;
@@ -156,38 +110,19 @@ namespace Pspc
       /// bigD, blened deviation fields. new wFields = bigW + lambda * bigD
       DArray<DArray <double> > dArrays_;
 
-      /// bigWcP, blended parameter
-      FArray <double, 6> wCpArrays_;
-
-      /// bigDCp, blened deviation parameter. new wParameter = bigWCp + lambda * bigDCp
-      FArray <double, 6> dCpArrays_;
-
-      DArray< DArray<double> > tempDev;
-
+      using AmIteratorBase<D>::lambda_;
+      using AmIteratorBase<D>::nHist_;
+      using AmIteratorBase<D>::devHists_;
+      using AmIteratorBase<D>::omHists_;
+      using AmIteratorBase<D>::coeffs_;
+      using AmIteratorBase<D>::allocateHistories;
       using Iterator<D>::setClassName;
       using Iterator<D>::systemPtr_;
       using Iterator<D>::system;
-      using ParamComposite::read;
       using ParamComposite::readOptional;
 
-   //friend:
-   //for testing purposes
-
-
    };
 
-   template<int D>
-   inline double AmIterator<D>::epsilon()
-   { return epsilon_; }
-
-   template<int D>
-   inline int AmIterator<D>::maxHist()
-   { return maxHist_; }
-
-   template<int D>
-   inline int AmIterator<D>::maxItr()
-   { return maxItr_; }
-
    #ifndef PSPC_AM_ITERATOR_TPP
    // Suppress implicit instantiation
    extern template class AmIterator<1>;
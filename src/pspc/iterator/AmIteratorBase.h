@@ -0,0 +1,299 @@
+#ifndef PSPC_AM_ITERATOR_BASE_H
+#define PSPC_AM_ITERATOR_BASE_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <pspc/iterator/Iterator.h>     // base class
+#include <pspc/iterator/HistMat.h>      // member
+#include <pspc/iterator/HistoryArena.h> // member
+#include <pscf/math/LuSolver.h>         // member
+#include <util/containers/DArray.h>
+#include <util/containers/FArray.h>
+#include <util/containers/FSArray.h>
+#include <util/containers/DMatrix.h>
+#include <util/containers/RingBuffer.h>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /**
+   * Base class for Anderson mixing iterators.
+   *
+   * AmIteratorBase implements the Anderson mixing algorithm, including
+   * the iteration loop, histories of w fields and deviations, the
+   * matrix of inner products of deviations, the optimal mixing
+   * coefficients, the update of a flexible unit cell, the convergence
+   * test and checkpointing of the iterator state. The histories store
+   * nMonomer fields per iteration, in a representation chosen by the
+   * subclass, which implements the pure virtual functions storeOmega,
+   * computeResidual and mixOmega, and may override the functions that
+   * convert fields between representations.
+   *
+   * \ingroup Pspc_Iterator_Module
+   */
+   template <int D>
+   class AmIteratorBase : public Iterator<D>
+   {
+   public:
+
+      /**
+      * Constructor
+      *
+      * \param system pointer to a parent System object
+      */
+      AmIteratorBase(System<D>* system);
+
+      /**
+      * Destructor
+      */
+      virtual ~AmIteratorBase();
+
+      /**
+      * Read all parameters and initialize.
+      *
+      * \param in input filestream
+      */
+      virtual void readParameters(std::istream& in);
+
+      /**
+      * Iterate to a solution
+      */
+      int solve();
+
+      /**
+      * Return true, since this iterator can save and load its state.
+      */
+      bool canSaveState() const
+      {  return true; }
+
+      /**
+      * Save iteration history to a binary archive, for a checkpoint.
+      *
+      * \param ar output archive
+      */
+      void saveState(BinaryFileOArchive& ar);
+
+      /**
+      * Load iteration history saved by saveState.
+      *
+      * The next call to solve() resumes the saved iteration, and
+      * gives the same sequence of fields as an uninterrupted solve.
+      *
+      * \param ar input archive
+      */
+      void loadState(BinaryFileIArchive& ar);
+
+      /**
+      * Get epsilon (error threshhold).
+      */
+      double epsilon();
+
+      /**
+      * Get the maximum number of field histories retained.
+      */
+      int maxHist();
+
+      /**
+      * Get the maximum number of iteration before convergence.
+      */
+      int maxItr();
+
+      /**
+      * Compute the deviation of w fields from a mean field solution.
+      */
+      void computeDeviation();
+
+      /**
+      * Check if solution is converge within specified tolerance.
+      *
+      * \return true for error < epsilon and false for error >= epsilon
+      */
+      bool isConverged();
+
+      /**
+      * Determine the coefficients that would minimize invertMatrix_ Umn
+      */
+      void minimizeCoeff(int itr);
+
+      /**
+      * Rebuild w fields for the next iteration from minimized coefficients
+      */
+      void buildOmega(int itr);
+
+   protected:
+
+      /**
+      * Allocate histories and work space, after parameters are read.
+      *
+      * \param nField number of fields per history (nMonomer)
+      * \param devSize number of elements of each deviation field
+      * \param omSize number of elements of each omega field
+      */
+      void allocateHistories(int nField, int devSize, int omSize);
+
+      /**
+      * Copy the current w fields into a new omega history slot.
+      *
+      * \param om array of nMonomer pointers to the fields of the slot
+      */
+      virtual void storeOmega(double* const * om) = 0;
+
+      /**
+      * Compute the SCF residual into a new deviation history slot.
+      *
+      * \param dev array of nMonomer pointers to the fields of the slot
+      * \return maximum magnitude of the residual (before any scaling)
+      */
+      virtual double computeResidual(double* const * dev) = 0;
+
+      /**
+      * Set new w fields by mixing the stored histories.
+      *
+      * The new fields are bigW + lambda_*bigD, in which bigW and bigD
+      * are the most recent omega and deviation fields, plus coeffs_[i]
+      * times their differences from history i + 1, for i < nHist_.
+      */
+      virtual void mixOmega() = 0;
+
+      /**
+      * Setup data that depend on the unit cell or interaction.
+      *
+      * Called at the start of each solve and after each change of
+      * a flexible unit cell. The default implementation is empty.
+      */
+      virtual void setup()
+      {}
+
+      /**
+      * Convert new w fields to the r-grid before each MDE solution.
+      *
+      * The default implementation is empty.
+      */
+      virtual void convertWFields()
+      {}
+
+      /**
+      * Convert c fields from the r-grid after each MDE solution.
+      *
+      * The default implementation is empty.
+      */
+      virtual void convertCFields()
+      {}
+
+      /**
+      * Complete a successful solution, before timing output.
+      *
+      * The default implementation is empty.
+      */
+      virtual void finalize()
+      {}
+
+      /// Flexible cell computation (1) or rigid (0), default value = 0
+      bool isFlexible_;
+
+      /// Free parameter for minimization
+      double lambda_;
+
+      /// Number of previous steps to use to compute next state. [0,maxHist_]
+      int nHist_;
+
+      /// Holds histories of deviation for each monomer
+      /// 1st index = history, 2nd index = monomer, 3rd index = element
+      HistoryArena devHists_;
+
+      /// Holds histories of omega fields for each monomer
+      /// 1st index = history, 2nd index = monomer, 3rd index = element
+      HistoryArena omHists_;
+
+      /// Cn, coefficient to convolute previous histories with
+      /// (capacity maxHist_, leading nHist_ elements used)
+      DArray<double> coeffs_;
+
+      using Iterator<D>::systemPtr_;
+      using Iterator<D>::system;
+      using Iterator<D>::nIteration_;
+      using ParamComposite::read;
+      using ParamComposite::readOptional;
+
+   private:
+
+      /// Error tolerance
+      double epsilon_;
+
+      /// Maximum magnitude of the (unscaled) SCF residual
+      double scfError_;
+
+      // Number of histories to retain.
+      int maxHist_;
+
+      /// Maximum number of iterations to attempt.
+      int maxItr_;
+
+      /// Number of iterations since histories were last discarded.
+      int totalItr_;
+
+      /// Were histories loaded by loadState since the last solve?
+      bool isRestarted_;
+
+      // Work Array for iterating on parameters
+      FSArray<double, 6> parameters;
+
+      /// History of deviation for each cell parameter
+      /// 1st index = history, 2nd index = cell parameter
+      // The ringbuffer used is now slightly modified to return by reference
+      RingBuffer< FArray <double, 6> > devCpHists_;
+
+      /// History of cell parameters
+      RingBuffer< FSArray<double, 6> > CpHists_;
+
+      /// Inner products of stored deviations, updated incrementally
+      HistMat histMat_;
+
+      /// Umn, matrix to be minimized
+      /// (capacity maxHist_ x maxHist_, leading nHist_ block used)
+      DMatrix<double> invertMatrix_;
+
+      /// Vm, right hand side for coefficients
+      DArray<double> vM_;
+
+      /// Solver for coefficients, reused for all iterations
+      LuSolver solver_;
+
+      /// bigWcP, blended parameter
+      FArray <double, 6> wCpArrays_;
+
+      /// bigDCp, blened deviation parameter. new wParameter = bigWCp + lambda * bigDCp
+      FArray <double, 6> dCpArrays_;
+
+   };
+
+   template<int D>
+   inline double AmIteratorBase<D>::epsilon()
+   { return epsilon_; }
+
+   template<int D>
+   inline int AmIteratorBase<D>::maxHist()
+   { return maxHist_; }
+
+   template<int D>
+   inline int AmIteratorBase<D>::maxItr()
+   { return maxItr_; }
+
+   #ifndef PSPC_AM_ITERATOR_BASE_TPP
+   // Suppress implicit instantiation
+   extern template class AmIteratorBase<1>;
+   extern template class AmIteratorBase<2>;
+   extern template class AmIteratorBase<3>;
+   #endif
+
+}
+}
+#endif
@@ -0,0 +1,509 @@
+#ifndef PSPC_AM_ITERATOR_BASE_TPP
+#define PSPC_AM_ITERATOR_BASE_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "AmIteratorBase.h"
+#include <pspc/System.h>
+#include <util/archives/BinaryFileOArchive.h>
+#include <util/archives/BinaryFileIArchive.h>
+#include <util/format/Dbl.h>
+#include <util/misc/Timer.h>
+#include <cmath>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /*
+   * Constructor
+   */
+   template <int D>
+   AmIteratorBase<D>::AmIteratorBase(System<D>* system)
+    : Iterator<D>(system),
+      isFlexible_(0),
+      lambda_(0),
+      nHist_(0),
+      epsilon_(0),
+      scfError_(0),
+      maxHist_(0),
+      maxItr_(0),
+      totalItr_(0),
+      isRestarted_(false)
+   {}
+
+   /*
+   * Destructor
+   */
+   template <int D>
+   AmIteratorBase<D>::~AmIteratorBase()
+   {}
+
+   /*
+   * Read parameter file block.
+   */
+   template <int D>
+   void AmIteratorBase<D>::readParameters(std::istream& in)
+   {
+      isFlexible_ = 0; // default value (fixed cell)
+      read(in, "maxItr", maxItr_);
+      read(in, "epsilon", epsilon_);
+      read(in, "maxHist", maxHist_);
+      readOptional(in, "isFlexible", isFlexible_);
+   }
+
+   /*
+   * Allocate histories.
+   */
+   template <int D>
+   void AmIteratorBase<D>::allocateHistories(int nField, int devSize,
+                                             int omSize)
+   {
+      devHists_.allocate(maxHist_+1, nField, devSize);
+      omHists_.allocate(maxHist_+1, nField, omSize);
+      histMat_.allocate(maxHist_+1);
+
+      if (isFlexible_) {
+         devCpHists_.allocate(maxHist_+1);
+         CpHists_.allocate(maxHist_+1);
+      }
+
+      // Work space for the coefficients, used as leading nHist_ blocks
+      if (maxHist_ > 0) {
+         invertMatrix_.allocate(maxHist_, maxHist_);
+         coeffs_.allocate(maxHist_);
+         vM_.allocate(maxHist_);
+         solver_.allocate(maxHist_);
+      }
+   }
+
+   /*
+   * Solve iteratively.
+   */
+   template <int D>
+   int AmIteratorBase<D>::solve()
+   {
+      // Preconditions:
+      UTIL_CHECK(system().hasWFields());
+      // Assumes basis.makeBasis() has been called
+      // Assumes allocate() has been called
+      // TODO: Check these conditions on entry
+
+      Timer convertTimer;
+      Timer solverTimer;
+      Timer stressTimer;
+      Timer updateTimer;
+      Timer::TimePoint now;
+      bool done;
+
+      #if 0
+      // Convert from Basis to RGrid
+      convertTimer.start();
+      system().fieldIo().convertBasisToRGrid(system().wFields(),
+                                             system().wFieldsRGrid());
+      now = Timer::now();
+      convertTimer.stop(now);
+      #endif
+
+      // Discard histories left by any previous solve, unless they were
+      // loaded from a checkpoint, in which case continue from them
+      int itr0;
+      if (isRestarted_) {
+         itr0 = totalItr_;
+         isRestarted_ = false;
+      } else {
+         itr0 = 0;
+         totalItr_ = 0;
+         devHists_.clear();
+         omHists_.clear();
+         histMat_.clear();
+         if (isFlexible_) {
+            devCpHists_.clear();
+            CpHists_.clear();
+         }
+      }
+      if (isFlexible_) {
+         parameters = system().unitCell().parameters();
+      }
+
+      // Setup data that may have changed since the previous solve
+      setup();
+
+      // Solve MDE for initial state
+      solverTimer.start();
+      system().mixture().compute(system().wFieldsRGrid(),
+                                 system().cFieldsRGrid());
+      now = Timer::now();
+      solverTimer.stop(now);
+
+      convertTimer.start(now);
+      convertCFields();
+      now = Timer::now();
+      convertTimer.stop(now);
+
+      // Compute initial stress if needed
+      if (isFlexible_) {
+         stressTimer.start(now);
+         system().mixture().computeStress();
+         now = Timer::now();
+         stressTimer.stop(now);
+      }
+
+      // Iterative loop
+      for (int itr = itr0 + 1; itr <= itr0 + maxItr_; ++itr) {
+
+         nIteration_ = itr - itr0;
+         totalItr_ = itr;
+
+         updateTimer.start(now);
+
+         Log::file()<<"---------------------"<<std::endl;
+         Log::file()<<" Iteration  "<<itr<<std::endl;
+
+         if (itr <= maxHist_) {
+            lambda_ = 1.0 - pow(0.9, itr);
+            nHist_ = itr-1;
+         } else {
+            lambda_ = 1.0;
+            nHist_ = maxHist_;
+         }
+         computeDeviation();
+
+         // Test for convergence
+         done = isConverged();
+
+         if (done) {
+
+            now = Timer::now();
+            updateTimer.stop(now);
+            Log::file() << "----------CONVERGED----------"<< std::endl;
+
+            convertTimer.start(now);
+            finalize();
+            now = Timer::now();
+            convertTimer.stop(now);
+
+            // Output timing results
+            double updateTime = updateTimer.time();
+            double convertTime = convertTimer.time();
+            double solverTime = solverTimer.time();
+            double stressTime = 0.0;
+            double totalTime = updateTime + convertTime + solverTime;
+            if (isFlexible_) {
+               stressTime = stressTimer.time();
+               totalTime += stressTime;
+            }
+            Log::file() << "\n";
+            Log::file() << "Iterator times contributions:\n";
+            Log::file() << "\n";
+            Log::file() << "solver time  = " << solverTime  << " s,  "
+                        << solverTime/totalTime << "\n";
+            Log::file() << "stress time  = " << stressTime  << " s,  "
+                        << stressTime/totalTime << "\n";
+            Log::file() << "convert time = " << convertTime << " s,  "
+                        << convertTime/totalTime << "\n";
+            Log::file() << "update time  = "  << updateTime  << " s,  "
+                        << updateTime/totalTime << "\n";
+            Log::file() << "total time   = "  << totalTime   << " s  ";
+            Log::file() << "\n\n";
+
+            // If the unit cell is rigid, compute and output final stress
+            if (!isFlexible_) {
+               system().mixture().computeStress();
+               Log::file() << "Final stress:" << "\n";
+               for (int m=0; m<(systemPtr_->unitCell()).nParameter(); ++m){
+                  Log::file() << "Stress  "<< m << "   = "
+                              << Dbl(systemPtr_->mixture().stress(m))
+                              << "\n";
+               }
+               Log::file() << "\n";
+            }
+
+            // Successful completion (i.e., converged within tolerance)
+            return 0;
+
+         } else {
+
+            minimizeCoeff(itr);
+            buildOmega(itr);
+
+            now = Timer::now();
+            updateTimer.stop(now);
+
+            convertTimer.start(now);
+            convertWFields();
+            now = Timer::now();
+            convertTimer.stop(now);
+
+            // Solve MDE
+            solverTimer.start(now);
+            system().mixture().compute(system().wFieldsRGrid(),
+                                       system().cFieldsRGrid());
+            now = Timer::now();
+            solverTimer.stop(now);
+
+            // Compute stress if needed
+            if (isFlexible_){
+               stressTimer.start(now);
+               system().mixture().computeStress();
+               now = Timer::now();
+               stressTimer.stop(now);
+            }
+
+            convertTimer.start(now);
+            convertCFields();
+            now = Timer::now();
+            convertTimer.stop(now);
+
+         }
+
+      }
+
+      // Failure: iteration counter itr reached maxItr without converging
+      return 1;
+   }
+
+   /*
+   * Save iteration count and all histories.
+   */
+   template <int D>
+   void AmIteratorBase<D>::saveState(BinaryFileOArchive& ar)
+   {
+      ar & totalItr_;
+      ar & devHists_;
+      ar & omHists_;
+      ar & histMat_;
+      if (isFlexible_) {
+         int nParameter = system().unitCell().nParameter();
+         int n = CpHists_.size();
+         UTIL_CHECK(devCpHists_.size() == n);
+         ar & n;
+         int k, m;
+         for (k = n - 1; k >= 0; --k) {
+            for (m = 0; m < nParameter; ++m) {
+               ar & CpHists_[k][m];
+               ar & devCpHists_[k][m];
+            }
+         }
+      }
+   }
+
+   /*
+   * Load iteration count and all histories, to resume iteration.
+   */
+   template <int D>
+   void AmIteratorBase<D>::loadState(BinaryFileIArchive& ar)
+   {
+      ar & totalItr_;
+      ar & devHists_;
+      ar & omHists_;
+      ar & histMat_;
+      if (isFlexible_) {
+         int nParameter = system().unitCell().nParameter();
+         int n;
+         ar & n;
+         UTIL_CHECK(n <= CpHists_.capacity());
+         devCpHists_.clear();
+         CpHists_.clear();
+         FSArray<double, 6> cp;
+         FArray<double, 6> devCp;
+         double value;
+         int k, m;
+         for (k = n - 1; k >= 0; --k) {
+            cp.clear();
+            for (m = 0; m < nParameter; ++m) {
+               ar & value;
+               cp.append(value);
+               ar & devCp[m];
+            }
+            CpHists_.append(cp);
+            devCpHists_.append(devCp);
+         }
+      }
+      isRestarted_ = true;
+   }
+
+   template <int D>
+   void AmIteratorBase<D>::computeDeviation()
+   {
+      // Copy current omega fields into a new history slot, in place
+      storeOmega(omHists_.advance());
+
+      if (isFlexible_) {
+         CpHists_.append((systemPtr_->unitCell()).parameters());
+      }
+
+      // Compute new deviation directly in a new history slot
+      scfError_ = computeResidual(devHists_.advance());
+
+      if (isFlexible_){
+         FArray<double, 6 > tempCp;
+         for (int i = 0; i<(systemPtr_->unitCell()).nParameter() ; i++){
+            tempCp [i] = -((systemPtr_->mixture()).stress(i));
+         }
+         devCpHists_.append(tempCp);
+      }
+
+      // Compute inner products of the new deviation with all stored
+      // deviations. Products among older deviations are retained.
+      // Sums are accumulated in extended precision because elements of
+      // the AM matrix are later formed as differences of these values.
+      histMat_.advance();
+      UTIL_CHECK(histMat_.size() == devHists_.size());
+      int nField = devHists_.nField();
+      int fieldSize = devHists_.fieldSize();
+      long double elm;
+      for (int i = 0; i < histMat_.size(); ++i) {
+         elm = 0.0;
+         for (int k = 0; k < nField; ++k) {
+            double const * dev0 = devHists_[0][k];
+            double const * devI = devHists_[i][k];
+            for (int l = 0; l < fieldSize; ++l) {
+               elm += dev0[l]*devI[l];
+            }
+         }
+         if (isFlexible_) {
+            int nParameter = systemPtr_->unitCell().nParameter();
+            for (int m = 0; m < nParameter; ++m) {
+               elm += devCpHists_[0][m]*devCpHists_[i][m];
+            }
+         }
+         histMat_.setInnerProduct(i, (double)elm);
+      }
+   }
+
+   template <int D>
+   bool AmIteratorBase<D>::isConverged()
+   {
+      double error;
+
+      #if 0
+      // Error as defined in Matsen's Papers
+      double dError = 0;
+      double wError = 0;
+      for ( int i = 0; i < systemPtr_->mixture().nMonomer(); i++) {
+         for ( int j = 0; j < systemPtr_->basis().nStar() - 1; j++) {
+            dError += devHists_[0][i][j] * devHists_[0][i][j];
+
+            //the extra shift is due to the zero indice coefficient being
+            //exactly known
+            wError += systemPtr_->wField(i)[j+1] * systemPtr_->wField(i)[j+1];
+         }
+      }
+
+      if (isFlexible_){
+         for ( int i = 0; i < (systemPtr_->unitCell()).nParameter() ; i++) {
+            dError +=  devCpHists_[0][i] *  devCpHists_[0][i];
+            wError +=  (systemPtr_->unitCell()).parameters() [i] * (systemPtr_->unitCell()).parameters() [i];
+         }
+      }
+      Log::file() << " dError :" << Dbl(dError)<<std::endl;
+      Log::file() << " wError :" << Dbl(wError)<<std::endl;
+      error = sqrt(dError / wError);
+      #endif
+
+      // Error by Max Residuals (computed before any preconditioning)
+      double temp1 = scfError_;
+      double temp2 = 0;
+      Log::file() << "SCF Error   = " << Dbl(temp1) << std::endl;
+      error = temp1;
+
+      if (isFlexible_){
+         for ( int i = 0; i < (systemPtr_->unitCell()).nParameter() ; i++) {
+            if (temp2 < fabs (devCpHists_[0][i]))
+                temp2 = fabs (devCpHists_[0][i]);
+         }
+         // Output current stress values
+         for (int m=0; m<(systemPtr_->unitCell()).nParameter() ; ++m){
+            Log::file() << "Stress  "<< m << "   = "
+                        << Dbl(systemPtr_->mixture().stress(m)) <<"\n";
+         }
+         error = (temp1>(100*temp2)) ? temp1 : (100*temp2);
+         // 100 is chose as stress rescale factor
+         // TODO: Separate SCF and stress tolerance limits
+      }
+      Log::file() << "Error       = " << Dbl(error) << std::endl;
+
+      // Output current unit cell parameter values
+      if (isFlexible_){
+         for (int m=0; m<(systemPtr_->unitCell()).nParameter() ; ++m){
+               Log::file() << "Parameter " << m << " = "
+                           << Dbl((systemPtr_->unitCell()).parameters()[m])
+                           << "\n";
+         }
+      }
+
+      // Check if total error is below tolerance
+      if (error < epsilon_) {
+         return true;
+      } else {
+         return false;
+      }
+   }
+
+   template <int D>
+   void AmIteratorBase<D>::minimizeCoeff(int itr)
+   {
+      if (nHist_ == 0) {
+         //do nothing
+      } else {
+
+         // Construct Umn and Vm from inner products of deviations,
+         // which are updated incrementally by computeDeviation
+         UTIL_CHECK(nHist_ < histMat_.size());
+         for (int i = 0; i < nHist_; ++i) {
+            for (int j = i; j < nHist_; ++j) {
+               invertMatrix_(i,j) = histMat_.makeUmn(i, j);
+               invertMatrix_(j,i) = invertMatrix_(i,j);
+            }
+            vM_[i] = histMat_.makeVm(i);
+         }
+
+         if (nHist_ == 1) {
+            coeffs_[0] = vM_[0] / invertMatrix_(0,0);
+         } else {
+            solver_.computeLU(invertMatrix_, nHist_);
+            solver_.solve(vM_, coeffs_);
+         }
+      }
+   }
+
+   template <int D>
+   void AmIteratorBase<D>::buildOmega(int itr)
+   {
+      // New w fields, from the histories and coefficients
+      mixOmega();
+
+      // New unit cell parameters, mixed in the same way
+      if (isFlexible_){
+         UnitCell<D> const & unitCell = systemPtr_->unitCell();
+         for (int m = 0; m < unitCell.nParameter() ; ++m){
+            wCpArrays_[m] = CpHists_[0][m];
+            dCpArrays_[m] = devCpHists_[0][m];
+         }
+         for (int i = 0; i < nHist_; ++i) {
+            for (int m = 0; m < unitCell.nParameter() ; ++m) {
+               wCpArrays_[m] += coeffs_[i]*( CpHists_[i+1][m] -
+                                             CpHists_[0][m]);
+               dCpArrays_[m] += coeffs_[i]*( devCpHists_[i+1][m] -
+                                             devCpHists_[0][m]);
+            }
+         }
+         for (int m = 0; m < unitCell.nParameter() ; ++m){
+            parameters [m] = wCpArrays_[m] + lambda_ * dCpArrays_[m];
+         }
+         systemPtr_->setUnitCell(parameters);
+         setup();
+      }
+   }
+
+}
+}
+#endif
@@ -0,0 +1,121 @@
+#ifndef PSPC_AM_ITERATOR_GRID_H
+#define PSPC_AM_ITERATOR_GRID_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <pspc/iterator/AmIteratorBase.h> // base class
+#include <util/containers/DArray.h>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /**
+   * Anderson mixing iterator that operates on real-space grid fields.
+   *
+   * This iterator mixes the w fields stored on the real-space grid,
+   * System::wFieldsRGrid(), rather than their components in the
+   * symmetry-adapted basis, and thus does not convert fields between
+   * grid and basis representations during iteration. It does not
+   * impose space group symmetry. The deviation for each monomer type
+   * is the real-space residual of the SCF equations, with its spatial
+   * average subtracted, so that the average of each w field remains
+   * equal to its initial value. The error is the maximum magnitude of
+   * the residual over all grid points.
+   *
+   * Upon convergence, the final w and c fields are converted to the
+   * symmetry-adapted basis, as required to compute the free energy.
+   * Fields with no known symmetry may be treated by using the space
+   * group P_1.
+   *
+   * The parameter file block has the same format as that of an
+   * AmIterator, with block label AmIteratorGrid.
+   *
+   * \ingroup Pspc_Iterator_Module
+   */
+   template <int D>
+   class AmIteratorGrid : public AmIteratorBase<D>
+   {
+   public:
+
+      /**
+      * Constructor
+      *
+      * \param system pointer to a parent System object
+      */
+      AmIteratorGrid(System<D>* system);
+
+      /**
+      * Destructor
+      */
+      ~AmIteratorGrid();
+
+      /**
+      * Allocate all arrays
+      */
+      void allocate();
+
+   protected:
+
+      /**
+      * Copy the w fields on the r-grid.
+      *
+      * \param om array of nMonomer pointers to the fields of the slot
+      */
+      void storeOmega(double* const * om);
+
+      /**
+      * Compute the residual on the r-grid, with averages removed.
+      *
+      * \param dev array of nMonomer pointers to the fields of the slot
+      * \return maximum magnitude of the residual
+      */
+      double computeResidual(double* const * dev);
+
+      /**
+      * Set new w fields on the r-grid by mixing histories.
+      */
+      void mixOmega();
+
+      /**
+      * Convert the final w and c fields to the symmetry-adapted basis.
+      */
+      void finalize();
+
+   private:
+
+      /// bigW, blended omega fields (all monomers, contiguous)
+      DArray<double> wArray_;
+
+      /// bigD, blened deviation fields. new wFields = bigW + lambda * bigD
+      DArray<double> dArray_;
+
+      using AmIteratorBase<D>::lambda_;
+      using AmIteratorBase<D>::nHist_;
+      using AmIteratorBase<D>::devHists_;
+      using AmIteratorBase<D>::omHists_;
+      using AmIteratorBase<D>::coeffs_;
+      using AmIteratorBase<D>::allocateHistories;
+      using Iterator<D>::setClassName;
+      using Iterator<D>::systemPtr_;
+      using Iterator<D>::system;
+
+   };
+
+   #ifndef PSPC_AM_ITERATOR_GRID_TPP
+   // Suppress implicit instantiation
+   extern template class AmIteratorGrid<1>;
+   extern template class AmIteratorGrid<2>;
+   extern template class AmIteratorGrid<3>;
+   #endif
+
+}
+}
+#endif
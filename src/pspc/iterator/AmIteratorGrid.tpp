@@ -0,0 +1,177 @@
+#ifndef PSPC_AM_ITERATOR_GRID_TPP
+#define PSPC_AM_ITERATOR_GRID_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "AmIteratorGrid.h"
+#include <pspc/System.h>
+#include <pscf/inter/ChiInteraction.h>
+#include <pscf/math/fieldKernels.h>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /*
+   * Constructor
+   */
+   template <int D>
+   AmIteratorGrid<D>::AmIteratorGrid(System<D>* system)
+    : AmIteratorBase<D>(system)
+   {  setClassName("AmIteratorGrid"); }
+
+   /*
+   * Destructor
+   */
+   template <int D>
+   AmIteratorGrid<D>::~AmIteratorGrid()
+   {}
+
+   /*
+   * Allocate memory required by iterator.
+   */
+   template <int D>
+   void AmIteratorGrid<D>::allocate()
+   {
+      int nMonomer = systemPtr_->mixture().nMonomer();
+      int meshSize = systemPtr_->mesh().size();
+      allocateHistories(nMonomer, meshSize, meshSize);
+
+      wArray_.allocate(nMonomer*meshSize);
+      dArray_.allocate(nMonomer*meshSize);
+   }
+
+   /*
+   * Copy current w fields on the grid. Fields of a history slot are
+   * contiguous, as are those of a contiguous block.
+   */
+   template <int D>
+   void AmIteratorGrid<D>::storeOmega(double* const * omNew)
+   {
+      int nMonomer = systemPtr_->mixture().nMonomer();
+      int meshSize = systemPtr_->mesh().size();
+      RFieldBlock<D> const & wBlock = systemPtr_->wFieldsRGridBlock();
+      if (wBlock.isContiguous()) {
+         copyField(wBlock.data().cField(), omNew[0], nMonomer*meshSize);
+      } else {
+         for (int i = 0; i < nMonomer; ++i) {
+            copyField(wBlock[i].cField(), omNew[i], meshSize);
+         }
+      }
+   }
+
+   /*
+   * Compute residuals on the grid, with spatial averages removed.
+   */
+   template <int D>
+   double AmIteratorGrid<D>::computeResidual(double* const * devNew)
+   {
+      int nMonomer = systemPtr_->mixture().nMonomer();
+      int meshSize = systemPtr_->mesh().size();
+      double chi, idemp, average;
+      for (int i = 0; i < nMonomer; ++i) {
+         double* dev = devNew[i];
+         for (int k = 0; k < meshSize; ++k) {
+            dev[k] = 0.0;
+         }
+         for (int j = 0; j < nMonomer; ++j) {
+            chi = systemPtr_->interaction().chi(i,j);
+            idemp = systemPtr_->interaction().idemp(i,j);
+            RField<D> const & cField = systemPtr_->cFieldRGrid(j);
+            RField<D> const & wField = systemPtr_->wFieldRGrid(j);
+            for (int k = 0; k < meshSize; ++k) {
+               dev[k] += chi*cField[k] - idemp*wField[k];
+            }
+         }
+         average = 0.0;
+         for (int k = 0; k < meshSize; ++k) {
+            average += dev[k];
+         }
+         average /= double(meshSize);
+         for (int k = 0; k < meshSize; ++k) {
+            dev[k] -= average;
+         }
+      }
+
+      // Maximum residual over all grid points
+      double scfError = 0.0;
+      double error;
+      for (int i = 0; i < nMonomer; i++) {
+         error = maxAbsField(devNew[i], meshSize);
+         if (scfError < error) {
+            scfError = error;
+         }
+      }
+      return scfError;
+   }
+
+   /*
+   * Mix histories on the grid to obtain new w fields.
+   */
+   template <int D>
+   void AmIteratorGrid<D>::mixOmega()
+   {
+      int nMonomer = systemPtr_->mixture().nMonomer();
+      int meshSize = systemPtr_->mesh().size();
+
+      // Blended fields bigW and bigD, for all monomers. History slots 
+      // are contiguous, so each update is applied to all monomer fields
+      // of a slot at once.
+      int n = nMonomer*meshSize;
+      double const * w;
+      double const * d;
+      if (nHist_ == 0) {
+         w = omHists_[0][0];
+         d = devHists_[0][0];
+      } else {
+         double const * om0 = omHists_[0][0];
+         double const * dev0 = devHists_[0][0];
+         copyField(om0, wArray_.cArray(), n);
+         copyField(dev0, dArray_.cArray(), n);
+         for (int i = 0; i < nHist_; ++i) {
+            axpyDiffField(coeffs_[i], omHists_[i+1][0], om0, 
+                          wArray_.cArray(), n);
+            axpyDiffField(coeffs_[i], devHists_[i+1][0], dev0, 
+                          dArray_.cArray(), n);
+         }
+         w = wArray_.cArray();
+         d = dArray_.cArray();
+      }
+
+      // New w fields = bigW + lambda * bigD
+      RFieldBlock<D>& wBlock = systemPtr_->wFieldsRGridBlock();
+      if (wBlock.isContiguous()) {
+         copyField(w, wBlock.data().cField(), n);
+         axpyField(lambda_, d, wBlock.data().cField(), n);
+      } else {
+         for (int i = 0; i < nMonomer; ++i) {
+            copyField(w + i*meshSize, wBlock[i].cField(), meshSize);
+            axpyField(lambda_, d + i*meshSize, wBlock[i].cField(), 
+                      meshSize);
+         }
+      }
+   }
+
+   /*
+   * Convert final fields to the symmetry-adapted basis.
+   */
+   template <int D>
+   void AmIteratorGrid<D>::finalize()
+   {
+      FieldIo<D>& fieldIo = system().fieldIo();
+      fieldIo.convertRGridToBasis(system().wFieldsRGridBlock(),
+                                  system().wFields());
+      fieldIo.convertRGridToBasis(system().cFieldsRGridBlock(),
+                                  system().cFields());
+   }
+
+}
+}
+#endif
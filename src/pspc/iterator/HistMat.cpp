@@ -0,0 +1,86 @@
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "HistMat.h"
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /*
+   * Constructor.
+   */
+   HistMat::HistMat()
+    : matrix_(),
+      size_(0),
+      capacity_(0)
+   {}
+
+   /*
+   * Destructor.
+   */
+   HistMat::~HistMat()
+   {}
+
+   /*
+   * Allocate memory.
+   */
+   void HistMat::allocate(int capacity)
+   {
+      UTIL_CHECK(capacity > 0);
+      matrix_.allocate(capacity, capacity);
+      capacity_ = capacity;
+      clear();
+   }
+
+   /*
+   * Discard all stored values.
+   */
+   void HistMat::clear()
+   {
+      for (int i = 0; i < capacity_; ++i) {
+         for (int j = 0; j < capacity_; ++j) {
+            matrix_(i, j) = 0.0;
+         }
+      }
+      size_ = 0;
+   }
+
+   /*
+   * Shift element (i, j) to (i+1, j+1), discarding the oldest residual.
+   */
+   void HistMat::advance()
+   {
+      UTIL_CHECK(capacity_ > 0);
+      if (size_ < capacity_) {
+         ++size_;
+      }
+      for (int i = size_ - 1; i > 0; --i) {
+         for (int j = size_ - 1; j > 0; --j) {
+            matrix_(i, j) = matrix_(i - 1, j - 1);
+         }
+      }
+      for (int i = 0; i < size_; ++i) {
+         matrix_(0, i) = 0.0;
+         matrix_(i, 0) = 0.0;
+      }
+   }
+
+   /*
+   * Set the inner product of the newest residual with residual i.
+   */
+   void HistMat::setInnerProduct(int i, double value)
+   {
+      UTIL_CHECK(i >= 0 && i < size_);
+      matrix_(0, i) = value;
+      matrix_(i, 0) = value;
+   }
+
+}
+}
@@ -0,0 +1,190 @@
+#ifndef PSPC_HIST_MAT_H
+#define PSPC_HIST_MAT_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <util/containers/DMatrix.h>      // member template
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /**
+   * Matrix of inner products of residual histories, for Anderson mixing.
+   *
+   * A HistMat stores the inner products (d_i, d_j) of the residual 
+   * vectors d_i of up to capacity() previous iterations, in which index
+   * 0 denotes the most recent. When a new residual is added, advance()
+   * shifts all existing elements to the next older index, and only the 
+   * row of inner products of the new residual with itself and the older
+   * residuals must then be set by setInnerProduct(). The Anderson mixing
+   * matrix U and vector V are then constructed from the stored values by
+   * makeUmn() and makeVm().
+   *
+   * \ingroup Pspc_Iterator_Module
+   */
+   class HistMat 
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      */
+      HistMat();
+
+      /**
+      * Destructor.
+      */
+      ~HistMat();
+
+      /**
+      * Allocate memory. 
+      *
+      * \param capacity maximum number of stored residuals (maxHist + 1)
+      */
+      void allocate(int capacity);
+
+      /**
+      * Discard all stored values.
+      */
+      void clear();
+
+      /**
+      * Shift stored values to make room for a new most recent residual.
+      *
+      * Values for the oldest residual are discarded if the matrix is
+      * full. The inner products in row 0 must then be set by calling
+      * setInnerProduct(i, value) for all 0 <= i < size().
+      */
+      void advance();
+
+      /**
+      * Set the inner product of the newest residual with residual i.
+      *
+      * \param i  index of older residual (0 for the newest)
+      * \param value  inner product (d_0, d_i)
+      */
+      void setInnerProduct(int i, double value);
+
+      /**
+      * Get the stored inner product (d_i, d_j).
+      *
+      * \param i  index of first residual
+      * \param j  index of second residual
+      */
+      double innerProduct(int i, int j) const;
+
+      /**
+      * Compute element U_mn = (d_0 - d_{m+1}, d_0 - d_{n+1}).
+      *
+      * \param m  row index, 0 <= m < size() - 1
+      * \param n  column index, 0 <= n < size() - 1
+      */
+      double makeUmn(int m, int n) const;
+
+      /**
+      * Compute element V_m = (d_0 - d_{m+1}, d_0).
+      *
+      * \param m  index, 0 <= m < size() - 1
+      */
+      double makeVm(int m) const;
+
+      /**
+      * Number of residuals for which inner products are stored.
+      */
+      int size() const;
+
+      /**
+      * Maximum number of stored residuals.
+      */
+      int capacity() const;
+
+      /**
+      * Serialize capacity and stored inner products to/from an archive.
+      *
+      * An unallocated matrix is allocated when loading. An allocated
+      * matrix must have the same capacity as the saved one.
+      *
+      * \param ar       archive
+      * \param version  archive version id
+      */
+      template <class Archive>
+      void serialize(Archive& ar, const unsigned int version);
+
+   private:
+
+      /// Symmetric matrix of inner products.
+      DMatrix<double> matrix_;
+
+      /// Number of residuals stored.
+      int size_;
+
+      /// Maximum number of residuals.
+      int capacity_;
+
+   };
+
+   // Inline member functions
+
+   inline 
+   double HistMat::innerProduct(int i, int j) const
+   {  return matrix_(i, j); }
+
+   inline 
+   double HistMat::makeUmn(int m, int n) const
+   {
+      return matrix_(0, 0) + matrix_(m + 1, n + 1) 
+           - matrix_(0, m + 1) - matrix_(0, n + 1);
+   }
+
+   inline 
+   double HistMat::makeVm(int m) const
+   {  return matrix_(0, 0) - matrix_(0, m + 1); }
+
+   inline 
+   int HistMat::size() const
+   {  return size_; }
+
+   inline 
+   int HistMat::capacity() const
+   {  return capacity_; }
+
+   /*
+   * Serialize a HistMat to/from an Archive.
+   */
+   template <class Archive>
+   void HistMat::serialize(Archive& ar, const unsigned int version)
+   {
+      int capacity;
+      if (Archive::is_saving()) {
+         capacity = capacity_;
+      }
+      ar & capacity;
+      if (Archive::is_loading()) {
+         if (!matrix_.isAllocated()) {
+            allocate(capacity);
+         } else {
+            if (capacity != capacity_) {
+               UTIL_THROW("Inconsistent HistMat capacities");
+            }
+         }
+      }
+      ar & size_;
+      for (int i = 0; i < capacity_; ++i) {
+         for (int j = 0; j < capacity_; ++j) {
+            ar & matrix_(i, j);
+         }
+      }
+   }
+
+}
+}
+#endif
@@ -0,0 +1,80 @@
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "HistoryArena.h"
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /*
+   * Constructor.
+   */
+   HistoryArena::HistoryArena()
+    : data_(),
+      fields_(),
+      head_(0),
+      size_(0),
+      capacity_(0),
+      nField_(0),
+      fieldSize_(0)
+   {}
+
+   /*
+   * Destructor.
+   */
+   HistoryArena::~HistoryArena()
+   {}
+
+   /*
+   * Allocate memory and set up field pointers.
+   */
+   void HistoryArena::allocate(int capacity, int nField, int fieldSize)
+   {
+      UTIL_CHECK(!isAllocated());
+      UTIL_CHECK(capacity > 0);
+      UTIL_CHECK(nField > 0);
+      UTIL_CHECK(fieldSize > 0);
+      capacity_ = capacity;
+      nField_ = nField;
+      fieldSize_ = fieldSize;
+      data_.allocate(capacity*nField*fieldSize);
+      fields_.allocate(capacity*nField);
+      double* ptr = data_.cArray();
+      for (int i = 0; i < capacity*nField; ++i) {
+         fields_[i] = ptr;
+         ptr += fieldSize;
+      }
+      clear();
+   }
+
+   /*
+   * Discard all histories.
+   */
+   void HistoryArena::clear()
+   {
+      head_ = 0;
+      size_ = 0;
+   }
+
+   /*
+   * Rotate the ring, making the oldest (or an unused) slot the newest.
+   */
+   double* const * HistoryArena::advance()
+   {
+      UTIL_CHECK(capacity_ > 0);
+      head_ = (head_ == 0) ? capacity_ - 1 : head_ - 1;
+      if (size_ < capacity_) {
+         ++size_;
+      }
+      return &fields_[head_*nField_];
+   }
+
+}
+}
@@ -0,0 +1,212 @@
+#ifndef PSPC_HISTORY_ARENA_H
+#define PSPC_HISTORY_ARENA_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <util/containers/DArray.h>      // member template
+#include <util/global.h>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /**
+   * Preallocated ring buffer of field histories, for Anderson mixing.
+   *
+   * A HistoryArena stores up to capacity() previous values of a set of
+   * nField() fields, each an array of fieldSize() doubles, in a single
+   * contiguous block of memory that is allocated once. Index 0 denotes 
+   * the most recent history slot, as for a RingBuffer. Calling advance() 
+   * rotates the ring so that the oldest slot (or an unused slot, if the 
+   * arena is not yet full) becomes slot 0, and returns pointers to its 
+   * fields, which the caller then overwrites in place. No data is copied
+   * or allocated after allocate() has been called.
+   *
+   * The expression arena[i][k][l] gives element l of field k in slot i.
+   *
+   * \ingroup Pspc_Iterator_Module
+   */
+   class HistoryArena 
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      */
+      HistoryArena();
+
+      /**
+      * Destructor.
+      */
+      ~HistoryArena();
+
+      /**
+      * Allocate memory.
+      *
+      * \param capacity maximum number of history slots
+      * \param nField number of fields per slot (e.g., nMonomer)
+      * \param fieldSize number of elements per field
+      */
+      void allocate(int capacity, int nField, int fieldSize);
+
+      /**
+      * Discard all stored histories (without deallocating memory).
+      */
+      void clear();
+
+      /**
+      * Rotate the ring to make a new most recent slot. 
+      *
+      * The contents of the returned slot are undefined (i.e., they 
+      * may hold the discarded oldest history) and must be overwritten
+      * by the caller.
+      *
+      * \return array of nField() pointers to the fields of slot 0
+      */
+      double* const * advance();
+
+      /**
+      * Get the fields of a history slot.
+      *
+      * \param i  history index (0 for the most recent)
+      * \return array of nField() pointers to the fields of slot i
+      */
+      double* const * operator [] (int i) const;
+
+      /**
+      * Number of history slots in use.
+      */
+      int size() const;
+
+      /**
+      * Maximum number of history slots.
+      */
+      int capacity() const;
+
+      /**
+      * Number of fields per history slot.
+      */
+      int nField() const;
+
+      /**
+      * Number of elements per field.
+      */
+      int fieldSize() const;
+
+      /**
+      * Is this arena allocated?
+      */
+      bool isAllocated() const;
+
+      /**
+      * Serialize dimensions and stored histories to/from an archive.
+      *
+      * An unallocated arena is allocated when loading. An allocated
+      * arena must have the same dimensions as the saved one.
+      *
+      * \param ar       archive
+      * \param version  archive version id
+      */
+      template <class Archive>
+      void serialize(Archive& ar, const unsigned int version);
+
+   private:
+
+      /// Contiguous storage for all fields of all slots.
+      DArray<double> data_;
+
+      /// Pointers to fields, nField_ consecutive pointers per slot.
+      DArray<double*> fields_;
+
+      /// Physical index of the most recent slot.
+      int head_;
+
+      /// Number of slots in use.
+      int size_;
+
+      /// Maximum number of slots.
+      int capacity_;
+
+      /// Number of fields per slot.
+      int nField_;
+
+      /// Number of elements per field.
+      int fieldSize_;
+
+   };
+
+   // Inline member functions
+
+   inline 
+   double* const * HistoryArena::operator [] (int i) const
+   {
+      UTIL_ASSERT(i >= 0 && i < size_);
+      int slot = head_ + i;
+      if (slot >= capacity_) slot -= capacity_;
+      return &fields_[slot*nField_];
+   }
+
+   inline 
+   int HistoryArena::size() const
+   {  return size_; }
+
+   inline 
+   int HistoryArena::capacity() const
+   {  return capacity_; }
+
+   inline 
+   int HistoryArena::nField() const
+   {  return nField_; }
+
+   inline 
+   int HistoryArena::fieldSize() const
+   {  return fieldSize_; }
+
+   inline 
+   bool HistoryArena::isAllocated() const
+   {  return data_.isAllocated(); }
+
+   /*
+   * Serialize a HistoryArena to/from an Archive.
+   */
+   template <class Archive>
+   void HistoryArena::serialize(Archive& ar, const unsigned int version)
+   {
+      int capacity, nField, fieldSize;
+      if (Archive::is_saving()) {
+         capacity = capacity_;
+         nField = nField_;
+         fieldSize = fieldSize_;
+      }
+      ar & capacity;
+      ar & nField;
+      ar & fieldSize;
+      if (Archive::is_loading()) {
+         if (!isAllocated()) {
+            allocate(capacity, nField, fieldSize);
+         } else {
+            if (capacity != capacity_ || nField != nField_ 
+                || fieldSize != fieldSize_) {
+               UTIL_THROW("Inconsistent HistoryArena dimensions");
+            }
+         }
+      }
+      ar & head_;
+      ar & size_;
+      int n = capacity_*nField_*fieldSize_;
+      for (int i = 0; i < n; ++i) {
+         ar & data_[i];
+      }
+   }
+
+}
+}
+#endif
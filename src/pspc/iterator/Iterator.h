@@ -11,6 +11,11 @@
 #include <util/param/ParamComposite.h>    // base class
 #include <util/global.h>                  
 
+namespace Util {
+   class BinaryFileOArchive;
+   class BinaryFileIArchive;
+}
+
 namespace Pscf {
 namespace Pspc
 {
@@ -43,6 +48,11 @@ namespace Pspc
       */
       ~Iterator();
 
+      /**
+      * Allocate all required memory, after parameters are read.
+      */
+      virtual void allocate() = 0;
+
       /**
       * Iterate to solution.
       *
@@ -50,11 +60,56 @@ namespace Pspc
       */
       virtual int solve() = 0;
 
+      /**
+      * Can this iterator save and load its state for a checkpoint?
+      *
+      * The default implementation returns false. Subclasses that
+      * override saveState and loadState should also override this
+      * function to return true. System::writeCheckpoint and 
+      * System::readCheckpoint throw an Exception if it is false.
+      */
+      virtual bool canSaveState() const
+      {  return false; }
+
+      /**
+      * Save internal state to a binary archive, for a checkpoint.
+      *
+      * The default implementation saves nothing. Subclasses that keep
+      * a history of previous iterations should override this function,
+      * loadState and canSaveState, so that an iteration can be resumed
+      * exactly.
+      *
+      * \param ar output archive
+      */
+      virtual void saveState(BinaryFileOArchive& ar)
+      {}
+
+      /**
+      * Load internal state saved by saveState.
+      *
+      * The next call to solve() then continues the saved iteration,
+      * rather than beginning a new one. The default implementation 
+      * loads nothing.
+      *
+      * \param ar input archive
+      */
+      virtual void loadState(BinaryFileIArchive& ar)
+      {}
+
+      /**
+      * Get the number of iterations used by the most recent solve().
+      */
+      int nIteration() const
+      {  return nIteration_; }
+
    protected:
 
       /// Pointer to parent System object
       System<D>* systemPtr_;
 
+      /// Number of iterations in the most recent solve (set by subclass)
+      int nIteration_;
+
       System<D>& system() 
       {  return *systemPtr_; }
 
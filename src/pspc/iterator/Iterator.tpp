@@ -15,7 +15,8 @@ namespace Pspc
 
    template<int D>
    Iterator<D>::Iterator(System<D>* system)
-    : systemPtr_(system)
+    : systemPtr_(system),
+      nIteration_(0)
    {  setClassName("Iterator"); }
 
    template<int D>
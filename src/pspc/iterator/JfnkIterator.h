@@ -0,0 +1,237 @@
+#ifndef PSPC_JFNK_ITERATOR_H
+#define PSPC_JFNK_ITERATOR_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <pspc/iterator/Iterator.h> // base class
+#include <util/containers/DArray.h>
+#include <util/containers/DMatrix.h>
+#include <util/containers/FSArray.h>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /**
+   * Jacobian-free Newton-Krylov iterator for the pseudo spectral method.
+   *
+   * The unknowns are the components of the w fields in the symmetry
+   * adapted basis, excluding the spatially homogeneous component, and
+   * (for a flexible unit cell) the unit cell parameters. The residuals
+   * are the corresponding SCF deviations, as in AmIterator, and the
+   * stress components for a flexible cell.
+   *
+   * Each Newton step solves the linear system J dx = -F approximately
+   * by restarted GMRES, to a relative accuracy eta = min(0.1, |F|), in
+   * which products of the Jacobian J with a vector v are approximated by
+   * the forward difference [F(x + h v) - F(x)]/h. Each such product thus
+   * requires one solution of the modified diffusion equation. The step
+   * is shortened by backtracking if it does not reduce |F|.
+   *
+   * The parameter file block has the format
+   * \code
+   *   JfnkIterator{
+   *     maxItr     100
+   *     epsilon    1e-10
+   *     maxKrylov  30
+   *     isFlexible 0
+   *   }
+   * \endcode
+   * in which maxItr is the maximum number of Newton steps, epsilon is
+   * the error tolerance, defined as for AmIterator, maxKrylov is the
+   * maximum dimension of the Krylov subspace before GMRES restarts, and
+   * isFlexible is optional (default 0).
+   *
+   * \ingroup Pspc_Iterator_Module
+   */
+   template <int D>
+   class JfnkIterator : public Iterator<D>
+   {
+   public:
+
+      /**
+      * Constructor
+      *
+      * \param system pointer to a parent System object
+      */
+      JfnkIterator(System<D>* system);
+
+      /**
+      * Destructor
+      */
+      ~JfnkIterator();
+
+      /**
+      * Read all parameters and initialize.
+      *
+      * \param in input filestream
+      */
+      void readParameters(std::istream& in);
+
+      /**
+      * Allocate all arrays
+      */
+      void allocate();
+
+      /**
+      * Iterate to a solution
+      *
+      * \return 0 for success, 1 for failure
+      */
+      int solve();
+
+      /**
+      * Get epsilon (error threshhold).
+      */
+      double epsilon();
+
+      /**
+      * Get the maximum number of Newton iterations.
+      */
+      int maxItr();
+
+      /**
+      * Get the maximum dimension of the Krylov subspace.
+      */
+      int maxKrylov();
+
+      /**
+      * Get the number of MDE solutions in the most recent solve().
+      */
+      int nSolve();
+
+   private:
+
+      /// Error tolerance
+      double epsilon_;
+
+      /// Maximum number of Newton iterations.
+      int maxItr_;
+
+      /// Maximum Krylov subspace dimension (GMRES restart length).
+      int maxKrylov_;
+
+      /// Flexible cell computation (1) or rigid (0), default value = 0
+      bool isFlexible_;
+
+      /// Number of unknowns (and residuals).
+      int nUnknown_;
+
+      /// Number of MDE solutions in the current or last solve().
+      int nSolve_;
+
+      /// Current unknowns.
+      DArray<double> x_;
+
+      /// Residuals at x_.
+      DArray<double> f_;
+
+      /// Newton step.
+      DArray<double> dx_;
+
+      /// Trial unknowns (x_ + h*v or x_ + lambda*dx_).
+      DArray<double> xTrial_;
+
+      /// Residuals at xTrial_.
+      DArray<double> fTrial_;
+
+      /// Orthonormal Krylov basis vectors, maxKrylov_ + 1 of them.
+      DArray< DArray<double> > krylov_;
+
+      /// Upper Hessenberg matrix of the Arnoldi process.
+      DMatrix<double> hessenberg_;
+
+      /// Cosines of Givens rotations.
+      DArray<double> cs_;
+
+      /// Sines of Givens rotations.
+      DArray<double> sn_;
+
+      /// Rotated right hand side of the GMRES least squares problem.
+      DArray<double> g_;
+
+      /// Solution of the GMRES least squares problem.
+      DArray<double> y_;
+
+      /// Work array for unit cell parameters.
+      FSArray<double, 6> parameters_;
+
+      /**
+      * Copy current w fields and cell parameters into an array.
+      */
+      void getUnknowns(DArray<double>& x);
+
+      /**
+      * Set w fields (and unit cell) from an array of unknowns.
+      */
+      void setUnknowns(DArray<double> const & x);
+
+      /**
+      * Solve the MDE for the current state and compute residuals.
+      */
+      void computeResidual(DArray<double>& f);
+
+      /**
+      * Set the unknowns to x and compute the corresponding residuals f.
+      */
+      void evaluate(DArray<double> const & x, DArray<double>& f);
+
+      /**
+      * Error measure used for the convergence test.
+      */
+      double error(DArray<double> const & f);
+
+      /**
+      * Solve J dx = -f_ approximately by restarted GMRES.
+      *
+      * \param eta relative tolerance for the linear residual
+      */
+      void solveLinear(double eta);
+
+      /**
+      * Euclidean norm of an array of unknowns.
+      */
+      double norm(DArray<double> const & v);
+
+      using Iterator<D>::setClassName;
+      using Iterator<D>::systemPtr_;
+      using Iterator<D>::system;
+      using Iterator<D>::nIteration_;
+      using ParamComposite::read;
+      using ParamComposite::readOptional;
+
+   };
+
+   template<int D>
+   inline double JfnkIterator<D>::epsilon()
+   { return epsilon_; }
+
+   template<int D>
+   inline int JfnkIterator<D>::maxItr()
+   { return maxItr_; }
+
+   template<int D>
+   inline int JfnkIterator<D>::maxKrylov()
+   { return maxKrylov_; }
+
+   template<int D>
+   inline int JfnkIterator<D>::nSolve()
+   { return nSolve_; }
+
+   #ifndef PSPC_JFNK_ITERATOR_TPP
+   // Suppress implicit instantiation
+   extern template class JfnkIterator<1>;
+   extern template class JfnkIterator<2>;
+   extern template class JfnkIterator<3>;
+   #endif
+
+}
+}
+#endif
@@ -0,0 +1,475 @@
+#ifndef PSPC_JFNK_ITERATOR_TPP
+#define PSPC_JFNK_ITERATOR_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "JfnkIterator.h"
+#include <pspc/System.h>
+#include <pscf/inter/ChiInteraction.h>
+#include <util/format/Dbl.h>
+#include <util/misc/Timer.h>
+#include <cmath>
+#include <limits>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /*
+   * Constructor
+   */
+   template <int D>
+   JfnkIterator<D>::JfnkIterator(System<D>* system)
+    : Iterator<D>(system),
+      epsilon_(0),
+      maxItr_(0),
+      maxKrylov_(0),
+      isFlexible_(0),
+      nUnknown_(0),
+      nSolve_(0)
+   {  setClassName("JfnkIterator"); }
+
+   /*
+   * Destructor
+   */
+   template <int D>
+   JfnkIterator<D>::~JfnkIterator()
+   {}
+
+   /*
+   * Read parameter file block.
+   */
+   template <int D>
+   void JfnkIterator<D>::readParameters(std::istream& in)
+   {
+      isFlexible_ = 0; // default value (fixed cell)
+      read(in, "maxItr", maxItr_);
+      read(in, "epsilon", epsilon_);
+      read(in, "maxKrylov", maxKrylov_);
+      readOptional(in, "isFlexible", isFlexible_);
+      UTIL_CHECK(maxKrylov_ > 0);
+   }
+
+   /*
+   * Allocate memory required by iterator.
+   */
+   template <int D>
+   void JfnkIterator<D>::allocate()
+   {
+      int nMonomer = systemPtr_->mixture().nMonomer();
+      int nStar = systemPtr_->basis().nStar();
+      nUnknown_ = nMonomer*(nStar - 1);
+      if (isFlexible_) {
+         nUnknown_ += systemPtr_->unitCell().nParameter();
+      }
+
+      x_.allocate(nUnknown_);
+      f_.allocate(nUnknown_);
+      dx_.allocate(nUnknown_);
+      xTrial_.allocate(nUnknown_);
+      fTrial_.allocate(nUnknown_);
+      krylov_.allocate(maxKrylov_ + 1);
+      for (int i = 0; i <= maxKrylov_; ++i) {
+         krylov_[i].allocate(nUnknown_);
+      }
+      hessenberg_.allocate(maxKrylov_ + 1, maxKrylov_);
+      cs_.allocate(maxKrylov_);
+      sn_.allocate(maxKrylov_);
+      g_.allocate(maxKrylov_ + 1);
+      y_.allocate(maxKrylov_);
+   }
+
+   /*
+   * Solve iteratively.
+   */
+   template <int D>
+   int JfnkIterator<D>::solve()
+   {
+      UTIL_CHECK(system().hasWFields());
+      UTIL_CHECK(x_.isAllocated());
+
+      Timer timer;
+      timer.start();
+      nSolve_ = 0;
+
+      // Evaluate residuals for initial state
+      getUnknowns(x_);
+      evaluate(x_, f_);
+
+      double err, normF, normTrial, eta, lambda;
+      int i, j;
+      bool isAccepted;
+      for (int itr = 1; itr <= maxItr_; ++itr) {
+
+         nIteration_ = itr;
+
+         Log::file()<<"---------------------"<<std::endl;
+         Log::file()<<" Iteration  "<<itr<<std::endl;
+
+         // Test for convergence
+         err = error(f_);
+         if (err < epsilon_) {
+
+            timer.stop();
+            Log::file() << "----------CONVERGED----------"<< std::endl;
+            Log::file() << "\n";
+            Log::file() << "MDE solutions = " << nSolve_ << "\n";
+            Log::file() << "total time    = " << timer.time() << " s  ";
+            Log::file() << "\n\n";
+
+            // If the unit cell is rigid, compute and output final stress
+            if (!isFlexible_) {
+               system().mixture().computeStress();
+               Log::file() << "Final stress:" << "\n";
+               for (int m=0; m<(systemPtr_->unitCell()).nParameter(); ++m){
+                  Log::file() << "Stress  "<< m << "   = "
+                              << Dbl(systemPtr_->mixture().stress(m))
+                              << "\n";
+               }
+               Log::file() << "\n";
+            }
+            return 0;
+         }
+
+         // Inexact Newton step, with forcing term eta
+         normF = norm(f_);
+         eta = (normF < 0.1) ? normF : 0.1;
+         solveLinear(eta);
+
+         // Backtracking line search on |F|
+         isAccepted = false;
+         lambda = 1.0;
+         for (i = 0; i < 10; ++i) {
+            for (j = 0; j < nUnknown_; ++j) {
+               xTrial_[j] = x_[j] + lambda*dx_[j];
+            }
+            evaluate(xTrial_, fTrial_);
+            normTrial = norm(fTrial_);
+            if (normTrial < (1.0 - 1.0E-4*lambda)*normF) {
+               isAccepted = true;
+               break;
+            }
+            lambda *= 0.5;
+         }
+
+         // Failure: no sufficient decrease along the Newton direction.
+         // Restore the system to the last accepted state and give up.
+         if (!isAccepted) {
+            Log::file() << "Line search failed" << std::endl;
+            evaluate(x_, f_);
+            return 1;
+         }
+         if (lambda != 1.0) {
+            Log::file() << "Step length = " << Dbl(lambda) << std::endl;
+         }
+
+         // Accept step. System state corresponds to xTrial_.
+         for (j = 0; j < nUnknown_; ++j) {
+            x_[j] = xTrial_[j];
+            f_[j] = fTrial_[j];
+         }
+      }
+
+      // Failure: iteration counter itr reached maxItr without converging
+      return 1;
+   }
+
+   /*
+   * Solve J dx = -f by restarted GMRES, with finite difference J*v.
+   */
+   template <int D>
+   void JfnkIterator<D>::solveLinear(double eta)
+   {
+      const double machineEps = std::numeric_limits<double>::epsilon();
+      const int maxRestart = 10;
+
+      int i, j, k, l;
+      double beta, target, h, temp, normX;
+
+      for (l = 0; l < nUnknown_; ++l) {
+         dx_[l] = 0.0;
+      }
+      target = eta*norm(f_);
+      normX = norm(x_);
+
+      int nKrylov = 0;
+      for (int restart = 0; restart < maxRestart; ++restart) {
+
+         // Initial residual r = -f - J*dx, stored in krylov_[0]
+         DArray<double>& r = krylov_[0];
+         temp = norm(dx_);
+         if (temp == 0.0) {
+            for (l = 0; l < nUnknown_; ++l) {
+               r[l] = -f_[l];
+            }
+         } else {
+            h = std::sqrt(machineEps)*(1.0 + normX)/temp;
+            for (l = 0; l < nUnknown_; ++l) {
+               xTrial_[l] = x_[l] + h*dx_[l];
+            }
+            evaluate(xTrial_, fTrial_);
+            for (l = 0; l < nUnknown_; ++l) {
+               r[l] = -f_[l] - (fTrial_[l] - f_[l])/h;
+            }
+         }
+         beta = norm(r);
+         if (beta <= target) break;
+         for (l = 0; l < nUnknown_; ++l) {
+            r[l] /= beta;
+         }
+         for (i = 0; i <= maxKrylov_; ++i) {
+            g_[i] = 0.0;
+         }
+         g_[0] = beta;
+
+         // Arnoldi process with Givens rotations
+         k = 0;
+         for (j = 0; j < maxKrylov_; ++j) {
+
+            // w = J*v_j, by forward difference, stored in krylov_[j+1]
+            DArray<double> const & v = krylov_[j];
+            DArray<double>& w = krylov_[j+1];
+            h = std::sqrt(machineEps)*(1.0 + normX);
+            for (l = 0; l < nUnknown_; ++l) {
+               xTrial_[l] = x_[l] + h*v[l];
+            }
+            evaluate(xTrial_, fTrial_);
+            for (l = 0; l < nUnknown_; ++l) {
+               w[l] = (fTrial_[l] - f_[l])/h;
+            }
+
+            // Modified Gram-Schmidt orthogonalization
+            for (i = 0; i <= j; ++i) {
+               DArray<double> const & vi = krylov_[i];
+               temp = 0.0;
+               for (l = 0; l < nUnknown_; ++l) {
+                  temp += w[l]*vi[l];
+               }
+               hessenberg_(i, j) = temp;
+               for (l = 0; l < nUnknown_; ++l) {
+                  w[l] -= temp*vi[l];
+               }
+            }
+            temp = norm(w);
+            hessenberg_(j+1, j) = temp;
+            if (temp > 0.0) {
+               for (l = 0; l < nUnknown_; ++l) {
+                  w[l] /= temp;
+               }
+            }
+
+            // Apply previous rotations to new column
+            for (i = 0; i < j; ++i) {
+               temp = cs_[i]*hessenberg_(i, j) + sn_[i]*hessenberg_(i+1, j);
+               hessenberg_(i+1, j) = -sn_[i]*hessenberg_(i, j)
+                                    + cs_[i]*hessenberg_(i+1, j);
+               hessenberg_(i, j) = temp;
+            }
+
+            // Compute and apply new rotation
+            temp = std::sqrt(hessenberg_(j, j)*hessenberg_(j, j)
+                           + hessenberg_(j+1, j)*hessenberg_(j+1, j));
+            if (temp == 0.0) {
+               cs_[j] = 1.0;
+               sn_[j] = 0.0;
+            } else {
+               cs_[j] = hessenberg_(j, j)/temp;
+               sn_[j] = hessenberg_(j+1, j)/temp;
+            }
+            hessenberg_(j, j) = temp;
+            hessenberg_(j+1, j) = 0.0;
+            g_[j+1] = -sn_[j]*g_[j];
+            g_[j] = cs_[j]*g_[j];
+
+            k = j + 1;
+            ++nKrylov;
+            if (std::abs(g_[j+1]) <= target || temp == 0.0) break;
+         }
+
+         // Solve upper triangular system H y = g, update dx
+         for (i = k - 1; i >= 0; --i) {
+            temp = g_[i];
+            for (j = i + 1; j < k; ++j) {
+               temp -= hessenberg_(i, j)*y_[j];
+            }
+            y_[i] = temp/hessenberg_(i, i);
+         }
+         for (i = 0; i < k; ++i) {
+            DArray<double> const & vi = krylov_[i];
+            for (l = 0; l < nUnknown_; ++l) {
+               dx_[l] += y_[i]*vi[l];
+            }
+         }
+
+         if (std::abs(g_[k]) <= target) break;
+      }
+
+      Log::file() << "GMRES iterations = " << nKrylov << std::endl;
+   }
+
+   /*
+   * Copy current w fields (and cell parameters) into x.
+   */
+   template <int D>
+   void JfnkIterator<D>::getUnknowns(DArray<double>& x)
+   {
+      int nMonomer = systemPtr_->mixture().nMonomer();
+      int nStar = systemPtr_->basis().nStar();
+      int i, k;
+      int l = 0;
+      for (i = 0; i < nMonomer; ++i) {
+         DArray<double> const & wField = systemPtr_->wField(i);
+         for (k = 0; k < nStar - 1; ++k) {
+            x[l] = wField[k + 1];
+            ++l;
+         }
+      }
+      if (isFlexible_) {
+         UnitCell<D> const & unitCell = systemPtr_->unitCell();
+         for (int m = 0; m < unitCell.nParameter(); ++m) {
+            x[l] = unitCell.parameter(m);
+            ++l;
+         }
+      }
+   }
+
+   /*
+   * Set w fields (and unit cell) from unknowns x.
+   */
+   template <int D>
+   void JfnkIterator<D>::setUnknowns(DArray<double> const & x)
+   {
+      int nMonomer = systemPtr_->mixture().nMonomer();
+      int nStar = systemPtr_->basis().nStar();
+      int i, k;
+      int l = 0;
+      for (i = 0; i < nMonomer; ++i) {
+         DArray<double>& wField = systemPtr_->wField(i);
+         for (k = 0; k < nStar - 1; ++k) {
+            wField[k + 1] = x[l];
+            ++l;
+         }
+      }
+      if (isFlexible_) {
+         UnitCell<D>& unitCell = systemPtr_->unitCell();
+         parameters_.clear();
+         for (int m = 0; m < unitCell.nParameter(); ++m) {
+            parameters_.append(x[l]);
+            ++l;
+         }
+         systemPtr_->setUnitCell(parameters_);
+      }
+      FieldIo<D>& fieldIo = systemPtr_->fieldIo();
+      fieldIo.convertBasisToRGrid(systemPtr_->wFields(),
+                                  systemPtr_->wFieldsRGridBlock());
+   }
+
+   /*
+   * Solve the MDE for the current w fields and compute residuals f.
+   */
+   template <int D>
+   void JfnkIterator<D>::computeResidual(DArray<double>& f)
+   {
+      Mixture<D>& mixture = systemPtr_->mixture();
+      mixture.compute(systemPtr_->wFieldsRGrid(),
+                      systemPtr_->cFieldsRGrid());
+      ++nSolve_;
+      FieldIo<D>& fieldIo = systemPtr_->fieldIo();
+      fieldIo.convertRGridToBasis(systemPtr_->cFieldsRGridBlock(),
+                                  systemPtr_->cFields());
+      if (isFlexible_) {
+         mixture.computeStress();
+      }
+
+      int nMonomer = mixture.nMonomer();
+      int nStar = systemPtr_->basis().nStar();
+      double chi, idemp;
+      int i, j, k;
+      for (i = 0; i < nMonomer; ++i) {
+         double* dev = f.cArray() + i*(nStar - 1);
+         for (k = 0; k < nStar - 1; ++k) {
+            dev[k] = 0.0;
+         }
+         for (j = 0; j < nMonomer; ++j) {
+            chi = systemPtr_->interaction().chi(i,j);
+            idemp = systemPtr_->interaction().idemp(i,j);
+            DArray<double> const & cField = systemPtr_->cField(j);
+            DArray<double> const & wField = systemPtr_->wField(j);
+            for (k = 0; k < nStar - 1; ++k) {
+               dev[k] += ( (chi*cField[k + 1]) - (idemp*wField[k + 1]) );
+            }
+         }
+      }
+      if (isFlexible_) {
+         int l = nMonomer*(nStar - 1);
+         for (int m = 0; m < systemPtr_->unitCell().nParameter(); ++m) {
+            f[l + m] = -mixture.stress(m);
+         }
+      }
+   }
+
+   /*
+   * Set unknowns and compute residuals.
+   */
+   template <int D>
+   void JfnkIterator<D>::evaluate(DArray<double> const & x,
+                                  DArray<double>& f)
+   {
+      setUnknowns(x);
+      computeResidual(f);
+   }
+
+   /*
+   * Error, defined as in AmIterator (maximum residual).
+   */
+   template <int D>
+   double JfnkIterator<D>::error(DArray<double> const & f)
+   {
+      int nField = systemPtr_->mixture().nMonomer()
+                 * (systemPtr_->basis().nStar() - 1);
+      double temp1 = 0.0;
+      double temp2 = 0.0;
+      int i;
+      for (i = 0; i < nField; ++i) {
+         if (temp1 < std::abs(f[i])) temp1 = std::abs(f[i]);
+      }
+      Log::file() << "SCF Error   = " << Dbl(temp1) << std::endl;
+      double error = temp1;
+      if (isFlexible_) {
+         for (i = nField; i < nUnknown_; ++i) {
+            if (temp2 < std::abs(f[i])) temp2 = std::abs(f[i]);
+         }
+         for (int m=0; m<(systemPtr_->unitCell()).nParameter() ; ++m){
+            Log::file() << "Stress  "<< m << "   = "
+                        << Dbl(systemPtr_->mixture().stress(m)) <<"\n";
+         }
+         // 100 is the stress rescale factor used by AmIterator
+         error = (temp1 > 100*temp2) ? temp1 : 100*temp2;
+      }
+      Log::file() << "Error       = " << Dbl(error) << std::endl;
+      return error;
+   }
+
+   /*
+   * Euclidean norm.
+   */
+   template <int D>
+   double JfnkIterator<D>::norm(DArray<double> const & v)
+   {
+      double sum = 0.0;
+      for (int l = 0; l < nUnknown_; ++l) {
+         sum += v[l]*v[l];
+      }
+      return std::sqrt(sum);
+   }
+
+}
+}
+#endif
@@ -0,0 +1,173 @@
+#ifndef PSPC_RPA_PRECONDITIONER_H
+#define PSPC_RPA_PRECONDITIONER_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <util/containers/DArray.h>      // member template
+#include <util/containers/DMatrix.h>     // argument template
+
+namespace Pscf { 
+   class ChiInteraction; 
+   template <int D> class Basis;
+}
+
+namespace Pscf {
+namespace Pspc
+{
+
+   template <int D> class Mixture;
+
+   using namespace Util;
+
+   /**
+   * Preconditioner for SCF residuals, based on the RPA response function.
+   *
+   * For a homogeneous melt, a small perturbation dw_j of the w field of
+   * monomer type j with a wavevector G changes the concentration of type
+   * i by dc_i = - sum_j S_ij(G) dw_j, in which S(G) is the ideal-gas
+   * single-chain correlation matrix, given by Debye functions of the
+   * dimensionless squared wavenumbers x = |G|^2 b^2 L/6 of the blocks.
+   * The Jacobian of the SCF residual d = chi c - idemp w with respect to
+   * w is then -M(G), with M = chi S + idemp.
+   *
+   * The preconditioner replaces the residual components d(G) of each
+   * star by M(G)^{-1} d(G), which is a Newton step for the linearized
+   * problem. This rescales long wavelength components, which have a
+   * large response to w, relative to short wavelength components, which
+   * have a weak response. The homogeneous (G=0) star is excluded.
+   *
+   * Because idemp is a projector of rank nMonomer - 1, and S(G) decays
+   * as 1/|G|^2, M(G) becomes nearly singular at large |G|, where M^{-1}
+   * would amplify the residual component along the null vector of idemp
+   * by a factor of order x = b^2|G|^2/6. To bound this, M is regularized
+   * as M = chi S + idemp + (I - idemp)/g, in which g is the maximum gain.
+   * Because (I - idemp) is the complementary projector, M^{-1} then
+   * tends to idemp + g (I - idemp) as S vanishes, so that no component
+   * is amplified by more than a factor g. This has little effect on
+   * stars with small |G|, for which chi S dominates.
+   *
+   * Only linear and branched block polymers are included in S(G).
+   *
+   * \ingroup Pspc_Iterator_Module
+   */
+   template <int D>
+   class RpaPreconditioner
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      */
+      RpaPreconditioner();
+
+      /**
+      * Destructor.
+      */
+      ~RpaPreconditioner();
+
+      /**
+      * Allocate memory.
+      *
+      * \param nMonomer number of monomer types
+      * \param nStar number of stars in the symmetry-adapted basis
+      */
+      void allocate(int nMonomer, int nStar);
+
+      /**
+      * Set the maximum gain g used to regularize M (default 100).
+      *
+      * \param maxGain  maximum amplification of any residual component
+      */
+      void setMaxGain(double maxGain);
+
+      /**
+      * Compute the inverse matrix M^{-1} for every star.
+      *
+      * This must be called again whenever the unit cell changes, after
+      * the basis has been updated.
+      *
+      * \param mixture  Mixture, containing polymer species
+      * \param interaction  ChiInteraction, defines chi and idemp
+      * \param basis  symmetry adapted basis (star eigenvalues |G|^2)
+      */
+      void setup(Mixture<D>& mixture,
+                 ChiInteraction& interaction,
+                 Basis<D> const & basis);
+
+      /**
+      * Apply the preconditioner to residuals, in place.
+      *
+      * Residual array dev[i] for monomer type i contains components
+      * for stars 1, ..., nStar - 1, as in AmIterator.
+      *
+      * \param dev array of nMonomer pointers to residual arrays
+      */
+      void apply(double* const * dev) const;
+
+      /**
+      * Compute the RPA correlation matrix S for a squared wavenumber.
+      *
+      * \param mixture  Mixture, containing polymer species
+      * \param kSq  squared wavenumber |G|^2
+      * \param S  correlation matrix (output, nMonomer x nMonomer)
+      */
+      static
+      void computeCorrelation(Mixture<D>& mixture, double kSq,
+                              DMatrix<double>& S);
+
+      /**
+      * Get the maximum gain g used to regularize M.
+      */
+      double maxGain() const;
+
+      /**
+      * Has setup been called since allocation?
+      */
+      bool isSetup() const;
+
+   private:
+
+      /// Inverse matrices M^{-1}, nMonomer^2 elements per star.
+      DArray<double> inverse_;
+
+      /// Work array for apply.
+      mutable DArray<double> work_;
+
+      /// Maximum gain, which sets the regularization of M.
+      double maxGain_;
+
+      /// Number of monomer types.
+      int nMonomer_;
+
+      /// Number of stars.
+      int nStar_;
+
+      /// Has setup been called?
+      bool isSetup_;
+
+   };
+
+   template <int D>
+   inline double RpaPreconditioner<D>::maxGain() const
+   {  return maxGain_; }
+
+   template <int D>
+   inline bool RpaPreconditioner<D>::isSetup() const
+   {  return isSetup_; }
+
+   #ifndef PSPC_RPA_PRECONDITIONER_TPP
+   // Suppress implicit instantiation
+   extern template class RpaPreconditioner<1>;
+   extern template class RpaPreconditioner<2>;
+   extern template class RpaPreconditioner<3>;
+   #endif
+
+}
+}
+#endif
@@ -0,0 +1,264 @@
+#ifndef PSPC_RPA_PRECONDITIONER_TPP
+#define PSPC_RPA_PRECONDITIONER_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "RpaPreconditioner.h"
+#include <pspc/solvers/Mixture.h>
+#include <pscf/crystal/Basis.h>
+#include <pscf/inter/ChiInteraction.h>
+#include <pscf/math/LuSolver.h>
+#include <util/containers/GArray.h>
+#include <cmath>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   namespace {
+
+      /*
+      * Debye function g(x) = 2[x - 1 + exp(-x)]/x^2 (intra-block).
+      */
+      double debyeG(double x)
+      {
+         if (x < 1.0E-5) {
+            return 1.0 - x/3.0 + x*x/12.0;
+         }
+         return 2.0*(x - 1.0 + std::exp(-x))/(x*x);
+      }
+
+      /*
+      * Function h(x) = [1 - exp(-x)]/x (block end correlation).
+      */
+      double debyeH(double x)
+      {
+         if (x < 1.0E-5) {
+            return 1.0 - 0.5*x + x*x/6.0;
+         }
+         return (1.0 - std::exp(-x))/x;
+      }
+
+      /*
+      * Element of a stack used to traverse a polymer graph.
+      */
+      struct VertexVisit {
+         int vertexId;
+         int fromBlockId;
+         double factor;
+      };
+
+   }
+
+   /*
+   * Constructor.
+   */
+   template <int D>
+   RpaPreconditioner<D>::RpaPreconditioner()
+    : inverse_(),
+      work_(),
+      maxGain_(100.0),
+      nMonomer_(0),
+      nStar_(0),
+      isSetup_(false)
+   {}
+
+   /*
+   * Destructor.
+   */
+   template <int D>
+   RpaPreconditioner<D>::~RpaPreconditioner()
+   {}
+
+   /*
+   * Allocate memory.
+   */
+   template <int D>
+   void RpaPreconditioner<D>::allocate(int nMonomer, int nStar)
+   {
+      UTIL_CHECK(nMonomer > 0);
+      UTIL_CHECK(nStar > 0);
+      nMonomer_ = nMonomer;
+      nStar_ = nStar;
+      inverse_.allocate(nStar*nMonomer*nMonomer);
+      work_.allocate(nMonomer);
+      isSetup_ = false;
+   }
+
+   /*
+   * Set maximum gain.
+   */
+   template <int D>
+   void RpaPreconditioner<D>::setMaxGain(double maxGain)
+   {
+      UTIL_CHECK(maxGain > 1.0);
+      maxGain_ = maxGain;
+      isSetup_ = false;
+   }
+
+   /*
+   * Compute and invert M = chi S + idemp + (I - idemp)/g for every star.
+   */
+   template <int D>
+   void RpaPreconditioner<D>::setup(Mixture<D>& mixture,
+                                    ChiInteraction& interaction,
+                                    Basis<D> const & basis)
+   {
+      UTIL_CHECK(inverse_.isAllocated());
+      UTIL_CHECK(mixture.nMonomer() == nMonomer_);
+      UTIL_CHECK(basis.nStar() == nStar_);
+
+      int n = nMonomer_;
+      DMatrix<double> S;
+      DMatrix<double> M;
+      DMatrix<double> inv;
+      S.allocate(n, n);
+      M.allocate(n, n);
+      inv.allocate(n, n);
+      LuSolver solver;
+      solver.allocate(n);
+
+      int i, j, k, star;
+      double sum;
+      double delta = 1.0/maxGain_;
+      for (star = 1; star < nStar_; ++star) {
+         computeCorrelation(mixture, basis.star(star).eigen, S);
+         for (i = 0; i < n; ++i) {
+            for (j = 0; j < n; ++j) {
+               sum = (1.0 - delta)*interaction.idemp(i, j);
+               if (i == j) {
+                  sum += delta;
+               }
+               for (k = 0; k < n; ++k) {
+                  sum += interaction.chi(i, k)*S(k, j);
+               }
+               M(i, j) = sum;
+            }
+         }
+         solver.computeLU(M);
+         solver.inverse(inv);
+         double* ptr = &inverse_[star*n*n];
+         for (i = 0; i < n; ++i) {
+            for (j = 0; j < n; ++j) {
+               ptr[i*n + j] = inv(i, j);
+            }
+         }
+      }
+      isSetup_ = true;
+   }
+
+   /*
+   * Replace residual components of each star by M^{-1} times residual.
+   */
+   template <int D>
+   void RpaPreconditioner<D>::apply(double* const * dev) const
+   {
+      UTIL_CHECK(isSetup_);
+      int n = nMonomer_;
+      int i, j, star;
+      double sum;
+      for (star = 1; star < nStar_; ++star) {
+         double const * ptr = &inverse_[star*n*n];
+         for (i = 0; i < n; ++i) {
+            sum = 0.0;
+            for (j = 0; j < n; ++j) {
+               sum += ptr[i*n + j]*dev[j][star - 1];
+            }
+            work_[i] = sum;
+         }
+         for (i = 0; i < n; ++i) {
+            dev[i][star - 1] = work_[i];
+         }
+      }
+   }
+
+   /*
+   * Compute ideal gas correlation matrix for squared wavenumber kSq.
+   */
+   template <int D>
+   void RpaPreconditioner<D>::computeCorrelation(Mixture<D>& mixture,
+                                                 double kSq,
+                                                 DMatrix<double>& S)
+   {
+      int nMonomer = mixture.nMonomer();
+      int i, j;
+      for (i = 0; i < nMonomer; ++i) {
+         for (j = 0; j < nMonomer; ++j) {
+            S(i, j) = 0.0;
+         }
+      }
+
+      GArray<VertexVisit> stack;
+      VertexVisit visit, next;
+      DArray<double> x;
+      DArray<double> h;
+      int nBlock, a, c, m, monomerA, monomerC;
+      double length, prefactor, step, la, lc;
+      for (int p = 0; p < mixture.nPolymer(); ++p) {
+         Polymer<D>& polymer = mixture.polymer(p);
+         nBlock = polymer.nBlock();
+
+         // Dimensionless wavenumbers x = kSq*b^2*L/6 of all blocks
+         x.allocate(nBlock);
+         h.allocate(nBlock);
+         length = 0.0;
+         for (a = 0; a < nBlock; ++a) {
+            step = mixture.monomer(polymer.block(a).monomerId()).step();
+            x[a] = kSq*step*step*polymer.block(a).length()/6.0;
+            h[a] = debyeH(x[a]);
+            length += polymer.block(a).length();
+         }
+         prefactor = polymer.phi()/length;
+
+         for (a = 0; a < nBlock; ++a) {
+            monomerA = polymer.block(a).monomerId();
+            la = polymer.block(a).length();
+
+            // Intra-block correlation
+            S(monomerA, monomerA) += prefactor*la*la*debyeG(x[a]);
+
+            // Inter-block correlations, by traversing the tree from a
+            stack.clear();
+            for (m = 0; m < 2; ++m) {
+               visit.vertexId = polymer.block(a).vertexId(m);
+               visit.fromBlockId = a;
+               visit.factor = 1.0;
+               stack.append(visit);
+            }
+            while (stack.size() > 0) {
+               visit = stack[stack.size() - 1];
+               stack.resize(stack.size() - 1);
+               Vertex const & vertex = polymer.vertex(visit.vertexId);
+               for (m = 0; m < vertex.size(); ++m) {
+                  c = vertex.inPropagatorId(m)[0];
+                  if (c == visit.fromBlockId) continue;
+                  monomerC = polymer.block(c).monomerId();
+                  lc = polymer.block(c).length();
+                  S(monomerA, monomerC) += prefactor*la*h[a]*lc*h[c]
+                                         * visit.factor;
+                  next.fromBlockId = c;
+                  next.factor = visit.factor*std::exp(-x[c]);
+                  if (polymer.block(c).vertexId(0) == visit.vertexId) {
+                     next.vertexId = polymer.block(c).vertexId(1);
+                  } else {
+                     next.vertexId = polymer.block(c).vertexId(0);
+                  }
+                  stack.append(next);
+               }
+            }
+         }
+         x.deallocate();
+         h.deallocate();
+      }
+   }
+
+}
+}
+#endif
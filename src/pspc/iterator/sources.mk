@@ -1,6 +1,13 @@
 pspc_iterator_= \
   pspc/iterator/Iterator.cpp \
-  pspc/iterator/AmIterator.cpp 
+  pspc/iterator/AmIteratorBase.cpp \
+  pspc/iterator/AmIterator.cpp \
+  pspc/iterator/AmIteratorGrid.cpp \
+  pspc/iterator/JfnkIterator.cpp \
+  pspc/iterator/IteratorFactory.cpp \
+  pspc/iterator/HistMat.cpp \
+  pspc/iterator/RpaPreconditioner.cpp \
+  pspc/iterator/HistoryArena.cpp 
 
   
 
@@ -9,14 +9,17 @@
 */
 
 #include "Propagator.h"                   // base class argument
+#include "WaveList.h"                     // member
 #include <pscf/solvers/BlockTmpl.h>       // base class template
 #include <pscf/mesh/Mesh.h>               // member
 #include <pscf/crystal/UnitCell.h>        // member
 #include <pspc/field/RField.h>            // member
 #include <pspc/field/RFieldDft.h>         // member
 #include <pspc/field/FFT.h>               // member
+#include <pspc/field/FFTBatched.h>        // member
+#include <pspc/field/FieldArena.h>        // function parameter
+#include <util/containers/DArray.h>       // member template
 #include <util/containers/FArray.h>       // member template
-#include <util/containers/DMatrix.h>      // member template
 
 namespace Pscf { 
    template <int D> class Mesh; 
@@ -74,18 +77,56 @@ namespace Pspc {
       *
       * \param ds desired (optimal) value for contour length step
       * \param mesh spatial discretization mesh
+      * \param checkpointInterval  interval between stored propagator 
+      *        slices (1 to store all, see Propagator<D>)
+      * \param singlePrecision  store propagator slices in float?
+      * \param workArena  arena for work fields (null for heap)
+      * \param qArena  arena for propagator slices (null for heap)
       */
-      void setDiscretization(double ds, const Mesh<D>& mesh);
+      void setDiscretization(double ds, const Mesh<D>& mesh,
+                             int checkpointInterval = 1,
+                             bool singlePrecision = false,
+                             FieldArena* workArena = 0,
+                             FieldArena* qArena = 0);
+
+      /**
+      * Enable adaptive contour stepping, with a local error tolerance.
+      *
+      * In adaptive mode, the block is divided into a non-uniform grid
+      * of nStep() contour steps, in which step i has a length ds()*2^l,
+      * where l = stepLevel(i) and 0 <= l < nLevel(). The grid initially
+      * consists of ns() - 1 steps of length ds(), and changes only in
+      * calls to adaptGrid, which Mixture<D>::adaptContour makes between
+      * converged solutions of the SCF equations. Both propagators use
+      * the same grid, which does not change while they are solved.
+      *
+      * The error estimate for a step is the maximum difference between
+      * the results of one full step and two half steps, which are both
+      * computed by step() before Richardson extrapolation, divided by 3
+      * and by the maximum of the new q field.
+      *
+      * Must be called after setDiscretization, with propagators that 
+      * store all slices in double precision, and before setupUnitCell.
+      *
+      * \param tolerance  maximum estimated relative local error per step
+      * \param workArena  arena for work fields (null for heap)
+      */
+      void setAdaptiveTolerance(double tolerance, 
+                                FieldArena* workArena = 0);
 
       /**
       * Setup parameters that depend on the unit cell.
       *
       * This should be called once after every change in unit cell
-      * parameters.
+      * parameters, after the |G|^2 values of the wavelist have been
+      * updated. The wavelist must remain valid, and its derivatives of
+      * |G|^2 must be updated before any later call to computeStress.
       *
       * \param unitCell unit cell, defining cell dimensions
+      * \param wavelist wavevector data shared by all blocks
       */
-      void setupUnitCell(const UnitCell<D>& unitCell);
+      void setupUnitCell(const UnitCell<D>& unitCell, 
+                         const WaveList<D>& wavelist);
 
       /**
       * Set solver for this block.
@@ -97,13 +138,68 @@ namespace Pspc {
       */
       void setupSolver(WField const & w);
 
+      /**
+      * Adapt the contour grid to the step errors of the last solution.
+      *
+      * Uses estimates of the local error of each step that were recorded
+      * by the last solution of propagator(0): Each step of which the 
+      * error exceeds the tolerance is split into shorter steps, and 
+      * adjacent pairs of equal steps are merged if the error predicted
+      * for the merged step is less than half the tolerance. Both 
+      * propagators use the new grid in the next solution. Does nothing
+      * if propagator(0) has not been solved since the last adaption.
+      *
+      * \pre isAdaptive() is true.
+      * \return true if the grid changed, false otherwise
+      */
+      bool adaptGrid();
+
       /**
       * Compute one step of solution of MDE, from i to i+1.
       *
+      * Each Block has two independent sets of work arrays and FFT 
+      * objects, one for each propagator direction, so that the two
+      * propagators of a block may be solved concurrently by different
+      * threads. The workId parameter selects the set to use, and 
+      * should be the direction id of the calling propagator.
+      *
+      * \param q  input value of QField, from step i
+      * \param qNew  ouput value of QField, from step i+1
+      * \param workId  index of work space (0 or 1)
+      */
+      void step(QField const& q, QField& qNew, int workId = 0);
+
+      /**
+      * Compute step i of the adaptive contour grid for one propagator.
+      *
+      * Step i of propagator(0) has level stepLevel(i), and step i of 
+      * propagator(1) has level stepLevel(nStep() - 1 - i), so that the
+      * two propagators traverse the same grid in opposite directions.
+      * For directionId == 0, the estimated error of the step is 
+      * recorded for use in the next call to adaptGrid. 
+      *
       * \param q  input value of QField, from step i
       * \param qNew  ouput value of QField, from step i+1
+      * \param i  step index, in the direction of propagation
+      * \param directionId  direction of propagator (0 or 1)
       */
-      void step(QField const& q, QField& qNew);
+      void stepAdaptive(QField const& q, QField& qNew, int i, 
+                        int directionId);
+
+      /**
+      * Compute one step of solution of MDE, unfused reference version.
+      *
+      * Applies the same Richardson-extrapolated pseudo-spectral algorithm
+      * as step(), but performs each pointwise multiplication in a separate
+      * pass over the grid, using additional work arrays. Results agree
+      * with those of step() to within round-off error. This version is
+      * retained for validation and benchmarking of step().
+      *
+      * \param q  input value of QField, from step i
+      * \param qNew  ouput value of QField, from step i+1
+      * \param workId  index of work space (0 or 1)
+      */
+      void stepUnfused(QField const& q, QField& qNew, int workId = 0);
 
       /**
       * Compute concentration (volume fraction) for block by integration.
@@ -121,6 +217,13 @@ namespace Pspc {
       * spatial average of q(r,L). This function is called by 
       * Polymer<D>::compute().
       *
+      * The integral is evaluated by Simpson's rule. The grid is divided 
+      * into tiles, and contributions of all contour steps are summed 
+      * for one tile before proceeding to the next. If PSPC_OPENMP is
+      * defined, tiles are distributed among OpenMP threads. In adaptive 
+      * mode, Simpson's rule for non-uniform steps is used, with the 
+      * weights given by sliceWeight().
+      *
       * \param prefactor constant multiplying integral
       */ 
       void computeConcentration(double prefactor);
@@ -151,6 +254,44 @@ namespace Pspc {
       */
       int ns() const;
 
+      /**
+      * Is adaptive contour stepping enabled?
+      */
+      bool isAdaptive() const;
+
+      /**
+      * Get tolerance for adaptive contour stepping (0 if disabled).
+      */
+      double adaptiveTolerance() const;
+
+      /**
+      * Number of allowed step lengths ds()*2^l, for 0 <= l < nLevel().
+      */
+      int nLevel() const;
+
+      /**
+      * Get number of contour steps in the current grid.
+      *
+      * Equal to ns() - 1 if adaptive stepping is disabled.
+      */
+      int nStep() const;
+
+      /**
+      * Get the level of step i of the adaptive grid.
+      *
+      * Steps are indexed in the direction of propagator(0).
+      *
+      * \param i  step index, 0 <= i < nStep()
+      */
+      int stepLevel(int i) const;
+
+      /**
+      * Get the Simpson's rule weight of slice j of the adaptive grid.
+      *
+      * \param j  slice index, 0 <= j <= nStep()
+      */
+      double sliceWeight(int j) const;
+
       /**
       * Get derivative of free energy w/ respect to unit cell parameter n.
       *
@@ -178,46 +319,86 @@ namespace Pspc {
 
    private:
 
-      /// Matrix to store derivatives of plane waves 
-      DMatrix<double> dGsq_;
-
-      /**
-      * Compute dGsq_.
-      */
-      void computedGsq();
+      /// Weighted sum over contour steps of products of transformed 
+      /// propagator slices, at each wavevector (used by computeStress).
+      DArray<double> stressSum_;
 
       /// Stress arising from this block
       FSArray<double, 6> stress_;
 
-      // Fourier transform plan
-      FFT<D> fft_;
+      /*
+      * Work space for the MDE step algorithm.
+      */
+      struct StepWork 
+      {
+
+         // Fourier transform plan and work array
+         FFT<D> fft;
+
+         // Work array for real-space field.
+         RField<D> qf;
+
+         // Work array for real-space field.
+         RField<D> qr;
+
+         // Work array for real-space field.
+         RField<D> qr2;
+
+         // Work array for wavevector space field.
+         RFieldDft<D> qk;
 
-      // Array of elements containing exp(-K^2 b^2 ds/6)
+         // Work array for wavevector space field.
+         RFieldDft<D> qk2;
+
+      };
+
+      // Work spaces for step algorithm, indexed by propagator direction
+      FArray<StepWork, 2> stepWork_;
+
+      // Batched Fourier transform, for propagator slices in computeStress
+      FFTBatched<D> fftBatched_;
+
+      // Contiguous batch of propagator slices (r-grid), for stress
+      Pspc::Field<double> qrBatch_;
+
+      // Contiguous batch of transformed propagator slices, for stress
+      Pspc::Field<fftw_complex> qkBatch_;
+
+      // Array of elements containing exp(-K^2 b^2 ds/6)/nx, where nx is
+      // the number of grid points. The factor 1/nx normalizes the 
+      // unscaled forward FFT.
       RField<D> expKsq_;
 
       // Array of elements containing exp(-W[i] ds/2)
       RField<D> expW_;
 
-      // Array of elements containing exp(-K^2 b^2 ds/(6*2))
+      // Array of elements containing exp(-K^2 b^2 ds/(6*2))/nx
       RField<D> expKsq2_;
 
       // Array of elements containing exp(-W[i] (ds/2)*0.5)
       RField<D> expW2_;
 
-      // Work array for real-space field.
-      RField<D> qf_;
+      // Arrays of exp(-K^2 b^2 ds 2^l/6)/nx for adaptive steps of level
+      // l > 0, with element l-1 for level l.
+      DArray< RField<D> > expKsqLevel_;
 
-      // Work array for real-space field.
-      RField<D> qr_;
+      // Arrays of exp(-K^2 b^2 ds 2^l/12)/nx, for levels l > 0
+      DArray< RField<D> > expKsq2Level_;
 
-      // Work array for real-space field.
-      RField<D> qr2_;
+      // Arrays of exp(-W[i] ds 2^l/2), for levels l > 0
+      DArray< RField<D> > expWLevel_;
 
-      // Work array for wavevector space field.
-      RFieldDft<D> qk_;
+      // Arrays of exp(-W[i] ds 2^l/4), for levels l > 0
+      DArray< RField<D> > expW2Level_;
 
-      // Work array for wavevector space field.
-      RFieldDft<D> qk2_;
+      /// Levels of steps of the adaptive grid (capacity ns_ - 1).
+      DArray<int> stepLevel_;
+
+      /// Estimated local errors of steps, recorded by propagator(0).
+      DArray<double> stepError_;
+
+      /// Simpson's rule weights of slices of the adaptive grid.
+      DArray<double> sliceWeight_;
 
       /// Pointer to associated Mesh<D> object.
       Mesh<D> const* meshPtr_;
@@ -225,6 +406,9 @@ namespace Pspc {
       /// Pointer to associated UnitCell<D>
       UnitCell<D> const* unitCellPtr_;
 
+      /// Pointer to associated WaveList<D>
+      WaveList<D> const* wavelistPtr_;
+
       /// Dimensions of wavevector mesh in real-to-complex transform
       IntVec<D> kMeshDimensions_;
 
@@ -234,6 +418,46 @@ namespace Pspc {
       /// Number of contour length steps = # grid points - 1.
       int ns_;
 
+      /// Tolerance for adaptive stepping (0 if disabled).
+      double adaptiveTolerance_;
+
+      /// Number of allowed levels of adaptive steps.
+      int nLevel_;
+
+      /// Number of steps in the adaptive grid.
+      int nStep_;
+
+      /// Have errors of all steps been recorded since the last adaption?
+      bool hasStepError_;
+
+      /// Maximum level of adaptive steps (longest step = 2^MaxLevel ds).
+      static const int MaxLevel = 4;
+
+      /// Maximum number of contour steps per batch in computeStress.
+      static const int StressBatchSize = 4;
+
+      /// Number of grid points per tile in computeConcentration.
+      static const int ConcentrationTileSize = 2048;
+
+      /**
+      * Compute one step of length ds_*2^level, optionally estimating
+      * its relative local error.
+      *
+      * \param q  input value of QField
+      * \param qNew  ouput value of QField
+      * \param level  step level (0 for step length ds_)
+      * \param workId  index of work space (0 or 1)
+      * \param estimate  if true, compute and return error estimate
+      * \return estimated error, or 0 if !estimate
+      */
+      double computeStep(QField const& q, QField& qNew, int level, 
+                         int workId, bool estimate);
+
+      /**
+      * Compute Simpson's rule weights for the current grid.
+      */
+      void computeSliceWeights();
+
       /** 
       * Access associated UnitCell<D> as reference.
       */  
@@ -253,6 +477,36 @@ namespace Pspc {
    inline double Block<D>::ds() const
    {  return ds_; }
 
+   /// Is adaptive contour stepping enabled?
+   template <int D>
+   inline bool Block<D>::isAdaptive() const
+   {  return (adaptiveTolerance_ > 0.0); }
+
+   /// Get tolerance for adaptive contour stepping.
+   template <int D>
+   inline double Block<D>::adaptiveTolerance() const
+   {  return adaptiveTolerance_; }
+
+   /// Get number of allowed step levels.
+   template <int D>
+   inline int Block<D>::nLevel() const
+   {  return nLevel_; }
+
+   /// Get number of contour steps in the current grid.
+   template <int D>
+   inline int Block<D>::nStep() const
+   {  return isAdaptive() ? nStep_ : ns_ - 1; }
+
+   /// Get level of step i of the adaptive grid.
+   template <int D>
+   inline int Block<D>::stepLevel(int i) const
+   {  return stepLevel_[i]; }
+
+   /// Get Simpson's rule weight of slice j of the adaptive grid.
+   template <int D>
+   inline double Block<D>::sliceWeight(int j) const
+   {  return sliceWeight_[j]; }
+
    /// Stress with respect to unit cell parameter n.
    template <int D>
    inline double Block<D>::stress(int n) const
@@ -14,11 +14,15 @@
 #include <pscf/crystal/UnitCell.h>
 #include <pscf/crystal/shiftToMinimum.h>
 #include <pscf/math/IntVec.h>
+#include <pscf/math/fieldKernels.h>
 #include <util/containers/DMatrix.h>      
 #include <util/containers/DArray.h>      
 #include <util/containers/FArray.h>      
 #include <util/containers/FSArray.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace Pscf { 
 namespace Pspc {
 
@@ -30,9 +34,15 @@ namespace Pspc {
    template <int D>
    Block<D>::Block()
     : meshPtr_(0),
+      unitCellPtr_(0),
+      wavelistPtr_(0),
       kMeshDimensions_(0),
       ds_(0.0),
-      ns_(0)
+      ns_(0),
+      adaptiveTolerance_(0.0),
+      nLevel_(1),
+      nStep_(0),
+      hasStepError_(false)
    {
       propagator(0).setBlock(*this);
       propagator(1).setBlock(*this);
@@ -46,7 +56,11 @@ namespace Pspc {
    {}
 
    template <int D>
-   void Block<D>::setDiscretization(double ds, const Mesh<D>& mesh)
+   void Block<D>::setDiscretization(double ds, const Mesh<D>& mesh,
+                                    int checkpointInterval,
+                                    bool singlePrecision,
+                                    FieldArena* workArena,
+                                    FieldArena* qArena)
    {  
       UTIL_CHECK(mesh.size() > 1);
       UTIL_CHECK(ds > 0.0);
@@ -87,23 +101,88 @@ namespace Pspc {
            kSize_ *= kMeshDimensions_[i];   
       }   
 
-      // Allocate work arrays
-      expKsq_.allocate(kMeshDimensions_);
-      expW_.allocate(mesh.dimensions());
-      expKsq2_.allocate(kMeshDimensions_);
-      expW2_.allocate(mesh.dimensions());
-      qr_.allocate(mesh.dimensions());
-      qk_.allocate(mesh.dimensions());
-      qr2_.allocate(mesh.dimensions());
-      qk2_.allocate(mesh.dimensions());
-      qf_.allocate(mesh.dimensions());
+      // Allocate work arrays (from workArena, if any)
+      expKsq_.allocate(kMeshDimensions_, workArena);
+      expW_.allocate(mesh.dimensions(), workArena);
+      expKsq2_.allocate(kMeshDimensions_, workArena);
+      expW2_.allocate(mesh.dimensions(), workArena);
+      for (int i = 0; i < 2; ++i) {
+         StepWork& work = stepWork_[i];
+         work.qr.allocate(mesh.dimensions(), workArena);
+         work.qk.allocate(mesh.dimensions(), workArena);
+         work.qr2.allocate(mesh.dimensions(), workArena);
+         work.qk2.allocate(mesh.dimensions(), workArena);
+         work.qf.allocate(mesh.dimensions(), workArena);
+
+         // Make FFT plans (required by fused transforms in step)
+         work.fft.setup(work.qr, work.qk);
+      }
+
+      stressSum_.allocate(kSize_);
 
-      dGsq_.allocate(kSize_, 6);
+      // Setup batched FFT for pairs of propagator slices in computeStress
+      int batchSize = (ns_ < StressBatchSize) ? ns_ : StressBatchSize;
+      batchSize *= 2;
+      fftBatched_.setup(mesh.dimensions(), batchSize);
+      qrBatch_.allocate(batchSize*mesh.size(), workArena);
+      qkBatch_.allocate(batchSize*kSize_, workArena);
 
-      propagator(0).allocate(ns_, mesh);
-      propagator(1).allocate(ns_, mesh);
-      cField().allocate(mesh.dimensions());
+      propagator(0).allocate(ns_, mesh, checkpointInterval, 
+                             singlePrecision, qArena);
+      propagator(1).allocate(ns_, mesh, checkpointInterval, 
+                             singlePrecision, qArena);
+      cField().allocate(mesh.dimensions(), workArena);
+
+   }
 
+   /*
+   * Enable adaptive contour stepping, starting from a uniform grid.
+   */
+   template <int D>
+   void Block<D>::setAdaptiveTolerance(double tolerance, 
+                                       FieldArena* workArena)
+   {
+      UTIL_CHECK(tolerance > 0.0);
+      UTIL_CHECK(ns_ > 1);
+      for (int d = 0; d < 2; ++d) {
+         if (propagator(d).checkpointInterval() != 1 
+             || propagator(d).isSinglePrecision()) {
+            UTIL_THROW("Adaptive stepping requires all slices in double");
+         }
+      }
+      adaptiveTolerance_ = tolerance;
+
+      if (!stepLevel_.isAllocated()) {
+
+         // Levels l with step lengths 2^l ds_ no longer than the block
+         nLevel_ = 1;
+         while (nLevel_ <= MaxLevel && (1 << nLevel_) <= ns_ - 1) {
+            ++nLevel_;
+         }
+         if (nLevel_ > 1) {
+            expKsqLevel_.allocate(nLevel_ - 1);
+            expKsq2Level_.allocate(nLevel_ - 1);
+            expWLevel_.allocate(nLevel_ - 1);
+            expW2Level_.allocate(nLevel_ - 1);
+            for (int l = 0; l < nLevel_ - 1; ++l) {
+               expKsqLevel_[l].allocate(kMeshDimensions_, workArena);
+               expKsq2Level_[l].allocate(kMeshDimensions_, workArena);
+               expWLevel_[l].allocate(mesh().dimensions(), workArena);
+               expW2Level_[l].allocate(mesh().dimensions(), workArena);
+            }
+         }
+         stepLevel_.allocate(ns_ - 1);
+         stepError_.allocate(ns_ - 1);
+         sliceWeight_.allocate(ns_);
+      }
+
+      // Initial grid of uniform steps of length ds_
+      nStep_ = ns_ - 1;
+      for (int i = 0; i < nStep_; ++i) {
+         stepLevel_[i] = 0;
+      }
+      hasStepError_ = false;
+      computeSliceWeights();
    }
 
    /*
@@ -111,31 +190,40 @@ namespace Pspc {
    */
    template <int D>
    void 
-   Block<D>::setupUnitCell(const UnitCell<D>& unitCell)
+   Block<D>::setupUnitCell(const UnitCell<D>& unitCell, 
+                           const WaveList<D>& wavelist)
    {
+      UTIL_CHECK(wavelist.hasKSq());
+      UTIL_CHECK(wavelist.kMeshDimensions() == kMeshDimensions_);
 
-      // Set association to unitCell
+      // Set associations to unitCell and wavelist
       unitCellPtr_ = &unitCell;
+      wavelistPtr_ = &wavelist;
 
-      MeshIterator<D> iter;
-      // std::cout << "kDimensions = " << kMeshDimensions_ << std::endl;
-      iter.setDimensions(kMeshDimensions_);
-      IntVec<D> G, Gmin;
-      double Gsq;
       double factor = -1.0*kuhn()*kuhn()*ds_/6.0;
-      // std::cout << "factor      = " << factor << std::endl;
-      int i;
-      for (iter.begin(); !iter.atEnd(); ++iter) {
-         i = iter.rank(); 
-         G = iter.position();
-         Gmin = shiftToMinimum(G, mesh().dimensions(), unitCell);
-         Gsq = unitCell.ksq(Gmin);
-         expKsq_[i] = exp(Gsq*factor);
-         expKsq2_[i] = exp(Gsq*factor*0.5);
-         //std::cout << i    << "  " 
-         //         << Gmin << "  " 
-         //          << Gsq  << "  "
-         //          << expKsq_[i] << std::endl;
+
+      // Normalization of unscaled forward FFTs, applied in k-space
+      double scale = 1.0/double(mesh().size());
+
+      DArray<double> const & kSq = wavelist.kSq();
+      int kSize = wavelist.kSize();
+      for (int i = 0; i < kSize; ++i) {
+         expKsq_[i] = exp(kSq[i]*factor)*scale;
+         expKsq2_[i] = exp(kSq[i]*factor*0.5)*scale;
+      }
+
+      // Longer steps of the adaptive grid
+      if (isAdaptive()) {
+         double levelFactor;
+         for (int l = 1; l < nLevel_; ++l) {
+            RField<D>& expKsqL = expKsqLevel_[l-1];
+            RField<D>& expKsq2L = expKsq2Level_[l-1];
+            levelFactor = factor*double(1 << l);
+            for (int i = 0; i < kSize; ++i) {
+               expKsqL[i] = exp(kSq[i]*levelFactor)*scale;
+               expKsq2L[i] = exp(kSq[i]*levelFactor*0.5)*scale;
+            }
+         }
       }
 
    }
@@ -151,18 +239,22 @@ namespace Pspc {
       int nx = mesh().size();
       UTIL_CHECK(nx > 0);
       
-      // Populate expW_
-      int i;
-      // std::cout << std::endl;
-      for (i = 0; i < nx; ++i) {
-         expW_[i] = exp(-0.5*w[i]*ds_);
-         expW2_[i] = exp(-0.5*0.5*w[i]*ds_);
-         // std::cout << "i = " << i 
-         //           << " expW_[i] = " << expW_[i]
-         //          << std::endl;
+      // Populate expW_ and expW2_ (full and half step)
+      expField(w.cField(), -0.5*ds_, expW_.cField(), nx);
+      expField(w.cField(), -0.25*ds_, expW2_.cField(), nx);
+
+      // Adaptive grid: Populate factors for all step levels
+      if (isAdaptive()) {
+         double dsL;
+         for (int l = 1; l < nLevel_; ++l) {
+            dsL = ds_*double(1 << l);
+            expField(w.cField(), -0.5*dsL, expWLevel_[l-1].cField(), nx);
+            expField(w.cField(), -0.25*dsL, expW2Level_[l-1].cField(), nx);
+         }
       }
 
       #if 0
+      int i;
       MeshIterator<D> iter;
       IntVec<D> G;
       IntVec<D> Gmin;
@@ -187,6 +279,135 @@ namespace Pspc {
       
    }
 
+   /*
+   * Adapt the grid to the errors recorded in the last solution.
+   *
+   * The local error of a step of length h is proportional to h^3, and 
+   * so changes by a factor of 8 per level. Steps with error greater
+   * than the tolerance are first split into 2^d steps of level l - d,
+   * using the smallest d for which the predicted error is acceptable. 
+   * Adjacent pairs of steps of equal level are then merged in repeated
+   * passes, if the predicted error of the merged step is less than 
+   * half the tolerance, which prevents merging of steps just split.
+   */
+   template <int D>
+   bool Block<D>::adaptGrid()
+   {
+      UTIL_CHECK(isAdaptive());
+      if (!hasStepError_) {
+         return false;
+      }
+      double tolerance = adaptiveTolerance_;
+      int i, j, k, d, l, n;
+      double error;
+
+      // Split steps with excessive error, in temporary arrays
+      DArray<int> levels;
+      DArray<double> errors;
+      levels.allocate(ns_ - 1);
+      errors.allocate(ns_ - 1);
+      n = 0;
+      for (i = 0; i < nStep_; ++i) {
+         l = stepLevel_[i];
+         error = stepError_[i];
+         d = 0;
+         while (l - d > 0 && error > tolerance) {
+            error /= 8.0;
+            ++d;
+         }
+         for (k = 0; k < (1 << d); ++k) {
+            UTIL_CHECK(n < ns_ - 1);
+            levels[n] = l - d;
+            errors[n] = error;
+            ++n;
+         }
+      }
+
+      // Merge pairs of steps with small error, in place
+      bool merged = true;
+      while (merged) {
+         merged = false;
+         j = 0;
+         i = 0;
+         while (i < n) {
+            l = levels[i];
+            if (i + 1 < n && levels[i+1] == l && l + 1 < nLevel_) {
+               error = 8.0*std::max(errors[i], errors[i+1]);
+               if (error < 0.5*tolerance) {
+                  levels[j] = l + 1;
+                  errors[j] = error;
+                  ++j;
+                  i += 2;
+                  merged = true;
+                  continue;
+               }
+            }
+            levels[j] = l;
+            errors[j] = errors[i];
+            ++j;
+            ++i;
+         }
+         n = j;
+      }
+
+      bool changed = (n != nStep_);
+      for (i = 0; i < n && !changed; ++i) {
+         changed = (stepLevel_[i] != levels[i]);
+      }
+      nStep_ = n;
+      for (i = 0; i < n; ++i) {
+         stepLevel_[i] = levels[i];
+      }
+      hasStepError_ = false;
+      if (changed) {
+         computeSliceWeights();
+      }
+      return changed;
+   }
+
+   /*
+   * Compute weights of slices for Simpson's rule on a non-uniform grid.
+   *
+   * Each successive pair of steps, of lengths h0 and h1, is integrated
+   * by the quadratic through its three slices. If the number of steps
+   * is odd, the last step is integrated by the quadratic through its
+   * slices and the preceding slice (or by the trapezoidal rule, if it
+   * is the only step).
+   */
+   template <int D>
+   void Block<D>::computeSliceWeights()
+   {
+      int n = nStep_;
+      UTIL_CHECK(n > 0);
+      int j;
+      for (j = 0; j <= n; ++j) {
+         sliceWeight_[j] = 0.0;
+      }
+
+      double h0, h1, h;
+      for (j = 0; j + 1 < n; j += 2) {
+         h0 = ds_*double(1 << stepLevel_[j]);
+         h1 = ds_*double(1 << stepLevel_[j+1]);
+         h = h0 + h1;
+         sliceWeight_[j] += h*(2.0 - h1/h0)/6.0;
+         sliceWeight_[j+1] += h*h*h/(6.0*h0*h1);
+         sliceWeight_[j+2] += h*(2.0 - h0/h1)/6.0;
+      }
+      if (j < n) {
+         h1 = ds_*double(1 << stepLevel_[j]);
+         if (j == 0) {
+            sliceWeight_[0] += 0.5*h1;
+            sliceWeight_[1] += 0.5*h1;
+         } else {
+            h0 = ds_*double(1 << stepLevel_[j-1]);
+            h = h0 + h1;
+            sliceWeight_[j-1] -= h1*h1*h1/(6.0*h0*h);
+            sliceWeight_[j] += h1*(h1 + 3.0*h0)/(6.0*h0);
+            sliceWeight_[j+1] += h1*(2.0*h1 + 3.0*h0)/(6.0*h);
+         }
+      }
+   }
+
    /*
    * Integrate to calculate monomer concentration for this block
    */
@@ -202,38 +423,115 @@ namespace Pspc {
       UTIL_CHECK(propagator(1).isAllocated());
       UTIL_CHECK(cField().capacity() == nx) 
 
-      // Initialize cField to zero at all points
-      int i;
-      for (i = 0; i < nx; ++i) {
-         cField()[i] = 0.0;
+      Propagator<D>& p0 = propagator(0);
+      Propagator<D>& p1 = propagator(1);
+      double* cPtr = cField().cField();
+
+      // Adaptive grid: Non-uniform Simpson's rule weights, by tiles
+      if (isAdaptive()) {
+         int n = nStep_;
+         int nTile = (nx + ConcentrationTileSize - 1)/ConcentrationTileSize;
+         #ifdef PSPC_OPENMP
+         #pragma omp parallel for schedule(static)
+         #endif
+         for (int t = 0; t < nTile; ++t) {
+            int begin = t*ConcentrationTileSize;
+            int end = begin + ConcentrationTileSize;
+            if (end > nx) {
+               end = nx;
+            }
+            int m = end - begin;
+            double const * q0Ptr = p0.q(0).cField();
+            double const * q1Ptr = p1.q(n).cField();
+            mulField(q0Ptr + begin, q1Ptr + begin, cPtr + begin, m);
+            scaleField(sliceWeight_[0], cPtr + begin, m);
+            for (int j = 1; j <= n; ++j) {
+               q0Ptr = p0.q(j).cField();
+               q1Ptr = p1.q(n - j).cField();
+               mulAddField(sliceWeight_[j], q0Ptr + begin, q1Ptr + begin,
+                           cPtr + begin, m);
+            }
+            scaleField(prefactor, cPtr + begin, m);
+         }
+         return;
       }
 
-      Propagator<D> const & p0 = propagator(0);
-      Propagator<D> const & p1 = propagator(1);
-
-      // Evaluate unnormalized integral
-      for(i = 0; i < nx; ++i) {
-         cField()[i] += p0.q(0)[i]*p1.q(ns_ - 1)[i];
-         cField()[i] += p0.q(ns_ -1)[i]*p1.q(0)[i];
-      }
+      prefactor *= ds_ / 3.0;
 
-      //odd indices
-      for(int j = 1; j < (ns_ -1); j += 2) {
-         for(int i = 0; i < nx; ++i) {
-            cField()[i] += p0.q(j)[i] * p1.q(ns_ - 1 - j)[i] * 4.0;   
+      // With checkpointed propagators, loop over slices in order of 
+      // increasing j for propagator 0 and decreasing j for propagator 1,
+      // so that each segment of slices is recomputed only once.
+      if (p0.checkpointInterval() > 1 || p1.checkpointInterval() > 1) {
+         double weight;
+         for (int j = 0; j < ns_; ++j) {
+            if (j == 0 || j == ns_ - 1) {
+               weight = 1.0;
+            } else {
+               weight = (j % 2 == 1) ? 4.0 : 2.0;
+            }
+            double const * q0Ptr = p0.qSlice(j).cField();
+            double const * q1Ptr = p1.qSlice(ns_ - 1 - j).cField();
+            if (j == 0) {
+               mulField(q0Ptr, q1Ptr, cPtr, nx);
+            } else {
+               mulAddField(weight, q0Ptr, q1Ptr, cPtr, nx);
+            }
          }
+         scaleField(prefactor, cPtr, nx);
+         return;
       }
 
-      //even indices
-      for(int j = 2; j < (ns_ -2); j += 2) {
-         for(int i = 0; i < nx; ++i) {
-            cField()[i] += p0.q(j)[i] * p1.q(ns_ - 1 - j)[i] * 2.0;   
+      // Evaluate integral by Simpson's rule, one tile of grid points at
+      // a time, so that partial sums for a tile remain in cache while
+      // all contour slices are added. Interior slices j have weight 4 
+      // for odd j and 2 for even j.
+      int nTile = (nx + ConcentrationTileSize - 1)/ConcentrationTileSize;
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel for schedule(static)
+      #endif
+      for (int t = 0; t < nTile; ++t) {
+         int begin = t*ConcentrationTileSize;
+         int end = begin + ConcentrationTileSize;
+         if (end > nx) {
+            end = nx;
+         }
+         double const * q0Ptr;
+         double const * q1Ptr;
+         double weight;
+         int n = end - begin;
+         int i, j;
+
+         // End points
+         q0Ptr = p0.q(0).cField();
+         q1Ptr = p1.q(ns_ - 1).cField();
+         mulField(q0Ptr + begin, q1Ptr + begin, cPtr + begin, n);
+         q0Ptr = p0.q(ns_ - 1).cField();
+         q1Ptr = p1.q(0).cField();
+         mulAddField(1.0, q0Ptr + begin, q1Ptr + begin, cPtr + begin, n);
+
+         // Interior points
+         if (p0.isSinglePrecision()) {
+            float const * f0Ptr;
+            float const * f1Ptr;
+            for (j = 1; j < ns_ - 1; ++j) {
+               weight = (j % 2 == 1) ? 4.0 : 2.0;
+               f0Ptr = p0.qFloat(j).cField();
+               f1Ptr = p1.qFloat(ns_ - 1 - j).cField();
+               for (i = begin; i < end; ++i) {
+                  cPtr[i] += weight*double(f0Ptr[i])*double(f1Ptr[i]);
+               }
+            }
+         } else {
+            for (j = 1; j < ns_ - 1; ++j) {
+               weight = (j % 2 == 1) ? 4.0 : 2.0;
+               q0Ptr = p0.q(j).cField();
+               q1Ptr = p1.q(ns_ - 1 - j).cField();
+               mulAddField(weight, q0Ptr + begin, q1Ptr + begin,
+                           cPtr + begin, n);
+            }
          }
-      }
 
-      prefactor *= ds_ / 3.0;
-      for (i = 0; i < nx; ++i) {
-         cField()[i] *= prefactor;
+         scaleField(prefactor, cPtr + begin, n);
       }
 
    }
@@ -254,7 +552,7 @@ namespace Pspc {
 
       stress_.clear();
 
-      double dels, normal, increment;
+      double dels, normal;
       int r, c, m;
  
       normal = 3.0*6.0;
@@ -275,88 +573,250 @@ namespace Pspc {
          stress_.append(0.0);
       }   
 
-      computedGsq();
-
-      Propagator<D> const & p0 = propagator(0);
-      Propagator<D> const & p1 = propagator(1);
-
-      // Evaluate unnormalized integral   
-      for (int j = 0; j < ns_ ; ++j) {
-           
-           qr_ = p0.q(j);
-           fft_.forwardTransform(qr_, qk_);
-           
-           qr2_ = p1.q(ns_ - 1 - j);
-           fft_.forwardTransform(qr2_, qk2_); 
-
-           dels = ds_;
-
-           if (j != 0 && j != ns_ - 1) {
-              if (j % 2 == 0) {
-                 dels = dels*2.0;
-              } else {
-                 dels = dels*4.0;
-              }           
-           }
-
-           for (int n = 0; n < r ; ++n) {
-              increment = 0;
-
-              for (m = 0; m < c ; ++m) {
-                 double prod = 0;
-                 prod = (qk2_[m][0] * qk_[m][0]) + (qk2_[m][1] * qk_[m][1]);
-                 prod *= dGsq_(m,n); 
-                 increment += prod; 
-              }
-              increment = (increment * kuhn() * kuhn() * dels)/normal;
-              dQ [n] = dQ[n]-increment; 
-           }    
+      UTIL_CHECK(wavelistPtr_);
+      UTIL_CHECK(wavelistPtr_->hasdKSq());
+      DMatrix<double> const & dkSq = wavelistPtr_->dkSq();
+
+      // Slices are accessed in order of increasing j for propagator 0
+      // and decreasing j for propagator 1, as required for efficient
+      // recomputation of slices of checkpointed propagators.
+      Propagator<D>& p0 = propagator(0);
+      Propagator<D>& p1 = propagator(1);
+      int ns = nStep() + 1;
+
+      // Batches of contour steps: Within a batch, slot 2*b holds slice
+      // j = j0 + b of propagator 0 and slot 2*b+1 holds slice ns-1-j 
+      // of propagator 1. Both are transformed by one batched FFT.
+      int nb = fftBatched_.batchSize()/2;
+      double* qrPtr;
+      fftw_complex const * qkPtr;
+      fftw_complex const * qk2Ptr;
+      int j0, j, b, nj, k;
+
+      // Accumulate the Simpson's rule sum over contour steps of the
+      // products of transformed slices at each wavevector
+      double* sumPtr = stressSum_.cArray();
+      for (m = 0; m < c; ++m) {
+         sumPtr[m] = 0.0;
+      }
+      for (j0 = 0; j0 < ns; j0 += nb) {
+
+         // Gather slices into contiguous batch, zero any unused slots
+         nj = std::min(nb, ns - j0);
+         for (b = 0; b < nb; ++b) {
+            qrPtr = qrBatch_.cField() + 2*b*nx;
+            if (b < nj) {
+               j = j0 + b;
+               QField const & q0 = p0.qSlice(j);
+               QField const & q1 = p1.qSlice(ns - 1 - j);
+               for (k = 0; k < nx; ++k) {
+                  qrPtr[k] = q0[k];
+                  qrPtr[nx + k] = q1[k];
+               }
+            } else {
+               for (k = 0; k < 2*nx; ++k) {
+                  qrPtr[k] = 0.0;
+               }
+            }
+         }
+         fftBatched_.forwardTransformUnscaled(qrBatch_, qkBatch_);
+
+         for (b = 0; b < nj; ++b) {
+            j = j0 + b;
+            qkPtr = qkBatch_.cField() + 2*b*c;
+            qk2Ptr = qkPtr + c;
+
+            // Simpson's rule weight, times 3 (included in normal)
+            if (isAdaptive()) {
+               dels = 3.0*sliceWeight_[j];
+            } else {
+               dels = ds_;
+               if (j != 0 && j != ns - 1) {
+                  if (j % 2 == 0) {
+                     dels = dels*2.0;
+                  } else {
+                     dels = dels*4.0;
+                  }           
+               }
+            }
+
+            for (m = 0; m < c; ++m) {
+               sumPtr[m] += dels*((qk2Ptr[m][0] * qkPtr[m][0]) 
+                                + (qk2Ptr[m][1] * qkPtr[m][1]));
+            }
+         }
       }   
+
+      // Contract the sum with the derivatives for each parameter
+      double const * dkSqPtr;
+      double increment;
+      for (int n = 0; n < r; ++n) {
+         dkSqPtr = dkSq.cArray() + n*c;
+         increment = 0.0;
+         for (m = 0; m < c; ++m) {
+            increment += dkSqPtr[m]*sumPtr[m];
+         }
+         increment = (increment * kuhn() * kuhn())/normal;
+         dQ[n] = dQ[n] - increment;
+      }
       
-      // Normalize
+      // Normalize, including factor 1/nx^2 for unscaled transforms
+      double scale = 1.0/double(nx);
       for (i = 0; i < r; ++i) {
-         stress_[i] = stress_[i] - (dQ[i] * prefactor);
+         stress_[i] = stress_[i] - (dQ[i] * scale * scale * prefactor);
       }   
 
    }
 
-   /*  
-   * Compute dGsq_
-   */  
+   /*
+   * Propagate solution by one step of length ds.
+   */
+   template <int D>
+   void Block<D>::step(QField const & q, QField& qNew, int workId)
+   {  computeStep(q, qNew, 0, workId, false); }
+
+   /*
+   * Propagate solution by one step of the adaptive grid.
+   */
+   template <int D>
+   void Block<D>::stepAdaptive(QField const & q, QField& qNew, int i, 
+                               int directionId)
+   {
+      UTIL_CHECK(isAdaptive());
+      UTIL_CHECK(i >= 0 && i < nStep_);
+      if (directionId == 0) {
+         stepError_[i] = computeStep(q, qNew, stepLevel_[i], 0, true);
+         if (i == nStep_ - 1) {
+            hasStepError_ = true;
+         }
+      } else {
+         UTIL_CHECK(directionId == 1);
+         computeStep(q, qNew, stepLevel_[nStep_ - 1 - i], 1, false);
+      }
+   }
+
+   /*
+   * Propagate solution by one step of length h = ds*2^level.
+   *
+   * Richardson extrapolation of one full step of length h and two
+   * half steps of length h/2. Pointwise multiplications by exp(-W)
+   * factors are fused into the copy that precedes each forward FFT, 
+   * or into the final extrapolation. The two exp(-W h/4) factors 
+   * applied at the midpoint of the pair of half steps are combined 
+   * into a single factor of expW. Forward transforms are unscaled: 
+   * The FFT normalization is included in expKsq and expKsq2.
+   *
+   * If estimate is true, the relative local error of the two half
+   * steps, which is 1/3 of their difference from the full step to
+   * leading order, is also computed and returned.
+   */
    template <int D>
-   void Block<D>::computedGsq()
+   double Block<D>::computeStep(QField const & q, QField& qNew, 
+                                int level, int workId, bool estimate)
    {
-      IntVec<D> temp;
-      IntVec<D> vec;
-      IntVec<D> Partner;
-      MeshIterator<D> iter;
-      iter.setDimensions(kMeshDimensions_);
+      UTIL_CHECK(workId >= 0 && workId < 2);
+      UTIL_CHECK(level >= 0 && level < nLevel_);
+      StepWork& work = stepWork_[workId];
+
+      // Exponential factors for this step length
+      RField<D> const & expW 
+                       = (level == 0) ? expW_ : expWLevel_[level-1];
+      RField<D> const & expW2 
+                       = (level == 0) ? expW2_ : expW2Level_[level-1];
+      RField<D> const & expKsq 
+                       = (level == 0) ? expKsq_ : expKsqLevel_[level-1];
+      RField<D> const & expKsq2
+                       = (level == 0) ? expKsq2_ : expKsq2Level_[level-1];
+
+      // Check real-space mesh sizes
+      int nx = mesh().size();
+      UTIL_CHECK(nx > 0);
+      UTIL_CHECK(q.isAllocated());
+      UTIL_CHECK(qNew.isAllocated());
+      UTIL_CHECK(q.capacity() == nx);
+      UTIL_CHECK(qNew.capacity() == nx);
+      UTIL_CHECK(work.qr.capacity() == nx);
+      UTIL_CHECK(expW.capacity() == nx);
 
-      for (int n = 0; n < unitCellPtr_->nParameter() ; ++n) {
-         for (iter.begin(); !iter.atEnd(); ++iter) {
-            temp = iter.position();
-            vec = shiftToMinimum(temp, mesh().dimensions(), *unitCellPtr_);
-            dGsq_(iter.rank(), n) = unitCellPtr_->dksq(vec, n);
-            for (int p = 0; p < D; ++p) {
-               if (temp [p] != 0) {
-                  Partner[p] = mesh().dimensions()[p] - temp[p];
-               } else {
-                  Partner[p] = 0;
-               }
-            }
-            if (Partner[D-1] > kMeshDimensions_[D-1]) {
-               dGsq_(iter.rank(), n) *= 2;
-            }
+      // Fourier-space mesh sizes
+      int nk = work.qk.capacity();
+      UTIL_CHECK(expKsq.capacity() == nk);
+
+      // Forward transforms of q*expW (full step) and q*expW2 (half step)
+      work.fft.forwardTransformUnscaled(q, expW, work.qk);
+      work.fft.forwardTransformUnscaled(q, expW2, work.qk2);
+
+      // Multiply by k-space factors, treating interleaved complex 
+      // elements of work.qk and work.qk2 as contiguous arrays of doubles
+      double* qkPtr = &work.qk[0][0];
+      double* qk2Ptr = &work.qk2[0][0];
+      double const * expKsqPtr = expKsq.cField();
+      double const * expKsq2Ptr = expKsq2.cField();
+      int i;
+      for (i = 0; i < nk; ++i) {
+         qkPtr[2*i] *= expKsqPtr[i];
+         qkPtr[2*i+1] *= expKsqPtr[i];
+         qk2Ptr[2*i] *= expKsq2Ptr[i];
+         qk2Ptr[2*i+1] *= expKsq2Ptr[i];
+      }
+      work.fft.inverseTransform(work.qk, work.qr);
+      work.fft.inverseTransform(work.qk2, work.qr2);
+
+      // Second half step, starting from qr2*expW2*expW2 = qr2*expW
+      work.fft.forwardTransformUnscaled(work.qr2, expW, work.qk2);
+      for (i = 0; i < nk; ++i) {
+         qk2Ptr[2*i] *= expKsq2Ptr[i];
+         qk2Ptr[2*i+1] *= expKsq2Ptr[i];
+      }
+      work.fft.inverseTransform(work.qk2, work.qr2);
+
+      // Apply final exp(-W) factors and Richardson extrapolation
+      double const * expWPtr = expW.cField();
+      double const * expW2Ptr = expW2.cField();
+      double const * qrPtr = work.qr.cField();
+      double const * qr2Ptr = work.qr2.cField();
+      double* qNewPtr = qNew.cField();
+      const double c1 = 4.0/3.0;
+      const double c2 = 1.0/3.0;
+      if (!estimate) {
+         for (i = 0; i < nx; ++i) {
+            qNewPtr[i] = c1*qr2Ptr[i]*expW2Ptr[i] - c2*qrPtr[i]*expWPtr[i];
          }
+         return 0.0;
+      }
+
+      // Also find maximum difference of full and two half step results,
+      // and maximum of the extrapolated result
+      double diff, diffMax, qMax;
+      diffMax = 0.0;
+      qMax = 0.0;
+      for (i = 0; i < nx; ++i) {
+         qNewPtr[i] = c1*qr2Ptr[i]*expW2Ptr[i] - c2*qrPtr[i]*expWPtr[i];
+         diff = std::abs(qr2Ptr[i]*expW2Ptr[i] - qrPtr[i]*expWPtr[i]);
+         if (diff > diffMax) {
+            diffMax = diff;
+         }
+         if (std::abs(qNewPtr[i]) > qMax) {
+            qMax = std::abs(qNewPtr[i]);
+         }
+      }
+      if (qMax > 0.0) {
+         return diffMax/(3.0*qMax);
+      } else {
+         return 0.0;
       }
    }
 
+
    /*
-   * Propagate solution by one step.
+   * Propagate solution by one step (unfused reference algorithm).
    */
    template <int D>
-   void Block<D>::step(QField const & q, QField& qNew)
+   void Block<D>::stepUnfused(QField const & q, QField& qNew, int workId)
    {
+      UTIL_CHECK(workId >= 0 && workId < 2);
+      StepWork& work = stepWork_[workId];
+
       // Check real-space mesh sizes`
       int nx = mesh().size();
       UTIL_CHECK(nx > 0);
@@ -364,45 +824,45 @@ namespace Pspc {
       UTIL_CHECK(qNew.isAllocated());
       UTIL_CHECK(q.capacity() == nx);
       UTIL_CHECK(qNew.capacity() == nx);
-      UTIL_CHECK(qr_.capacity() == nx);
+      UTIL_CHECK(work.qr.capacity() == nx);
       UTIL_CHECK(expW_.capacity() == nx);
 
       // Fourier-space mesh sizes
-      int nk = qk_.capacity();
+      int nk = work.qk.capacity();
       UTIL_CHECK(expKsq_.capacity() == nk);
 
       // Apply pseudo-spectral algorithm
       int i;
       for (i = 0; i < nx; ++i) {
-         qr_[i] = q[i]*expW_[i];
-         qr2_[i] = q[i]*expW2_[i];
+         work.qr[i] = q[i]*expW_[i];
+         work.qr2[i] = q[i]*expW2_[i];
       }
-      fft_.forwardTransform(qr_, qk_);
-      fft_.forwardTransform(qr2_, qk2_);
+      work.fft.forwardTransformUnscaled(work.qr, work.qk);
+      work.fft.forwardTransformUnscaled(work.qr2, work.qk2);
       for (i = 0; i < nk; ++i) {
-         qk_[i][0] *= expKsq_[i];
-         qk_[i][1] *= expKsq_[i];
-         qk2_[i][0] *= expKsq2_[i];
-         qk2_[i][1] *= expKsq2_[i];
+         work.qk[i][0] *= expKsq_[i];
+         work.qk[i][1] *= expKsq_[i];
+         work.qk2[i][0] *= expKsq2_[i];
+         work.qk2[i][1] *= expKsq2_[i];
       }
-      fft_.inverseTransform(qk_, qr_);
-      fft_.inverseTransform(qk2_, qr2_);
+      work.fft.inverseTransform(work.qk, work.qr);
+      work.fft.inverseTransform(work.qk2, work.qr2);
       for (i = 0; i < nx; ++i) {
-         qf_[i] = qr_[i]*expW_[i];
-         qr2_[i] = qr2_[i]*expW_[i];
+         work.qf[i] = work.qr[i]*expW_[i];
+         work.qr2[i] = work.qr2[i]*expW_[i];
       }
 
-      fft_.forwardTransform(qr2_, qk2_);
+      work.fft.forwardTransformUnscaled(work.qr2, work.qk2);
       for (i = 0; i < nk; ++i) {
-         qk2_[i][0] *= expKsq2_[i];
-         qk2_[i][1] *= expKsq2_[i];
+         work.qk2[i][0] *= expKsq2_[i];
+         work.qk2[i][1] *= expKsq2_[i];
       }
-      fft_.inverseTransform(qk2_, qr2_);
+      work.fft.inverseTransform(work.qk2, work.qr2);
       for (i = 0; i < nx; ++i) {
-         qr2_[i] = qr2_[i]*expW2_[i];
+         work.qr2[i] = work.qr2[i]*expW2_[i];
       }
       for (i = 0; i < nx; ++i) {
-         qNew[i] = (4.0*qr2_[i] - qf_[i])/3.0;
+         qNew[i] = (4.0*work.qr2[i] - work.qf[i])/3.0;
       }
    }
 
@@ -12,6 +12,7 @@
 #include "Solvent.h"
 #include <pscf/solvers/MixtureTmpl.h>
 #include <pscf/inter/Interaction.h>
+#include <pspc/field/FieldArena.h>
 #include <util/containers/DArray.h>
 #include <util/containers/FArray.h>
 
@@ -110,11 +111,14 @@ namespace Pspc
       * 
       * This function resets unit cell information in the solvers for 
       * every species in the system. It should be called once after
-      * every change in the unit cell.
+      * every change in the unit cell, after the |G|^2 values and their
+      * derivatives in the wavelist have been updated.
       *
       * \param unitCell UnitCell<D> object that contains Bravais lattice.
+      * \param wavelist wavevector data shared by all blocks
       */
-      void setupUnitCell(const UnitCell<D>& unitCell);
+      void setupUnitCell(const UnitCell<D>& unitCell, 
+                         const WaveList<D>& wavelist);
 
       /**
       * Compute partition functions and concentrations.
@@ -145,6 +149,24 @@ namespace Pspc
       */
       void computeStress();
 
+      /**
+      * Adapt the contour grids of all blocks to the last solution.
+      *
+      * Calls Block<D>::adaptGrid for every block, using step errors
+      * recorded by the last call to compute. This should be called
+      * only between iterative solutions of the SCF equations, so that
+      * the grids stay fixed while the iterator converges.
+      *
+      * \pre isAdaptive() is true.
+      * \return true if the grid of any block changed, false otherwise
+      */
+      bool adaptContour();
+
+      /**
+      * Are contour steps chosen adaptively (adaptiveTolerance > 0)?
+      */
+      bool isAdaptive() const;
+
       /**
       * Get derivative of free energy w/ respect to a unit cell parameter.
       *
@@ -163,6 +185,16 @@ namespace Pspc
       */
       double vMonomer() const;
 
+      /**
+      * Get arena for propagator slices of all blocks.
+      */
+      FieldArena& propagatorArena();
+
+      /**
+      * Get arena for work fields and concentrations of all blocks.
+      */
+      FieldArena& blockArena();
+
       // Inherited public member functions with non-dependent names
       using MixtureTmpl< Polymer<D>, Solvent<D> >::nMonomer;
       using MixtureTmpl< Polymer<D>, Solvent<D> >::nPolymer;
@@ -184,9 +216,24 @@ namespace Pspc
       /// Optimal contour length step size.
       double ds_;
 
+      /// Interval between stored propagator slices (1 by default).
+      int checkpointInterval_;
+
+      /// Store propagator slices in single precision? (false by default)
+      bool singlePrecision_;
+
+      /// Tolerance for adaptive contour steps (0, disabled, by default).
+      double adaptiveTolerance_;
+
       /// Array to store total stress
       FArray<double, 6> stress_;
 
+      /// Memory for propagator slices, allocated by setMesh.
+      FieldArena propagatorArena_;
+
+      /// Memory for block work fields, allocated by setMesh.
+      FieldArena blockArena_;
+
       /// Pointer to associated Mesh<D> object.
       Mesh<D> const * meshPtr_;
 
@@ -206,10 +253,24 @@ namespace Pspc
    {  return vMonomer_; }
 
    // Stress with respect to unit cell parameter n.
+   template <int D>
+   inline bool Mixture<D>::isAdaptive() const
+   {  return (adaptiveTolerance_ > 0.0); }
+
    template <int D>
    inline double Mixture<D>::stress(int n) const
    {  return stress_[n]; }
 
+   // Get arena for propagator slices (public).
+   template <int D>
+   inline FieldArena& Mixture<D>::propagatorArena()
+   {  return propagatorArena_; }
+
+   // Get arena for block work fields (public).
+   template <int D>
+   inline FieldArena& Mixture<D>::blockArena()
+   {  return blockArena_; }
+
    // Get Mesh<D> by constant reference (private).
    template <int D>
    inline Mesh<D> const & Mixture<D>::mesh() const
@@ -10,8 +10,10 @@
 
 #include "Mixture.h"
 #include <pscf/mesh/Mesh.h>
+#include <pscf/math/fieldKernels.h>
 
 #include <cmath>
+#include <exception>
 
 namespace Pscf {
 namespace Pspc
@@ -21,6 +23,11 @@ namespace Pspc
    Mixture<D>::Mixture()
     : vMonomer_(1.0),
       ds_(-1.0),
+      checkpointInterval_(1),
+      singlePrecision_(false),
+      adaptiveTolerance_(0.0),
+      propagatorArena_("propagators"),
+      blockArena_("block work"),
       meshPtr_(0),
       unitCellPtr_(0)
    {  setClassName("Mixture"); }
@@ -36,10 +43,23 @@ namespace Pspc
       vMonomer_ = 1.0; // Default value
       readOptional(in, "vMonomer", vMonomer_);
       read(in, "ds", ds_);
+      checkpointInterval_ = 1; // Default value
+      readOptional(in, "checkpointInterval", checkpointInterval_);
+      singlePrecision_ = false; // Default value
+      readOptional(in, "singlePrecision", singlePrecision_);
+      adaptiveTolerance_ = 0.0; // Default value (disabled)
+      readOptional(in, "adaptiveTolerance", adaptiveTolerance_);
 
       UTIL_CHECK(nMonomer() > 0);
       UTIL_CHECK(nPolymer()+ nSolvent() > 0);
       UTIL_CHECK(ds_ > 0);
+      UTIL_CHECK(checkpointInterval_ > 0);
+      UTIL_CHECK(adaptiveTolerance_ >= 0.0);
+      if (adaptiveTolerance_ > 0.0) {
+         if (checkpointInterval_ > 1 || singlePrecision_) {
+            UTIL_THROW("adaptiveTolerance requires all slices in double");
+         }
+      }
    }
 
    template <int D>
@@ -55,21 +75,30 @@ namespace Pspc
       int i, j;
       for (i = 0; i < nPolymer(); ++i) {
          for (j = 0; j < polymer(i).nBlock(); ++j) {
-            polymer(i).block(j).setDiscretization(ds_, mesh);
+            polymer(i).block(j).setDiscretization(ds_, mesh, 
+                                                  checkpointInterval_,
+                                                  singlePrecision_,
+                                                  &blockArena_,
+                                                  &propagatorArena_);
+            if (adaptiveTolerance_ > 0.0) {
+               polymer(i).block(j).setAdaptiveTolerance(adaptiveTolerance_,
+                                                        &blockArena_);
+            }
          }
       }
 
    }
 
    template <int D>
-   void Mixture<D>::setupUnitCell(const UnitCell<D>& unitCell)
+   void Mixture<D>::setupUnitCell(const UnitCell<D>& unitCell,
+                                  const WaveList<D>& wavelist)
    {
 
       // Set association to unitCell
       unitCellPtr_ = &unitCell;
 
       for (int i = 0; i < nPolymer(); ++i) {
-         polymer(i).setupUnitCell(unitCell);
+         polymer(i).setupUnitCell(unitCell, wavelist);
       }
    }
 
@@ -89,20 +118,39 @@ namespace Pspc
 
       int nx = mesh().size();
       int nm = nMonomer();
-      int i, j, k;
+      int i, j;
 
       // Clear all monomer concentration fields
       for (i = 0; i < nm; ++i) {
          UTIL_CHECK(cFields[i].capacity() == nx);
          UTIL_CHECK(wFields[i].capacity() == nx);
-         for (j = 0; j < nx; ++j) {
-            cFields[i][j] = 0.0;
-         }
+         setField(0.0, cFields[i].cField(), nx);
       }
 
-      // Solve MDE for all polymers
-      for (i = 0; i < nPolymer(); ++i) {
-         polymer(i).compute(wFields);
+      // Solve MDE for all polymers. Distinct polymers are independent,
+      // and may be solved by different threads. With one polymer, the
+      // outer region is inactive, allowing nested parallelism within 
+      // Polymer<D>::compute. An exception thrown for any polymer is 
+      // rethrown after the loop, since it may not leave the region.
+      int np = nPolymer();
+      std::exception_ptr error;
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel for schedule(dynamic, 1) if (np > 1)
+      #endif
+      for (i = 0; i < np; ++i) {
+         try {
+            polymer(i).compute(wFields);
+         } catch (...) {
+            #ifdef PSPC_OPENMP
+            #pragma omp critical
+            #endif
+            {
+               if (!error) error = std::current_exception();
+            }
+         }
+      }
+      if (error) {
+         std::rethrow_exception(error);
       }
 
       // Accumulate monomer concentration fields
@@ -113,9 +161,7 @@ namespace Pspc
             UTIL_CHECK(monomerId < nm);
             CField& monomerField = cFields[monomerId];
             CField& blockField = polymer(i).block(j).cField();
-            for (k = 0; k < nx; ++k) {
-               monomerField[k] += blockField[k];
-            }
+            addField(blockField.cField(), monomerField.cField(), nx);
          }
       }
 
@@ -148,6 +194,25 @@ namespace Pspc
       }
    }
 
+   /*
+   * Adapt contour grids of all blocks to the last solution.
+   */
+   template <int D>
+   bool Mixture<D>::adaptContour()
+   {
+      UTIL_CHECK(isAdaptive());
+      bool changed = false;
+      int i, j;
+      for (i = 0; i < nPolymer(); ++i) {
+         for (j = 0; j < polymer(i).nBlock(); ++j) {
+            if (polymer(i).block(j).adaptGrid()) {
+               changed = true;
+            }
+         }
+      }
+      return changed;
+   }
+
 } // namespace Pspc
 } // namespace Pscf
 #endif
@@ -12,6 +12,7 @@
 #include <pscf/solvers/PolymerTmpl.h>
 #include <pspc/field/RField.h>
 #include <util/containers/FArray.h>      // member template
+#include <util/containers/DArray.h>      // member template
 
 namespace Pscf { 
 namespace Pspc { 
@@ -78,8 +79,10 @@ namespace Pspc {
       * polymer.
       *
       * \param unitCell crystallographic unit cell
+      * \param wavelist wavevector data for the current unit cell
       */ 
-      void setupUnitCell(UnitCell<D> const & unitCell);
+      void setupUnitCell(UnitCell<D> const & unitCell, 
+                         WaveList<D> const & wavelist);
 
       /**
       * Compute solution to MDE and block concentrations.
@@ -123,9 +126,25 @@ namespace Pspc {
       using Base::ensemble;
       using Base::solve;
       using Base::length;
+      using Base::nPropagator;
+      using Base::propagator;
 
    protected:
 
+      /**
+      * Solve the MDE for all propagators, concurrently where possible.
+      *
+      * Propagators are grouped into levels: A propagator with no 
+      * sources is in level 0, and any other propagator is in a level
+      * one greater than the highest level of any of its sources. All 
+      * propagators within a level are thus independent. Levels are 
+      * solved in order. If PSPC_OPENMP is defined, the propagators 
+      * within each level are distributed among OpenMP threads. This 
+      * requires that the two propagators of each block use separate 
+      * work space (see Block<D>::step).
+      */
+      virtual void solvePropagators();
+
       using ParamComposite::setClassName;
 
    private: 
@@ -133,6 +152,20 @@ namespace Pspc {
       /// Pointer to associated UnitCell<D>
       const UnitCell<D>* unitCellPtr_;
 
+      /// Propagator indices, sorted by level.
+      DArray<int> scheduleIds_;
+
+      /// Index in scheduleIds_ of first propagator in each level.
+      DArray<int> levelBegin_;
+
+      /// Number of levels of mutually independent propagators.
+      int nLevel_;
+
+      /**
+      * Assign propagators to levels and create schedule.
+      */
+      void makeSchedule();
+
       /// Stress contribution from this polymer species
       FArray<double, 6> stress_;
 
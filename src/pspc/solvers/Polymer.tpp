@@ -10,11 +10,17 @@
 
 #include "Polymer.h"
 
+#include <exception>
+
 namespace Pscf {
 namespace Pspc { 
 
    template <int D>
    Polymer<D>::Polymer()
+    : unitCellPtr_(0),
+      scheduleIds_(),
+      levelBegin_(),
+      nLevel_(0)
    {  setClassName("Polymer");}
 
    template <int D>
@@ -41,13 +47,14 @@ namespace Pspc {
    * Set unit cell dimensions in all solvers.
    */ 
    template <int D>
-   void Polymer<D>::setupUnitCell(UnitCell<D> const & unitCell)
+   void Polymer<D>::setupUnitCell(UnitCell<D> const & unitCell,
+                                  WaveList<D> const & wavelist)
    {
       // Set association to unitCell
       unitCellPtr_ = &unitCell;
 
       for (int j = 0; j < nBlock(); ++j) {
-         block(j).setupUnitCell(unitCell);
+         block(j).setupUnitCell(unitCell, wavelist);
       }
    }
 
@@ -68,6 +75,99 @@ namespace Pspc {
       solve();
    }
 
+   /*
+   * Solve the MDE for all propagators, one level at a time.
+   */ 
+   template <int D>
+   void Polymer<D>::solvePropagators()
+   {
+      if (!scheduleIds_.isAllocated()) {
+         makeSchedule();
+      }
+
+      int begin, end, k;
+      for (int level = 0; level < nLevel_; ++level) {
+         begin = levelBegin_[level];
+         end = levelBegin_[level + 1];
+
+         // Check before solving, to avoid throwing in a parallel region
+         for (k = begin; k < end; ++k) {
+            UTIL_CHECK(propagator(scheduleIds_[k]).isReady());
+            UTIL_CHECK(propagator(scheduleIds_[k]).isAllocated());
+         }
+
+         // An exception thrown by any solve is rethrown after the loop
+         std::exception_ptr error;
+         #ifdef PSPC_OPENMP
+         #pragma omp parallel for schedule(dynamic, 1)
+         #endif
+         for (k = begin; k < end; ++k) {
+            try {
+               propagator(scheduleIds_[k]).solve();
+            } catch (...) {
+               #ifdef PSPC_OPENMP
+               #pragma omp critical
+               #endif
+               {
+                  if (!error) error = std::current_exception();
+               }
+            }
+         }
+         if (error) {
+            std::rethrow_exception(error);
+         }
+      }
+   }
+
+   /*
+   * Assign propagators to levels of mutually independent propagators.
+   */ 
+   template <int D>
+   void Polymer<D>::makeSchedule()
+   {
+      int nP = nPropagator();
+      UTIL_CHECK(nP > 0);
+
+      // Compute level of each propagator. Sources of propagator j 
+      // precede j in the order of computation given by propagator(j).
+      DArray<int> levels;
+      levels.allocate(nP);
+      nLevel_ = 0;
+      int i, j, k;
+      for (j = 0; j < nP; ++j) {
+         Propagator<D> const & p = propagator(j);
+         levels[j] = 0;
+         for (i = 0; i < p.nSource(); ++i) {
+            for (k = 0; k < j; ++k) {
+               if (&propagator(k) == &p.source(i)) {
+                  if (levels[k] + 1 > levels[j]) {
+                     levels[j] = levels[k] + 1;
+                  }
+               }
+            }
+         }
+         if (levels[j] + 1 > nLevel_) {
+            nLevel_ = levels[j] + 1;
+         }
+      }
+
+      // Sort propagator indices by level
+      scheduleIds_.allocate(nP);
+      levelBegin_.allocate(nLevel_ + 1);
+      k = 0;
+      for (i = 0; i < nLevel_; ++i) {
+         levelBegin_[i] = k;
+         for (j = 0; j < nP; ++j) {
+            if (levels[j] == i) {
+               scheduleIds_[k] = j;
+               ++k;
+            }
+         }
+      }
+      levelBegin_[nLevel_] = k;
+      UTIL_CHECK(k == nP);
+   }
+
    /*
    * Compute stress from a polymer chain.
    */
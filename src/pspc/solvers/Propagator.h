@@ -10,6 +10,8 @@
 
 #include <pscf/solvers/PropagatorTmpl.h> // base class template
 #include <pspc/field/RField.h>           // member template
+#include <pspc/field/Field.h>            // member template
+#include <pspc/field/FieldArena.h>       // function parameter
 #include <util/containers/DArray.h>      // member template
 #include <util/containers/FArray.h>      // member template
 
@@ -25,6 +27,27 @@ namespace Pspc
    /**
    * MDE solver for one-direction of one block.
    *
+   * By default, a Propagator stores the solution q(r,s) at all ns 
+   * contour steps. If a checkpoint interval k > 1 is passed to 
+   * allocate(), only every k-th slice (s = 0, k, 2k, ...) and the tail
+   * slice are stored. Other slices are recomputed from the preceding 
+   * checkpoint when requested by qSlice(), one segment of k-1 slices 
+   * at a time. This reduces memory from ns to about ns/k + k slices, 
+   * which is minimized by k near sqrt(ns), at the cost of solving the
+   * MDE again for each sweep through all slices.
+   *
+   * If single precision storage is requested in allocate(), stored 
+   * slices other than the head and tail are kept in float, which halves
+   * the memory and bandwidth required for them. The MDE is still solved
+   * in double precision, and the head and tail are stored in double.
+   * Stored float slices are accessed by qFloat(), or converted to 
+   * double by qSlice().
+   *
+   * If adaptive contour stepping is enabled for the block (see 
+   * Block<D>::setAdaptiveTolerance), the MDE is integrated over the
+   * current non-uniform grid of the block, and slices 0, ..., 
+   * block().nStep() are used, of the ns slices that were allocated.
+   *
    * \ingroup Pspc_Solver_Module
    */
    template <int D>
@@ -79,8 +102,14 @@ namespace Pspc
       * 
       * \param ns number of contour length steps
       * \param mesh spatial discretization mesh
+      * \param checkpointInterval  interval k between stored slices 
+      * \param singlePrecision  store interior slices in float?
+      * \param arena  arena for all slices and buffers (null for heap)
       */ 
-      void allocate(int ns, const Mesh<D>& mesh);
+      void allocate(int ns, const Mesh<D>& mesh, 
+                    int checkpointInterval = 1, 
+                    bool singlePrecision = false,
+                    FieldArena* arena = 0);
 
       /**
       * Solve the modified diffusion equation (MDE) for this block.
@@ -117,10 +146,56 @@ namespace Pspc
       /**
       * Return q-field at specified step.
       *
+      * If checkpointInterval() > 1, step i must be a stored slice, 
+      * i.e., the tail or a multiple of checkpointInterval(). If slices
+      * are stored in single precision, i must be the head or tail.
+      *
       * \param i step index
       */
       const QField& q(int i) const;
 
+      /**
+      * Return q-field at any step, recomputing it if not stored.
+      *
+      * If the slice is not stored, the segment of slices between the 
+      * preceding and following checkpoints is recomputed and cached,
+      * so that access to all slices in ascending or descending order 
+      * recomputes each segment only once. The returned reference is 
+      * valid until the next call that recomputes a different segment.
+      * A slice stored in single precision is converted to double in a
+      * workspace that is valid only until the next call.
+      *
+      * \param i step index
+      */
+      const QField& qSlice(int i);
+
+      /**
+      * Return single precision q-field at a stored interior step.
+      *
+      * Requires isSinglePrecision(), 0 < i < ns - 1 and i a multiple
+      * of checkpointInterval().
+      *
+      * \param i step index
+      */
+      Pspc::Field<float> const & qFloat(int i) const;
+
+      /**
+      * Is the slice at step i stored (rather than recomputed)?
+      *
+      * \param i step index
+      */
+      bool isStored(int i) const;
+
+      /**
+      * Interval between stored slices (1 if all slices are stored).
+      */
+      int checkpointInterval() const;
+
+      /**
+      * Are interior stored slices kept in single precision?
+      */
+      bool isSinglePrecision() const;
+
       /**
       * Return q-field at beginning of block (initial condition).
       */
@@ -149,6 +224,7 @@ namespace Pspc
       using PropagatorTmpl< Propagator<D> >::setIsSolved;
       using PropagatorTmpl< Propagator<D> >::isSolved;
       using PropagatorTmpl< Propagator<D> >::hasPartner;
+      using PropagatorTmpl< Propagator<D> >::directionId;
 
    protected:
 
@@ -157,21 +233,64 @@ namespace Pspc
       */
       void computeHead();
 
+      /**
+      * Integrate MDE from head, storing checkpoints and tail.
+      */
+      void integrate();
+
+      /**
+      * Recompute slices of segment iSegment into segment_.
+      *
+      * \param iSegment  index of segment (i.e., of preceding checkpoint)
+      */
+      void computeSegment(int iSegment);
+
+      /**
+      * Convert a single precision stored slice to double precision.
+      *
+      * \param iStored  index of stored slice (step / checkpointInterval)
+      * \param out  double precision output field
+      */
+      void convertSlice(int iStored, QField& out) const;
+
    private:
      
-      // Array of statistical weight fields 
+      // Array of stored statistical weight fields, at steps that are 
+      // multiples of checkpointInterval_ (all steps by default). Only
+      // the head is stored here if isSinglePrecision_.
       DArray<QField> qFields_;
 
-      // Workspace
+      // Single precision stored fields, if isSinglePrecision_. Element
+      // i/checkpointInterval_ holds interior step i.
+      DArray< Pspc::Field<float> > qFloat_;
+
+      // Tail field, if ns_ - 1 is not a multiple of checkpointInterval_
+      // or if isSinglePrecision_.
+      QField tail_;
+
+      // Segment of recomputed slices (if checkpointInterval_ > 1), also
+      // used for intermediate slices in integrate().
+      DArray<QField> segment_;
+
+      // Workspace for conversion of single precision slices
       QField work_;
 
+      /// Interval between stored slices (1 if all are stored).
+      int checkpointInterval_;
+
+      /// Are interior stored slices kept in single precision?
+      bool isSinglePrecision_;
+
+      /// Index of segment currently in segment_, or -1 if none.
+      int segmentId_;
+
       /// Pointer to associated Block.
       Block<D>* blockPtr_;
 
       /// Pointer to associated Mesh
       Mesh<D> const * meshPtr_;
 
-      /// Number of contour length steps = # grid points - 1.
+      /// Number of contour slices in use (# steps + 1).
       int ns_;
 
       /// Is this propagator allocated?
@@ -195,15 +314,61 @@ namespace Pspc
    template <int D>
    inline 
    typename Propagator<D>::QField const& Propagator<D>::tail() const
-   {  return qFields_[ns_-1]; }
+   {  return q(ns_-1); }
 
    /*
-   * Return q-field at specified step.
+   * Return stored q-field at specified step.
    */
    template <int D>
    inline 
    typename Propagator<D>::QField const& Propagator<D>::q(int i) const
-   {  return qFields_[i]; }
+   {
+      if (i == 0) {
+         return qFields_[0];
+      }
+      if (i % checkpointInterval_ == 0 && !isSinglePrecision_) {
+         return qFields_[i/checkpointInterval_]; 
+      }
+      assert(i == ns_ - 1);
+      return tail_;
+   }
+
+   /*
+   * Return single precision stored q-field at specified step.
+   */
+   template <int D>
+   inline 
+   Pspc::Field<float> const & Propagator<D>::qFloat(int i) const
+   {
+      assert(isSinglePrecision_);
+      assert(i > 0 && i < ns_ - 1);
+      assert(i % checkpointInterval_ == 0);
+      return qFloat_[i/checkpointInterval_];
+   }
+
+   /*
+   * Is the slice at step i stored?
+   */
+   template <int D>
+   inline 
+   bool Propagator<D>::isStored(int i) const
+   {  return (i % checkpointInterval_ == 0 || i == ns_ - 1); }
+
+   /*
+   * Interval between stored slices.
+   */
+   template <int D>
+   inline 
+   int Propagator<D>::checkpointInterval() const
+   {  return checkpointInterval_; }
+
+   /*
+   * Are interior stored slices kept in single precision?
+   */
+   template <int D>
+   inline 
+   bool Propagator<D>::isSinglePrecision() const
+   {  return isSinglePrecision_; }
 
    /*
    * Get the associated Block object.
@@ -12,6 +12,7 @@
 #include "Block.h"
 
 #include <pscf/mesh/Mesh.h>
+#include <pscf/math/fieldKernels.h>
 
 namespace Pscf {
 namespace Pspc {
@@ -23,7 +24,10 @@ namespace Pspc {
    */
    template <int D>
    Propagator<D>::Propagator()
-    : blockPtr_(0),
+    : checkpointInterval_(1),
+      isSinglePrecision_(false),
+      segmentId_(-1),
+      blockPtr_(0),
       meshPtr_(0),
       ns_(0),
       isAllocated_(false)
@@ -37,15 +41,62 @@ namespace Pspc {
    {}
 
    template <int D>
-   void Propagator<D>::allocate(int ns, const Mesh<D>& mesh)
+   void Propagator<D>::allocate(int ns, const Mesh<D>& mesh,
+                                int checkpointInterval, 
+                                bool singlePrecision,
+                                FieldArena* arena)
    {
+      UTIL_CHECK(ns > 1);
+      UTIL_CHECK(checkpointInterval > 0);
       ns_ = ns;
       meshPtr_ = &mesh;
 
-      qFields_.allocate(ns);
-      for (int i = 0; i < ns; ++i) {
-         qFields_[i].allocate(mesh.dimensions());
+      // An interval >= ns - 1 would store only the head and tail
+      int k = checkpointInterval;
+      if (k > ns - 1) {
+         k = ns - 1;
       }
+      checkpointInterval_ = k;
+      isSinglePrecision_ = singlePrecision;
+      segmentId_ = -1;
+
+      // Stored slices 0, k, 2k, ..., and tail if not a multiple of k
+      int nStored = (ns - 1)/k + 1;
+      if (isSinglePrecision_) {
+
+         // Double precision head and tail, float interior slices
+         qFields_.allocate(1);
+         qFields_[0].allocate(mesh.dimensions(), arena);
+         tail_.allocate(mesh.dimensions(), arena);
+         qFloat_.allocate(nStored);
+         for (int i = 1; i < nStored; ++i) {
+            if (i*k < ns - 1) {
+               qFloat_[i].allocate(mesh.size(), arena);
+            }
+         }
+         work_.allocate(mesh.dimensions(), arena);
+
+      } else {
+
+         qFields_.allocate(nStored);
+         for (int i = 0; i < nStored; ++i) {
+            qFields_[i].allocate(mesh.dimensions(), arena);
+         }
+         if ((ns - 1) % k != 0) {
+            tail_.allocate(mesh.dimensions(), arena);
+         }
+
+      }
+
+      // Segment buffer, also used for intermediate slices in solve
+      if (k > 1 || isSinglePrecision_) {
+         int nSegment = (k - 1 > 2) ? k - 1 : 2;
+         segment_.allocate(nSegment);
+         for (int i = 0; i < nSegment; ++i) {
+            segment_[i].allocate(mesh.dimensions(), arena);
+         }
+      }
+
       isAllocated_ = true;
    }
 
@@ -60,11 +111,8 @@ namespace Pspc {
       QField& qh = qFields_[0];
 
       // Initialize qh field to 1.0 at all grid points
-      int ix;
       int nx = meshPtr_->size();
-      for (ix = 0; ix < nx; ++ix) {
-         qh[ix] = 1.0;
-      }
+      setField(1.0, qh.cField(), nx);
 
       // Pointwise multiply tail QFields of all sources
       for (int is = 0; is < nSource(); ++is) {
@@ -72,9 +120,7 @@ namespace Pspc {
             UTIL_THROW("Source not solved in computeHead");
          }
          QField const& qt = source(is).tail();
-         for (ix = 0; ix < nx; ++ix) {
-            qh[ix] *= qt[ix];
-         }
+         mulField(qt.cField(), qh.cField(), nx);
       }
    }
 
@@ -86,9 +132,7 @@ namespace Pspc {
    {
       UTIL_CHECK(isAllocated());
       computeHead();
-      for (int iStep = 0; iStep < ns_ - 1; ++iStep) {
-         block().step(qFields_[iStep], qFields_[iStep + 1]);
-      }
+      integrate();
       setIsSolved(true);
    }
 
@@ -103,17 +147,138 @@ namespace Pspc {
 
       // Initialize initial (head) field
       QField& qh = qFields_[0];
-      for (int i = 0; i < nx; ++i) {
-         qh[i] = head[i];
-      }
+      copyField(head.cField(), qh.cField(), nx);
 
       // Setup solver and solve
-      for (int iStep = 0; iStep < ns_ - 1; ++iStep) {
-         block().step(qFields_[iStep], qFields_[iStep + 1]);
-      }
+      integrate();
       setIsSolved(true);
    }
 
+   /*
+   * Integrate the MDE from the head, storing checkpoints and tail.
+   */
+   template <int D>
+   void Propagator<D>::integrate()
+   {
+      // Adaptive grid of the block, with the current number of steps
+      if (block().isAdaptive()) {
+         UTIL_CHECK(checkpointInterval_ == 1 && !isSinglePrecision_);
+         ns_ = block().nStep() + 1;
+         UTIL_CHECK(ns_ <= qFields_.capacity());
+         for (int iStep = 0; iStep < ns_ - 1; ++iStep) {
+            block().stepAdaptive(qFields_[iStep], qFields_[iStep + 1], 
+                                 iStep, directionId());
+         }
+         return;
+      }
+
+      if (checkpointInterval_ == 1 && !isSinglePrecision_) {
+         for (int iStep = 0; iStep < ns_ - 1; ++iStep) {
+            block().step(qFields_[iStep], qFields_[iStep + 1], 
+                         directionId());
+         }
+         return;
+      }
+
+      // Slices that are not stored in double precision alternate 
+      // between two buffers. Single precision slices are stored by
+      // conversion from the buffer.
+      int k = checkpointInterval_;
+      QField const * qOldPtr = &qFields_[0];
+      QField* qNewPtr;
+      int buffer = 0;
+      int nx = meshPtr_->size();
+      for (int iStep = 1; iStep < ns_; ++iStep) {
+         if (iStep % k == 0 && !isSinglePrecision_) {
+            qNewPtr = &qFields_[iStep/k];
+         } else 
+         if (iStep == ns_ - 1) {
+            qNewPtr = &tail_;
+         } else {
+            qNewPtr = &segment_[buffer];
+            buffer = 1 - buffer;
+         }
+         block().step(*qOldPtr, *qNewPtr, directionId());
+         if (isSinglePrecision_ && iStep % k == 0 && iStep < ns_ - 1) {
+            float* qfPtr = qFloat_[iStep/k].cField();
+            double const * qPtr = qNewPtr->cField();
+            for (int i = 0; i < nx; ++i) {
+               qfPtr[i] = (float) qPtr[i];
+            }
+         }
+         qOldPtr = qNewPtr;
+      }
+
+      // Segment buffers were overwritten
+      segmentId_ = -1;
+   }
+
+   /*
+   * Return q-field at any step, recomputing a segment if necessary.
+   */
+   template <int D>
+   typename Propagator<D>::QField const& Propagator<D>::qSlice(int i)
+   {
+      UTIL_CHECK(i >= 0 && i < ns_);
+      if (i == 0 || i == ns_ - 1) {
+         return q(i);
+      }
+      if (isStored(i)) {
+         if (!isSinglePrecision_) {
+            return q(i);
+         }
+         convertSlice(i/checkpointInterval_, work_);
+         return work_;
+      }
+      UTIL_CHECK(isSolved());
+      int iSegment = i/checkpointInterval_;
+      if (iSegment != segmentId_) {
+         computeSegment(iSegment);
+      }
+      return segment_[i - iSegment*checkpointInterval_ - 1];
+   }
+
+   /*
+   * Recompute slices between checkpoint iSegment and the next.
+   */
+   template <int D>
+   void Propagator<D>::computeSegment(int iSegment)
+   {
+      int k = checkpointInterval_;
+      int begin = iSegment*k;
+      UTIL_CHECK(begin < ns_ - 1);
+
+      // Slot m of segment_ holds slice begin + m + 1
+      int end = begin + k;
+      if (end > ns_ - 1) {
+         end = ns_ - 1;
+      }
+      if (iSegment == 0 || !isSinglePrecision_) {
+         block().step(qFields_[iSegment], segment_[0], directionId());
+      } else {
+         convertSlice(iSegment, work_);
+         block().step(work_, segment_[0], directionId());
+      }
+      for (int m = 1; m < end - begin - 1; ++m) {
+         block().step(segment_[m-1], segment_[m], directionId());
+      }
+      segmentId_ = iSegment;
+   }
+
+   /*
+   * Convert a single precision stored slice to double precision.
+   */
+   template <int D>
+   void Propagator<D>::convertSlice(int iStored, QField& out) const
+   {
+      float const * qfPtr = qFloat_[iStored].cField();
+      double* qPtr = out.cField();
+      int nx = meshPtr_->size();
+      for (int i = 0; i < nx; ++i) {
+         qPtr[i] = (double) qfPtr[i];
+      }
+   }
+
    /*
    * Integrate to calculate monomer concentration for this block
    */
@@ -137,10 +302,7 @@ namespace Pspc {
       UTIL_CHECK(qh.capacity() == nx);
 
       // Take inner product of head and partner tail fields
-      double Q = 0;
-      for (int i =0; i < nx; ++i) {
-         Q += qh[i]*qt[i];
-      }
+      double Q = dotField(qh.cField(), qt.cField(), nx);
       Q /= double(nx);
       return Q;
    }
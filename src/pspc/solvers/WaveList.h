@@ -0,0 +1,216 @@
+#ifndef PSPC_WAVE_LIST_H
+#define PSPC_WAVE_LIST_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <pscf/math/IntVec.h>            // member template argument
+#include <util/containers/DArray.h>      // member template
+#include <util/containers/DMatrix.h>     // member template
+
+namespace Pscf { 
+   template <int D> class Mesh; 
+   template <int D> class UnitCell; 
+}
+
+namespace Pscf { 
+namespace Pspc
+{ 
+
+   using namespace Util;
+
+   /**
+   * Wavevector data for the discrete Fourier transform mesh.
+   *
+   * A WaveList holds, for each wavevector of the k-space mesh used by
+   * a real-to-complex FFT, the minimum image of the wavevector, its 
+   * square magnitude |G|^2, and the derivatives d|G|^2/dp of |G|^2 
+   * with respect to each unit cell parameter p. One WaveList is owned 
+   * by the System, and is shared by all blocks of all polymers.
+   *
+   * Minimum images are computed once per mesh, by computeMinimumImages.
+   * The functions computeKSq and computedKSq must be called again after 
+   * every change in unit cell parameters, and update values in place.
+   *
+   * \ingroup Pspc_Solver_Module
+   */
+   template <int D>
+   class WaveList
+   {
+
+   public:
+      
+      /**
+      * Constructor.
+      */
+      WaveList();
+
+      /**
+      * Destructor.
+      */
+      ~WaveList();
+
+      /**
+      * Allocate memory for all arrays. 
+      *
+      * \param mesh  spatial discretization mesh (r-grid)
+      * \param unitCell  crystallographic unit cell
+      */
+      void allocate(Mesh<D> const & mesh, UnitCell<D> const & unitCell);
+         
+      /**
+      * Compute minimum images of all wavevectors.
+      *
+      * This is called once, after allocate, for the initial unit cell.
+      *
+      * \param mesh  spatial discretization mesh (r-grid)
+      * \param unitCell  crystallographic unit cell
+      */
+      void computeMinimumImages(Mesh<D> const & mesh, 
+                                UnitCell<D> const & unitCell);
+
+      /**
+      * Compute square magnitudes |G|^2 of all wavevectors.
+      *
+      * \param unitCell  crystallographic unit cell
+      */
+      void computeKSq(UnitCell<D> const & unitCell);
+
+      /**
+      * Compute derivatives of |G|^2 with respect to unit cell parameters.
+      *
+      * Values for wavevectors whose inversion partner is not included 
+      * in the k-space mesh are multiplied by 2.
+      *
+      * \param unitCell  crystallographic unit cell
+      */
+      void computedKSq(UnitCell<D> const & unitCell);
+
+      /**
+      * Get the minimum image of the wavevector with index i.
+      *
+      * \param i  rank of wavevector in the k-space mesh
+      */
+      IntVec<D> const & minImage(int i) const;
+
+      /**
+      * Get the array of values of |G|^2, indexed by wavevector rank.
+      */
+      DArray<double> const & kSq() const;
+
+      /**
+      * Get the matrix of derivatives of |G|^2.
+      *
+      * Element (n, i) is the derivative for wavevector i with respect 
+      * to unit cell parameter n, or twice this value if the partner of
+      * wavevector i is not included in the k-space mesh. 
+      */
+      DMatrix<double> const & dkSq() const;
+
+      /**
+      * Dimensions of the k-space mesh.
+      */
+      IntVec<D> const & kMeshDimensions() const;
+
+      /**
+      * Number of wavevectors in the k-space mesh.
+      */
+      int kSize() const;
+
+      /**
+      * Has memory been allocated?
+      */
+      bool isAllocated() const;
+
+      /**
+      * Are the |G|^2 values current?
+      */
+      bool hasKSq() const;
+
+      /**
+      * Are the derivatives of |G|^2 current?
+      */
+      bool hasdKSq() const;
+
+   private:
+
+      // Minimum images of all wavevectors in the k-space mesh
+      DArray< IntVec<D> > minImage_;
+
+      // Values of |G|^2
+      DArray<double> kSq_;
+
+      // Derivatives of |G|^2 with respect to unit cell parameters
+      DMatrix<double> dkSq_;
+
+      // Does the inversion partner of each wavevector lie outside mesh?
+      DArray<bool> implicit_;
+
+      // Dimensions of the r-space mesh
+      IntVec<D> meshDimensions_;
+
+      // Dimensions of the k-space mesh
+      IntVec<D> kMeshDimensions_;
+
+      // Number of wavevectors in the k-space mesh
+      int kSize_;
+
+      // Have minimum images been computed?
+      bool hasMinimumImages_;
+
+      // Are the kSq_ values current?
+      bool hasKSq_;
+
+      // Are the dkSq_ values current?
+      bool hasdKSq_;
+
+   };
+
+   // Inline member functions
+
+   template <int D>
+   inline IntVec<D> const & WaveList<D>::minImage(int i) const
+   {  return minImage_[i]; }
+
+   template <int D>
+   inline DArray<double> const & WaveList<D>::kSq() const
+   {  return kSq_; }
+
+   template <int D>
+   inline DMatrix<double> const & WaveList<D>::dkSq() const
+   {  return dkSq_; }
+
+   template <int D>
+   inline IntVec<D> const & WaveList<D>::kMeshDimensions() const
+   {  return kMeshDimensions_; }
+
+   template <int D>
+   inline int WaveList<D>::kSize() const
+   {  return kSize_; }
+
+   template <int D>
+   inline bool WaveList<D>::isAllocated() const
+   {  return kSq_.isAllocated(); }
+
+   template <int D>
+   inline bool WaveList<D>::hasKSq() const
+   {  return hasKSq_; }
+
+   template <int D>
+   inline bool WaveList<D>::hasdKSq() const
+   {  return hasdKSq_; }
+
+   #ifndef PSPC_WAVE_LIST_TPP
+   // Suppress implicit instantiation
+   extern template class WaveList<1>;
+   extern template class WaveList<2>;
+   extern template class WaveList<3>;
+   #endif
+
+}
+}
+#endif
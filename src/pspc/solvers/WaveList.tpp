@@ -0,0 +1,140 @@
+#ifndef PSPC_WAVE_LIST_TPP
+#define PSPC_WAVE_LIST_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "WaveList.h"
+
+#include <pscf/mesh/Mesh.h>
+#include <pscf/mesh/MeshIterator.h>
+#include <pscf/crystal/UnitCell.h>
+#include <pscf/crystal/shiftToMinimum.h>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /*
+   * Constructor.
+   */
+   template <int D>
+   WaveList<D>::WaveList()
+    : kSize_(0),
+      hasMinimumImages_(false),
+      hasKSq_(false),
+      hasdKSq_(false)
+   {}
+
+   /*
+   * Destructor.
+   */
+   template <int D>
+   WaveList<D>::~WaveList()
+   {}
+
+   /*
+   * Allocate memory for all arrays.
+   */
+   template <int D>
+   void WaveList<D>::allocate(Mesh<D> const & mesh, 
+                              UnitCell<D> const & unitCell)
+   {
+      UTIL_CHECK(mesh.size() > 0);
+      UTIL_CHECK(unitCell.nParameter() > 0);
+      meshDimensions_ = mesh.dimensions();
+
+      // Dimensions of k-space mesh for a real-to-complex transform
+      kSize_ = 1;
+      for (int i = 0; i < D; ++i) {
+         if (i < D - 1) {
+            kMeshDimensions_[i] = meshDimensions_[i];
+         } else {
+            kMeshDimensions_[i] = meshDimensions_[i]/2 + 1;
+         }
+         kSize_ *= kMeshDimensions_[i];
+      }
+
+      minImage_.allocate(kSize_);
+      kSq_.allocate(kSize_);
+      dkSq_.allocate(6, kSize_);
+      implicit_.allocate(kSize_);
+   }
+
+   /*
+   * Compute minimum images, and identify implicit partners.
+   */
+   template <int D>
+   void WaveList<D>::computeMinimumImages(Mesh<D> const & mesh, 
+                                          UnitCell<D> const & unitCell)
+   {
+      UTIL_CHECK(isAllocated());
+      UTIL_CHECK(mesh.dimensions() == meshDimensions_);
+
+      MeshIterator<D> iter;
+      iter.setDimensions(kMeshDimensions_);
+      IntVec<D> G;
+      int i, partner;
+      for (iter.begin(); !iter.atEnd(); ++iter) {
+         i = iter.rank();
+         G = iter.position();
+         minImage_[i] = shiftToMinimum(G, meshDimensions_, unitCell);
+
+         // Is the partner -G of G outside the k-space mesh?
+         if (G[D-1] != 0) {
+            partner = meshDimensions_[D-1] - G[D-1];
+         } else {
+            partner = 0;
+         }
+         implicit_[i] = (partner > kMeshDimensions_[D-1]);
+      }
+      hasMinimumImages_ = true;
+      hasKSq_ = false;
+      hasdKSq_ = false;
+   }
+
+   /*
+   * Compute |G|^2 for all wavevectors.
+   */
+   template <int D>
+   void WaveList<D>::computeKSq(UnitCell<D> const & unitCell)
+   {
+      UTIL_CHECK(hasMinimumImages_);
+      for (int i = 0; i < kSize_; ++i) {
+         kSq_[i] = unitCell.ksq(minImage_[i]);
+      }
+      hasKSq_ = true;
+   }
+
+   /*
+   * Compute derivatives of |G|^2 with respect to unit cell parameters.
+   */
+   template <int D>
+   void WaveList<D>::computedKSq(UnitCell<D> const & unitCell)
+   {
+      UTIL_CHECK(hasMinimumImages_);
+      int nParameter = unitCell.nParameter();
+      UTIL_CHECK(nParameter <= 6);
+      double* dkSqPtr;
+      int i, n;
+      for (n = 0; n < nParameter; ++n) {
+         dkSqPtr = dkSq_.cArray() + n*kSize_;
+         for (i = 0; i < kSize_; ++i) {
+            dkSqPtr[i] = unitCell.dksq(minImage_[i], n);
+            if (implicit_[i]) {
+               dkSqPtr[i] *= 2.0;
+            }
+         }
+      }
+      hasdKSq_ = true;
+   }
+
+}
+}
+#endif
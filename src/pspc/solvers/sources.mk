@@ -4,7 +4,8 @@ pspc_solvers_= \
   pspc/solvers/Propagator.cpp \
   pspc/solvers/Polymer.cpp \
   pspc/solvers/Solvent.cpp \
-  pspc/solvers/Mixture.cpp 
+  pspc/solvers/Mixture.cpp \
+  pspc/solvers/WaveList.cpp 
 
 pspc_solvers_SRCS=\
      $(addprefix $(SRC_DIR)/, $(pspc_solvers_))
@@ -0,0 +1,16 @@
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "ChiSweep.tpp"
+
+namespace Pscf {
+namespace Pspc {
+   template class ChiSweep<1>;
+   template class ChiSweep<2>;
+   template class ChiSweep<3>;
+}
+}
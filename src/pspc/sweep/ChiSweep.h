@@ -0,0 +1,92 @@
+#ifndef PSPC_CHI_SWEEP_H
+#define PSPC_CHI_SWEEP_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "Sweep.h"                       // base class
+#include <util/containers/DMatrix.h>     // member
+#include <util/global.h>                  
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /**
+   * Sweep along a line in the space of Flory-Huggins chi parameters.
+   *
+   * The chi matrix at path coordinate s is chi0 + s*dChi, in which chi0
+   * is the chi matrix at the beginning of the sweep and dChi is a
+   * symmetric matrix read from the parameter file.
+   *
+   * \ingroup Pspc_Sweep_Module
+   */
+   template <int D>
+   class ChiSweep : public Sweep<D>
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      *
+      * \param system parent System object
+      */
+      ChiSweep(System<D>& system);
+
+      /**
+      * Destructor.
+      */
+      ~ChiSweep();
+
+      /**
+      * Read parameters.
+      *
+      * \param in input stream
+      */
+      virtual void readParameters(std::istream& in);
+
+      /**
+      * Initialization at beginning sweep. Set chi0 to current chi.
+      */
+      virtual void setup();
+
+      /**
+      * Set chi matrix for specified value of s.
+      *
+      * \param s path length coordinate, in [0,1]
+      */
+      virtual void setState(double s);
+
+   private:
+
+      /**
+      * Chi matrix at beginning of sweep (s=0).
+      */
+      DMatrix<double> chi0_;
+
+      /**
+      * Change in chi matrix over sweep s=[0,1].
+      */
+      DMatrix<double> dChi_;
+
+      using Sweep<D>::system;
+
+   };
+
+   #ifndef PSPC_CHI_SWEEP_TPP
+   // Suppress implicit instantiation
+   extern template class ChiSweep<1>;
+   extern template class ChiSweep<2>;
+   extern template class ChiSweep<3>;
+   #endif
+
+} // namespace Pspc
+} // namespace Pscf
+#endif
@@ -0,0 +1,78 @@
+#ifndef PSPC_CHI_SWEEP_TPP
+#define PSPC_CHI_SWEEP_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "ChiSweep.h"
+#include <pspc/System.h>
+#include <pscf/inter/ChiInteraction.h>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   template <int D>
+   ChiSweep<D>::ChiSweep(System<D>& system)
+    : Sweep<D>(system)
+   {  ParamComposite::setClassName("ChiSweep"); }
+
+   template <int D>
+   ChiSweep<D>::~ChiSweep()
+   {}
+
+   /*
+   * Read parameters.
+   */
+   template <int D>
+   void ChiSweep<D>::readParameters(std::istream& in)
+   {
+      // Read ns, baseFileName and optional continuation parameters
+      Sweep<D>::readParameters(in);
+
+      int nm = system().mixture().nMonomer();
+      chi0_.allocate(nm, nm);
+      dChi_.allocate(nm, nm);
+      ParamComposite::readDSymmMatrix(in, "dChi", dChi_, nm);
+   }
+
+   /*
+   * Initialization at beginning sweep. Set chi0 to current chi.
+   */
+   template <int D>
+   void ChiSweep<D>::setup()
+   {
+      int nm = system().mixture().nMonomer();
+      for (int i = 0; i < nm; ++i) {
+         for (int j = 0; j < nm; ++j) {
+            chi0_(i, j) = system().interaction().chi(i, j);
+         }
+      }
+   }
+
+   /*
+   * Set state for specified value of s.
+   */
+   template <int D>
+   void ChiSweep<D>::setState(double s)
+   {
+      int nm = system().mixture().nMonomer();
+      for (int i = 0; i < nm; ++i) {
+         for (int j = 0; j <= i; ++j) {
+            if (dChi_(i, j) != 0.0) {
+               system().interaction().setChi(i, j, 
+                                           chi0_(i, j) + s*dChi_(i, j));
+            }
+         }
+      }
+   }
+
+} // namespace Pspc
+} // namespace Pscf
+#endif
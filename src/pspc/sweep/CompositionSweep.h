@@ -0,0 +1,94 @@
+#ifndef PSPC_COMPOSITION_SWEEP_H
+#define PSPC_COMPOSITION_SWEEP_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "Sweep.h"                       // base class
+#include <util/containers/DArray.h>      // member
+#include <util/global.h>                  
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /**
+   * Sweep along a line in the space of polymer volume fractions.
+   *
+   * The volume fraction of polymer species i at path coordinate s is
+   * phi0[i] + s*dPhi[i], in which phi0 is the value at the beginning of
+   * the sweep and dPhi is read from the parameter file. The elements of
+   * dPhi must sum to zero. All polymer species must be in the closed 
+   * (canonical) ensemble.
+   *
+   * \ingroup Pspc_Sweep_Module
+   */
+   template <int D>
+   class CompositionSweep : public Sweep<D>
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      *
+      * \param system parent System object
+      */
+      CompositionSweep(System<D>& system);
+
+      /**
+      * Destructor.
+      */
+      ~CompositionSweep();
+
+      /**
+      * Read parameters.
+      *
+      * \param in input stream
+      */
+      virtual void readParameters(std::istream& in);
+
+      /**
+      * Initialization at beginning sweep. Set phi0 to current phi.
+      */
+      virtual void setup();
+
+      /**
+      * Set volume fractions for specified value of s.
+      *
+      * \param s path length coordinate, in [0,1]
+      */
+      virtual void setState(double s);
+
+   private:
+
+      /**
+      * Molecular volume fractions at beginning of sweep (s=0).
+      */
+      DArray<double> phi0_;
+
+      /**
+      * Change in molecule volume fractions over sweep s=[0,1].
+      */
+      DArray<double> dPhi_;
+
+      using Sweep<D>::system;
+
+   };
+
+   #ifndef PSPC_COMPOSITION_SWEEP_TPP
+   // Suppress implicit instantiation
+   extern template class CompositionSweep<1>;
+   extern template class CompositionSweep<2>;
+   extern template class CompositionSweep<3>;
+   #endif
+
+} // namespace Pspc
+} // namespace Pscf
+#endif
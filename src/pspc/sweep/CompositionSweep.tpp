@@ -0,0 +1,79 @@
+#ifndef PSPC_COMPOSITION_SWEEP_TPP
+#define PSPC_COMPOSITION_SWEEP_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "CompositionSweep.h"
+#include <pspc/System.h>
+#include <cmath>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   template <int D>
+   CompositionSweep<D>::CompositionSweep(System<D>& system)
+    : Sweep<D>(system)
+   {  ParamComposite::setClassName("CompositionSweep"); }
+
+   template <int D>
+   CompositionSweep<D>::~CompositionSweep()
+   {}
+
+   /*
+   * Read parameters.
+   */
+   template <int D>
+   void CompositionSweep<D>::readParameters(std::istream& in)
+   {
+      // Read ns, baseFileName and optional continuation parameters
+      Sweep<D>::readParameters(in);
+
+      int np = system().mixture().nPolymer();
+      dPhi_.allocate(np);
+      phi0_.allocate(np);
+      ParamComposite::readDArray<double>(in, "dPhi", dPhi_, np);
+
+      double sum = 0.0;
+      for (int i = 0; i < np; ++i) {
+         sum += dPhi_[i];
+      }
+      if (std::abs(sum) > 1.0E-8) {
+         UTIL_THROW("Elements of dPhi do not sum to zero");
+      }
+   }
+
+   /*
+   * Initialization at beginning sweep. Set phi0 to current composition.
+   */
+   template <int D>
+   void CompositionSweep<D>::setup()
+   {
+      int np = system().mixture().nPolymer();
+      for (int i = 0; i < np; ++i) {
+         phi0_[i] = system().mixture().polymer(i).phi();
+      }
+   }
+
+   /*
+   * Set state for specified value of s.
+   */
+   template <int D>
+   void CompositionSweep<D>::setState(double s)
+   {
+      int np = system().mixture().nPolymer();
+      for (int i = 0; i < np; ++i) {
+         system().mixture().polymer(i).setPhi(phi0_[i] + s*dPhi_[i]);
+      }
+   }
+
+} // namespace Pspc
+} // namespace Pscf
+#endif
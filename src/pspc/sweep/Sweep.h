@@ -0,0 +1,181 @@
+#ifndef PSPC_SWEEP_H
+#define PSPC_SWEEP_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <util/param/ParamComposite.h>        // base class
+#include <pspc/iterator/HistoryArena.h>       // member
+#include <util/containers/DArray.h>           // member
+#include <util/containers/FSArray.h>          // member
+
+#include <util/global.h>
+#include <string>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   template <int D> class System;
+
+   using namespace Util;
+
+   /**
+   * Solve a sequence of problems along a line in parameter space.
+   *
+   * A Sweep solves the SCFT equations at a sequence of states along a
+   * path parameterized by a contour variable s in the range [0,1]. The
+   * state at s=0 is the state defined by the parameter file, and the
+   * state at other values of s is set by the setState() function of a
+   * subclass.
+   *
+   * Converged w fields (in symmetry-adapted basis format) and unit cell
+   * parameters of up to historyCapacity previous states are kept in
+   * memory. The initial guess for each new state is obtained by
+   * Lagrange polynomial extrapolation through all stored states, which
+   * gives continuation of order historyCapacity - 1. If the optional
+   * parameter targetItr is positive, the step size is increased or
+   * decreased after each converged state so as to keep the number of
+   * iterations near targetItr, within a range [1/(4 ns), 4/ns]. The 
+   * step size is halved after a failure to converge, and the sweep 
+   * fails if it falls below 1/(16 ns).
+   *
+   * \ingroup Pspc_Sweep_Module
+   */
+   template <int D>
+   class Sweep : public ParamComposite
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      *
+      * \param system parent System object.
+      */
+      Sweep(System<D>& system);
+
+      /**
+      * Destructor.
+      */
+      ~Sweep();
+
+      /**
+      * Read ns, baseFileName and optional continuation parameters.
+      *
+      * \param in input stream
+      */
+      virtual void readParameters(std::istream& in);
+
+      /**
+      * Setup operation at beginning sweep.
+      */
+      virtual void setup(){};
+
+      /**
+      * Set system parameters.
+      *
+      * \param s path length coordinate, in range [0,1]
+      */
+      virtual void setState(double s) = 0;
+
+      /**
+      * Output information after obtaining a converged solution.
+      *
+      * \param stateFileName base name of output files
+      * \param s value of path length parameter s
+      */
+      virtual void outputSolution(std::string const & stateFileName,
+                                  double s);
+
+      /**
+      * Output data to a running summary.
+      *
+      * \param outFile  output file, open for writing
+      * \param i  integer index
+      * \param s  value of path length parameter s
+      */
+      virtual void outputSummary(std::ostream& outFile, int i, double s);
+
+      /**
+      * Iterate to solution.
+      */
+      virtual void solve();
+
+   protected:
+
+      /// Number of steps (initial step size is 1/ns).
+      int ns_;
+
+      /// Base name for output files
+      std::string baseFileName_;
+
+      /// Maximum number of stored previous solutions.
+      int historyCapacity_;
+
+      /// Desired number of iterations per step (0 for a fixed step).
+      int targetItr_;
+
+      /**
+      * Get parent System by reference.
+      */
+      System<D>& system()
+      {  return *systemPtr_; }
+
+   private:
+
+      /// Converged w fields in basis format, most recent first.
+      HistoryArena wHists_;
+
+      /// Converged unit cell parameters, most recent first.
+      HistoryArena cellHists_;
+
+      /// Values of s for stored solutions, most recent first.
+      DArray<double> sHists_;
+
+      /// Extrapolation coefficients.
+      DArray<double> coeffs_;
+
+      /// Work array for unit cell parameters.
+      FSArray<double, 6> parameters_;
+
+      /// Pointer to parent System.
+      System<D>* systemPtr_;
+
+      /**
+      * Store the current converged solution as the most recent one.
+      *
+      * \param s value of path length parameter s
+      */
+      void pushState(double s);
+
+      /**
+      * Set w fields and unit cell to those of a stored solution.
+      *
+      * \param i history index (0 for the most recent)
+      */
+      void restoreState(int i);
+
+      /**
+      * Set w fields and unit cell by extrapolation to s.
+      *
+      * \param s value of path length parameter s for the new state
+      */
+      void extrapolate(double s);
+
+   };
+
+   #ifndef PSPC_SWEEP_TPP
+   // Suppress implicit instantiation
+   extern template class Sweep<1>;
+   extern template class Sweep<2>;
+   extern template class Sweep<3>;
+   #endif
+
+} // namespace Pspc
+} // namespace Pscf
+#endif
@@ -0,0 +1,346 @@
+#ifndef PSPC_SWEEP_TPP
+#define PSPC_SWEEP_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "Sweep.h"
+#include <pspc/System.h>
+#include <pspc/iterator/Iterator.h>
+#include <util/misc/ioUtil.h>
+#include <util/format/Int.h>
+#include <util/format/Dbl.h>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   template <int D>
+   Sweep<D>::Sweep(System<D>& system)
+    : ns_(0),
+      baseFileName_(),
+      historyCapacity_(3),
+      targetItr_(0),
+      wHists_(),
+      cellHists_(),
+      sHists_(),
+      coeffs_(),
+      parameters_(),
+      systemPtr_(&system)
+   {  setClassName("Sweep"); }
+
+   template <int D>
+   Sweep<D>::~Sweep()
+   {}
+
+   /*
+   * Read parameters.
+   */
+   template <int D>
+   void Sweep<D>::readParameters(std::istream& in)
+   {
+      read<int>(in, "ns", ns_);
+      read<std::string>(in, "baseFileName", baseFileName_);
+      historyCapacity_ = 3; // default value (2nd order continuation)
+      readOptional<int>(in, "historyCapacity", historyCapacity_);
+      targetItr_ = 0; // default value (fixed step size)
+      readOptional<int>(in, "targetItr", targetItr_);
+      UTIL_CHECK(ns_ > 0);
+      UTIL_CHECK(historyCapacity_ > 0);
+      UTIL_CHECK(targetItr_ >= 0);
+   }
+
+   template <int D>
+   void Sweep<D>::solve()
+   {
+      int nm = system().mixture().nMonomer();
+      int nStar = system().basis().nStar();
+      int nParameter = system().unitCell().nParameter();
+      UTIL_CHECK(nm > 0);
+      UTIL_CHECK(nStar > 0);
+
+      // Allocate memory for stored solutions
+      if (!wHists_.isAllocated()) {
+         wHists_.allocate(historyCapacity_, nm, nStar);
+         cellHists_.allocate(historyCapacity_, 1, nParameter);
+         sHists_.allocate(historyCapacity_);
+         coeffs_.allocate(historyCapacity_);
+      }
+      wHists_.clear();
+      cellHists_.clear();
+
+      // Compute and output ds
+      double ds = 1.0/double(ns_);
+      double dsMin = ds/16.0;      // Minimum step after failures
+      double dsMinAdapt = ds/4.0;  // Minimum step set by adaptation
+      double dsMaxAdapt = ds*4.0;  // Maximum step set by adaptation
+      Log::file() << std::endl;
+      Log::file() << "ns = " << ns_ << std::endl;
+      Log::file() << "ds = " << ds  << std::endl;
+
+      // Set Sweep object
+      setup();
+
+      // Open summary file
+      std::ofstream outFile;
+      std::string fileName = baseFileName_;
+      fileName += "log";
+      system().fileMaster().openOutputFile(fileName, outFile);
+
+      // Solve for initial state of sweep
+      double s = 0.0;
+      int i = 0;
+      int error;
+      Log::file() << std::endl;
+      Log::file() << "Begin s = " << s << std::endl;
+      error = system().iterate();
+      if (error) {
+         UTIL_THROW("Failure to converge initial state of sweep");
+      } else {
+         pushState(s);
+         fileName = baseFileName_;
+         fileName += toString(i);
+         outputSolution(fileName, s);
+         outputSummary(outFile, i, s);
+      }
+
+      // Loop over states on path
+      double factor;
+      int nItr;
+      while (s < 1.0 - 1.0E-8) {
+
+         // Do not step past the end of the path
+         if (s + ds > 1.0 - 1.0E-8) {
+            ds = 1.0 - s;
+         }
+
+         error = 1;
+         while (error) {
+
+            Log::file() << std::endl;
+            Log::file() << "Attempt s = " << s + ds << std::endl;
+            Log::file() << "Continuation of order "
+                        << wHists_.size() - 1 << std::endl;
+
+            // Set initial guess and parameters, then iterate
+            extrapolate(s + ds);
+            setState(s + ds);
+            error = system().iterate();
+
+            if (error) {
+
+               // Upon failure, reset to last converged solution
+               restoreState(0);
+
+               // Decrease ds by half
+               ds *= 0.50;
+               if (ds < dsMin) {
+                  UTIL_THROW("Step size too small in sweep");
+               }
+
+            } else {
+
+               // Upon success, update s and store solution
+               s += ds;
+               ++i;
+               pushState(s);
+
+               // Output
+               fileName = baseFileName_;
+               fileName += toString(i);
+               outputSolution(fileName, s);
+               outputSummary(outFile, i, s);
+
+               // Adjust step size to approach targetItr iterations
+               if (targetItr_ > 0) {
+                  nItr = system().iterator().nIteration();
+                  if (nItr < 1) nItr = 1;
+                  factor = double(targetItr_)/double(nItr);
+                  if (factor > 2.0) factor = 2.0;
+                  if (factor < 0.5) factor = 0.5;
+                  ds *= factor;
+                  if (ds < dsMinAdapt) ds = dsMinAdapt;
+                  if (ds > dsMaxAdapt) ds = dsMaxAdapt;
+               }
+
+            }
+         }
+      }
+      outFile.close();
+   }
+
+   template <int D>
+   void Sweep<D>::outputSolution(std::string const & fileName, double s)
+   {
+      std::ofstream out;
+      std::string outFileName;
+
+      // Write parameter file, with thermodynamic properties at end
+      outFileName = fileName;
+      outFileName += ".prm";
+      system().fileMaster().openOutputFile(outFileName, out);
+      system().writeParam(out);
+      out << std::endl;
+      system().outputThermo(out);
+      out.close();
+
+      // Write concentration fields
+      outFileName = fileName;
+      outFileName += ".c";
+      system().writeCBasis(outFileName);
+
+      // Write chemical potential fields
+      outFileName = fileName;
+      outFileName += ".w";
+      system().writeWBasis(outFileName);
+   }
+
+   template <int D>
+   void Sweep<D>::outputSummary(std::ostream& out, int i, double s)
+   {
+      out << Int(i,5) << Dbl(s)
+          << Dbl(system().fHelmholtz(),16)
+          << Dbl(system().pressure(),16)
+          << std::endl;
+   }
+
+   /*
+   * Store current w fields and unit cell as most recent solution.
+   */
+   template <int D>
+   void Sweep<D>::pushState(double s)
+   {
+      int nm = wHists_.nField();
+      int nStar = wHists_.fieldSize();
+      int nParameter = cellHists_.fieldSize();
+
+      double* const * w = wHists_.advance();
+      int i, j;
+      for (i = 0; i < nm; ++i) {
+         DArray<double> const & field = system().wField(i);
+         for (j = 0; j < nStar; ++j) {
+            w[i][j] = field[j];
+         }
+      }
+
+      double* cell = cellHists_.advance()[0];
+      parameters_ = system().unitCell().parameters();
+      for (j = 0; j < nParameter; ++j) {
+         cell[j] = parameters_[j];
+      }
+
+      for (i = wHists_.size() - 1; i > 0; --i) {
+         sHists_[i] = sHists_[i-1];
+      }
+      sHists_[0] = s;
+   }
+
+   /*
+   * Reset w fields and unit cell to those of a stored solution.
+   */
+   template <int D>
+   void Sweep<D>::restoreState(int k)
+   {
+      int nm = wHists_.nField();
+      int nStar = wHists_.fieldSize();
+      int nParameter = cellHists_.fieldSize();
+
+      double* const * w = wHists_[k];
+      int i, j;
+      for (i = 0; i < nm; ++i) {
+         DArray<double>& field = system().wField(i);
+         for (j = 0; j < nStar; ++j) {
+            field[j] = w[i][j];
+         }
+      }
+      system().fieldIo().convertBasisToRGrid(system().wFields(),
+                                             system().wFieldsRGridBlock());
+
+      double const * cell = cellHists_[k][0];
+      parameters_ = system().unitCell().parameters();
+      bool isChanged = false;
+      for (j = 0; j < nParameter; ++j) {
+         if (parameters_[j] != cell[j]) {
+            parameters_[j] = cell[j];
+            isChanged = true;
+         }
+      }
+      if (isChanged) {
+         system().setUnitCell(parameters_);
+      }
+   }
+
+   /*
+   * Set w fields and unit cell by polynomial extrapolation to s.
+   */
+   template <int D>
+   void Sweep<D>::extrapolate(double s)
+   {
+      int n = wHists_.size();
+      UTIL_CHECK(n > 0);
+      if (n == 1) {
+         restoreState(0);
+         return;
+      }
+
+      // Lagrange interpolation coefficients for stored values of s
+      int i, j, k;
+      for (k = 0; k < n; ++k) {
+         coeffs_[k] = 1.0;
+         for (j = 0; j < n; ++j) {
+            if (j != k) {
+               coeffs_[k] *= (s - sHists_[j])/(sHists_[k] - sHists_[j]);
+            }
+         }
+      }
+
+      // Extrapolate w fields
+      int nm = wHists_.nField();
+      int nStar = wHists_.fieldSize();
+      double sum;
+      for (i = 0; i < nm; ++i) {
+         DArray<double>& field = system().wField(i);
+         for (j = 0; j < nStar; ++j) {
+            sum = 0.0;
+            for (k = 0; k < n; ++k) {
+               sum += coeffs_[k]*wHists_[k][i][j];
+            }
+            field[j] = sum;
+         }
+      }
+      system().fieldIo().convertBasisToRGrid(system().wFields(),
+                                             system().wFieldsRGridBlock());
+
+      // Extrapolate unit cell parameters, unless they are constant.
+      // Otherwise, the cell is already that of the latest solution.
+      int nParameter = cellHists_.fieldSize();
+      bool isVarying = false;
+      for (k = 1; k < n; ++k) {
+         for (j = 0; j < nParameter; ++j) {
+            if (cellHists_[k][0][j] != cellHists_[0][0][j]) {
+               isVarying = true;
+            }
+         }
+      }
+      if (isVarying) {
+         parameters_ = system().unitCell().parameters();
+         for (j = 0; j < nParameter; ++j) {
+            sum = 0.0;
+            for (k = 0; k < n; ++k) {
+               sum += coeffs_[k]*cellHists_[k][0][j];
+            }
+            parameters_[j] = sum;
+         }
+         system().setUnitCell(parameters_);
+      }
+   }
+
+} // namespace Pspc
+} // namespace Pscf
+#endif
@@ -6,12 +6,14 @@
 
 #include "field/FieldTestComposite.h"
 #include "solvers/SolverTestComposite.h"
+#include "iterator/IteratorTestComposite.h"
 #include "system/SystemTest.h"
 #include <util/global.h>
 
 TEST_COMPOSITE_BEGIN(PspcNsTestComposite)
 addChild(new FieldTestComposite, "field/");
 addChild(new SolverTestComposite, "solvers/");
+addChild(new IteratorTestComposite, "iterator/");
 addChild(new TEST_RUNNER(SystemTest), "system/");
 TEST_COMPOSITE_END
 
@@ -0,0 +1,234 @@
+#ifndef PSPC_BASIS_DFT_MAP_TEST_H
+#define PSPC_BASIS_DFT_MAP_TEST_H
+
+#include <test/UnitTest.h>
+#include <test/UnitTestRunner.h>
+
+#include <pspc/field/BasisDftMap.h>
+#include <pspc/field/RFieldDft.h>
+#include <pscf/crystal/Basis.h>
+#include <pscf/crystal/UnitCell.h>
+#include <pscf/mesh/Mesh.h>
+
+#include <util/containers/DArray.h>
+
+#include <cmath>
+#include <complex>
+#include <sstream>
+
+using namespace Util;
+using namespace Pscf;
+using namespace Pscf::Pspc;
+
+class BasisDftMapTest : public UnitTest
+{
+
+public:
+
+   void setUp() {}
+   void tearDown() {}
+
+   void testConstructor();
+   void testBasisToDft();
+   void testRoundTrip();
+   void testBatch();
+
+private:
+
+   // Make a cubic basis of space group groupName on an 8x8x8 mesh.
+   void makeBasis(std::string groupName, Mesh<3>& mesh,
+                  Basis<3>& basis);
+
+   // Set components of a field to arbitrary values in [-0.5, 0.5].
+   void setComponents(DArray<double>& in, int seed);
+
+};
+
+void BasisDftMapTest::makeBasis(std::string groupName, Mesh<3>& mesh,
+                                Basis<3>& basis)
+{
+   UnitCell<3> unitCell;
+   std::istringstream cellIn("cubic 4.0");
+   cellIn >> unitCell;
+   IntVec<3> d;
+   d[0] = 8;
+   d[1] = 8;
+   d[2] = 8;
+   mesh.setDimensions(d);
+   basis.makeBasis(mesh, unitCell, groupName);
+   TEST_ASSERT(basis.isValid());
+}
+
+void BasisDftMapTest::setComponents(DArray<double>& in, int seed)
+{
+   for (int i = 0; i < in.capacity(); ++i) {
+      in[i] = 0.5*sin(1.7*double(i + seed) + 0.3*double(seed));
+   }
+}
+
+void BasisDftMapTest::testConstructor()
+{
+   printMethod(TEST_FUNC);
+   {
+      BasisDftMap<3> map;
+      TEST_ASSERT(!map.isSetup());
+   }
+}
+
+/*
+* Compare output to a direct evaluation of each wave of each star.
+*/
+void BasisDftMapTest::testBasisToDft()
+{
+   printMethod(TEST_FUNC);
+
+   Mesh<3> mesh;
+   Basis<3> basis;
+   makeBasis("P_4_3_2", mesh, basis);
+
+   BasisDftMap<3> map;
+   map.setup(basis, mesh);
+   TEST_ASSERT(map.isSetup());
+   TEST_ASSERT(map.nStar() == basis.nStar());
+   TEST_ASSERT(map.dftSize() == 8*8*5);
+
+   int nStar = basis.nStar();
+   DArray<double> in;
+   in.allocate(nStar);
+   setComponents(in, 1);
+   RFieldDft<3> out;
+   out.allocate(mesh.dimensions());
+   map.basisToDft(in.cArray(), out.cField());
+
+   IntVec<3> dftDimensions = mesh.dimensions();
+   dftDimensions[2] = mesh.dimension(2)/2 + 1;
+   Mesh<3> dftMesh(dftDimensions);
+
+   std::complex<double> component, value;
+   int is, iw, rank;
+   for (is = 0; is < nStar; ++is) {
+      Basis<3>::Star const & star = basis.star(is);
+      if (star.cancel) {
+         component = std::complex<double>(0.0, 0.0);
+      } else
+      if (star.invertFlag == 0) {
+         component = std::complex<double>(in[is], 0.0);
+      } else
+      if (star.invertFlag == 1) {
+         component = std::complex<double>(in[is], -in[is+1]);
+         component /= sqrt(2.0);
+      } else {
+         component = std::complex<double>(in[is-1], in[is]);
+         component /= sqrt(2.0);
+      }
+      for (iw = star.beginId; iw < star.endId; ++iw) {
+         Basis<3>::Wave const & wave = basis.wave(iw);
+         if (!wave.implicit) {
+            value = component*wave.coeff;
+            rank = dftMesh.rank(wave.indicesDft);
+            TEST_ASSERT(eq(out[rank][0], value.real()));
+            TEST_ASSERT(eq(out[rank][1], value.imag()));
+         }
+      }
+   }
+}
+
+/*
+* Conversion to DFT and back should recover the input components.
+*/
+void BasisDftMapTest::testRoundTrip()
+{
+   printMethod(TEST_FUNC);
+
+   Mesh<3> mesh;
+   Basis<3> basis;
+   makeBasis("I_a_-3_d", mesh, basis);
+
+   BasisDftMap<3> map;
+   map.setup(basis, mesh);
+
+   int nStar = basis.nStar();
+   DArray<double> in, out;
+   in.allocate(nStar);
+   out.allocate(nStar);
+   setComponents(in, 2);
+
+   // Zero components of cancelled stars, which are not represented
+   int is;
+   for (is = 0; is < nStar; ++is) {
+      if (basis.star(is).cancel) {
+         in[is] = 0.0;
+      }
+   }
+
+   RFieldDft<3> kField;
+   kField.allocate(mesh.dimensions());
+   map.basisToDft(in.cArray(), kField.cField());
+   map.dftToBasis(kField.cField(), out.cArray());
+   for (is = 0; is < nStar; ++is) {
+      TEST_ASSERT(std::abs(in[is] - out[is]) < 1.0E-10);
+   }
+}
+
+/*
+* Batch conversions should equal conversions of separate fields.
+*/
+void BasisDftMapTest::testBatch()
+{
+   printMethod(TEST_FUNC);
+
+   Mesh<3> mesh;
+   Basis<3> basis;
+   makeBasis("P_4_3_2", mesh, basis);
+
+   BasisDftMap<3> map;
+   map.setup(basis, mesh);
+
+   int nStar = basis.nStar();
+   int dftSize = map.dftSize();
+   int kSize = dftSize + 3;
+   int nField = 3;
+   int i, k;
+
+   DArray< DArray<double> > in, out;
+   in.allocate(nField);
+   out.allocate(nField);
+   for (k = 0; k < nField; ++k) {
+      in[k].allocate(nStar);
+      out[k].allocate(nStar);
+      setComponents(in[k], k + 3);
+   }
+
+   Field<fftw_complex> batch;
+   batch.allocate(nField*kSize);
+   map.basisToDft(in, batch.cField(), kSize);
+
+   RFieldDft<3> kField;
+   kField.allocate(mesh.dimensions());
+   DArray<double> single;
+   single.allocate(nStar);
+   for (k = 0; k < nField; ++k) {
+      map.basisToDft(in[k].cArray(), kField.cField());
+      for (i = 0; i < dftSize; ++i) {
+         TEST_ASSERT(kField[i][0] == batch[k*kSize + i][0]);
+         TEST_ASSERT(kField[i][1] == batch[k*kSize + i][1]);
+      }
+   }
+
+   map.dftToBasis(batch.cField(), kSize, out);
+   for (k = 0; k < nField; ++k) {
+      map.dftToBasis(batch.cField() + k*kSize, single.cArray());
+      for (i = 0; i < nStar; ++i) {
+         TEST_ASSERT(single[i] == out[k][i]);
+      }
+   }
+}
+
+TEST_BEGIN(BasisDftMapTest)
+TEST_ADD(BasisDftMapTest, testConstructor)
+TEST_ADD(BasisDftMapTest, testBasisToDft)
+TEST_ADD(BasisDftMapTest, testRoundTrip)
+TEST_ADD(BasisDftMapTest, testBatch)
+TEST_END(BasisDftMapTest)
+
+#endif
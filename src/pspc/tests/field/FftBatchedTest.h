@@ -0,0 +1,192 @@
+#ifndef PSPC_FFT_BATCHED_TEST_H
+#define PSPC_FFT_BATCHED_TEST_H
+
+#include <test/UnitTest.h>
+#include <test/UnitTestRunner.h>
+
+#include <pspc/field/FFTBatched.h>
+#include <pspc/field/FFT.h>
+#include <pspc/field/RField.h>
+#include <pspc/field/RFieldDft.h>
+
+#include <util/containers/DArray.h>
+#include <util/math/Constants.h>
+
+using namespace Util;
+using namespace Pscf::Pspc;
+
+class FftBatchedTest : public UnitTest
+{
+public:
+
+   void setUp() {}
+   void tearDown() {}
+
+   void testConstructor();
+   void testTransform2D();
+   void testTransform3D();
+
+};
+
+void FftBatchedTest::testConstructor()
+{
+   printMethod(TEST_FUNC);
+   {
+      FFTBatched<1> v;
+      TEST_ASSERT(!v.isSetup());
+   }
+}
+
+void FftBatchedTest::testTransform2D()
+{
+   printMethod(TEST_FUNC);
+
+   IntVec<2> d;
+   d[0] = 6;
+   d[1] = 5;
+   int nBatch = 3;
+
+   FFTBatched<2> v;
+   v.setup(d, nBatch);
+   TEST_ASSERT(v.isSetup());
+   TEST_ASSERT(v.batchSize() == nBatch);
+   TEST_ASSERT(v.rSize() == 30);
+   TEST_ASSERT(v.kSize() == 18);
+   int rSize = v.rSize();
+   int kSize = v.kSize();
+
+   // Contiguous batch of input fields, and separate copies
+   Field<double> in;
+   in.allocate(nBatch*rSize);
+   DArray< RField<2> > fields;
+   fields.allocate(nBatch);
+   double twoPi = 2.0*Constants::Pi;
+   double x, y;
+   int i, j, k, rank;
+   for (k = 0; k < nBatch; ++k) {
+      fields[k].allocate(d);
+      for (i = 0; i < d[0]; ++i) {
+         for (j = 0; j < d[1]; ++j) {
+            rank = j + i*d[1];
+            x = twoPi*double(i)/double(d[0]);
+            y = twoPi*double(j)/double(d[1]);
+            fields[k][rank] = 1.0 + cos(x + k*y) + 0.5*sin(2.0*k*x);
+            in[k*rSize + rank] = fields[k][rank];
+         }
+      }
+   }
+
+   // Compare batched transforms to individual transforms by FFT<2>
+   Field<fftw_complex> out;
+   out.allocate(nBatch*kSize);
+   v.forwardTransform(in, out);
+
+   RField<2> rField;
+   RFieldDft<2> kField;
+   rField.allocate(d);
+   kField.allocate(d);
+   FFT<2> fft;
+   fft.setup(rField, kField);
+   for (k = 0; k < nBatch; ++k) {
+      fft.forwardTransform(fields[k], kField);
+      for (i = 0; i < kSize; ++i) {
+         TEST_ASSERT(eq(out[k*kSize + i][0], kField[i][0]));
+         TEST_ASSERT(eq(out[k*kSize + i][1], kField[i][1]));
+      }
+   }
+
+   // Transform of separate fields should equal that of contiguous batch
+   Field<fftw_complex> out2;
+   out2.allocate(nBatch*kSize);
+   v.forwardTransform(fields, out2);
+   for (i = 0; i < nBatch*kSize; ++i) {
+      TEST_ASSERT(eq(out[i][0], out2[i][0]));
+      TEST_ASSERT(eq(out[i][1], out2[i][1]));
+   }
+
+   // Inverse transforms should recover input data
+   Field<double> inCopy;
+   inCopy.allocate(nBatch*rSize);
+   v.inverseTransform(out, inCopy);
+   for (i = 0; i < nBatch*rSize; ++i) {
+      TEST_ASSERT(eq(in[i], inCopy[i]));
+   }
+
+   DArray< RField<2> > fieldsCopy;
+   fieldsCopy.allocate(nBatch);
+   for (k = 0; k < nBatch; ++k) {
+      fieldsCopy[k].allocate(d);
+   }
+   v.inverseTransform(out2, fieldsCopy);
+   for (k = 0; k < nBatch; ++k) {
+      for (i = 0; i < rSize; ++i) {
+         TEST_ASSERT(eq(fields[k][i], fieldsCopy[k][i]));
+      }
+   }
+}
+
+void FftBatchedTest::testTransform3D()
+{
+   printMethod(TEST_FUNC);
+
+   IntVec<3> d;
+   d[0] = 4;
+   d[1] = 3;
+   d[2] = 6;
+   int nBatch = 2;
+
+   FFTBatched<3> v;
+   v.setup(d, nBatch);
+   int rSize = v.rSize();
+   int kSize = v.kSize();
+   TEST_ASSERT(rSize == 72);
+   TEST_ASSERT(kSize == 48);
+
+   DArray< RField<3> > fields;
+   fields.allocate(nBatch);
+   double twoPi = 2.0*Constants::Pi;
+   double x, y, z;
+   int i, j, k, m, rank;
+   for (m = 0; m < nBatch; ++m) {
+      fields[m].allocate(d);
+      for (i = 0; i < d[0]; ++i) {
+         for (j = 0; j < d[1]; ++j) {
+            for (k = 0; k < d[2]; ++k) {
+               rank = k + (j + i*d[1])*d[2];
+               x = twoPi*double(i)/double(d[0]);
+               y = twoPi*double(j)/double(d[1]);
+               z = twoPi*double(k)/double(d[2]);
+               fields[m][rank] = cos(x + y) + (m + 1)*sin(z - x);
+            }
+         }
+      }
+   }
+
+   Field<fftw_complex> out;
+   out.allocate(nBatch*kSize);
+   v.forwardTransform(fields, out);
+
+   DArray< RField<3> > fieldsCopy;
+   fieldsCopy.allocate(nBatch);
+   for (m = 0; m < nBatch; ++m) {
+      fieldsCopy[m].allocate(d);
+   }
+   v.inverseTransform(out, fieldsCopy);
+   for (m = 0; m < nBatch; ++m) {
+      for (i = 0; i < rSize; ++i) {
+         TEST_ASSERT(eq(fields[m][i], fieldsCopy[m][i]));
+      }
+   }
+
+   // Setup again with a different batch size
+   v.setup(d, 1);
+   TEST_ASSERT(v.batchSize() == 1);
+}
+
+TEST_BEGIN(FftBatchedTest)
+TEST_ADD(FftBatchedTest, testConstructor)
+TEST_ADD(FftBatchedTest, testTransform2D)
+TEST_ADD(FftBatchedTest, testTransform3D)
+TEST_END(FftBatchedTest)
+
+#endif
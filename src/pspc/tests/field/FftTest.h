@@ -5,12 +5,18 @@
 #include <test/UnitTestRunner.h>
 
 #include <pspc/field/FFT.h>
+#include <pspc/field/FFTPlanner.h>
 #include <pspc/field/RField.h>
 #include <pspc/field/RFieldDft.h>
 
 #include <util/math/Constants.h>
 #include <util/format/Dbl.h>
 
+#include <fftw3.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
 using namespace Util;
 using namespace Pscf::Pspc;
 
@@ -25,6 +31,19 @@ public:
    void testTransform1D();
    void testTransform2D();
    void testTransform3D();
+   void testTransformUnscaled();
+   void testPlanningRigor();
+   void testWisdom1D();
+   void testWisdom2D();
+   void testWisdom3D();
+   void testWisdomMissing();
+   void testWisdomCorrupt();
+
+   template <int D>
+   void checkWisdom(IntVec<D> const & d, std::string const & filename);
+
+   template <int D>
+   void checkMeasuredTransform(IntVec<D> const & d);
 
 };
 
@@ -157,11 +176,248 @@ void FftTest::testTransform3D() {
    }
 }
 
+void FftTest::testTransformUnscaled() 
+{
+   printMethod(TEST_FUNC);
+
+   IntVec<3> d;
+   d[0] = 4;
+   d[1] = 3;
+   d[2] = 5;
+   RField<3> in, factor;
+   RFieldDft<3> out, outUnscaled;
+   in.allocate(d);
+   factor.allocate(d);
+   out.allocate(d);
+   outUnscaled.allocate(d);
+   int i;
+   int n = in.capacity();
+   for (i = 0; i < n; i++) {
+      in[i] = 1.0 + 0.5*cos(2.0*Constants::Pi*double(i)/double(n));
+      factor[i] = 1.0;
+   }
+
+   FFT<3> v;
+   v.setup(in, out);
+   v.forwardTransform(in, out);
+   v.forwardTransformUnscaled(in, outUnscaled);
+   for (i = 0; i < out.capacity(); i++) {
+      TEST_ASSERT(eq(outUnscaled[i][0], out[i][0]*n));
+      TEST_ASSERT(eq(outUnscaled[i][1], out[i][1]*n));
+   }
+
+   // Product transform with unit factor
+   v.forwardTransformUnscaled(in, factor, outUnscaled);
+   for (i = 0; i < out.capacity(); i++) {
+      TEST_ASSERT(eq(outUnscaled[i][0], out[i][0]*n));
+      TEST_ASSERT(eq(outUnscaled[i][1], out[i][1]*n));
+   }
+
+   // Input is preserved
+   for (i = 0; i < n; i++) {
+      TEST_ASSERT(eq(in[i], 1.0 + 0.5*cos(2.0*Constants::Pi*i/double(n))));
+   }
+}
+
+void FftTest::testPlanningRigor() 
+{
+   printMethod(TEST_FUNC);
+
+   // Read and write FFTPlanner::Rigor
+   FFTPlanner::Rigor rigor;
+   std::stringstream in("patient");
+   in >> rigor;
+   TEST_ASSERT(rigor == FFTPlanner::Patient);
+   std::stringstream out;
+   out << FFTPlanner::Exhaustive;
+   TEST_ASSERT(out.str() == "exhaustive");
+
+   IntVec<2> d;
+   d[0] = 4;
+   d[1] = 6;
+   RField<2> rField;
+   RFieldDft<2> kField;
+   rField.allocate(d);
+   kField.allocate(d);
+   double twoPi = 2.0*Constants::Pi;
+   int i, j, rank;
+   for (i = 0; i < d[0]; i++) {
+      for (j = 0; j < d[1]; j++) {
+         rank = j + i*d[1];
+         rField[rank] = 1.0 + cos(twoPi*(double(i)/double(d[0]) 
+                                         + double(j)/double(d[1])));
+      }
+   }
+   RField<2> rInit;
+   rInit.allocate(d);
+   for (i = 0; i < rField.capacity(); i++) {
+      rInit[i] = rField[i];
+   }
+
+   // Setup with measured plans must not overwrite input data
+   FFTPlanner::setRigor(FFTPlanner::Measure);
+   FFT<2> v;
+   v.setup(rField, kField);
+   FFTPlanner::setRigor(FFTPlanner::Estimate);
+   for (i = 0; i < rField.capacity(); i++) {
+      TEST_ASSERT(eq(rField[i], rInit[i]));
+   }
+
+   // Round trip transform
+   RField<2> rCopy;
+   rCopy.allocate(d);
+   v.forwardTransform(rField, kField);
+   v.inverseTransform(kField, rCopy);
+   for (i = 0; i < rField.capacity(); i++) {
+      TEST_ASSERT(eq(rField[i], rCopy[i]));
+   }
+}
+
+/*
+* Create a plan with measured rigor and check a round trip transform.
+*/
+template <int D>
+void FftTest::checkMeasuredTransform(IntVec<D> const & d)
+{
+   RField<D> rField;
+   RField<D> rCopy;
+   RFieldDft<D> kField;
+   rField.allocate(d);
+   rCopy.allocate(d);
+   kField.allocate(d);
+
+   FFTPlanner::setRigor(FFTPlanner::Measure);
+   FFT<D> v;
+   v.setup(rField, kField);
+   FFTPlanner::setRigor(FFTPlanner::Estimate);
+
+   int n = rField.capacity();
+   double twoPi = 2.0*Constants::Pi;
+   for (int i = 0; i < n; ++i) {
+      rField[i] = 1.0 + cos(twoPi*double(i)/double(n));
+   }
+   v.forwardTransform(rField, kField);
+   v.inverseTransform(kField, rCopy);
+   for (int i = 0; i < n; ++i) {
+      TEST_ASSERT(eq(rField[i], rCopy[i]));
+   }
+}
+
+/*
+* Export wisdom for a mesh, forget it, and import it again.
+*/
+template <int D>
+void FftTest::checkWisdom(IntVec<D> const & d, 
+                          std::string const & filename)
+{
+   std::string path = filePrefix() + filename;
+   checkMeasuredTransform(d);
+   TEST_ASSERT(FFTPlanner::exportWisdom(path));
+
+   fftw_forget_wisdom();
+   TEST_ASSERT(FFTPlanner::importWisdom(path));
+   checkMeasuredTransform(d);
+
+   // Wisdom file is not empty, and is rewritten after import
+   std::ifstream in(path.c_str());
+   std::stringstream buffer;
+   buffer << in.rdbuf();
+   TEST_ASSERT(buffer.str().size() > 0);
+   TEST_ASSERT(FFTPlanner::exportWisdom(path));
+   TEST_ASSERT(FFTPlanner::importWisdom(path));
+}
+
+void FftTest::testWisdom1D() 
+{
+   printMethod(TEST_FUNC);
+   IntVec<1> d;
+   d[0] = 12;
+   fftw_forget_wisdom();
+   checkWisdom<1>(d, "out/wisdom1D");
+}
+
+void FftTest::testWisdom2D() 
+{
+   printMethod(TEST_FUNC);
+   IntVec<2> d;
+   d[0] = 4;
+   d[1] = 6;
+   fftw_forget_wisdom();
+   checkWisdom<2>(d, "out/wisdom2D");
+}
+
+void FftTest::testWisdom3D() 
+{
+   printMethod(TEST_FUNC);
+   IntVec<3> d;
+   d[0] = 4;
+   d[1] = 6;
+   d[2] = 8;
+   fftw_forget_wisdom();
+   checkWisdom<3>(d, "out/wisdom3D");
+}
+
+void FftTest::testWisdomMissing() 
+{
+   printMethod(TEST_FUNC);
+
+   // A missing file is reported, and planning is unaffected
+   std::string path = filePrefix() + "out/wisdomMissing";
+   std::remove(path.c_str());
+   TEST_ASSERT(!FFTPlanner::importWisdom(path));
+   IntVec<2> d;
+   d[0] = 6;
+   d[1] = 4;
+   checkMeasuredTransform(d);
+}
+
+void FftTest::testWisdomCorrupt() 
+{
+   printMethod(TEST_FUNC);
+
+   // Obtain valid wisdom for a mesh
+   IntVec<3> d;
+   d[0] = 4;
+   d[1] = 4;
+   d[2] = 6;
+   fftw_forget_wisdom();
+   checkMeasuredTransform(d);
+
+   // Corrupt and truncated files are rejected
+   std::string path = filePrefix() + "out/wisdomCorrupt";
+   std::ofstream out(path.c_str());
+   out << "this is not FFTW wisdom" << std::endl;
+   out.close();
+   TEST_ASSERT(!FFTPlanner::importWisdom(path));
+
+   std::string valid = filePrefix() + "out/wisdomValid";
+   TEST_ASSERT(FFTPlanner::exportWisdom(valid));
+   std::ifstream in(valid.c_str());
+   std::stringstream buffer;
+   buffer << in.rdbuf();
+   in.close();
+   std::string text = buffer.str();
+   out.open(path.c_str());
+   out << text.substr(0, text.size()/2);
+   out.close();
+   TEST_ASSERT(!FFTPlanner::importWisdom(path));
+
+   // Planning still works after a failed import
+   checkMeasuredTransform(d);
+}
+
 TEST_BEGIN(FftTest)
 TEST_ADD(FftTest, testConstructor)
 TEST_ADD(FftTest, testTransform1D)
 TEST_ADD(FftTest, testTransform2D)
 TEST_ADD(FftTest, testTransform3D)
+TEST_ADD(FftTest, testTransformUnscaled)
+TEST_ADD(FftTest, testPlanningRigor)
+TEST_ADD(FftTest, testWisdom1D)
+TEST_ADD(FftTest, testWisdom2D)
+TEST_ADD(FftTest, testWisdom3D)
+TEST_ADD(FftTest, testWisdomMissing)
+TEST_ADD(FftTest, testWisdomCorrupt)
 TEST_END(FftTest)
 
 #endif
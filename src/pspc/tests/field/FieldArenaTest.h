@@ -0,0 +1,146 @@
+#ifndef PSPC_FIELD_ARENA_TEST_H
+#define PSPC_FIELD_ARENA_TEST_H
+
+#include <test/UnitTest.h>
+#include <test/UnitTestRunner.h>
+
+#include <pspc/field/FieldArena.h>
+#include <pspc/field/RField.h>
+#include <pspc/field/RFieldDft.h>
+#include <pspc/field/RFieldBlock.h>
+
+#include <sstream>
+
+using namespace Util;
+using namespace Pscf::Pspc;
+
+class FieldArenaTest : public UnitTest
+{
+
+public:
+
+   void setUp() {}
+   void tearDown() {}
+
+   void testConstructor();
+   void testAllocate();
+   void testFields();
+   void testHugePages();
+
+};
+
+void FieldArenaTest::testConstructor()
+{
+   printMethod(TEST_FUNC);
+   {
+      FieldArena arena("test");
+      TEST_ASSERT(arena.name() == "test");
+      TEST_ASSERT(arena.nArray() == 0);
+      TEST_ASSERT(arena.nRegion() == 0);
+      TEST_ASSERT(arena.size() == 0);
+      TEST_ASSERT(arena.capacity() == 0);
+   }
+}
+
+void FieldArenaTest::testAllocate()
+{
+   printMethod(TEST_FUNC);
+   {
+      FieldArena arena;
+      arena.setRegionSize(1024);
+
+      double* a = arena.allocate<double>(3);
+      float* b = arena.allocate<float>(20);
+      TEST_ASSERT(size_t(a) % FieldArena::Alignment == 0);
+      TEST_ASSERT(size_t(b) % FieldArena::Alignment == 0);
+      TEST_ASSERT((char*)b == (char*)a + 64);
+      TEST_ASSERT(a[0] == 0.0 && a[2] == 0.0);
+      TEST_ASSERT(b[19] == 0.0);
+      TEST_ASSERT(arena.nArray() == 2);
+      TEST_ASSERT(arena.size() == 192);
+      TEST_ASSERT(arena.nRegion() == 1);
+      TEST_ASSERT(arena.capacity() == 1024);
+
+      // Request larger than remaining space starts a new region
+      double* c = arena.allocate<double>(200);
+      TEST_ASSERT(size_t(c) % FieldArena::Alignment == 0);
+      TEST_ASSERT(arena.nRegion() == 2);
+      TEST_ASSERT(arena.capacity() == 1024 + 1600);
+      c[199] = 1.0;
+
+      arena.clear();
+      TEST_ASSERT(arena.nArray() == 0);
+      TEST_ASSERT(arena.nRegion() == 0);
+      TEST_ASSERT(arena.size() == 0);
+   }
+}
+
+void FieldArenaTest::testFields()
+{
+   printMethod(TEST_FUNC);
+   {
+      FieldArena arena("fields");
+      IntVec<3> d;
+      d[0] = 4;
+      d[1] = 4;
+      d[2] = 6;
+
+      RField<3> r;
+      r.allocate(d, &arena);
+      TEST_ASSERT(r.isAllocated());
+      TEST_ASSERT(!r.isOwner());
+      TEST_ASSERT(r.capacity() == 96);
+      TEST_ASSERT(r.meshDimensions() == d);
+
+      RFieldDft<3> k;
+      k.allocate(d, &arena);
+      TEST_ASSERT(!k.isOwner());
+      TEST_ASSERT(k.capacity() == 64);
+      TEST_ASSERT(k.dftDimensions()[2] == 4);
+
+      RFieldBlock<3> block;
+      block.allocate(2, d, &arena);
+      TEST_ASSERT(block.isContiguous());
+      TEST_ASSERT(!block.data().isOwner());
+      TEST_ASSERT(arena.nArray() == 3);
+      TEST_ASSERT(arena.size() == sizeof(double)*(96 + 2*64 + 2*96));
+
+      // A null arena allocates from the heap
+      RField<3> h;
+      h.allocate(d, 0);
+      TEST_ASSERT(h.isOwner());
+      TEST_ASSERT(arena.nArray() == 3);
+
+      // Deallocating a field from an arena only dissociates it
+      r.deallocate();
+      TEST_ASSERT(!r.isAllocated());
+      TEST_ASSERT(arena.size() == sizeof(double)*(96 + 2*64 + 2*96));
+
+      std::stringstream out;
+      arena.writeReport(out);
+      TEST_ASSERT(out.str().find("fields") != std::string::npos);
+   }
+}
+
+void FieldArenaTest::testHugePages()
+{
+   printMethod(TEST_FUNC);
+   {
+      FieldArena arena;
+      arena.setHugePages(true);
+      TEST_ASSERT(arena.hugePages());
+      arena.setRegionSize(1024);
+      double* a = arena.allocate<double>(10);
+      TEST_ASSERT(size_t(a) % FieldArena::HugePageSize == 0);
+      TEST_ASSERT(arena.capacity() == FieldArena::HugePageSize);
+   }
+}
+
+TEST_BEGIN(FieldArenaTest)
+TEST_ADD(FieldArenaTest, testConstructor)
+TEST_ADD(FieldArenaTest, testAllocate)
+TEST_ADD(FieldArenaTest, testFields)
+TEST_ADD(FieldArenaTest, testHugePages)
+TEST_END(FieldArenaTest)
+
+#endif
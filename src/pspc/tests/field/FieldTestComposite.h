@@ -6,14 +6,24 @@
 #include "FieldTest.h"
 #include "RFieldTest.h"
 #include "RFieldDftTest.h"
+#include "RFieldBlockTest.h"
+#include "FieldArenaTest.h"
 #include "FftTest.h"
+#include "FftBatchedTest.h"
+#include "TextValuesTest.h"
+#include "BasisDftMapTest.h"
 //#include "FieldUtilTest.h"
 
 TEST_COMPOSITE_BEGIN(FieldTestComposite)
 TEST_COMPOSITE_ADD_UNIT(FieldTest);
 TEST_COMPOSITE_ADD_UNIT(RFieldTest);
 TEST_COMPOSITE_ADD_UNIT(RFieldDftTest);
+TEST_COMPOSITE_ADD_UNIT(RFieldBlockTest);
+TEST_COMPOSITE_ADD_UNIT(FieldArenaTest);
 TEST_COMPOSITE_ADD_UNIT(FftTest);
+TEST_COMPOSITE_ADD_UNIT(FftBatchedTest);
+TEST_COMPOSITE_ADD_UNIT(TextValuesTest);
+TEST_COMPOSITE_ADD_UNIT(BasisDftMapTest);
 //TEST_COMPOSITE_ADD_UNIT(FieldUtilTest);
 TEST_COMPOSITE_END
 
@@ -0,0 +1,129 @@
+#ifndef PSPC_R_FIELD_BLOCK_TEST_H
+#define PSPC_R_FIELD_BLOCK_TEST_H
+
+#include <test/UnitTest.h>
+#include <test/UnitTestRunner.h>
+
+#include <pspc/field/RFieldBlock.h>
+#include <pspc/field/RField.h>
+
+using namespace Util;
+using namespace Pscf::Pspc;
+
+class RFieldBlockTest : public UnitTest
+{
+
+public:
+
+   void setUp() {}
+   void tearDown() {}
+
+   void testConstructor();
+   void testAllocate();
+   void testPadding();
+   void testView();
+
+};
+
+void RFieldBlockTest::testConstructor()
+{
+   printMethod(TEST_FUNC);
+   {
+      RFieldBlock<3> block;
+      TEST_ASSERT(!block.isAllocated());
+      TEST_ASSERT(block.nField() == 0);
+   }
+}
+
+void RFieldBlockTest::testAllocate()
+{
+   printMethod(TEST_FUNC);
+   {
+      IntVec<3> d;
+      d[0] = 2;
+      d[1] = 3;
+      d[2] = 4;
+      RFieldBlock<3> block;
+      block.allocate(3, d);
+      TEST_ASSERT(block.isAllocated());
+      TEST_ASSERT(block.nField() == 3);
+      TEST_ASSERT(block.fieldSize() == 24);
+      TEST_ASSERT(block.stride() == 24);
+      TEST_ASSERT(block.isContiguous());
+      TEST_ASSERT(block.meshDimensions() == d);
+      TEST_ASSERT(block.data().capacity() == 72);
+      TEST_ASSERT(block.fields().capacity() == 3);
+      for (int i = 0; i < 3; ++i) {
+         TEST_ASSERT(block[i].isAllocated());
+         TEST_ASSERT(!block[i].isOwner());
+         TEST_ASSERT(block[i].capacity() == 24);
+         TEST_ASSERT(block[i].meshDimensions() == d);
+         TEST_ASSERT(block[i].cField() == block.data().cField() + 24*i);
+      }
+   }
+}
+
+void RFieldBlockTest::testPadding()
+{
+   printMethod(TEST_FUNC);
+   {
+      IntVec<2> d;
+      d[0] = 3;
+      d[1] = 5;
+      RFieldBlock<2> block;
+      block.allocate(2, d);
+      TEST_ASSERT(block.fieldSize() == 15);
+      TEST_ASSERT(block.stride() == 16);
+      TEST_ASSERT(!block.isContiguous());
+      TEST_ASSERT(block.data().capacity() == 32);
+      TEST_ASSERT(block[1].cField() == block.data().cField() + 16);
+      TEST_ASSERT(block.data()[15] == 0.0);
+      TEST_ASSERT(block.data()[31] == 0.0);
+   }
+}
+
+void RFieldBlockTest::testView()
+{
+   printMethod(TEST_FUNC);
+   {
+      IntVec<1> d;
+      d[0] = 8;
+      RFieldBlock<1> block;
+      block.allocate(2, d);
+      int i, j;
+      for (i = 0; i < 2; ++i) {
+         for (j = 0; j < 8; ++j) {
+            block[i][j] = double(10*i + j);
+         }
+      }
+      for (i = 0; i < 16; ++i) {
+         TEST_ASSERT(block.data()[i] == double(10*(i/8) + i%8));
+      }
+
+      // Assignment to a view copies into the block
+      RField<1> other;
+      other.allocate(d);
+      for (j = 0; j < 8; ++j) {
+         other[j] = -1.0*double(j);
+      }
+      block[1] = other;
+      TEST_ASSERT(block[1].cField() == block.data().cField() + 8);
+      TEST_ASSERT(block.data()[13] == -5.0);
+
+      // Deallocating a copy does not affect the block
+      RField<1> copy(block[0]);
+      TEST_ASSERT(copy.isOwner());
+      TEST_ASSERT(copy.cField() != block[0].cField());
+      copy.deallocate();
+      TEST_ASSERT(block[0][3] == 3.0);
+   }
+}
+
+TEST_BEGIN(RFieldBlockTest)
+TEST_ADD(RFieldBlockTest, testConstructor)
+TEST_ADD(RFieldBlockTest, testAllocate)
+TEST_ADD(RFieldBlockTest, testPadding)
+TEST_ADD(RFieldBlockTest, testView)
+TEST_END(RFieldBlockTest)
+
+#endif
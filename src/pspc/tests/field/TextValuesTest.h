@@ -0,0 +1,132 @@
+#ifndef PSPC_TEXT_VALUES_TEST_H
+#define PSPC_TEXT_VALUES_TEST_H
+
+#include <test/UnitTest.h>
+#include <test/UnitTestRunner.h>
+
+#include <pspc/field/textValues.h>
+#include <util/format/Dbl.h>
+
+#include <sstream>
+#include <string>
+#include <cstdio>
+#include <cmath>
+
+using namespace Util;
+using namespace Pscf::Pspc;
+
+class TextValuesTest : public UnitTest 
+{
+
+public:
+
+   void setUp()
+   {}
+
+   void tearDown()
+   {}
+
+   void testRead()
+   {
+      printMethod(TEST_FUNC);
+
+      std::istringstream in("  1.5 -2.25e-3\n\t3\n 4.0e+02  \n-0.1\n");
+      double values[5];
+      readTextValues(in, values, 5);
+      TEST_ASSERT(values[0] == 1.5);
+      TEST_ASSERT(values[1] == -2.25e-3);
+      TEST_ASSERT(values[2] == 3.0);
+      TEST_ASSERT(values[3] == 400.0);
+      TEST_ASSERT(values[4] == -0.1);
+
+      // As for operator >>, whitespace after the last value is unread
+      TEST_ASSERT(in.good());
+      TEST_ASSERT(in.get() == '\n');
+      TEST_ASSERT(in.peek() == EOF);
+   }
+
+   void testReadTrailing()
+   {
+      printMethod(TEST_FUNC);
+
+      // Read values that are followed by other content
+      std::istringstream in("1.0 2.0\n3.0 4.0 end\n 5.0\n");
+      double values[3];
+      readTextValues(in, values, 3);
+      TEST_ASSERT(values[0] == 1.0);
+      TEST_ASSERT(values[1] == 2.0);
+      TEST_ASSERT(values[2] == 3.0);
+
+      // Continue reading after the last value
+      double x;
+      std::string label;
+      in >> x >> label;
+      TEST_ASSERT(x == 4.0);
+      TEST_ASSERT(label == "end");
+      readTextValues(in, values, 1);
+      TEST_ASSERT(values[0] == 5.0);
+
+      // A value at the very end of the stream sets eof, as for >>
+      std::istringstream in2("6.0 7.0");
+      readTextValues(in2, values, 2);
+      TEST_ASSERT(values[1] == 7.0);
+      TEST_ASSERT(in2.eof());
+      TEST_ASSERT(!in2.fail());
+   }
+
+   void testReadCount()
+   {
+      printMethod(TEST_FUNC);
+
+      std::istringstream in("1.0 2.0 3.0\n");
+      double values[4];
+      bool thrown = false;
+      try {
+         readTextValues(in, values, 4);
+      } catch (...) {
+         thrown = true;
+      }
+      TEST_ASSERT(thrown);
+   }
+
+   void testWrite()
+   {
+      printMethod(TEST_FUNC);
+
+      // Write two columns, and compare to output of Dbl(value, 18, 15)
+      const int nRow = 5;
+      double a[nRow] = {1.0, -2.5E-7, 3.14159265358979, 0.0, -1.0E+12};
+      double b[nRow] = {0.1, 1.0/3.0, -7.0, 2.0E-300, 123456.789};
+      double const * columns[2] = {a, b};
+      std::ostringstream out;
+      writeTextColumns(out, columns, 2, nRow, "  ", "%18.15e");
+
+      std::ostringstream check;
+      for (int i = 0; i < nRow; ++i) {
+         check << "  " << Dbl(a[i], 18, 15) 
+               << "  " << Dbl(b[i], 18, 15) << std::endl;
+      }
+      TEST_ASSERT(out.str() == check.str());
+
+      // Read back values
+      std::istringstream in(out.str());
+      double values[2*nRow];
+      readTextValues(in, values, 2*nRow);
+      for (int i = 0; i < nRow; ++i) {
+         TEST_ASSERT(std::abs(values[2*i] - a[i]) 
+                     <= 1.0E-14*std::abs(a[i]));
+         TEST_ASSERT(std::abs(values[2*i+1] - b[i]) 
+                     <= 1.0E-14*std::abs(b[i]));
+      }
+   }
+
+};
+
+TEST_BEGIN(TextValuesTest)
+TEST_ADD(TextValuesTest, testRead)
+TEST_ADD(TextValuesTest, testReadTrailing)
+TEST_ADD(TextValuesTest, testReadCount)
+TEST_ADD(TextValuesTest, testWrite)
+TEST_END(TextValuesTest)
+
+#endif
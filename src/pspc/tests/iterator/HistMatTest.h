@@ -0,0 +1,175 @@
+#ifndef PSPC_HIST_MAT_TEST_H
+#define PSPC_HIST_MAT_TEST_H
+
+#include <test/UnitTest.h>
+#include <test/UnitTestRunner.h>
+
+#include <pspc/iterator/HistMat.h>
+#include <pspc/iterator/HistoryArena.h>
+#include <util/archives/BinaryFileOArchive.h>
+#include <util/archives/BinaryFileIArchive.h>
+
+#include <cmath>
+
+using namespace Util;
+using namespace Pscf::Pspc;
+
+class HistMatTest : public UnitTest
+{
+
+public:
+
+   void setUp() {}
+   void tearDown() {}
+
+   /*
+   * Inner product of histories i and j, recomputed from scratch.
+   */
+   double dot(HistoryArena const & hists, int i, int j)
+   {
+      double sum = 0.0;
+      for (int k = 0; k < hists.nField(); ++k) {
+         for (int l = 0; l < hists.fieldSize(); ++l) {
+            sum += hists[i][k][l]*hists[j][k][l];
+         }
+      }
+      return sum;
+   }
+
+   /*
+   * Inner product (d_0 - d_{m+1}, d_0 - d_n), recomputed from scratch.
+   */
+   double dotDiff(HistoryArena const & hists, int m, int n)
+   {
+      double sum = 0.0;
+      double a, b;
+      for (int k = 0; k < hists.nField(); ++k) {
+         for (int l = 0; l < hists.fieldSize(); ++l) {
+            a = hists[0][k][l] - hists[m+1][k][l];
+            b = hists[0][k][l] - hists[n][k][l];
+            sum += a*b;
+         }
+      }
+      return sum;
+   }
+
+   /*
+   * Add a new residual to hists and update mat incrementally, as in
+   * AmIteratorBase::computeDeviation.
+   */
+   void addResidual(HistoryArena& hists, HistMat& mat, int itr)
+   {
+      double* const * dev = hists.advance();
+      for (int k = 0; k < hists.nField(); ++k) {
+         for (int l = 0; l < hists.fieldSize(); ++l) {
+            dev[k][l] = sin(1.3*itr + 0.7*k + 0.3*l) + 0.1*itr;
+         }
+      }
+      mat.advance();
+      for (int i = 0; i < mat.size(); ++i) {
+         mat.setInnerProduct(i, dot(hists, 0, i));
+      }
+   }
+
+   void testConstructor()
+   {
+      printMethod(TEST_FUNC);
+      HistMat mat;
+      TEST_ASSERT(mat.size() == 0);
+      TEST_ASSERT(mat.capacity() == 0);
+      mat.allocate(4);
+      TEST_ASSERT(mat.size() == 0);
+      TEST_ASSERT(mat.capacity() == 4);
+   }
+
+   /*
+   * Add residuals as AmIteratorBase::computeDeviation does, for more
+   * than capacity iterations, and compare the incrementally updated
+   * matrix with inner products recomputed from the stored residuals.
+   */
+   void testIncrementalUpdate()
+   {
+      printMethod(TEST_FUNC);
+
+      int maxHist = 3;
+      int nField = 2;
+      int fieldSize = 5;
+      HistoryArena hists;
+      hists.allocate(maxHist + 1, nField, fieldSize);
+      HistMat mat;
+      mat.allocate(maxHist + 1);
+
+      int itr, i, j;
+      double error;
+      for (itr = 0; itr < 3*(maxHist + 1) + 2; ++itr) {
+
+         addResidual(hists, mat, itr);
+         TEST_ASSERT(mat.size() == hists.size());
+
+         // Compare all stored elements to recomputed inner products
+         for (i = 0; i < mat.size(); ++i) {
+            for (j = 0; j < mat.size(); ++j) {
+               error = std::abs(mat.innerProduct(i, j) - dot(hists, i, j));
+               TEST_ASSERT(error < 1.0E-12*(1.0 + dot(hists, i, i)));
+            }
+         }
+
+         // Compare elements of the AM matrix U and vector V
+         for (i = 0; i < mat.size() - 1; ++i) {
+            for (j = 0; j < mat.size() - 1; ++j) {
+               error = std::abs(mat.makeUmn(i, j) - dotDiff(hists, i, j+1));
+               TEST_ASSERT(error < 1.0E-10*(1.0 + dot(hists, 0, 0)));
+            }
+            error = std::abs(mat.makeVm(i) - dot(hists, 0, 0)
+                             + dot(hists, i + 1, 0));
+            TEST_ASSERT(error < 1.0E-10*(1.0 + dot(hists, 0, 0)));
+         }
+      }
+      TEST_ASSERT(mat.size() == maxHist + 1);
+
+      // Clear discards all values
+      mat.clear();
+      hists.clear();
+      TEST_ASSERT(mat.size() == 0);
+   }
+
+   void testSerialize()
+   {
+      printMethod(TEST_FUNC);
+      HistoryArena hists;
+      hists.allocate(4, 2, 5);
+      HistMat mat;
+      mat.allocate(4);
+      int itr, i, j;
+      for (itr = 0; itr < 6; ++itr) {
+         addResidual(hists, mat, itr);
+      }
+
+      BinaryFileOArchive oArchive;
+      openOutputFile("binary", oArchive.file());
+      oArchive << mat;
+      oArchive.file().close();
+
+      HistMat copy;
+      BinaryFileIArchive iArchive;
+      openInputFile("binary", iArchive.file());
+      iArchive >> copy;
+      iArchive.file().close();
+      TEST_ASSERT(copy.capacity() == 4);
+      TEST_ASSERT(copy.size() == 4);
+      for (i = 0; i < 4; ++i) {
+         for (j = 0; j < 4; ++j) {
+            TEST_ASSERT(copy.innerProduct(i, j) == mat.innerProduct(i, j));
+         }
+      }
+   }
+
+};
+
+TEST_BEGIN(HistMatTest)
+TEST_ADD(HistMatTest, testConstructor)
+TEST_ADD(HistMatTest, testIncrementalUpdate)
+TEST_ADD(HistMatTest, testSerialize)
+TEST_END(HistMatTest)
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef PSPC_HISTORY_ARENA_TEST_H
+#define PSPC_HISTORY_ARENA_TEST_H
+
+#include <test/UnitTest.h>
+#include <test/UnitTestRunner.h>
+
+#include <pspc/iterator/HistoryArena.h>
+#include <util/archives/BinaryFileOArchive.h>
+#include <util/archives/BinaryFileIArchive.h>
+
+#include <algorithm>
+
+using namespace Util;
+using namespace Pscf::Pspc;
+
+class HistoryArenaTest : public UnitTest
+{
+
+public:
+
+   void setUp() {}
+   void tearDown() {}
+
+   /*
+   * Set all elements of a new slot to values identifying slot number k.
+   */
+   void fill(double* const * slot, int nField, int fieldSize, int k)
+   {
+      for (int f = 0; f < nField; ++f) {
+         for (int l = 0; l < fieldSize; ++l) {
+            slot[f][l] = 100.0*k + 10.0*f + l;
+         }
+      }
+   }
+
+   /*
+   * Check that slot i of arena holds the values written for slot k.
+   */
+   bool holds(HistoryArena const & arena, int i, int k)
+   {
+      for (int f = 0; f < arena.nField(); ++f) {
+         for (int l = 0; l < arena.fieldSize(); ++l) {
+            if (arena[i][f][l] != 100.0*k + 10.0*f + l) {
+               return false;
+            }
+         }
+      }
+      return true;
+   }
+
+   void testAllocate()
+   {
+      printMethod(TEST_FUNC);
+      HistoryArena arena;
+      TEST_ASSERT(!arena.isAllocated());
+      arena.allocate(3, 2, 4);
+      TEST_ASSERT(arena.isAllocated());
+      TEST_ASSERT(arena.capacity() == 3);
+      TEST_ASSERT(arena.nField() == 2);
+      TEST_ASSERT(arena.fieldSize() == 4);
+      TEST_ASSERT(arena.size() == 0);
+   }
+
+   void testRingOrder()
+   {
+      printMethod(TEST_FUNC);
+      HistoryArena arena;
+      arena.allocate(3, 2, 4);
+
+      // Fill beyond capacity, so that the ring wraps around twice
+      int k, i;
+      double* const * first = 0;
+      for (k = 0; k < 7; ++k) {
+         double* const * slot = arena.advance();
+         if (k == 0) {
+            first = slot;
+         }
+         fill(slot, 2, 4, k);
+         TEST_ASSERT(arena.size() == std::min(k + 1, 3));
+         for (i = 0; i < arena.size(); ++i) {
+            TEST_ASSERT(holds(arena, i, k - i));
+         }
+
+         // Fields of each slot are contiguous
+         TEST_ASSERT(slot[1] == slot[0] + 4);
+
+         // Oldest slot is reused once the arena is full
+         if (k == 3 || k == 6) {
+            TEST_ASSERT(slot == first);
+         }
+      }
+
+      // Clear discards histories but keeps memory
+      arena.clear();
+      TEST_ASSERT(arena.size() == 0);
+      TEST_ASSERT(arena.isAllocated());
+      fill(arena.advance(), 2, 4, 9);
+      TEST_ASSERT(arena.size() == 1);
+      TEST_ASSERT(holds(arena, 0, 9));
+   }
+
+   void testSerialize()
+   {
+      printMethod(TEST_FUNC);
+      HistoryArena arena;
+      arena.allocate(3, 2, 4);
+      int k, i;
+      for (k = 0; k < 5; ++k) {
+         fill(arena.advance(), 2, 4, k);
+      }
+
+      BinaryFileOArchive oArchive;
+      openOutputFile("binary", oArchive.file());
+      oArchive << arena;
+      oArchive.file().close();
+
+      // Load into an unallocated arena
+      HistoryArena copy;
+      BinaryFileIArchive iArchive;
+      openInputFile("binary", iArchive.file());
+      iArchive >> copy;
+      iArchive.file().close();
+      TEST_ASSERT(copy.capacity() == 3);
+      TEST_ASSERT(copy.nField() == 2);
+      TEST_ASSERT(copy.fieldSize() == 4);
+      TEST_ASSERT(copy.size() == 3);
+      for (i = 0; i < 3; ++i) {
+         TEST_ASSERT(holds(copy, i, 4 - i));
+      }
+
+      // Both arenas continue in the same ring order
+      fill(arena.advance(), 2, 4, 5);
+      fill(copy.advance(), 2, 4, 5);
+      for (i = 0; i < 3; ++i) {
+         TEST_ASSERT(holds(arena, i, 5 - i));
+         TEST_ASSERT(holds(copy, i, 5 - i));
+      }
+
+      // Load into an allocated arena with other contents
+      HistoryArena other;
+      other.allocate(3, 2, 4);
+      fill(other.advance(), 2, 4, 8);
+      openInputFile("binary", iArchive.file());
+      iArchive >> other;
+      iArchive.file().close();
+      TEST_ASSERT(other.size() == 3);
+      for (i = 0; i < 3; ++i) {
+         TEST_ASSERT(holds(other, i, 4 - i));
+      }
+
+      // Loading into an arena of different dimensions fails
+      HistoryArena wrong;
+      wrong.allocate(4, 2, 4);
+      openInputFile("binary", iArchive.file());
+      bool thrown = false;
+      try {
+         iArchive >> wrong;
+      } catch (Exception&) {
+         thrown = true;
+      }
+      iArchive.file().close();
+      TEST_ASSERT(thrown);
+   }
+
+};
+
+TEST_BEGIN(HistoryArenaTest)
+TEST_ADD(HistoryArenaTest, testAllocate)
+TEST_ADD(HistoryArenaTest, testRingOrder)
+TEST_ADD(HistoryArenaTest, testSerialize)
+TEST_END(HistoryArenaTest)
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef PSPC_ITERATOR_TEST_COMPOSITE_H
+#define PSPC_ITERATOR_TEST_COMPOSITE_H
+
+#include <test/CompositeTestRunner.h>
+
+#include "HistoryArenaTest.h"
+#include "HistMatTest.h"
+//#include "IteratorTest.h"
+
+TEST_COMPOSITE_BEGIN(IteratorTestComposite)
+TEST_COMPOSITE_ADD_UNIT(HistoryArenaTest);
+TEST_COMPOSITE_ADD_UNIT(HistMatTest);
+//TEST_COMPOSITE_ADD_UNIT(IteratorTest);
+TEST_COMPOSITE_END
+
+#endif
@@ -1,9 +1,9 @@
 /*
-* This program runs all unit tests in the pspc/tests/fftw directory.
+* This program runs all unit tests in the pspc/tests/iterator directory.
 */ 
 
 #include <util/global.h>
-#include "IteratorTest.h"
+#include "IteratorTestComposite.h"
 
 #include <test/TestRunner.h>
 #include <test/CompositeTestRunner.h>
@@ -13,7 +13,7 @@
 
 int main(int argc, char* argv[])
 {
-   TEST_RUNNER(IteratorTest) runner;
+   IteratorTestComposite runner;
 
    #if 0
    if (argc > 2) {
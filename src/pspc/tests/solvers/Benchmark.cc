@@ -0,0 +1,151 @@
+/*
+* This program benchmarks the MDE step algorithm of Pspc::Block.
+*
+* Usage: Benchmark [n [nStep]]
+*
+* The fused Block<3>::step is compared to the unfused reference
+* implementation Block<3>::stepUnfused on an n x n x n mesh (default
+* n = 64), using nStep steps per timing (default 50). For each, the
+* program reports ns per grid point per step and an effective memory
+* bandwidth. The bandwidth is computed from the number of doubles read
+* and written by the pointwise (non-FFT) stages of each algorithm,
+* and thus excludes memory traffic within FFTW. This program must be
+* run from the pspc/tests/solvers directory.
+*/
+
+#include <pspc/solvers/Block.h>
+#include <pspc/solvers/Propagator.h>
+#include <pspc/solvers/WaveList.h>
+#include <pscf/mesh/Mesh.h>
+#include <pscf/mesh/MeshIterator.h>
+#include <pscf/crystal/UnitCell.h>
+#include <pscf/math/IntVec.h>
+#include <util/math/Constants.h>
+#include <util/misc/Timer.h>
+#include <util/format/Dbl.h>
+#include <util/format/Int.h>
+#include <util/global.h>
+
+#include <fstream>
+#include <iomanip>
+#include <cstdlib>
+
+using namespace Util;
+using namespace Pscf;
+using namespace Pscf::Pspc;
+
+/*
+* Doubles read or written per step by pointwise stages, per r-grid
+* point (nx) and per k-grid point (nk). FFT internals are excluded.
+*/
+const double unfusedNx = 16.0;
+const double unfusedNk = 15.0;
+const double fusedNx = 14.0;
+const double fusedNk = 15.0;
+
+void report(std::string name, double time, int nStep, int nx, int nk,
+            double cx, double ck)
+{
+   double nsPerPoint = 1.0E9*time/(double(nStep)*double(nx));
+   double bytes = double(nStep)*(cx*nx + ck*nk)*sizeof(double);
+   double gbs = 1.0E-9*bytes/time;
+   std::cout << std::setw(10) << std::left << name << std::right
+             << Dbl(time, 15, 6)
+             << Dbl(nsPerPoint, 15, 6)
+             << Dbl(gbs, 15, 6) << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+   int n = 64;
+   int nStep = 50;
+   if (argc > 1) {
+      n = atoi(argv[1]);
+   }
+   if (argc > 2) {
+      nStep = atoi(argv[2]);
+   }
+   UTIL_CHECK(n > 1);
+   UTIL_CHECK(nStep > 0);
+
+   // Block
+   Block<3> block;
+   block.setId(0);
+   block.setLength(2.0);
+   block.setMonomerId(0);
+   block.setKuhn(1.0);
+
+   // Mesh
+   Mesh<3> mesh;
+   IntVec<3> d;
+   d[0] = n;
+   d[1] = n;
+   d[2] = n;
+   mesh.setDimensions(d);
+   block.setDiscretization(0.01, mesh);
+
+   // Unit cell
+   UnitCell<3> unitCell;
+   std::ifstream in;
+   in.open("in/Orthorhombic");
+   UTIL_CHECK(in.is_open());
+   in >> unitCell;
+   in.close();
+   WaveList<3> wavelist;
+   wavelist.allocate(mesh, unitCell);
+   wavelist.computeMinimumImages(mesh, unitCell);
+   wavelist.computeKSq(unitCell);
+   wavelist.computedKSq(unitCell);
+   block.setupUnitCell(unitCell, wavelist);
+
+   // Chemical potential field and initial q field
+   RField<3> w;
+   Propagator<3>::QField q0, q1;
+   w.allocate(d);
+   q0.allocate(d);
+   q1.allocate(d);
+   MeshIterator<3> iter(d);
+   double twoPi = 2.0*Constants::Pi;
+   double x, y, z;
+   for (iter.begin(); !iter.atEnd(); ++iter) {
+      x = twoPi*double(iter.position(0))/double(n);
+      y = twoPi*double(iter.position(1))/double(n);
+      z = twoPi*double(iter.position(2))/double(n);
+      w[iter.rank()] = cos(x)*cos(y) + cos(y)*cos(z) + cos(z)*cos(x);
+      q0[iter.rank()] = 1.0;
+   }
+   block.setupSolver(w);
+
+   int nx = mesh.size();
+   int nk = (nx/n)*(n/2 + 1);
+
+   std::cout << "mesh = " << d << ",  nStep = " << nStep << std::endl;
+   std::cout << std::setw(10) << std::left << "algorithm" << std::right
+             << std::setw(15) << "time (s)"
+             << std::setw(15) << "ns/point"
+             << std::setw(15) << "GB/s" << std::endl;
+
+   Timer timer;
+   int i;
+
+   // Unfused reference algorithm
+   block.stepUnfused(q0, q1);
+   timer.start();
+   for (i = 0; i < nStep; ++i) {
+      block.stepUnfused(q0, q1);
+   }
+   timer.stop();
+   report("unfused", timer.time(), nStep, nx, nk, unfusedNx, unfusedNk);
+
+   // Fused algorithm
+   timer.clear();
+   block.step(q0, q1);
+   timer.start();
+   for (i = 0; i < nStep; ++i) {
+      block.step(q0, q1);
+   }
+   timer.stop();
+   report("fused", timer.time(), nStep, nx, nk, fusedNx, fusedNk);
+
+   return 0;
+}
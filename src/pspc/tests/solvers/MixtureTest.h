@@ -8,6 +8,7 @@
 #include <pspc/solvers/Polymer.h>
 #include <pspc/solvers/Block.h>
 #include <pspc/solvers/Propagator.h>
+#include <pspc/solvers/WaveList.h>
 #include <pscf/mesh/Mesh.h>
 #include <pscf/crystal/UnitCell.h>
 #include <pscf/math/IntVec.h>
@@ -65,7 +66,12 @@ public:
       Mesh<1> mesh;
       mesh.setDimensions(d);
       mixture.setMesh(mesh);
-      mixture.setupUnitCell(unitCell);
+      WaveList<1> wavelist;
+      wavelist.allocate(mesh, unitCell);
+      wavelist.computeMinimumImages(mesh, unitCell);
+      wavelist.computeKSq(unitCell);
+      wavelist.computedKSq(unitCell);
+      mixture.setupUnitCell(unitCell, wavelist);
 
       #if 0
       std::cout << "\n";
@@ -140,7 +146,12 @@ public:
       Mesh<2> mesh;
       mesh.setDimensions(d);
       mixture.setMesh(mesh);
-      mixture.setupUnitCell(unitCell);
+      WaveList<2> wavelist;
+      wavelist.allocate(mesh, unitCell);
+      wavelist.computeMinimumImages(mesh, unitCell);
+      wavelist.computeKSq(unitCell);
+      wavelist.computedKSq(unitCell);
+      mixture.setupUnitCell(unitCell, wavelist);
 
       #if 0
       std::cout << "\n";
@@ -235,7 +246,12 @@ public:
       Mesh<2> mesh;
       mesh.setDimensions(d);
       mixture.setMesh(mesh);
-      mixture.setupUnitCell(unitCell);
+      WaveList<2> wavelist;
+      wavelist.allocate(mesh, unitCell);
+      wavelist.computeMinimumImages(mesh, unitCell);
+      wavelist.computeKSq(unitCell);
+      wavelist.computedKSq(unitCell);
+      mixture.setupUnitCell(unitCell, wavelist);
 
       #if 0
       std::cout << "\n";
@@ -319,7 +335,12 @@ public:
       Mesh<3> mesh;
       mesh.setDimensions(d);
       mixture.setMesh(mesh);
-      mixture.setupUnitCell(unitCell);
+      WaveList<3> wavelist;
+      wavelist.allocate(mesh, unitCell);
+      wavelist.computeMinimumImages(mesh, unitCell);
+      wavelist.computeKSq(unitCell);
+      wavelist.computedKSq(unitCell);
+      mixture.setupUnitCell(unitCell, wavelist);
 
       #if 0
       std::cout << "\n";
@@ -7,6 +7,7 @@
 #include <pspc/solvers/Block.h>
 #include <pscf/mesh/MeshIterator.h>
 #include <pspc/solvers/Propagator.h>
+#include <pspc/solvers/WaveList.h>
 #include <pscf/mesh/Mesh.h>
 #include <pscf/crystal/UnitCell.h>
 #include <pscf/math/IntVec.h>
@@ -87,6 +88,16 @@ public:
       mesh.setDimensions(d);
    }
 
+   template <int D>
+   void setupWaveList(Mesh<D> const & mesh, UnitCell<D> const & unitCell,
+                      WaveList<D>& wavelist)
+   {
+      wavelist.allocate(mesh, unitCell);
+      wavelist.computeMinimumImages(mesh, unitCell);
+      wavelist.computeKSq(unitCell);
+      wavelist.computedKSq(unitCell);
+   }
+
    void setupUnitCell1D(UnitCell<1>& unitCell) 
    {
       std::ifstream in;
@@ -198,6 +209,8 @@ public:
 
       UnitCell<1> unitCell;
       setupUnitCell1D(unitCell);
+      WaveList<1> wavelist;
+      setupWaveList(mesh, unitCell, wavelist);
       std::cout << std::endl;
       std::cout << "unit cell = " << unitCell << std::endl;
       TEST_ASSERT(eq(unitCell.rBasis(0)[0], 4.0));
@@ -210,7 +223,7 @@ public:
          w[i] = 1.0;
       }
 
-      block.setupUnitCell(unitCell);
+      block.setupUnitCell(unitCell, wavelist);
       block.setupSolver(w);
    }
    
@@ -231,6 +244,8 @@ public:
 
       UnitCell<2> unitCell;
       setupUnitCell2D(unitCell);
+      WaveList<2> wavelist;
+      setupWaveList(mesh, unitCell, wavelist);
       std::cout << std::endl;
       std::cout << "unit cell = " << unitCell << std::endl;
       TEST_ASSERT(eq(unitCell.rBasis(0)[0], 3.0));
@@ -244,7 +259,7 @@ public:
          w[i] = 1.0;
       }
 
-      block.setupUnitCell(unitCell);
+      block.setupUnitCell(unitCell, wavelist);
       block.setupSolver(w);
    }
 
@@ -265,6 +280,8 @@ public:
 
       UnitCell<3> unitCell;
       setupUnitCell3D(unitCell);
+      WaveList<3> wavelist;
+      setupWaveList(mesh, unitCell, wavelist);
       std::cout << std::endl;
       std::cout << "unit cell = " << unitCell << std::endl;
       TEST_ASSERT(eq(unitCell.rBasis(0)[0], 3.0));
@@ -279,7 +296,7 @@ public:
          w[i] = 1.0;
       }
 
-      block.setupUnitCell(unitCell);
+      block.setupUnitCell(unitCell, wavelist);
       block.setupSolver(w);
    }
 
@@ -300,6 +317,8 @@ public:
 
       UnitCell<1> unitCell;
       setupUnitCell1D(unitCell);
+      WaveList<1> wavelist;
+      setupWaveList(mesh, unitCell, wavelist);
       // std::cout << std::endl;
       // std::cout << "unit cell = " << unitCell << std::endl;
 
@@ -313,7 +332,7 @@ public:
          w[i] = wc;
       }
 
-      block.setupUnitCell(unitCell);
+      block.setupUnitCell(unitCell, wavelist);
       block.setupSolver(w);
 
       // Test step
@@ -383,6 +402,8 @@ public:
 
       UnitCell<2> unitCell;
       setupUnitCell2D(unitCell);
+      WaveList<2> wavelist;
+      setupWaveList(mesh, unitCell, wavelist);
       //std::cout << std::endl;
       //std::cout << "unit cell = " << unitCell << std::endl;
       TEST_ASSERT(eq(unitCell.rBasis(0)[0], 3.0));
@@ -399,7 +420,7 @@ public:
          w[i] = wc;
       }
 
-      block.setupUnitCell(unitCell);
+      block.setupUnitCell(unitCell, wavelist);
       block.setupSolver(w);
 
       // Test step
@@ -479,6 +500,8 @@ public:
 
       UnitCell<3> unitCell;
       setupUnitCell3D(unitCell);
+      WaveList<3> wavelist;
+      setupWaveList(mesh, unitCell, wavelist);
       //std::cout << std::endl;
       //std::cout << "unit cell = " << unitCell << std::endl;
       TEST_ASSERT(eq(unitCell.rBasis(0)[0], 3.0));
@@ -496,7 +519,7 @@ public:
          w[i] = wc;
       }
 
-      block.setupUnitCell(unitCell);
+      block.setupUnitCell(unitCell, wavelist);
       block.setupSolver(w);
 
       // Test step
@@ -560,6 +583,371 @@ public:
 
    }
 
+   void testStepFused3D()
+   {
+      printMethod(TEST_FUNC);
+
+      // Create and initialize block
+      Block<3> block;
+      setupBlock3D(block);
+
+      // Create and initialize mesh
+      Mesh<3> mesh;
+      setupMesh3D(mesh);
+
+      double ds = 0.02;
+      block.setDiscretization(ds, mesh);
+
+      UnitCell<3> unitCell;
+      setupUnitCell3D(unitCell);
+      WaveList<3> wavelist;
+      setupWaveList(mesh, unitCell, wavelist);
+      block.setupUnitCell(unitCell, wavelist);
+
+      // Setup inhomogeneous chemical potential field and initial q
+      RField<3> w;
+      w.allocate(mesh.dimensions());
+      Propagator<3>::QField qin;
+      Propagator<3>::QField qFused;
+      Propagator<3>::QField qUnfused;
+      qin.allocate(mesh.dimensions());
+      qFused.allocate(mesh.dimensions());
+      qUnfused.allocate(mesh.dimensions());
+
+      MeshIterator<3> iter(mesh.dimensions());
+      double twoPi = 2.0*Constants::Pi;
+      double x, y, z;
+      for (iter.begin(); !iter.atEnd(); ++iter){
+         x = twoPi*double(iter.position(0))/double(mesh.dimension(0));
+         y = twoPi*double(iter.position(1))/double(mesh.dimension(1));
+         z = twoPi*double(iter.position(2))/double(mesh.dimension(2));
+         w[iter.rank()] = 0.3 + 2.0*cos(x)*sin(2.0*y) + cos(z);
+         qin[iter.rank()] = 1.0 + 0.5*cos(x + y + z) + 0.2*sin(3.0*z);
+      }
+      block.setupSolver(w);
+
+      block.step(qin, qFused);
+      block.stepUnfused(qin, qUnfused);
+
+      double diff;
+      double maxDiff = 0.0;
+      for (int i = 0; i < mesh.size(); ++i) {
+         diff = std::abs(qFused[i] - qUnfused[i]);
+         if (diff > maxDiff) maxDiff = diff;
+      }
+      TEST_ASSERT(maxDiff < 1.0E-12);
+   }
+
+   void testCheckpoint1D()
+   {
+      printMethod(TEST_FUNC);
+
+      // Create blocks with full and checkpointed propagator storage
+      Block<1> block, blockCp;
+      setupBlock1D(block);
+      setupBlock1D(blockCp);
+
+      Mesh<1> mesh;
+      setupMesh1D(mesh);
+
+      double ds = 0.02;
+      block.setDiscretization(ds, mesh);
+      blockCp.setDiscretization(ds, mesh, 4);
+      TEST_ASSERT(blockCp.propagator(0).checkpointInterval() == 4);
+      TEST_ASSERT(blockCp.propagator(0).isStored(0));
+      TEST_ASSERT(blockCp.propagator(0).isStored(8));
+      TEST_ASSERT(!blockCp.propagator(0).isStored(9));
+      TEST_ASSERT(blockCp.propagator(0).isStored(blockCp.ns() - 1));
+
+      UnitCell<1> unitCell;
+      setupUnitCell1D(unitCell);
+      WaveList<1> wavelist;
+      setupWaveList(mesh, unitCell, wavelist);
+      block.setupUnitCell(unitCell, wavelist);
+      blockCp.setupUnitCell(unitCell, wavelist);
+
+      // Inhomogeneous chemical potential field
+      RField<1> w;
+      w.allocate(mesh.dimensions());
+      int nx = mesh.size();
+      double twoPi = 2.0*Constants::Pi;
+      for (int i = 0; i < nx; ++i) {
+         w[i] = 0.3 + cos(twoPi*double(i)/double(nx));
+      }
+      block.setupSolver(w);
+      blockCp.setupSolver(w);
+
+      int d, i, j;
+      for (d = 0; d < 2; ++d) {
+         block.propagator(d).solve();
+         blockCp.propagator(d).solve();
+      }
+
+      // Compare all slices, in descending order for propagator 1
+      int ns = block.ns();
+      for (j = 0; j < ns; ++j) {
+         Propagator<1>::QField const & q0 = block.propagator(0).q(j);
+         Propagator<1>::QField const & q0Cp 
+                                     = blockCp.propagator(0).qSlice(j);
+         Propagator<1>::QField const & q1 = block.propagator(1).q(ns-1-j);
+         Propagator<1>::QField const & q1Cp 
+                                 = blockCp.propagator(1).qSlice(ns-1-j);
+         for (i = 0; i < nx; ++i) {
+            TEST_ASSERT(eq(q0[i], q0Cp[i]));
+            TEST_ASSERT(eq(q1[i], q1Cp[i]));
+         }
+      }
+
+      // Compare concentrations
+      block.computeConcentration(1.0);
+      blockCp.computeConcentration(1.0);
+      for (i = 0; i < nx; ++i) {
+         TEST_ASSERT(eq(block.cField()[i], blockCp.cField()[i]));
+      }
+   }
+
+   void testSinglePrecision1D()
+   {
+      printMethod(TEST_FUNC);
+
+      // Blocks with double and single precision slices, the latter
+      // with and without checkpointing
+      Block<1> block, blockSp, blockSpCp;
+      setupBlock1D(block);
+      setupBlock1D(blockSp);
+      setupBlock1D(blockSpCp);
+
+      Mesh<1> mesh;
+      setupMesh1D(mesh);
+
+      double ds = 0.02;
+      block.setDiscretization(ds, mesh);
+      blockSp.setDiscretization(ds, mesh, 1, true);
+      blockSpCp.setDiscretization(ds, mesh, 4, true);
+      TEST_ASSERT(!block.propagator(0).isSinglePrecision());
+      TEST_ASSERT(blockSp.propagator(0).isSinglePrecision());
+      TEST_ASSERT(blockSpCp.propagator(1).isSinglePrecision());
+
+      UnitCell<1> unitCell;
+      setupUnitCell1D(unitCell);
+      WaveList<1> wavelist;
+      setupWaveList(mesh, unitCell, wavelist);
+      block.setupUnitCell(unitCell, wavelist);
+      blockSp.setupUnitCell(unitCell, wavelist);
+      blockSpCp.setupUnitCell(unitCell, wavelist);
+
+      RField<1> w;
+      w.allocate(mesh.dimensions());
+      int nx = mesh.size();
+      double twoPi = 2.0*Constants::Pi;
+      for (int i = 0; i < nx; ++i) {
+         w[i] = 0.3 + cos(twoPi*double(i)/double(nx));
+      }
+      block.setupSolver(w);
+      blockSp.setupSolver(w);
+      blockSpCp.setupSolver(w);
+
+      int d, i, j;
+      for (d = 0; d < 2; ++d) {
+         block.propagator(d).solve();
+         blockSp.propagator(d).solve();
+         blockSpCp.propagator(d).solve();
+      }
+
+      // Head and tail are computed and stored in double precision
+      int ns = block.ns();
+      for (i = 0; i < nx; ++i) {
+         TEST_ASSERT(eq(block.propagator(0).tail()[i], 
+                        blockSp.propagator(0).tail()[i]));
+         TEST_ASSERT(eq(block.propagator(0).tail()[i], 
+                        blockSpCp.propagator(0).tail()[i]));
+      }
+
+      // Interior slices agree to single precision
+      double tol = 1.0E-6;
+      for (j = 0; j < ns; ++j) {
+         Propagator<1>::QField const & q0 = block.propagator(0).q(j);
+         Propagator<1>::QField const & q0Sp 
+                                  = blockSp.propagator(0).qSlice(j);
+         Propagator<1>::QField const & q0SpCp
+                                  = blockSpCp.propagator(0).qSlice(j);
+         for (i = 0; i < nx; ++i) {
+            TEST_ASSERT(std::abs(q0[i] - q0Sp[i]) < tol*std::abs(q0[i]));
+            TEST_ASSERT(std::abs(q0[i] - q0SpCp[i]) < tol*std::abs(q0[i]));
+         }
+      }
+
+      // Concentrations
+      block.computeConcentration(1.0);
+      blockSp.computeConcentration(1.0);
+      blockSpCp.computeConcentration(1.0);
+      double c;
+      for (i = 0; i < nx; ++i) {
+         c = block.cField()[i];
+         TEST_ASSERT(std::abs(c - blockSp.cField()[i]) < tol*c);
+         TEST_ASSERT(std::abs(c - blockSpCp.cField()[i]) < tol*c);
+      }
+   }
+
+   void testStressCache1D()
+   {
+      printMethod(TEST_FUNC);
+
+      Block<1> block, block2;
+      setupBlock1D(block);
+      setupBlock1D(block2);
+
+      Mesh<1> mesh;
+      setupMesh1D(mesh);
+      double ds = 0.02;
+      block.setDiscretization(ds, mesh);
+      block2.setDiscretization(ds, mesh);
+
+      UnitCell<1> unitCell, unitCell2;
+      setupUnitCell1D(unitCell);
+      WaveList<1> wavelist;
+      setupWaveList(mesh, unitCell, wavelist);
+      block.setupUnitCell(unitCell, wavelist);
+
+      RField<1> w;
+      w.allocate(mesh.dimensions());
+      int nx = mesh.size();
+      double twoPi = 2.0*Constants::Pi;
+      for (int i = 0; i < nx; ++i) {
+         w[i] = 0.3 + cos(twoPi*double(i)/double(nx));
+      }
+      block.setupSolver(w);
+      block.propagator(0).solve();
+      block.propagator(1).solve();
+      block.computeStress(1.0);
+
+      // Repeated evaluation reuses derivatives of G^2 in wavelist
+      double stress = block.stress(0);
+      block.computeStress(1.0);
+      TEST_ASSERT(eq(stress, block.stress(0)));
+
+      // Change unit cell parameters, and solve again
+      FSArray<double, 6> parameters = unitCell.parameters();
+      parameters[0] *= 1.1;
+      unitCell.setParameters(parameters);
+      wavelist.computeKSq(unitCell);
+      wavelist.computedKSq(unitCell);
+      block.setupUnitCell(unitCell, wavelist);
+      block.setupSolver(w);
+      block.propagator(0).solve();
+      block.propagator(1).solve();
+      block.computeStress(1.0);
+
+      // Compare to a block and wavelist that were only set up for the 
+      // new unit cell
+      setupUnitCell1D(unitCell2);
+      unitCell2.setParameters(parameters);
+      WaveList<1> wavelist2;
+      setupWaveList(mesh, unitCell2, wavelist2);
+      block2.setupUnitCell(unitCell2, wavelist2);
+      block2.setupSolver(w);
+      block2.propagator(0).solve();
+      block2.propagator(1).solve();
+      block2.computeStress(1.0);
+      TEST_ASSERT(!eq(stress, block.stress(0)));
+      TEST_ASSERT(eq(block2.stress(0), block.stress(0)));
+   }
+
+   void testAdaptive1D()
+   {
+      printMethod(TEST_FUNC);
+
+      // Blocks with uniform and adaptive contour steps
+      Block<1> block, blockA;
+      setupBlock1D(block);
+      setupBlock1D(blockA);
+
+      Mesh<1> mesh;
+      setupMesh1D(mesh);
+
+      double ds = 0.005;
+      block.setDiscretization(ds, mesh);
+      blockA.setDiscretization(ds, mesh);
+      blockA.setAdaptiveTolerance(1.0E-5);
+      TEST_ASSERT(!block.isAdaptive());
+      TEST_ASSERT(blockA.isAdaptive());
+      TEST_ASSERT(blockA.nLevel() == 5);
+      TEST_ASSERT(blockA.nStep() == blockA.ns() - 1);
+
+      UnitCell<1> unitCell;
+      setupUnitCell1D(unitCell);
+      WaveList<1> wavelist;
+      setupWaveList(mesh, unitCell, wavelist);
+      block.setupUnitCell(unitCell, wavelist);
+      blockA.setupUnitCell(unitCell, wavelist);
+
+      RField<1> w;
+      w.allocate(mesh.dimensions());
+      int nx = mesh.size();
+      double twoPi = 2.0*Constants::Pi;
+      for (int i = 0; i < nx; ++i) {
+         w[i] = 0.3 + cos(twoPi*double(i)/double(nx));
+      }
+      block.setupSolver(w);
+      block.propagator(0).solve();
+      block.propagator(1).solve();
+      block.computeConcentration(1.0);
+      block.computeStress(1.0);
+
+      // Grid of blockA is adapted only by explicit calls to adaptGrid
+      int i, j, k;
+      blockA.setupSolver(w);
+      blockA.propagator(0).solve();
+      blockA.setupSolver(w);
+      TEST_ASSERT(blockA.nStep() == blockA.ns() - 1);
+
+      // Repeated solution and adaption converges to a stable grid
+      for (k = 0; k < 6; ++k) {
+         blockA.setupSolver(w);
+         blockA.propagator(0).solve();
+         blockA.propagator(1).solve();
+         if (!blockA.adaptGrid()) {
+            break;
+         }
+      }
+      TEST_ASSERT(k < 6);
+
+      // Without a new solution, adaptGrid does nothing
+      TEST_ASSERT(!blockA.adaptGrid());
+      blockA.computeConcentration(1.0);
+      blockA.computeStress(1.0);
+
+      // Steps fill the block, with fewer steps than the uniform grid
+      int n = blockA.nStep();
+      int nFine = 0;
+      double sum = 0.0;
+      for (j = 0; j < n; ++j) {
+         nFine += (1 << blockA.stepLevel(j));
+      }
+      for (j = 0; j <= n; ++j) {
+         sum += blockA.sliceWeight(j);
+      }
+      TEST_ASSERT(nFine == blockA.ns() - 1);
+      TEST_ASSERT(n < (blockA.ns() - 1)/2);
+      TEST_ASSERT(eq(sum, blockA.length()));
+      TEST_ASSERT(blockA.propagator(0).tail().capacity() == nx);
+
+      // Partition functions, concentrations and stress agree closely
+      double Q = block.propagator(0).computeQ();
+      double QA = blockA.propagator(0).computeQ();
+      TEST_ASSERT(std::abs(Q - QA) < 1.0E-6*Q);
+      TEST_ASSERT(std::abs(QA - blockA.propagator(1).computeQ()) 
+                  < 1.0E-10*QA);
+      double c;
+      for (i = 0; i < nx; ++i) {
+         c = block.cField()[i];
+         TEST_ASSERT(std::abs(c - blockA.cField()[i]) < 1.0E-5*c);
+      }
+      double stress = block.stress(0);
+      TEST_ASSERT(std::abs(stress - blockA.stress(0)) 
+                  < 1.0E-4*std::abs(stress));
+   }
+
 };
 
 TEST_BEGIN(PropagatorTest)
@@ -571,6 +959,11 @@ TEST_ADD(PropagatorTest, testSetupSolver3D)
 TEST_ADD(PropagatorTest, testSolver1D)
 TEST_ADD(PropagatorTest, testSolver2D)
 TEST_ADD(PropagatorTest, testSolver3D)
+TEST_ADD(PropagatorTest, testStepFused3D)
+TEST_ADD(PropagatorTest, testCheckpoint1D)
+TEST_ADD(PropagatorTest, testSinglePrecision1D)
+TEST_ADD(PropagatorTest, testStressCache1D)
+TEST_ADD(PropagatorTest, testAdaptive1D)
 TEST_END(PropagatorTest)
 
 #endif
@@ -5,10 +5,12 @@
 
 #include "PropagatorTest.h"
 #include "MixtureTest.h"
+#include "WaveListTest.h"
 
 TEST_COMPOSITE_BEGIN(SolverTestComposite)
 TEST_COMPOSITE_ADD_UNIT(PropagatorTest);
 TEST_COMPOSITE_ADD_UNIT(MixtureTest);
+TEST_COMPOSITE_ADD_UNIT(WaveListTest);
 TEST_COMPOSITE_END
 
 #endif
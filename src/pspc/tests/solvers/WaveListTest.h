@@ -0,0 +1,101 @@
+#ifndef PSPC_WAVE_LIST_TEST_H
+#define PSPC_WAVE_LIST_TEST_H
+
+#include <test/UnitTest.h>
+#include <test/UnitTestRunner.h>
+
+#include <pspc/solvers/WaveList.h>
+#include <pscf/mesh/Mesh.h>
+#include <pscf/mesh/MeshIterator.h>
+#include <pscf/crystal/UnitCell.h>
+#include <pscf/crystal/shiftToMinimum.h>
+#include <pscf/math/IntVec.h>
+
+#include <fstream>
+
+using namespace Util;
+using namespace Pscf;
+using namespace Pscf::Pspc;
+
+class WaveListTest : public UnitTest 
+{
+
+public:
+
+   void setUp()
+   {}
+
+   void tearDown()
+   {}
+
+   void testCompute2D()
+   {
+      printMethod(TEST_FUNC);
+
+      Mesh<2> mesh;
+      IntVec<2> d;
+      d[0] = 12;
+      d[1] = 10;
+      mesh.setDimensions(d);
+
+      UnitCell<2> unitCell;
+      std::ifstream in;
+      openInputFile("in/Rectangular", in);
+      in >> unitCell;
+      in.close();
+
+      WaveList<2> wavelist;
+      TEST_ASSERT(!wavelist.isAllocated());
+      wavelist.allocate(mesh, unitCell);
+      wavelist.computeMinimumImages(mesh, unitCell);
+      wavelist.computeKSq(unitCell);
+      wavelist.computedKSq(unitCell);
+      TEST_ASSERT(wavelist.isAllocated());
+      TEST_ASSERT(wavelist.hasKSq());
+      TEST_ASSERT(wavelist.hasdKSq());
+      TEST_ASSERT(wavelist.kSize() == 12*6);
+      checkWaves(mesh, unitCell, wavelist);
+
+      // Update in place after a change in unit cell parameters
+      FSArray<double, 6> parameters = unitCell.parameters();
+      parameters[0] *= 1.2;
+      parameters[1] *= 0.9;
+      unitCell.setParameters(parameters);
+      wavelist.computeKSq(unitCell);
+      wavelist.computedKSq(unitCell);
+      checkWaves(mesh, unitCell, wavelist);
+   }
+
+   template <int D>
+   void checkWaves(Mesh<D> const & mesh, UnitCell<D> const & unitCell,
+                   WaveList<D> const & wavelist)
+   {
+      MeshIterator<D> iter;
+      iter.setDimensions(wavelist.kMeshDimensions());
+      IntVec<D> G, Gmin;
+      double dkSq;
+      int i, n;
+      for (iter.begin(); !iter.atEnd(); ++iter) {
+         i = iter.rank();
+         G = iter.position();
+         Gmin = shiftToMinimum(G, mesh.dimensions(), unitCell);
+         TEST_ASSERT(Gmin == wavelist.minImage(i));
+         TEST_ASSERT(eq(unitCell.ksq(Gmin), wavelist.kSq()[i]));
+         for (n = 0; n < unitCell.nParameter(); ++n) {
+            dkSq = unitCell.dksq(Gmin, n);
+            if (G[D-1] != 0 && 
+                mesh.dimension(D-1) - G[D-1] > mesh.dimension(D-1)/2 + 1) {
+               dkSq *= 2.0;
+            }
+            TEST_ASSERT(eq(dkSq, wavelist.dkSq()(n, i)));
+         }
+      }
+   }
+
+};
+
+TEST_BEGIN(WaveListTest)
+TEST_ADD(WaveListTest, testCompute2D)
+TEST_END(WaveListTest)
+
+#endif
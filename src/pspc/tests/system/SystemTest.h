@@ -5,12 +5,16 @@
 #include <test/UnitTestRunner.h>
 
 #include <pspc/System.h>
+#include <pspc/iterator/Iterator.h>
+#include <pspc/iterator/RpaPreconditioner.h>
+#include <pspc/sweep/Sweep.h>
 #include <pscf/mesh/MeshIterator.h>
 
 //#include <pspc/iterator/AmIterator.h>
 //#include <util/format/Dbl.h>
 
 #include <fstream>
+#include <cmath>
 
 using namespace Util;
 using namespace Pscf;
@@ -701,6 +705,676 @@ public:
       TEST_ASSERT(diff);
    }
 
+   /*
+   * Compare free energy and stress computed with propagator slices
+   * stored in single precision to those obtained in double precision,
+   * for the same w fields.
+   */
+   template <int D>
+   void compareSinglePrecision(char const * paramFile, 
+                               char const * spParamFile,
+                               std::string const & wFile)
+   {
+      System<D> system;
+      system.fileMaster().setInputPrefix(filePrefix());
+      system.fileMaster().setOutputPrefix(filePrefix());
+      std::ifstream in;
+      openInputFile(paramFile, in);
+      system.readParam(in);
+      in.close();
+
+      System<D> spSystem;
+      spSystem.fileMaster().setInputPrefix(filePrefix());
+      spSystem.fileMaster().setOutputPrefix(filePrefix());
+      openInputFile(spParamFile, in);
+      spSystem.readParam(in);
+      in.close();
+
+      system.readWBasis(wFile);
+      system.compute();
+      system.computeFreeEnergy();
+      system.mixture().computeStress();
+
+      spSystem.readWBasis(wFile);
+      spSystem.compute();
+      spSystem.computeFreeEnergy();
+      spSystem.mixture().computeStress();
+
+      double f = system.fHelmholtz();
+      double fSp = spSystem.fHelmholtz();
+      TEST_ASSERT(std::abs(f - fSp) < 1.0E-6*std::abs(f));
+      int nParameter = system.unitCell().nParameter();
+      for (int i = 0; i < nParameter; ++i) {
+         double s = system.mixture().stress(i);
+         double sSp = spSystem.mixture().stress(i);
+         TEST_ASSERT(std::abs(s - sSp) < 1.0E-7);
+      }
+      if (verbose() > 0) {
+         std::cout << "\nfHelmholtz: " << f << "  " << fSp 
+                   << "\nstress[0]:  " << system.mixture().stress(0) 
+                   << "  " << spSystem.mixture().stress(0);
+      }
+   }
+
+   void testSinglePrecision1D_lam()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testSinglePrecision1D_lam.log"); 
+      compareSinglePrecision<1>("in/domainOff/System1D", 
+                                "in/singlePrecision/System1D",
+                                "contents/omega/domainOff/omega_lam");
+   }
+
+   void testSinglePrecision2D_hex()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testSinglePrecision2D_hex.log"); 
+      compareSinglePrecision<2>("in/domainOff/System2D", 
+                                "in/singlePrecision/System2D",
+                                "contents/omega/domainOff/omega_hex");
+   }
+
+   void testSinglePrecision3D_bcc()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testSinglePrecision3D_bcc.log"); 
+      compareSinglePrecision<3>("in/domainOff/System3D", 
+                                "in/singlePrecision/System3D",
+                                "contents/omega/domainOff/omega_bcc");
+   }
+
+   /*
+   * Iterate from the same perturbed w fields with an AmIterator and
+   * another iterator, and compare the resulting solutions. If isFaster
+   * is true, also require that the other iterator takes fewer steps.
+   */
+   template <int D>
+   void compareIterators(char const * paramFile,
+                         char const * otherParamFile,
+                         std::string const & wFile,
+                         bool isFaster = false)
+   {
+      System<D> system;
+      system.fileMaster().setInputPrefix(filePrefix());
+      system.fileMaster().setOutputPrefix(filePrefix());
+      std::ifstream in;
+      openInputFile(paramFile, in);
+      system.readParam(in);
+      in.close();
+
+      System<D> gridSystem;
+      gridSystem.fileMaster().setInputPrefix(filePrefix());
+      gridSystem.fileMaster().setOutputPrefix(filePrefix());
+      openInputFile(otherParamFile, in);
+      gridSystem.readParam(in);
+      in.close();
+
+      // Read w fields and scale all nonuniform components
+      system.readWBasis(wFile);
+      gridSystem.readWBasis(wFile);
+      int nMonomer = system.mixture().nMonomer();
+      int ns = system.basis().nStar();
+      for (int i = 0; i < nMonomer; ++i) {
+         for (int j = 1; j < ns; ++j) {
+            system.wFields()[i][j] *= 0.9;
+            gridSystem.wFields()[i][j] *= 0.9;
+         }
+      }
+      system.fieldIo().convertBasisToRGrid(system.wFields(),
+                                           system.wFieldsRGrid());
+      gridSystem.fieldIo().convertBasisToRGrid(gridSystem.wFields(),
+                                               gridSystem.wFieldsRGrid());
+
+      TEST_ASSERT(system.iterate() == 0);
+      TEST_ASSERT(gridSystem.iterate() == 0);
+      if (isFaster) {
+         TEST_ASSERT(gridSystem.iterator().nIteration()
+                     < system.iterator().nIteration());
+      }
+
+      double f = system.fHelmholtz();
+      double fGrid = gridSystem.fHelmholtz();
+      TEST_ASSERT(std::abs(f - fGrid) < 1.0E-8*std::abs(f));
+      double error = 0.0;
+      double err;
+      for (int i = 0; i < nMonomer; ++i) {
+         for (int j = 0; j < ns; ++j) {
+            err = system.wFields()[i][j] - gridSystem.wFields()[i][j];
+            err = std::abs(err);
+            if (err > error) {
+               error = err;
+            }
+         }
+      }
+      TEST_ASSERT(error < 1.0E-7);
+      int nParameter = system.unitCell().nParameter();
+      for (int i = 0; i < nParameter; ++i) {
+         TEST_ASSERT(std::abs(system.unitCell().parameter(i)
+                              - gridSystem.unitCell().parameter(i)) < 1.0E-7);
+      }
+      if (verbose() > 0) {
+         std::cout << "\nfHelmholtz: " << f << "  " << fGrid
+                   << "\nMax w error: " << error;
+      }
+   }
+
+   void testIterateGrid1D_lam_rigid()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testIterateGrid1D_lam_rigid.log");
+      compareIterators<1>("in/domainOff/System1D",
+                          "in/grid/System1D",
+                          "contents/omega/domainOff/omega_lam");
+   }
+
+   void testIterateGrid1D_lam_flex()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testIterateGrid1D_lam_flex.log");
+      compareIterators<1>("in/domainOn/System1D",
+                          "in/grid/System1D_flex",
+                          "contents/omega/domainOn/omega_lam");
+   }
+
+   /*
+   * Run the sweep of one system, then solve the final state of the 
+   * sweep directly with another system, and compare results.
+   */
+   template <int D>
+   void compareSweep(char const * paramFile,
+                     char const * endParamFile,
+                     std::string const & wFile)
+   {
+      System<D> system;
+      system.fileMaster().setInputPrefix(filePrefix());
+      system.fileMaster().setOutputPrefix(filePrefix());
+      std::ifstream in;
+      openInputFile(paramFile, in);
+      system.readParam(in);
+      in.close();
+      TEST_ASSERT(system.hasSweep());
+
+      System<D> endSystem;
+      endSystem.fileMaster().setInputPrefix(filePrefix());
+      endSystem.fileMaster().setOutputPrefix(filePrefix());
+      openInputFile(endParamFile, in);
+      endSystem.readParam(in);
+      in.close();
+
+      system.readWBasis(wFile);
+      system.sweep().solve();
+      TEST_ASSERT(system.hasCFields());
+
+      endSystem.readWBasis(wFile);
+      TEST_ASSERT(endSystem.iterate() == 0);
+
+      double f = system.fHelmholtz();
+      double fEnd = endSystem.fHelmholtz();
+      TEST_ASSERT(std::abs(f - fEnd) < 1.0E-8*std::abs(f));
+      int nParameter = system.unitCell().nParameter();
+      for (int i = 0; i < nParameter; ++i) {
+         TEST_ASSERT(std::abs(system.unitCell().parameter(i)
+                              - endSystem.unitCell().parameter(i)) < 1.0E-7);
+      }
+      if (verbose() > 0) {
+         std::cout << "\nfHelmholtz: " << f << "  " << fEnd;
+      }
+   }
+
+   void testIterateJfnk1D_lam_rigid()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testIterateJfnk1D_lam_rigid.log");
+      compareIterators<1>("in/domainOff/System1D",
+                          "in/jfnk/System1D",
+                          "contents/omega/domainOff/omega_lam");
+   }
+
+   void testIterateJfnk1D_lam_flex()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testIterateJfnk1D_lam_flex.log");
+      compareIterators<1>("in/domainOn/System1D",
+                          "in/jfnk/System1D_flex",
+                          "contents/omega/domainOn/omega_lam");
+   }
+
+   void testRpaCorrelation1D()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testRpaCorrelation1D.log");
+
+      System<1> system;
+      system.fileMaster().setInputPrefix(filePrefix());
+      system.fileMaster().setOutputPrefix(filePrefix());
+      std::ifstream in;
+      openInputFile("in/domainOff/System1D", in);
+      system.readParam(in);
+      in.close();
+
+      // At k = 0, S_ij = phi_i phi_j for a melt of a single diblock
+      DMatrix<double> S;
+      S.allocate(2, 2);
+      RpaPreconditioner<1>::computeCorrelation(system.mixture(), 0.0, S);
+      double fA = 0.56;
+      double fB = 0.44;
+      TEST_ASSERT(std::abs(S(0, 0) - fA*fA) < 1.0E-10);
+      TEST_ASSERT(std::abs(S(0, 1) - fA*fB) < 1.0E-10);
+      TEST_ASSERT(std::abs(S(1, 0) - fA*fB) < 1.0E-10);
+      TEST_ASSERT(std::abs(S(1, 1) - fB*fB) < 1.0E-10);
+
+      // At large k, correlations decay, and S remains symmetric
+      RpaPreconditioner<1>::computeCorrelation(system.mixture(), 100.0, S);
+      TEST_ASSERT(S(0, 0) < fA*fA);
+      TEST_ASSERT(S(0, 1) < fA*fB);
+      TEST_ASSERT(std::abs(S(0, 1) - S(1, 0)) < 1.0E-12);
+   }
+
+   void testRpaPreconditionerGain1D()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testRpaPreconditionerGain1D.log");
+
+      System<1> system;
+      system.fileMaster().setInputPrefix(filePrefix());
+      system.fileMaster().setOutputPrefix(filePrefix());
+      std::ifstream in;
+      openInputFile("in/domainOff/System1D", in);
+      system.readParam(in);
+      in.close();
+
+      // Residual along the null vector of idemp for the star with the
+      // largest |G|, at which M = chi S + idemp is nearly singular
+      int ns = system.basis().nStar();
+      DArray<double> dev0, dev1;
+      dev0.allocate(ns - 1);
+      dev1.allocate(ns - 1);
+      double* dev[2];
+      dev[0] = dev0.cArray();
+      dev[1] = dev1.cArray();
+
+      RpaPreconditioner<1> preconditioner;
+      preconditioner.allocate(2, ns);
+      double gains[3] = {1.0E+6, 100.0, 10.0};
+      for (int k = 0; k < 3; ++k) {
+         preconditioner.setMaxGain(gains[k]);
+         preconditioner.setup(system.mixture(), system.interaction(),
+                              system.basis());
+         for (int j = 0; j < ns - 1; ++j) {
+            dev0[j] = 1.0;
+            dev1[j] = 1.0;
+         }
+         preconditioner.apply(dev);
+
+         // Amplification is bounded by the maximum gain
+         TEST_ASSERT(dev0[ns - 2] > 1.0);
+         TEST_ASSERT(dev1[ns - 2] > 1.0);
+         TEST_ASSERT(dev0[ns - 2] <= gains[k]);
+         TEST_ASSERT(dev1[ns - 2] <= gains[k]);
+
+         // Without effective regularization, amplification exceeds 100
+         if (k == 0) {
+            TEST_ASSERT(dev0[ns - 2] > 100.0);
+         }
+      }
+   }
+
+   void testIteratePrecond1D_lam_rigid()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testIteratePrecond1D_lam_rigid.log");
+      compareIterators<1>("in/domainOff/System1D",
+                          "in/precond/System1D",
+                          "contents/omega/domainOff/omega_lam");
+   }
+
+   void testIteratePrecond1D_lam_flex()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testIteratePrecond1D_lam_flex.log");
+      compareIterators<1>("in/domainOn/System1D",
+                          "in/precond/System1D_flex",
+                          "contents/omega/domainOn/omega_lam", true);
+   }
+
+   void testIteratePrecond2D_hex_rigid()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testIteratePrecond2D_hex_rigid.log");
+      compareIterators<2>("in/domainOff/System2D",
+                          "in/precond/System2D",
+                          "contents/omega/domainOff/omega_hex", true);
+   }
+
+   void testIteratePrecond2D_hex_flex()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testIteratePrecond2D_hex_flex.log");
+      compareIterators<2>("in/domainOn/System2D",
+                          "in/precond/System2D_flex",
+                          "contents/omega/domainOn/omega_hex", true);
+   }
+
+   /*
+   * Converge the bcc phase from perturbed fields with preconditioning.
+   * The unpreconditioned AmIterator needs 63 iterations for this.
+   */
+   void testIteratePrecond3D_bcc_rigid()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testIteratePrecond3D_bcc_rigid.log");
+
+      System<3> system;
+      system.fileMaster().setInputPrefix(filePrefix());
+      system.fileMaster().setOutputPrefix(filePrefix());
+      std::ifstream in;
+      openInputFile("in/precond/System3D", in);
+      system.readParam(in);
+      in.close();
+
+      system.readWBasis("contents/omega/domainOff/omega_bcc");
+      int nMonomer = system.mixture().nMonomer();
+      int ns = system.basis().nStar();
+      DArray< DArray<double> > wFields_check;
+      wFields_check.allocate(nMonomer);
+      for (int i = 0; i < nMonomer; ++i) {
+         wFields_check[i] = system.wFields()[i];
+         for (int j = 1; j < ns; ++j) {
+            system.wFields()[i][j] *= 0.9;
+         }
+      }
+      system.fieldIo().convertBasisToRGrid(system.wFields(),
+                                           system.wFieldsRGrid());
+
+      TEST_ASSERT(system.iterate() == 0);
+      TEST_ASSERT(system.iterator().nIteration() <= 40);
+
+      double error = 0.0;
+      double err;
+      for (int i = 0; i < nMonomer; ++i) {
+         for (int j = 0; j < ns; ++j) {
+            err = std::abs(system.wFields()[i][j] - wFields_check[i][j]);
+            if (err > error) {
+               error = err;
+            }
+         }
+      }
+      TEST_ASSERT(error < 5.0E-7);
+      if (verbose() > 0) {
+         std::cout << "\nIterations: " << system.iterator().nIteration()
+                   << "\nMax w error: " << error;
+      }
+   }
+
+   void testSweepChi1D_lam_rigid()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testSweepChi1D_lam_rigid.log");
+      compareSweep<1>("in/sweep/System1D",
+                      "in/sweep/System1D_end",
+                      "contents/omega/domainOff/omega_lam");
+   }
+
+   void testSweepChi1D_lam_flex()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testSweepChi1D_lam_flex.log");
+      compareSweep<1>("in/sweep/System1D_flex",
+                      "in/sweep/System1D_flex_end",
+                      "contents/omega/domainOn/omega_lam");
+   }
+
+   void testBinaryRGrid3D_bcc()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testBinaryRGrid3D_bcc.log");
+
+      System<3> system;
+      system.fileMaster().setInputPrefix(filePrefix());
+      system.fileMaster().setOutputPrefix(filePrefix());
+      std::ifstream in;
+      openInputFile("in/domainOn/System3D", in);
+      system.readParam(in);
+      in.close();
+      system.readWBasis("contents/omega/domainOn/omega_bcc");
+
+      // Store r-grid fields, then write in text and binary formats
+      int nMonomer = system.mixture().nMonomer();
+      int meshSize = system.mesh().size();
+      DArray< RField<3> > wCheck;
+      wCheck.allocate(nMonomer);
+      for (int i = 0; i < nMonomer; ++i) {
+         wCheck[i].allocate(system.mesh().dimensions());
+         for (int j = 0; j < meshSize; ++j) {
+            wCheck[i][j] = system.wFieldRGrid(i)[j];
+         }
+      }
+      system.writeWRGrid("out/w_bcc.rf");
+      system.writeWRGridBinary("out/w_bcc.rfb");
+
+      // Binary round trip is exact
+      for (int i = 0; i < nMonomer; ++i) {
+         for (int j = 0; j < meshSize; ++j) {
+            system.wFieldRGrid(i)[j] = 0.0;
+         }
+      }
+      system.readWRGridBinary("out/w_bcc.rfb");
+      for (int i = 0; i < nMonomer; ++i) {
+         for (int j = 0; j < meshSize; ++j) {
+            TEST_ASSERT(system.wFieldRGrid(i)[j] == wCheck[i][j]);
+         }
+      }
+
+      // Text -> binary conversion
+      system.rGridToBinary("out/w_bcc.rf", "out/w_bcc_conv.rfb");
+      system.readWRGridBinary("out/w_bcc_conv.rfb");
+      for (int i = 0; i < nMonomer; ++i) {
+         for (int j = 0; j < meshSize; ++j) {
+            TEST_ASSERT(std::abs(system.wFieldRGrid(i)[j] 
+                                 - wCheck[i][j]) < 1.0E-12);
+         }
+      }
+
+      // Binary -> text conversion
+      system.binaryToRGrid("out/w_bcc.rfb", "out/w_bcc_conv.rf");
+      system.readWRGrid("out/w_bcc_conv.rf");
+      for (int i = 0; i < nMonomer; ++i) {
+         for (int j = 0; j < meshSize; ++j) {
+            TEST_ASSERT(std::abs(system.wFieldRGrid(i)[j] 
+                                 - wCheck[i][j]) < 1.0E-12);
+         }
+      }
+   }
+
+   /*
+   * Iterate with adaptive contour steps, and compare to a solution
+   * obtained with uniform steps.
+   */
+   void testIterateAdaptive1D_lam_flex()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testIterateAdaptive1D_lam_flex.log");
+
+      System<1> system;
+      system.fileMaster().setInputPrefix(filePrefix());
+      system.fileMaster().setOutputPrefix(filePrefix());
+      std::ifstream in;
+      openInputFile("in/domainOn/System1D", in);
+      system.readParam(in);
+      in.close();
+      system.readWBasis("contents/omega/domainOn/omega_lam");
+      TEST_ASSERT(system.iterate() == 0);
+
+      System<1> adaptive;
+      adaptive.fileMaster().setInputPrefix(filePrefix());
+      adaptive.fileMaster().setOutputPrefix(filePrefix());
+      openInputFile("in/adaptive/System1D_flex", in);
+      adaptive.readParam(in);
+      in.close();
+      TEST_ASSERT(adaptive.mixture().isAdaptive());
+      adaptive.readWBasis("contents/omega/domainOn/omega_lam");
+      TEST_ASSERT(adaptive.iterate() == 0);
+
+      // Grids are stable, with fewer steps than the initial grids
+      TEST_ASSERT(!adaptive.mixture().adaptContour());
+      int nStep = 0;
+      int nUniform = 0;
+      Polymer<1>& polymer = adaptive.mixture().polymer(0);
+      for (int j = 0; j < polymer.nBlock(); ++j) {
+         nStep += polymer.block(j).nStep();
+         nUniform += polymer.block(j).ns() - 1;
+      }
+      TEST_ASSERT(nStep < nUniform);
+
+      // Solutions agree closely
+      double f = system.fHelmholtz();
+      double fA = adaptive.fHelmholtz();
+      TEST_ASSERT(std::abs(f - fA) < 1.0E-7*std::abs(f));
+      int nMonomer = system.mixture().nMonomer();
+      int ns = system.basis().nStar();
+      double error = 0.0;
+      double err;
+      for (int i = 0; i < nMonomer; ++i) {
+         for (int j = 0; j < ns; ++j) {
+            err = std::abs(system.wField(i)[j] - adaptive.wField(i)[j]);
+            if (err > error) {
+               error = err;
+            }
+         }
+      }
+      TEST_ASSERT(error < 2.0E-5);
+      TEST_ASSERT(std::abs(system.unitCell().parameter(0)
+                           - adaptive.unitCell().parameter(0)) < 1.0E-6);
+      if (verbose() > 0) {
+         std::cout << "\nfHelmholtz: " << f << "  " << fA
+                   << "\nSteps:      " << nUniform << "  " << nStep
+                   << "\nMax w error: " << error;
+      }
+   }
+
+   /*
+   * Solve from a perturbed lamellar guess, using the parameter file
+   * paramFile, and then solve again in chunks of at most maxItr 
+   * iterations (as set in chunkParamFile), each by a new System that
+   * restarts from the checkpoint written by the previous chunk. 
+   * Require that both give the same solution and iteration count.
+   */
+   void compareCheckpoint(char const * paramFile,
+                          char const * chunkParamFile)
+   {
+      // Uninterrupted solution from a perturbed initial guess
+      System<1> system;
+      system.fileMaster().setInputPrefix(filePrefix());
+      system.fileMaster().setOutputPrefix(filePrefix());
+      std::ifstream in;
+      openInputFile(paramFile, in);
+      system.readParam(in);
+      in.close();
+      system.readWBasis("contents/omega/domainOn/omega_lam");
+      int nMonomer = system.mixture().nMonomer();
+      int ns = system.basis().nStar();
+      for (int i = 0; i < nMonomer; ++i) {
+         for (int j = 0; j < ns; ++j) {
+            system.wField(i)[j] *= 0.9;
+         }
+      }
+      system.fieldIo().convertBasisToRGrid(system.wFields(),
+                                           system.wFieldsRGrid());
+      TEST_ASSERT(system.iterate() == 0);
+      int nItr = system.iterator().nIteration();
+      TEST_ASSERT(nItr > 10);
+
+      // Same solution in chunks of at most maxItr iterations, each by
+      // a new System that restarts from the previous checkpoint
+      int total = 0;
+      int error = 1;
+      int chunk = 0;
+      while (error && chunk < 20) {
+         System<1> part;
+         part.fileMaster().setInputPrefix(filePrefix());
+         part.fileMaster().setOutputPrefix(filePrefix());
+         openInputFile(chunkParamFile, in);
+         part.readParam(in);
+         in.close();
+         if (chunk == 0) {
+            part.readWBasis("contents/omega/domainOn/omega_lam");
+            for (int i = 0; i < nMonomer; ++i) {
+               for (int j = 0; j < ns; ++j) {
+                  part.wField(i)[j] *= 0.9;
+               }
+            }
+            part.fieldIo().convertBasisToRGrid(part.wFields(),
+                                               part.wFieldsRGrid());
+         } else {
+            part.readCheckpoint("out/checkpoint_lam");
+         }
+         error = part.iterate();
+         total += part.iterator().nIteration();
+         if (error) {
+            part.writeCheckpoint("out/checkpoint_lam");
+         } else {
+            for (int i = 0; i < nMonomer; ++i) {
+               for (int j = 0; j < ns; ++j) {
+                  TEST_ASSERT(std::abs(part.wField(i)[j] 
+                                       - system.wField(i)[j]) < 1.0E-10);
+               }
+            }
+            TEST_ASSERT(std::abs(part.unitCell().parameter(0)
+                             - system.unitCell().parameter(0)) < 1.0E-12);
+         }
+         ++chunk;
+      }
+      TEST_ASSERT(error == 0);
+      TEST_ASSERT(chunk > 1);
+      TEST_ASSERT(total == nItr);
+      if (verbose() > 0) {
+         std::cout << "\nIterations: " << nItr << "  " << total 
+                   << " in " << chunk << " runs";
+      }
+   }
+
+   void testCheckpoint1D_lam_flex()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testCheckpoint1D_lam_flex.log");
+      compareCheckpoint("in/domainOn/System1D",
+                        "in/checkpoint/System1D_flex");
+   }
+
+   void testCheckpointGrid1D_lam_flex()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testCheckpointGrid1D_lam_flex.log");
+      compareCheckpoint("in/grid/System1D_flex",
+                        "in/checkpoint/System1D_grid_flex");
+   }
+
+   /*
+   * An iterator without saveState and loadState cannot checkpoint.
+   */
+   void testCheckpointJfnk1D_lam()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testCheckpointJfnk1D_lam.log");
+
+      System<1> system;
+      system.fileMaster().setInputPrefix(filePrefix());
+      system.fileMaster().setOutputPrefix(filePrefix());
+      std::ifstream in;
+      openInputFile("in/jfnk/System1D", in);
+      system.readParam(in);
+      in.close();
+      system.readWBasis("contents/omega/domainOff/omega_lam");
+      TEST_ASSERT(!system.iterator().canSaveState());
+
+      bool thrown = false;
+      try {
+         system.writeCheckpoint("out/checkpoint_jfnk");
+      } catch (Exception&) {
+         thrown = true;
+      }
+      TEST_ASSERT(thrown);
+   }
 
 };
 
@@ -710,12 +1384,33 @@ TEST_ADD(SystemTest, testReadParameters1D)
 TEST_ADD(SystemTest, testConversion1D_lam)
 TEST_ADD(SystemTest, testConversion2D_hex)
 TEST_ADD(SystemTest, testConversion3D_bcc)
+TEST_ADD(SystemTest, testBinaryRGrid3D_bcc)
 TEST_ADD(SystemTest, testIterate1D_lam_rigid)
 TEST_ADD(SystemTest, testIterate1D_lam_flex)
 TEST_ADD(SystemTest, testIterate2D_hex_rigid)
 TEST_ADD(SystemTest, testIterate2D_hex_flex)
 TEST_ADD(SystemTest, testIterate3D_bcc_rigid)
 TEST_ADD(SystemTest, testIterate3D_bcc_flex)
+TEST_ADD(SystemTest, testSinglePrecision1D_lam)
+TEST_ADD(SystemTest, testSinglePrecision2D_hex)
+TEST_ADD(SystemTest, testSinglePrecision3D_bcc)
+TEST_ADD(SystemTest, testIterateGrid1D_lam_rigid)
+TEST_ADD(SystemTest, testIterateGrid1D_lam_flex)
+TEST_ADD(SystemTest, testIterateJfnk1D_lam_rigid)
+TEST_ADD(SystemTest, testIterateJfnk1D_lam_flex)
+TEST_ADD(SystemTest, testRpaCorrelation1D)
+TEST_ADD(SystemTest, testRpaPreconditionerGain1D)
+TEST_ADD(SystemTest, testIteratePrecond1D_lam_rigid)
+TEST_ADD(SystemTest, testIteratePrecond1D_lam_flex)
+TEST_ADD(SystemTest, testIteratePrecond2D_hex_rigid)
+TEST_ADD(SystemTest, testIteratePrecond2D_hex_flex)
+TEST_ADD(SystemTest, testIteratePrecond3D_bcc_rigid)
+TEST_ADD(SystemTest, testSweepChi1D_lam_rigid)
+TEST_ADD(SystemTest, testSweepChi1D_lam_flex)
+TEST_ADD(SystemTest, testIterateAdaptive1D_lam_flex)
+TEST_ADD(SystemTest, testCheckpoint1D_lam_flex)
+TEST_ADD(SystemTest, testCheckpointGrid1D_lam_flex)
+TEST_ADD(SystemTest, testCheckpointJfnk1D_lam)
 
 TEST_END(SystemTest)
 